@@ -0,0 +1,412 @@
+#define _GNU_SOURCE // mkdir() con -std=c99
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <math.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "sequence_generator.h"
+
+/**
+ * Generador determinista del corpus de las pruebas de rendimiento (make bench)
+ *
+ * Con la misma semilla y las mismas opciones produce siempre los mismos bytes,
+ * así que los resultados de dos commits se pueden comparar. Las secuencias
+ * alternan tramos aleatorios con repeticiones (ver sequence_generator.h); el
+ * porcentaje y la longitud de las repeticiones se controlan desde la línea de
+ * comandos.
+ */
+
+#define TAMANO_BUFFER_SALIDA (1 << 20)
+#define BASES_POR_LINEA_FASTA 60
+#define BASES_POR_REGISTRO_FASTA (1 << 20)
+#define BASES_POR_LECTURA_FASTQ 150
+
+typedef enum {
+    CORPUS_FASTA,
+    CORPUS_FASTQ,
+    CORPUS_BINARIO,
+    CORPUS_ARBOL
+} TipoCorpus;
+
+// Distribución de los tamaños de los archivos del árbol
+typedef enum {
+    TAMANOS_UNIFORME,           // Entre la mitad y una vez y media el tamaño medio
+    TAMANOS_FIJO,               // Todos iguales al tamaño medio
+    TAMANOS_EXPONENCIAL         // Muchos archivos diminutos y una cola de grandes
+} DistribucionTamanos;
+
+typedef struct {
+    TipoCorpus tipo;
+    const char* salida;
+    size_t tamano;              // Del archivo, o tamaño medio de cada archivo del árbol
+    size_t num_archivos;        // Solo árbol
+    size_t por_directorio;      // Solo árbol
+    int profundidad;            // Solo árbol: niveles de subdirectorios
+    size_t ramas;               // Solo árbol: subdirectorios de cada nivel intermedio
+    DistribucionTamanos distribucion;
+    int repeticiones;           // Porcentaje aproximado de bases en repeticiones
+    int longitud_repeticion;    // Longitud máxima de cada tramo
+    uint64_t semilla;
+} OpcionesCorpus;
+
+static const char CALIDADES[5] = {'#', '+', '5', '?', 'F'}; // Calidades agrupadas de Illumina
+
+// Escritura con un buffer propio que se corta exactamente en el tamaño pedido
+typedef struct {
+    FILE* archivo;
+    char* buffer;
+    size_t usado;
+    size_t escritos;
+    size_t limite;
+    int error;
+} Salida;
+
+static void volcar(Salida* salida) {
+    if (salida->usado > 0 && fwrite(salida->buffer, 1, salida->usado, salida->archivo) != salida->usado) {
+        salida->error = 1;
+    }
+    salida->usado = 0;
+}
+
+// Devuelve 0 cuando ya se alcanzó el límite
+static int poner(Salida* salida, char caracter) {
+    if (salida->escritos == salida->limite) {
+        return 0;
+    }
+    if (salida->usado == TAMANO_BUFFER_SALIDA) {
+        volcar(salida);
+    }
+    salida->buffer[salida->usado++] = caracter;
+    salida->escritos++;
+    return 1;
+}
+
+static int poner_texto(Salida* salida, const char* texto) {
+    for (; *texto; texto++) {
+        if (!poner(salida, *texto)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void generar_fasta(Salida* salida, GeneradorBases* generador, size_t* registro) {
+    char cabecera[64];
+    while (salida->escritos < salida->limite) {
+        snprintf(cabecera, sizeof(cabecera), ">secuencia_%zu sintetica\n", ++*registro);
+        if (!poner_texto(salida, cabecera)) {
+            return;
+        }
+        for (size_t i = 0; i < BASES_POR_REGISTRO_FASTA; i++) {
+            if (!poner(salida, siguiente_base(generador))) {
+                return;
+            }
+            if ((i + 1) % BASES_POR_LINEA_FASTA == 0 && !poner(salida, '\n')) {
+                return;
+            }
+        }
+        if (!poner(salida, '\n')) {
+            return;
+        }
+    }
+}
+
+static void generar_fastq(Salida* salida, GeneradorBases* generador, size_t* registro) {
+    char cabecera[64];
+    // Las calidades también forman tramos: se repite la anterior con la misma frecuencia que las bases
+    int calidad = 4;
+    while (salida->escritos < salida->limite) {
+        snprintf(cabecera, sizeof(cabecera), "@lectura_%zu/1\n", ++*registro);
+        if (!poner_texto(salida, cabecera)) {
+            return;
+        }
+        for (int i = 0; i < BASES_POR_LECTURA_FASTQ; i++) {
+            if (!poner(salida, siguiente_base(generador))) {
+                return;
+            }
+        }
+        if (!poner_texto(salida, "\n+\n")) {
+            return;
+        }
+        for (int i = 0; i < BASES_POR_LECTURA_FASTQ; i++) {
+            if (aleatorio_entre(&generador->estado, 1, 100) > generador->repeticiones) {
+                calidad = aleatorio_entre(&generador->estado, 0, 4);
+            }
+            if (!poner(salida, CALIDADES[calidad])) {
+                return;
+            }
+        }
+        if (!poner(salida, '\n')) {
+            return;
+        }
+    }
+}
+
+static void generar_binario(Salida* salida, GeneradorBases* generador) {
+    while (salida->escritos < salida->limite) {
+        uint64_t valor = aleatorio(&generador->estado);
+        for (int i = 0; i < 8; i++, valor >>= 8) {
+            if (!poner(salida, (char)(valor & 0xFF))) {
+                return;
+            }
+        }
+    }
+}
+
+// Crea un archivo del corpus con el contenido del tipo indicado
+static int escribir_archivo(const char* ruta, TipoCorpus tipo, size_t tamano,
+                            GeneradorBases* generador, size_t* registro, char* buffer) {
+    FILE* archivo = fopen(ruta, "wb");
+    if (!archivo) {
+        fprintf(stderr, "Error: No se pudo crear '%s': %s\n", ruta, strerror(errno));
+        return -1;
+    }
+    Salida salida = {archivo, buffer, 0, 0, tamano, 0};
+    switch (tipo) {
+        case CORPUS_FASTQ:   generar_fastq(&salida, generador, registro); break;
+        case CORPUS_BINARIO: generar_binario(&salida, generador); break;
+        default:             generar_fasta(&salida, generador, registro); break;
+    }
+    volcar(&salida);
+    if (fclose(archivo) != 0 || salida.error) {
+        fprintf(stderr, "Error: No se pudo escribir '%s'\n", ruta);
+        return -1;
+    }
+    return 0;
+}
+
+static int crear_directorio(const char* ruta) {
+    if (mkdir(ruta, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Error: No se pudo crear el directorio '%s': %s\n", ruta, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+// Tamaño de un archivo del árbol según la distribución pedida
+static size_t tamano_archivo_arbol(const OpcionesCorpus* opciones, GeneradorBases* generador) {
+    double medio = (double)opciones->tamano;
+    switch (opciones->distribucion) {
+        case TAMANOS_FIJO:
+            return opciones->tamano;
+        case TAMANOS_EXPONENCIAL: {
+            // Inversa de la función de distribución, con una cola hasta 32 veces la media
+            double u = ((double)(aleatorio(&generador->estado) >> 11) + 0.5) / 9007199254740992.0;
+            double tamano = -medio * log(u);
+            return (size_t)(tamano < medio * 32.0 ? tamano : medio * 32.0);
+        }
+        default:
+            return opciones->tamano / 2 + (size_t)(aleatorio(&generador->estado) % (opciones->tamano + 1));
+    }
+}
+
+// Ruta del directorio hoja número indice: con profundidad P, los P - 1 niveles
+// intermedios tienen ramas subdirectorios cada uno y el primero crece sin límite
+static void ruta_directorio_arbol(const OpcionesCorpus* opciones, size_t indice, char* ruta, size_t capacidad) {
+    size_t componentes[64];
+    for (int nivel = opciones->profundidad - 1; nivel > 0; nivel--) {
+        componentes[nivel] = indice % opciones->ramas;
+        indice /= opciones->ramas;
+    }
+    componentes[0] = indice;
+    int largo = snprintf(ruta, capacidad, "%s", opciones->salida);
+    for (int nivel = 0; nivel < opciones->profundidad && largo > 0 && (size_t)largo < capacidad; nivel++) {
+        largo += snprintf(ruta + largo, capacidad - (size_t)largo, "/dir_%04zu", componentes[nivel]);
+    }
+}
+
+// Crea un directorio y los que le faltan por encima, hasta la raíz del árbol
+static int crear_directorios(const char* raiz, char* ruta) {
+    for (char* barra = ruta + strlen(raiz) + 1; (barra = strchr(barra, '/')) != NULL; barra++) {
+        *barra = '\0';
+        int resultado = crear_directorio(ruta);
+        *barra = '/';
+        if (resultado != 0) {
+            return -1;
+        }
+    }
+    return crear_directorio(ruta);
+}
+
+// Árbol de archivos FASTA pequeños repartidos en directorios hoja de
+// por_directorio archivos, a la profundidad pedida
+static int generar_arbol(const OpcionesCorpus* opciones, GeneradorBases* generador, char* buffer) {
+    if (crear_directorio(opciones->salida) != 0) {
+        return -1;
+    }
+    char directorio[4096];
+    char ruta[4096 + 32];
+    size_t registro = 0;
+    for (size_t i = 0; i < opciones->num_archivos; i++) {
+        if (i % opciones->por_directorio == 0) {
+            ruta_directorio_arbol(opciones, i / opciones->por_directorio, directorio, sizeof(directorio));
+            if (crear_directorios(opciones->salida, directorio) != 0) {
+                return -1;
+            }
+        }
+        snprintf(ruta, sizeof(ruta), "%s/archivo_%06zu.fa", directorio, i);
+        size_t tamano = tamano_archivo_arbol(opciones, generador);
+        if (escribir_archivo(ruta, CORPUS_FASTA, tamano, generador, &registro, buffer) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int parsear_tamano(const char* texto, size_t* tamano) {
+    char* fin;
+    unsigned long long valor = strtoull(texto, &fin, 10);
+    if (fin == texto || texto[0] == '-') {
+        return -1;
+    }
+    switch (*fin) {
+        case 'k': case 'K': valor <<= 10; fin++; break;
+        case 'm': case 'M': valor <<= 20; fin++; break;
+        case 'g': case 'G': valor <<= 30; fin++; break;
+        default: break;
+    }
+    if (*fin != '\0' || valor == 0) {
+        return -1;
+    }
+    *tamano = (size_t)valor;
+    return 0;
+}
+
+static void mostrar_uso(const char* programa) {
+    printf("Uso: %s TIPO SALIDA [opciones]\n\n", programa);
+    printf("Tipos:\n");
+    printf("  fasta                 Secuencias en registros de 1 Mb con líneas de 60 bases\n");
+    printf("  fastq                 Lecturas de 150 bases con calidades agrupadas\n");
+    printf("  binario               Bytes aleatorios (incompresibles)\n");
+    printf("  arbol                 Directorio con muchos archivos FASTA pequeños\n\n");
+    printf("Opciones:\n");
+    printf("  -s TAM                Tamaño del archivo, o tamaño medio de cada archivo del árbol\n");
+    printf("                        (por defecto 16M, o 4K en el árbol)\n");
+    printf("  -n N                  Archivos del árbol (por defecto 1000)\n");
+    printf("  --por-directorio N    Archivos en cada directorio hoja del árbol (por defecto 100)\n");
+    printf("  --profundidad N       Niveles de directorios del árbol (1-16, por defecto 1)\n");
+    printf("  --ramas N             Subdirectorios de cada nivel intermedio (por defecto 10)\n");
+    printf("  --distribucion D      Tamaños del árbol: uniforme (entre la mitad y 1,5 veces el\n");
+    printf("                        medio), fijo o exponencial (por defecto uniforme)\n");
+    printf("  -r PCT                Porcentaje aproximado de bases en repeticiones (0-100, por defecto 50)\n");
+    printf("  -l N                  Longitud máxima de cada repetición o tramo aleatorio (2-64, por defecto 12)\n");
+    printf("  --semilla N           Semilla del generador (por defecto 1)\n");
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        mostrar_uso(argv[0]);
+        return 1;
+    }
+
+    OpcionesCorpus opciones = {CORPUS_FASTA, argv[2], 0, 1000, 100, 1, 10, TAMANOS_UNIFORME, 50, 12, 1};
+    if (strcmp(argv[1], "fasta") == 0) {
+        opciones.tipo = CORPUS_FASTA;
+    } else if (strcmp(argv[1], "fastq") == 0) {
+        opciones.tipo = CORPUS_FASTQ;
+    } else if (strcmp(argv[1], "binario") == 0 || strcmp(argv[1], "binary") == 0) {
+        opciones.tipo = CORPUS_BINARIO;
+    } else if (strcmp(argv[1], "arbol") == 0 || strcmp(argv[1], "tree") == 0) {
+        opciones.tipo = CORPUS_ARBOL;
+    } else {
+        fprintf(stderr, "Error: Tipo de corpus desconocido '%s'\n", argv[1]);
+        return 1;
+    }
+
+    for (int i = 3; i < argc; i++) {
+        const char* valor = i + 1 < argc ? argv[i + 1] : NULL;
+        char* fin = NULL;
+        if (!valor) {
+            fprintf(stderr, "Error: %s requiere un valor\n", argv[i]);
+            return 1;
+        }
+        if (strcmp(argv[i], "-s") == 0) {
+            if (parsear_tamano(valor, &opciones.tamano) != 0) {
+                fprintf(stderr, "Error: Tamaño inválido '%s'\n", valor);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-n") == 0) {
+            opciones.num_archivos = strtoul(valor, &fin, 10);
+            if (*fin != '\0' || opciones.num_archivos == 0) {
+                fprintf(stderr, "Error: Número de archivos inválido '%s'\n", valor);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--por-directorio") == 0) {
+            opciones.por_directorio = strtoul(valor, &fin, 10);
+            if (*fin != '\0' || opciones.por_directorio == 0) {
+                fprintf(stderr, "Error: Archivos por directorio inválidos '%s'\n", valor);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--profundidad") == 0 || strcmp(argv[i], "--depth") == 0) {
+            opciones.profundidad = (int)strtol(valor, &fin, 10);
+            if (*fin != '\0' || opciones.profundidad < 1 || opciones.profundidad > 16) {
+                fprintf(stderr, "Error: Profundidad inválida '%s' (1-16)\n", valor);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--ramas") == 0 || strcmp(argv[i], "--fanout") == 0) {
+            opciones.ramas = strtoul(valor, &fin, 10);
+            if (*fin != '\0' || opciones.ramas < 2) {
+                fprintf(stderr, "Error: Número de ramas inválido '%s' (2 o más)\n", valor);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--distribucion") == 0 || strcmp(argv[i], "--distribution") == 0) {
+            if (strcmp(valor, "uniforme") == 0 || strcmp(valor, "uniform") == 0) {
+                opciones.distribucion = TAMANOS_UNIFORME;
+            } else if (strcmp(valor, "fijo") == 0 || strcmp(valor, "fixed") == 0) {
+                opciones.distribucion = TAMANOS_FIJO;
+            } else if (strcmp(valor, "exponencial") == 0 || strcmp(valor, "exponential") == 0) {
+                opciones.distribucion = TAMANOS_EXPONENCIAL;
+            } else {
+                fprintf(stderr, "Error: Distribución desconocida '%s' (uniforme, fijo, exponencial)\n", valor);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-r") == 0) {
+            opciones.repeticiones = (int)strtol(valor, &fin, 10);
+            if (*fin != '\0' || opciones.repeticiones < 0 || opciones.repeticiones > 100) {
+                fprintf(stderr, "Error: Porcentaje de repeticiones inválido '%s' (0-100)\n", valor);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-l") == 0) {
+            opciones.longitud_repeticion = (int)strtol(valor, &fin, 10);
+            if (*fin != '\0' || opciones.longitud_repeticion < 2 || opciones.longitud_repeticion > 64) {
+                fprintf(stderr, "Error: Longitud de repetición inválida '%s' (2-64)\n", valor);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--semilla") == 0 || strcmp(argv[i], "--seed") == 0) {
+            opciones.semilla = strtoull(valor, &fin, 10);
+            if (*fin != '\0') {
+                fprintf(stderr, "Error: Semilla inválida '%s'\n", valor);
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Error: Opción desconocida '%s'\n", argv[i]);
+            return 1;
+        }
+        i++;
+    }
+    if (opciones.tamano == 0) {
+        opciones.tamano = opciones.tipo == CORPUS_ARBOL ? ((size_t)4 << 10) : ((size_t)16 << 20);
+    }
+    if (opciones.tipo == CORPUS_ARBOL && opciones.tamano > ((size_t)1 << 30) / 32) {
+        fprintf(stderr, "Error: El tamaño medio de los archivos del árbol no puede superar 32M\n");
+        return 1;
+    }
+
+    char* buffer = malloc(TAMANO_BUFFER_SALIDA);
+    if (!buffer) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para el buffer de salida\n");
+        return 1;
+    }
+    GeneradorBases generador;
+    iniciar_generador_bases(&generador, opciones.semilla, opciones.repeticiones, opciones.longitud_repeticion);
+
+    size_t registro = 0;
+    int resultado = opciones.tipo == CORPUS_ARBOL
+                    ? generar_arbol(&opciones, &generador, buffer)
+                    : escribir_archivo(opciones.salida, opciones.tipo, opciones.tamano, &generador, &registro, buffer);
+    free(buffer);
+    return resultado == 0 ? 0 : 1;
+}
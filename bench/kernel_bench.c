@@ -0,0 +1,550 @@
+#define _GNU_SOURCE // clock_gettime() con -std=c99
+#include "../include/compression.h"
+#include "../include/encryption.h"
+#include "sequence_generator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * Microbenchmarks de los núcleos de RLE y Vigenère (make bench-kernels)
+ *
+ * Cada núcleo se mide aislado, sobre buffers ya reservados y tocados, con
+ * varios tamaños de entrada; se informa la mediana de muchas repeticiones.
+ * Antes de medir, las variantes de cada núcleo (en memoria, en el sitio, por
+ * bloques y por flujo) se comparan byte a byte: todas deben producir la misma
+ * salida. Con --base se compara cada mediana con una base guardada y una
+ * caída mayor que el umbral hace fallar la ejecución.
+ */
+
+#define TAMANOS_POR_DEFECTO "4K,64K,1M,16M,256M,1G"
+#define MAX_TAMANOS 32
+#define MAX_REPETICIONES 100000
+#define TROZO_FLUJO ((size_t)1 << 20)   // El trozo del pipeline
+#define TROZO_COMPROBACION 65537        // Impar, para cortar repeticiones y tokens por la mitad
+#define CLAVE "Genoma"
+
+// Buffers de una medida: se reservan una vez por tamaño y se reutilizan
+typedef struct {
+    char* datos;
+    size_t tamano;
+    char* comprimidos;
+    size_t tamano_comprimido;
+    char* salida;
+} Buffers;
+
+typedef void (*FuncionNucleo)(Buffers* buffers);
+
+typedef struct {
+    const char* nombre;
+    FuncionNucleo funcion;
+} Nucleo;
+
+typedef struct {
+    size_t tamanos[MAX_TAMANOS];
+    int num_tamanos;
+    const char* base;
+    const char* guardar_base;
+    double umbral;              // Caída máxima admitida, en porcentaje
+    int min_repeticiones;
+    double tiempo;              // Segundos por medida, aproximados
+} OpcionesBench;
+
+// Una medida de la base guardada
+typedef struct {
+    char nucleo[64];
+    size_t tamano;
+    double mb_s;
+} MedidaBase;
+
+static double segundos_monotonicos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void nucleo_comprimir_rle(Buffers* buffers) {
+    comprimir_rle_en(buffers->datos, buffers->tamano, buffers->comprimidos, &buffers->tamano_comprimido);
+}
+
+static void nucleo_descomprimir_rle(Buffers* buffers) {
+    size_t tamano;
+    descomprimir_rle_en(buffers->comprimidos, buffers->tamano_comprimido, buffers->salida, &tamano);
+}
+
+static void nucleo_comprimir_rle_flujo(Buffers* buffers) {
+    FlujoRle flujo;
+    iniciar_flujo_rle(&flujo);
+    size_t escritos = 0;
+    for (size_t i = 0; i < buffers->tamano; i += TROZO_FLUJO) {
+        size_t trozo = buffers->tamano - i < TROZO_FLUJO ? buffers->tamano - i : TROZO_FLUJO;
+        escritos += comprimir_rle_flujo(&flujo, buffers->datos + i, trozo, buffers->comprimidos + escritos);
+    }
+    finalizar_compresion_rle_flujo(&flujo, buffers->comprimidos + escritos);
+}
+
+static void nucleo_descomprimir_rle_flujo(Buffers* buffers) {
+    FlujoRle flujo;
+    iniciar_flujo_rle(&flujo);
+    size_t escritos = 0;
+    for (size_t i = 0; i < buffers->tamano_comprimido; i += TROZO_FLUJO) {
+        size_t resto = buffers->tamano_comprimido - i;
+        size_t trozo = resto < TROZO_FLUJO ? resto : TROZO_FLUJO;
+        escritos += descomprimir_rle_flujo(&flujo, buffers->comprimidos + i, trozo, buffers->salida + escritos);
+    }
+    finalizar_descompresion_rle_flujo(&flujo, buffers->salida + escritos);
+}
+
+static void nucleo_encriptar_vigenere(Buffers* buffers) {
+    encriptar_vigenere_en(buffers->datos, buffers->tamano, CLAVE, buffers->salida);
+}
+
+static void nucleo_desencriptar_vigenere(Buffers* buffers) {
+    desencriptar_vigenere_en(buffers->datos, buffers->tamano, CLAVE, buffers->salida);
+}
+
+// Los MB/s de todos los núcleos se calculan sobre los bytes sin comprimir
+static const Nucleo NUCLEOS[] = {
+    {"comprimir_rle", nucleo_comprimir_rle},
+    {"descomprimir_rle", nucleo_descomprimir_rle},
+    {"comprimir_rle_flujo", nucleo_comprimir_rle_flujo},
+    {"descomprimir_rle_flujo", nucleo_descomprimir_rle_flujo},
+    {"encriptar_vigenere", nucleo_encriptar_vigenere},
+    {"desencriptar_vigenere", nucleo_desencriptar_vigenere},
+};
+#define NUM_NUCLEOS (sizeof(NUCLEOS) / sizeof(NUCLEOS[0]))
+
+// Compara la salida de una variante con la referencia a partir de un desplazamiento
+static int comparar(const char* variante, const char* referencia, size_t tamano_referencia,
+                    const char* obtenido, size_t desplazamiento, size_t tamano) {
+    if (desplazamiento + tamano > tamano_referencia) {
+        fprintf(stderr, "Error: %s produce más bytes que la referencia (%zu)\n", variante, tamano_referencia);
+        return -1;
+    }
+    if (memcmp(referencia + desplazamiento, obtenido, tamano) == 0) {
+        return 0;
+    }
+    size_t i = 0;
+    while (referencia[desplazamiento + i] == obtenido[i]) {
+        i++;
+    }
+    fprintf(stderr, "Error: %s difiere de la referencia en el byte %zu\n", variante, desplazamiento + i);
+    return -1;
+}
+
+// Variantes de Vigenère: en memoria, en el sitio, por bloques y por flujo.
+// Usa buffers->comprimidos como espacio de trabajo
+static int comprobar_vigenere(Buffers* buffers, char* trozo) {
+    size_t n = buffers->tamano;
+    encriptar_vigenere_en(buffers->datos, n, CLAVE, buffers->salida);
+
+    memcpy(buffers->comprimidos, buffers->datos, n);
+    encriptar_vigenere_en_sitio(buffers->comprimidos, n, CLAVE);
+    if (comparar("encriptar_vigenere_en_sitio", buffers->salida, n, buffers->comprimidos, 0, n) != 0) {
+        return -1;
+    }
+
+    size_t posicion_clave = 0;
+    FlujoVigenere flujo;
+    iniciar_flujo_vigenere(&flujo, CLAVE, 0);
+    for (size_t i = 0; i < n; i += TROZO_COMPROBACION) {
+        size_t tamano = n - i < TROZO_COMPROBACION ? n - i : TROZO_COMPROBACION;
+        aplicar_vigenere_bloque(buffers->datos + i, trozo, tamano, CLAVE, posicion_clave, 0);
+        if (comparar("aplicar_vigenere_bloque", buffers->salida, n, trozo, i, tamano) != 0) {
+            return -1;
+        }
+        posicion_clave += contar_letras(buffers->datos + i, tamano);
+        aplicar_vigenere_flujo(&flujo, buffers->datos + i, trozo, tamano);
+        if (comparar("aplicar_vigenere_flujo", buffers->salida, n, trozo, i, tamano) != 0) {
+            return -1;
+        }
+    }
+
+    desencriptar_vigenere_en(buffers->salida, n, CLAVE, buffers->comprimidos);
+    return comparar("desencriptar_vigenere_en", buffers->datos, n, buffers->comprimidos, 0, n);
+}
+
+// Variantes de RLE: en memoria, por bloques y por flujo, en los dos sentidos.
+// Deja en buffers->comprimidos el resultado de referencia
+static int comprobar_rle(Buffers* buffers, char* trozo) {
+    size_t n = buffers->tamano;
+    comprimir_rle_en(buffers->datos, n, buffers->comprimidos, &buffers->tamano_comprimido);
+    const char* referencia = buffers->comprimidos;
+    size_t tamano_comprimido = buffers->tamano_comprimido;
+
+    // Los bloques se cortan donde un byte difiere del anterior
+    size_t desplazamiento = 0;
+    for (size_t inicio = 0; inicio < n; ) {
+        size_t fin = inicio + TROZO_COMPROBACION < n ? inicio + TROZO_COMPROBACION : n;
+        while (fin < n && buffers->datos[fin] == buffers->datos[fin - 1]) {
+            fin++;
+        }
+        int siguiente = fin < n ? (unsigned char)buffers->datos[fin] : -1;
+        size_t escritos = comprimir_rle_bloque(buffers->datos + inicio, fin - inicio, siguiente, trozo);
+        if (comparar("comprimir_rle_bloque", referencia, tamano_comprimido, trozo, desplazamiento, escritos) != 0) {
+            return -1;
+        }
+        desplazamiento += escritos;
+        inicio = fin;
+    }
+
+    FlujoRle flujo;
+    iniciar_flujo_rle(&flujo);
+    desplazamiento = 0;
+    for (size_t i = 0; i < n; i += TROZO_COMPROBACION) {
+        size_t escritos = comprimir_rle_flujo(&flujo, buffers->datos + i,
+                                              n - i < TROZO_COMPROBACION ? n - i : TROZO_COMPROBACION, trozo);
+        if (comparar("comprimir_rle_flujo", referencia, tamano_comprimido, trozo, desplazamiento, escritos) != 0) {
+            return -1;
+        }
+        desplazamiento += escritos;
+    }
+    size_t escritos = finalizar_compresion_rle_flujo(&flujo, trozo);
+    if (comparar("finalizar_compresion_rle_flujo", referencia, tamano_comprimido, trozo, desplazamiento, escritos) != 0) {
+        return -1;
+    }
+    desplazamiento += escritos;
+    if (desplazamiento != tamano_comprimido) {
+        fprintf(stderr, "Error: comprimir_rle_flujo produjo %zu bytes en lugar de %zu\n", desplazamiento, tamano_comprimido);
+        return -1;
+    }
+
+    size_t restaurado;
+    descomprimir_rle_en(referencia, tamano_comprimido, buffers->salida, &restaurado);
+    if (comparar("descomprimir_rle_en", buffers->datos, n, buffers->salida, 0, restaurado) != 0) {
+        return -1;
+    }
+
+    // Un bloque comprimido debe empezar en un token: en un byte que no sea un contador '1'..'9'
+    desplazamiento = 0;
+    for (size_t inicio = 0; inicio < tamano_comprimido; ) {
+        size_t fin = inicio + TROZO_COMPROBACION < tamano_comprimido ? inicio + TROZO_COMPROBACION : tamano_comprimido;
+        while (fin < tamano_comprimido && referencia[fin] >= '1' && referencia[fin] <= '9') {
+            fin++;
+        }
+        size_t escritos = descomprimir_rle_bloque(referencia + inicio, fin - inicio, trozo);
+        if (comparar("descomprimir_rle_bloque", buffers->datos, n, trozo, desplazamiento, escritos) != 0) {
+            return -1;
+        }
+        desplazamiento += escritos;
+        inicio = fin;
+    }
+
+    iniciar_flujo_rle(&flujo);
+    size_t restaurados = 0;
+    for (size_t i = 0; i < tamano_comprimido; i += TROZO_COMPROBACION) {
+        size_t resto = tamano_comprimido - i;
+        escritos = descomprimir_rle_flujo(&flujo, referencia + i, resto < TROZO_COMPROBACION ? resto : TROZO_COMPROBACION,
+                                          trozo);
+        if (comparar("descomprimir_rle_flujo", buffers->datos, n, trozo, restaurados, escritos) != 0) {
+            return -1;
+        }
+        restaurados += escritos;
+    }
+    escritos = finalizar_descompresion_rle_flujo(&flujo, trozo);
+    if (comparar("finalizar_descompresion_rle_flujo", buffers->datos, n, trozo, restaurados, escritos) != 0) {
+        return -1;
+    }
+    restaurados += escritos;
+    if (restaurado != n || desplazamiento != n || restaurados != n) {
+        fprintf(stderr, "Error: La descompresión en memoria, por bloques o por flujo no restaura todos los bytes\n");
+        return -1;
+    }
+    return 0;
+}
+
+static int comparar_dobles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Mediana de las repeticiones de un núcleo, tras una ejecución de calentamiento
+static double medir(const Nucleo* nucleo, Buffers* buffers, const OpcionesBench* opciones,
+                    double* tiempos, int* repeticiones) {
+    double inicio = segundos_monotonicos();
+    nucleo->funcion(buffers);
+    double estimado = segundos_monotonicos() - inicio;
+
+    double deseadas = estimado > 0.0 ? opciones->tiempo / estimado : (double)MAX_REPETICIONES;
+    int total = deseadas < (double)MAX_REPETICIONES ? (int)deseadas : MAX_REPETICIONES;
+    if (total < opciones->min_repeticiones) {
+        total = opciones->min_repeticiones;
+    }
+    for (int i = 0; i < total; i++) {
+        inicio = segundos_monotonicos();
+        nucleo->funcion(buffers);
+        tiempos[i] = segundos_monotonicos() - inicio;
+    }
+    qsort(tiempos, (size_t)total, sizeof(double), comparar_dobles);
+    *repeticiones = total;
+    return total % 2 ? tiempos[total / 2] : (tiempos[total / 2 - 1] + tiempos[total / 2]) / 2.0;
+}
+
+static int parsear_tamano(const char* texto, size_t* tamano) {
+    char* fin;
+    unsigned long long valor = strtoull(texto, &fin, 10);
+    if (fin == texto || texto[0] == '-') {
+        return -1;
+    }
+    switch (*fin) {
+        case 'k': case 'K': valor <<= 10; fin++; break;
+        case 'm': case 'M': valor <<= 20; fin++; break;
+        case 'g': case 'G': valor <<= 30; fin++; break;
+        default: break;
+    }
+    if (*fin != '\0' || valor == 0) {
+        return -1;
+    }
+    *tamano = (size_t)valor;
+    return 0;
+}
+
+static int parsear_tamanos(const char* texto, OpcionesBench* opciones) {
+    char copia[256];
+    if (strlen(texto) >= sizeof(copia)) {
+        return -1;
+    }
+    strcpy(copia, texto);
+    opciones->num_tamanos = 0;
+    for (char* parte = strtok(copia, ","); parte; parte = strtok(NULL, ",")) {
+        if (opciones->num_tamanos == MAX_TAMANOS ||
+            parsear_tamano(parte, &opciones->tamanos[opciones->num_tamanos]) != 0) {
+            return -1;
+        }
+        opciones->num_tamanos++;
+    }
+    return opciones->num_tamanos > 0 ? 0 : -1;
+}
+
+// Tamaño con el mayor sufijo exacto (4K, 16M, 1G)
+static void formatear_tamano(size_t tamano, char* destino, size_t capacidad) {
+    const char* sufijos = "KMG";
+    int sufijo = -1;
+    while (sufijo < 2 && tamano >= 1024 && tamano % 1024 == 0) {
+        tamano /= 1024;
+        sufijo++;
+    }
+    if (sufijo < 0) {
+        snprintf(destino, capacidad, "%zu", tamano);
+    } else {
+        snprintf(destino, capacidad, "%zu%c", tamano, sufijos[sufijo]);
+    }
+}
+
+// Lee la base: una medida por línea, "núcleo bytes MB/s"; '#' empieza un comentario
+static MedidaBase* leer_base(const char* ruta, int* num_medidas) {
+    FILE* archivo = fopen(ruta, "r");
+    if (!archivo) {
+        return NULL;
+    }
+    int capacidad = 64;
+    MedidaBase* medidas = malloc((size_t)capacidad * sizeof(MedidaBase));
+    char linea[256];
+    *num_medidas = 0;
+    while (medidas && fgets(linea, sizeof(linea), archivo)) {
+        MedidaBase medida;
+        if (linea[0] == '#' || sscanf(linea, "%63s %zu %lf", medida.nucleo, &medida.tamano, &medida.mb_s) != 3) {
+            continue;
+        }
+        if (*num_medidas == capacidad) {
+            capacidad *= 2;
+            MedidaBase* nuevas = realloc(medidas, (size_t)capacidad * sizeof(MedidaBase));
+            if (!nuevas) {
+                free(medidas);
+                medidas = NULL;
+                break;
+            }
+            medidas = nuevas;
+        }
+        medidas[(*num_medidas)++] = medida;
+    }
+    fclose(archivo);
+    return medidas;
+}
+
+static const MedidaBase* buscar_base(const MedidaBase* medidas, int num_medidas, const char* nucleo, size_t tamano) {
+    for (int i = 0; i < num_medidas; i++) {
+        if (medidas[i].tamano == tamano && strcmp(medidas[i].nucleo, nucleo) == 0) {
+            return &medidas[i];
+        }
+    }
+    return NULL;
+}
+
+static void mostrar_uso(const char* programa) {
+    printf("Uso: %s [opciones]\n\n", programa);
+    printf("  --tamanos LISTA       Tamaños de entrada separados por comas (por defecto %s)\n", TAMANOS_POR_DEFECTO);
+    printf("  --tiempo S            Segundos aproximados de cada medida (por defecto 0.5)\n");
+    printf("  --min-repeticiones N  Repeticiones mínimas de cada medida (por defecto 5)\n");
+    printf("  --base ARCHIVO        Comparar con una base guardada y fallar si algún núcleo\n");
+    printf("                        es más lento que el umbral\n");
+    printf("  --umbral PCT          Caída máxima de MB/s respecto de la base (por defecto 10)\n");
+    printf("  --guardar-base ARCHIVO Guardar las medianas como nueva base\n");
+}
+
+int main(int argc, char* argv[]) {
+    OpcionesBench opciones;
+    memset(&opciones, 0, sizeof(opciones));
+    opciones.umbral = 10.0;
+    opciones.min_repeticiones = 5;
+    opciones.tiempo = 0.5;
+    parsear_tamanos(TAMANOS_POR_DEFECTO, &opciones);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            mostrar_uso(argv[0]);
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Error: %s requiere un valor\n", argv[i]);
+            return 2;
+        }
+        const char* valor = argv[++i];
+        char* fin = NULL;
+        if (strcmp(argv[i - 1], "--tamanos") == 0 || strcmp(argv[i - 1], "--sizes") == 0) {
+            if (parsear_tamanos(valor, &opciones) != 0) {
+                fprintf(stderr, "Error: Lista de tamaños inválida '%s'\n", valor);
+                return 2;
+            }
+        } else if (strcmp(argv[i - 1], "--tiempo") == 0) {
+            opciones.tiempo = strtod(valor, &fin);
+            if (*fin != '\0' || opciones.tiempo < 0.0) {
+                fprintf(stderr, "Error: Tiempo inválido '%s'\n", valor);
+                return 2;
+            }
+        } else if (strcmp(argv[i - 1], "--min-repeticiones") == 0) {
+            opciones.min_repeticiones = (int)strtol(valor, &fin, 10);
+            if (*fin != '\0' || opciones.min_repeticiones < 1 || opciones.min_repeticiones > MAX_REPETICIONES) {
+                fprintf(stderr, "Error: Repeticiones inválidas '%s' (1-%d)\n", valor, MAX_REPETICIONES);
+                return 2;
+            }
+        } else if (strcmp(argv[i - 1], "--base") == 0 || strcmp(argv[i - 1], "--baseline") == 0) {
+            opciones.base = valor;
+        } else if (strcmp(argv[i - 1], "--umbral") == 0 || strcmp(argv[i - 1], "--threshold") == 0) {
+            opciones.umbral = strtod(valor, &fin);
+            if (*fin != '\0' || opciones.umbral < 0.0 || opciones.umbral >= 100.0) {
+                fprintf(stderr, "Error: Umbral inválido '%s' (0-100)\n", valor);
+                return 2;
+            }
+        } else if (strcmp(argv[i - 1], "--guardar-base") == 0 || strcmp(argv[i - 1], "--save-baseline") == 0) {
+            opciones.guardar_base = valor;
+        } else {
+            fprintf(stderr, "Error: Opción desconocida '%s'\n", argv[i - 1]);
+            return 2;
+        }
+    }
+
+    MedidaBase* base = NULL;
+    int num_base = 0;
+    if (opciones.base) {
+        base = leer_base(opciones.base, &num_base);
+        if (!base) {
+            printf("Sin base en '%s': solo se informan las medidas (guardarla con --guardar-base)\n",
+                   opciones.base);
+        }
+    }
+    FILE* nueva_base = NULL;
+    if (opciones.guardar_base) {
+        nueva_base = fopen(opciones.guardar_base, "w");
+        if (!nueva_base) {
+            fprintf(stderr, "Error: No se pudo crear la base '%s'\n", opciones.guardar_base);
+            free(base);
+            return 2;
+        }
+        fprintf(nueva_base, "# núcleo bytes MB/s (medianas de kernel_bench)\n");
+    }
+
+    double* tiempos = malloc(MAX_REPETICIONES * sizeof(double));
+    char* trozo = malloc(cota_compresion_rle(TROZO_COMPROBACION) + cota_descompresion_rle(TROZO_COMPROBACION));
+    if (!tiempos || !trozo) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para las medidas\n");
+        free(tiempos);
+        free(trozo);
+        free(base);
+        return 2;
+    }
+
+    printf("%-25s %8s %13s %13s %10s %10s %8s\n", "núcleo", "tamaño", "repeticiones", "mediana µs",
+           "MB/s", "base", "cambio");
+    int regresiones = 0;
+    int fallos = 0;
+    for (int t = 0; t < opciones.num_tamanos && !fallos; t++) {
+        size_t n = opciones.tamanos[t];
+        Buffers buffers;
+        buffers.tamano = n;
+        buffers.datos = malloc(n);
+        buffers.comprimidos = malloc(cota_compresion_rle(n));
+        buffers.salida = malloc(n);
+        if (!buffers.datos || !buffers.comprimidos || !buffers.salida) {
+            fprintf(stderr, "Error: No hay memoria para medir con %zu bytes\n", n);
+            free(buffers.datos);
+            free(buffers.comprimidos);
+            free(buffers.salida);
+            fallos = 1;
+            break;
+        }
+        // Secuencia FASTA con la mitad de las bases en repeticiones y buffers ya tocados
+        GeneradorBases generador;
+        iniciar_generador_bases(&generador, 1, 50, 12);
+        for (size_t i = 0; i < n; i++) {
+            buffers.datos[i] = (i + 1) % 61 == 0 ? '\n' : siguiente_base(&generador);
+        }
+        memset(buffers.comprimidos, 0, cota_compresion_rle(n));
+        memset(buffers.salida, 0, n);
+
+        char tamano[32];
+        formatear_tamano(n, tamano, sizeof(tamano));
+        if (comprobar_vigenere(&buffers, trozo) != 0 || comprobar_rle(&buffers, trozo) != 0) {
+            fprintf(stderr, "Error: Las variantes de los núcleos no coinciden con %s\n", tamano);
+            fallos = 1;
+        }
+
+        for (size_t k = 0; k < NUM_NUCLEOS && !fallos; k++) {
+            int repeticiones;
+            double mediana = medir(&NUCLEOS[k], &buffers, &opciones, tiempos, &repeticiones);
+            double mb_s = mediana > 0.0 ? (double)n / (1024.0 * 1024.0) / mediana : 0.0;
+            const MedidaBase* medida = base ? buscar_base(base, num_base, NUCLEOS[k].nombre, n) : NULL;
+            char columna_base[32] = "-";
+            char cambio[32] = "-";
+            const char* estado = "";
+            if (medida && medida->mb_s > 0.0) {
+                double porcentaje = (mb_s - medida->mb_s) / medida->mb_s * 100.0;
+                snprintf(columna_base, sizeof(columna_base), "%.2f", medida->mb_s);
+                snprintf(cambio, sizeof(cambio), "%+.1f%%", porcentaje);
+                if (porcentaje < -opciones.umbral) {
+                    estado = "  LENTO";
+                    regresiones++;
+                }
+            }
+            printf("%-24s %7s %13d %12.1f %10.2f %10s %8s%s\n", NUCLEOS[k].nombre, tamano, repeticiones,
+                   mediana * 1e6, mb_s, columna_base, cambio, estado);
+            fflush(stdout);
+            if (nueva_base) {
+                fprintf(nueva_base, "%s %zu %.2f\n", NUCLEOS[k].nombre, n, mb_s);
+            }
+        }
+        free(buffers.datos);
+        free(buffers.comprimidos);
+        free(buffers.salida);
+    }
+
+    free(tiempos);
+    free(trozo);
+    free(base);
+    if (nueva_base && fclose(nueva_base) != 0) {
+        fprintf(stderr, "Error: No se pudo escribir la base '%s'\n", opciones.guardar_base);
+        fallos = 1;
+    } else if (nueva_base && !fallos) {
+        printf("Base guardada en %s\n", opciones.guardar_base);
+    }
+    if (fallos) {
+        return 1;
+    }
+    if (regresiones > 0) {
+        fprintf(stderr, "Error: %d medidas son más de un %.1f%% más lentas que la base\n", regresiones, opciones.umbral);
+        return 1;
+    }
+    return 0;
+}
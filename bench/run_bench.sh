@@ -0,0 +1,213 @@
+#!/usr/bin/env bash
+# Pruebas de rendimiento de GSEA (make bench)
+#
+# Genera un corpus determinista (FASTA, FASTQ, binario aleatorio y un árbol de
+# muchos archivos pequeños), ejecuta cada codec, cifrado, operación combinada y
+# pipeline con varios números de hilos y muestra una tabla de MB/s y archivos/s.
+# Los resultados se guardan también en JSON para comparar entre commits.
+#
+# Cada medida es la mejor de varias rondas con la caché de páginas caliente.
+# Las operaciones inversas se comprueban contra el original: una salida
+# incorrecta cuenta como fallo y el script termina con código 1.
+
+set -u
+
+GSEA=./gsea
+GENERADOR=bench/corpus_generator
+CORPUS=bench_corpus
+JSON=bench_resultados.json
+TAMANO=64M
+ARCHIVOS=2000
+TAMANO_ARCHIVO=4K
+REPETICIONES=50
+SEMILLA=1
+RONDAS=3
+HILOS=""
+CLAVE=Genoma
+
+mostrar_uso() {
+    cat <<EOF
+Uso: $0 [opciones]
+
+  --gsea RUTA             Ejecutable a medir (por defecto $GSEA)
+  --generador RUTA        Generador del corpus (por defecto $GENERADOR)
+  --corpus DIR            Directorio del corpus y de las salidas; en tmpfs mide
+                          solo CPU (por defecto $CORPUS)
+  --tamano TAM            Tamaño de los archivos FASTA, FASTQ y binario (por defecto $TAMANO)
+  --archivos N            Archivos del árbol (por defecto $ARCHIVOS)
+  --tamano-archivo TAM    Tamaño medio de los archivos del árbol (por defecto $TAMANO_ARCHIVO)
+  --repeticiones PCT      Porcentaje de bases en repeticiones (por defecto $REPETICIONES)
+  --semilla N             Semilla del corpus (por defecto $SEMILLA)
+  --hilos LISTA           Números de hilos separados por comas (por defecto 1,2,4 y los núcleos)
+  --rondas N              Ejecuciones de cada medida; se toma la mejor (por defecto $RONDAS)
+  --json ARCHIVO          Resultados en JSON (por defecto $JSON)
+EOF
+}
+
+while [ $# -gt 0 ]; do
+    if [ $# -lt 2 ] && [ "$1" != "-h" ] && [ "$1" != "--help" ]; then
+        echo "Error: $1 requiere un valor" >&2
+        exit 2
+    fi
+    case "$1" in
+        --gsea) GSEA=$2 ;;
+        --generador) GENERADOR=$2 ;;
+        --corpus) CORPUS=$2 ;;
+        --tamano) TAMANO=$2 ;;
+        --archivos) ARCHIVOS=$2 ;;
+        --tamano-archivo) TAMANO_ARCHIVO=$2 ;;
+        --repeticiones) REPETICIONES=$2 ;;
+        --semilla) SEMILLA=$2 ;;
+        --hilos) HILOS=$2 ;;
+        --rondas) RONDAS=$2 ;;
+        --json) JSON=$2 ;;
+        -h|--help) mostrar_uso; exit 0 ;;
+        *) echo "Error: Opción desconocida '$1'" >&2; mostrar_uso >&2; exit 2 ;;
+    esac
+    shift 2
+done
+
+for programa in "$GSEA" "$GENERADOR"; do
+    if [ ! -x "$programa" ]; then
+        echo "Error: No se encuentra el ejecutable '$programa' (¿make bench?)" >&2
+        exit 2
+    fi
+done
+
+NUCLEOS=$(nproc 2>/dev/null || echo 1)
+if [ -z "$HILOS" ]; then
+    HILOS="1,2,4,$NUCLEOS"
+fi
+HILOS=$(echo "$HILOS" | tr ',' '\n' | grep -E '^[1-9][0-9]*$' | sort -n -u | tr '\n' ' ')
+if [ -z "$HILOS" ]; then
+    echo "Error: Lista de hilos inválida" >&2
+    exit 2
+fi
+
+# El corpus solo se regenera si cambian sus parámetros o el generador
+PARAMETROS="tamano=$TAMANO archivos=$ARCHIVOS tamano_archivo=$TAMANO_ARCHIVO repeticiones=$REPETICIONES semilla=$SEMILLA generador=$(cksum < "$GENERADOR" | cut -d' ' -f1)"
+if [ ! -f "$CORPUS/parametros" ] || [ "$(cat "$CORPUS/parametros")" != "$PARAMETROS" ]; then
+    echo "Generando corpus en $CORPUS ($PARAMETROS)..."
+    rm -rf "$CORPUS"
+    mkdir -p "$CORPUS" || exit 2
+    "$GENERADOR" fasta "$CORPUS/secuencias.fa" -s "$TAMANO" -r "$REPETICIONES" --semilla "$SEMILLA" &&
+    "$GENERADOR" fastq "$CORPUS/lecturas.fq" -s "$TAMANO" -r "$REPETICIONES" --semilla "$SEMILLA" &&
+    "$GENERADOR" binario "$CORPUS/aleatorio.bin" -s "$TAMANO" --semilla "$SEMILLA" &&
+    "$GENERADOR" arbol "$CORPUS/arbol" -n "$ARCHIVOS" -s "$TAMANO_ARCHIVO" -r "$REPETICIONES" --semilla "$SEMILLA" || exit 2
+    echo "$PARAMETROS" > "$CORPUS/parametros"
+fi
+
+SALIDAS="$CORPUS/salidas"
+REGISTRO="$CORPUS/errores.log"
+: > "$REGISTRO"
+
+# Operaciones: nombre|opciones|entrada (original o salida de otra operación)|comprobar contra el original
+OPERACIONES=(
+    "-c|-c --comp-alg rle|original|no"
+    "-d|-d --comp-alg rle|-c|si"
+    "-e|-e --enc-alg vigenere -k $CLAVE|original|no"
+    "-u|-u --enc-alg vigenere -k $CLAVE|-e|si"
+    "-ce|-ce --comp-alg rle --enc-alg vigenere -k $CLAVE|original|no"
+    "-du|-du --comp-alg rle --enc-alg vigenere -k $CLAVE|-ce|si"
+    "pipeline rle,vigenere|--pipeline rle,vigenere -k $CLAVE|original|no"
+    "pipeline -vigenere,-rle|--pipeline -vigenere,-rle -k $CLAVE|pipeline rle,vigenere|si"
+)
+
+segundos_ahora() {
+    date +%s.%N
+}
+
+# Bytes y archivos regulares de un archivo o un árbol
+contar_bytes() {
+    find "$1" -type f -printf '%s\n' | awk '{ total += $1 } END { printf "%d", total }'
+}
+contar_archivos() {
+    find "$1" -type f | wc -l
+}
+
+# Nombre de salida de una operación dentro de $SALIDAS
+ruta_salida() {
+    echo "$SALIDAS/$1.$(echo "$2" | tr -c 'a-zA-Z0-9\n' '_')"
+}
+
+FALLOS=0
+PRIMERO=1
+COMMIT=$(git rev-parse --short HEAD 2>/dev/null || echo desconocido)
+if [ "$COMMIT" != desconocido ] && [ -n "$(git status --porcelain --untracked-files=no 2>/dev/null)" ]; then
+    COMMIT="$COMMIT-modificado"
+fi
+
+{
+    printf '{\n  "commit": "%s",\n  "fecha": "%s",\n  "nucleos": %s,\n' "$COMMIT" "$(date -u +%Y-%m-%dT%H:%M:%SZ)" "$NUCLEOS"
+    printf '  "corpus": {"tamano": "%s", "archivos": %s, "tamano_archivo": "%s", "repeticiones": %s, "semilla": %s},\n' \
+        "$TAMANO" "$ARCHIVOS" "$TAMANO_ARCHIVO" "$REPETICIONES" "$SEMILLA"
+    printf '  "rondas": %s,\n  "resultados": [' "$RONDAS"
+} > "$JSON"
+
+printf '\n%-10s %-25s %5s %10s %12s %10s\n' "corpus" "operación" "hilos" "MB/s" "archivos/s" "segundos"
+printf '%s\n' "--------------------------------------------------------------------------------"
+
+for corpus in secuencias.fa lecturas.fq aleatorio.bin arbol; do
+    original="$CORPUS/$corpus"
+    bytes=$(contar_bytes "$original")
+    archivos=$(contar_archivos "$original")
+    for hilos in $HILOS; do
+        rm -rf "$SALIDAS"
+        mkdir -p "$SALIDAS"
+        for operacion in "${OPERACIONES[@]}"; do
+            IFS='|' read -r nombre opciones entrada comprobar <<< "$operacion"
+            origen=$original
+            if [ "$entrada" != original ]; then
+                origen=$(ruta_salida "$corpus" "$entrada")
+            fi
+            destino=$(ruta_salida "$corpus" "$nombre")
+
+            mejor=""
+            correcto=1
+            for ((ronda = 0; ronda < RONDAS; ronda++)); do
+                rm -rf "$destino"
+                inicio=$(segundos_ahora)
+                # shellcheck disable=SC2086 # las opciones se separan a propósito
+                if ! "$GSEA" -q $opciones -t "$hilos" -i "$origen" -o "$destino" > /dev/null 2>> "$REGISTRO"; then
+                    correcto=0
+                    break
+                fi
+                fin=$(segundos_ahora)
+                mejor=$(awk -v a="$inicio" -v b="$fin" -v m="$mejor" 'BEGIN { t = b - a; if (m != "" && m < t) t = m; printf "%.6f", t }')
+            done
+            if [ $correcto = 1 ] && [ "$comprobar" = si ]; then
+                if [ -d "$original" ]; then
+                    diff -r -q "$original" "$destino" > /dev/null 2>&1 || correcto=0
+                else
+                    cmp -s "$original" "$destino" || correcto=0
+                fi
+            fi
+
+            if [ $correcto = 0 ]; then
+                FALLOS=$((FALLOS + 1))
+                printf '%-10s %-24s %5s %10s\n' "${corpus%%.*}" "$nombre" "$hilos" "ERROR"
+                echo "Fallo: $corpus $nombre con $hilos hilos" >> "$REGISTRO"
+                continue
+            fi
+            read -r mb_s archivos_s < <(awk -v b="$bytes" -v a="$archivos" -v t="$mejor" \
+                'BEGIN { if (t <= 0) t = 1e-6; printf "%.2f %.1f", b / t / 1048576, a / t }')
+            printf '%-10s %-24s %5s %10s %12s %10s\n' "${corpus%%.*}" "$nombre" "$hilos" "$mb_s" "$archivos_s" "$mejor"
+
+            if [ $PRIMERO = 0 ]; then
+                printf ',' >> "$JSON"
+            fi
+            PRIMERO=0
+            printf '\n    {"corpus": "%s", "operacion": "%s", "hilos": %s, "bytes": %s, "archivos": %s, "segundos": %s, "mb_s": %s, "archivos_s": %s}' \
+                "${corpus%%.*}" "$nombre" "$hilos" "$bytes" "$archivos" "$mejor" "$mb_s" "$archivos_s" >> "$JSON"
+        done
+    done
+done
+rm -rf "$SALIDAS"
+
+printf '\n  ],\n  "fallos": %s\n}\n' "$FALLOS" >> "$JSON"
+echo
+echo "Resultados en JSON: $JSON"
+if [ $FALLOS -gt 0 ]; then
+    echo "Error: $FALLOS medidas fallaron (detalles en $REGISTRO)" >&2
+    exit 1
+fi
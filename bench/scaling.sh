@@ -0,0 +1,236 @@
+#!/usr/bin/env bash
+# Curva de escalado del motor de directorios (make bench-scaling)
+#
+# Crea un árbol con muchos archivos pequeños (número, distribución de tamaños
+# y profundidad configurables), lo procesa con 1..N hilos y muestra archivos/s,
+# MB/s, aceleración y eficiencia de cada punto respecto del primero. Los puntos se guardan en JSON;
+# con --base se comparan con los de una ejecución anterior, para medir cada
+# cambio del planificador contra el actual.
+#
+# Cada punto es la mejor de varias rondas con la caché de páginas caliente.
+# En tmpfs (--dir /dev/shm/...) se mide el planificador sin el disco.
+
+set -u
+
+GSEA=./gsea
+GENERADOR=bench/corpus_generator
+DIRECTORIO=bench_arbol
+JSON=bench_escalado.json
+BASE=""
+ARCHIVOS=20000
+TAMANO_ARCHIVO=4K
+DISTRIBUCION=uniforme
+PROFUNDIDAD=2
+RAMAS=10
+POR_DIRECTORIO=100
+SEMILLA=1
+HILOS=""
+MAX_HILOS=""
+RONDAS=3
+OPERACION="-c --comp-alg rle"
+OPCIONES=""
+
+mostrar_uso() {
+    cat <<EOF
+Uso: $0 [opciones]
+
+  --gsea RUTA             Ejecutable a medir (por defecto $GSEA)
+  --generador RUTA        Generador del árbol (por defecto $GENERADOR)
+  --dir DIR               Directorio del árbol y de la salida; en tmpfs no
+                          interviene el disco (por defecto $DIRECTORIO)
+  --archivos N            Archivos del árbol (por defecto $ARCHIVOS)
+  --tamano-archivo TAM    Tamaño medio de cada archivo (por defecto $TAMANO_ARCHIVO)
+  --distribucion D        uniforme, fijo o exponencial (por defecto $DISTRIBUCION)
+  --profundidad N         Niveles de directorios (por defecto $PROFUNDIDAD)
+  --ramas N               Subdirectorios de cada nivel intermedio (por defecto $RAMAS)
+  --por-directorio N      Archivos de cada directorio hoja (por defecto $POR_DIRECTORIO)
+  --semilla N             Semilla del árbol (por defecto $SEMILLA)
+  --max-hilos N           Medir con 1, 2, 4... hasta N hilos (por defecto el doble de
+                          núcleos, al menos 4)
+  --hilos LISTA           Números de hilos exactos, separados por comas
+  --operacion "OPS"       Operación de gsea (por defecto "$OPERACION")
+  --opciones "OPS"        Opciones adicionales de gsea (p. ej. "--lectores 2 --escritores 2")
+  --rondas N              Ejecuciones de cada punto; se toma la mejor (por defecto $RONDAS)
+  --json ARCHIVO          Puntos de la curva en JSON (por defecto $JSON)
+  --base ARCHIVO          JSON de una ejecución anterior con el que comparar
+EOF
+}
+
+while [ $# -gt 0 ]; do
+    if [ $# -lt 2 ] && [ "$1" != "-h" ] && [ "$1" != "--help" ]; then
+        echo "Error: $1 requiere un valor" >&2
+        exit 2
+    fi
+    case "$1" in
+        --gsea) GSEA=$2 ;;
+        --generador) GENERADOR=$2 ;;
+        --dir) DIRECTORIO=$2 ;;
+        --archivos) ARCHIVOS=$2 ;;
+        --tamano-archivo) TAMANO_ARCHIVO=$2 ;;
+        --distribucion) DISTRIBUCION=$2 ;;
+        --profundidad) PROFUNDIDAD=$2 ;;
+        --ramas) RAMAS=$2 ;;
+        --por-directorio) POR_DIRECTORIO=$2 ;;
+        --semilla) SEMILLA=$2 ;;
+        --max-hilos) MAX_HILOS=$2 ;;
+        --hilos) HILOS=$2 ;;
+        --operacion) OPERACION=$2 ;;
+        --opciones) OPCIONES=$2 ;;
+        --rondas) RONDAS=$2 ;;
+        --json) JSON=$2 ;;
+        --base) BASE=$2 ;;
+        -h|--help) mostrar_uso; exit 0 ;;
+        *) echo "Error: Opción desconocida '$1'" >&2; mostrar_uso >&2; exit 2 ;;
+    esac
+    shift 2
+done
+
+for programa in "$GSEA" "$GENERADOR"; do
+    if [ ! -x "$programa" ]; then
+        echo "Error: No se encuentra el ejecutable '$programa' (¿make bench-scaling?)" >&2
+        exit 2
+    fi
+done
+if [ -n "$BASE" ] && [ ! -f "$BASE" ]; then
+    echo "Error: No existe la base '$BASE'" >&2
+    exit 2
+fi
+
+NUCLEOS=$(nproc 2>/dev/null || echo 1)
+if [ -z "$HILOS" ]; then
+    if [ -z "$MAX_HILOS" ]; then
+        MAX_HILOS=$((NUCLEOS * 2 > 4 ? NUCLEOS * 2 : 4))
+    fi
+    HILOS=""
+    for ((h = 1; h < MAX_HILOS; h *= 2)); do
+        HILOS="$HILOS,$h"
+    done
+    HILOS="$HILOS,$MAX_HILOS"
+fi
+HILOS=$(echo "$HILOS" | tr ',' '\n' | grep -E '^[1-9][0-9]*$' | sort -n -u | tr '\n' ' ')
+if [ -z "$HILOS" ]; then
+    echo "Error: Lista de hilos inválida" >&2
+    exit 2
+fi
+
+# El árbol solo se regenera si cambian sus parámetros o el generador
+ARBOL="$DIRECTORIO/arbol"
+SALIDA="$DIRECTORIO/salida"
+PARAMETROS="archivos=$ARCHIVOS tamano_archivo=$TAMANO_ARCHIVO distribucion=$DISTRIBUCION profundidad=$PROFUNDIDAD ramas=$RAMAS por_directorio=$POR_DIRECTORIO semilla=$SEMILLA generador=$(cksum < "$GENERADOR" | cut -d' ' -f1)"
+if [ ! -f "$DIRECTORIO/parametros" ] || [ "$(cat "$DIRECTORIO/parametros")" != "$PARAMETROS" ]; then
+    echo "Generando árbol en $ARBOL ($PARAMETROS)..."
+    rm -rf "$DIRECTORIO"
+    mkdir -p "$DIRECTORIO" || exit 2
+    "$GENERADOR" arbol "$ARBOL" -n "$ARCHIVOS" -s "$TAMANO_ARCHIVO" --distribucion "$DISTRIBUCION" \
+        --profundidad "$PROFUNDIDAD" --ramas "$RAMAS" --por-directorio "$POR_DIRECTORIO" --semilla "$SEMILLA" || exit 2
+    echo "$PARAMETROS" > "$DIRECTORIO/parametros"
+fi
+
+BYTES=$(find "$ARBOL" -type f -printf '%s\n' | awk '{ total += $1 } END { printf "%d", total }')
+NUM_ARCHIVOS=$(find "$ARBOL" -type f | wc -l)
+NUM_DIRECTORIOS=$(find "$ARBOL" -mindepth 1 -type d | wc -l)
+SISTEMA=$(stat -f -c %T "$DIRECTORIO" 2>/dev/null || echo desconocido)
+REGISTRO="$DIRECTORIO/errores.log"
+: > "$REGISTRO"
+
+# archivos/s de la base para un número de hilos (vacío si no lo midió)
+archivos_s_base() {
+    [ -n "$BASE" ] || return 0
+    awk -v h="$1" 'match($0, /"hilos": *[0-9]+/) {
+        valor = substr($0, RSTART, RLENGTH); sub(/.*: */, "", valor)
+        if (valor == h && match($0, /"archivos_s": *[0-9.]+/)) {
+            v = substr($0, RSTART, RLENGTH); sub(/.*: */, "", v); print v; exit
+        }
+    }' "$BASE"
+}
+
+COMMIT=$(git rev-parse --short HEAD 2>/dev/null || echo desconocido)
+if [ "$COMMIT" != desconocido ] && [ -n "$(git status --porcelain --untracked-files=no 2>/dev/null)" ]; then
+    COMMIT="$COMMIT-modificado"
+fi
+
+echo
+echo "Árbol: $NUM_ARCHIVOS archivos, $NUM_DIRECTORIOS directorios, $BYTES bytes en $SISTEMA"
+echo "Operación: $OPERACION $OPCIONES"
+
+PUNTOS=""
+MAXIMO=0
+FALLOS=0
+T1=""
+H1=""
+for hilos in $HILOS; do
+    mejor=""
+    correcto=1
+    for ((ronda = 0; ronda < RONDAS; ronda++)); do
+        rm -rf "$SALIDA"
+        inicio=$(date +%s.%N)
+        # shellcheck disable=SC2086 # las opciones se separan a propósito
+        if ! "$GSEA" -q $OPERACION $OPCIONES -t "$hilos" -i "$ARBOL" -o "$SALIDA" > /dev/null 2>> "$REGISTRO"; then
+            correcto=0
+            break
+        fi
+        fin=$(date +%s.%N)
+        mejor=$(awk -v a="$inicio" -v b="$fin" -v m="$mejor" 'BEGIN { t = b - a; if (m != "" && m < t) t = m; printf "%.6f", t }')
+    done
+    if [ $correcto = 1 ] && [ "$(find "$SALIDA" -type f | wc -l)" != "$NUM_ARCHIVOS" ]; then
+        echo "Fallo: la salida con $hilos hilos no tiene $NUM_ARCHIVOS archivos" >> "$REGISTRO"
+        correcto=0
+    fi
+    if [ $correcto = 0 ]; then
+        FALLOS=$((FALLOS + 1))
+        echo "  $hilos hilos: ERROR"
+        continue
+    fi
+    echo "  $hilos hilos: $mejor s"
+    T1=${T1:-$mejor}
+    H1=${H1:-$hilos}
+    PUNTOS="$PUNTOS $hilos:$mejor"
+    MAXIMO=$(awk -v a="$NUM_ARCHIVOS" -v t="$mejor" -v m="$MAXIMO" 'BEGIN { v = a / t; print (v > m ? v : m) }')
+done
+rm -rf "$SALIDA"
+
+# Los puntos se escriben al final para escalar las barras de la curva al máximo
+{
+    printf '{\n  "commit": "%s",\n  "fecha": "%s",\n  "nucleos": %s,\n  "sistema_archivos": "%s",\n' \
+        "$COMMIT" "$(date -u +%Y-%m-%dT%H:%M:%SZ)" "$NUCLEOS" "$SISTEMA"
+    printf '  "operacion": "%s",\n' "$(echo "$OPERACION $OPCIONES" | sed 's/ *$//; s/"/\\"/g')"
+    printf '  "arbol": {"archivos": %s, "directorios": %s, "bytes": %s, "tamano_archivo": "%s", "distribucion": "%s", "profundidad": %s, "ramas": %s, "por_directorio": %s, "semilla": %s},\n' \
+        "$NUM_ARCHIVOS" "$NUM_DIRECTORIOS" "$BYTES" "$TAMANO_ARCHIVO" "$DISTRIBUCION" "$PROFUNDIDAD" "$RAMAS" "$POR_DIRECTORIO" "$SEMILLA"
+    printf '  "rondas": %s,\n  "puntos": [' "$RONDAS"
+} > "$JSON"
+printf '\n%5s %10s %12s %10s %12s %11s %12s %8s  %s\n' "hilos" "segundos" "archivos/s" "MB/s" \
+    "aceleración" "eficiencia" "base arch/s" "cambio" "curva"
+printf '%s\n' "------------------------------------------------------------------------------------------------------"
+PRIMERO=1
+for punto in $PUNTOS; do
+    hilos=${punto%%:*}
+    segundos=${punto#*:}
+    read -r archivos_s mb_s aceleracion eficiencia barra < <(awk -v a="$NUM_ARCHIVOS" -v b="$BYTES" \
+        -v t="$segundos" -v t1="$T1" -v h1="$H1" -v h="$hilos" -v m="$MAXIMO" 'BEGIN {
+            v = a / t; n = m > 0 ? int(v / m * 30 + 0.5) : 0; barra = ""
+            for (i = 0; i < n; i++) barra = barra "#"
+            printf "%.1f %.2f %.2f %.2f %s", v, b / t / 1048576, t1 / t, t1 / t * h1 / h, (barra == "" ? "." : barra)
+        }')
+    base=$(archivos_s_base "$hilos")
+    cambio="-"
+    if [ -n "$base" ]; then
+        cambio=$(awk -v v="$archivos_s" -v b="$base" 'BEGIN { printf (b > 0 ? "%+.1f%%" : "-"), (v - b) / b * 100 }')
+    fi
+    printf '%5s %10s %12s %10s %11sx %11s %12s %8s  %s\n' "$hilos" "$segundos" "$archivos_s" "$mb_s" \
+        "$aceleracion" "$eficiencia" "${base:--}" "$cambio" "$barra"
+
+    if [ $PRIMERO = 0 ]; then
+        printf ',' >> "$JSON"
+    fi
+    PRIMERO=0
+    printf '\n    {"hilos": %s, "segundos": %s, "archivos_s": %s, "mb_s": %s, "aceleracion": %s, "eficiencia": %s}' \
+        "$hilos" "$segundos" "$archivos_s" "$mb_s" "$aceleracion" "$eficiencia" >> "$JSON"
+done
+printf '\n  ],\n  "fallos": %s\n}\n' "$FALLOS" >> "$JSON"
+
+echo
+echo "Curva en JSON: $JSON"
+if [ $FALLOS -gt 0 ]; then
+    echo "Error: $FALLOS puntos fallaron (detalles en $REGISTRO)" >&2
+    exit 1
+fi
@@ -0,0 +1,51 @@
+#include "sequence_generator.h"
+#include <string.h>
+
+static const char BASES[4] = {'A', 'C', 'G', 'T'};
+
+void iniciar_generador_bases(GeneradorBases* generador, uint64_t semilla, int repeticiones, int longitud) {
+    memset(generador, 0, sizeof(GeneradorBases));
+    generador->estado = semilla;
+    generador->repeticiones = repeticiones;
+    generador->longitud = longitud;
+}
+
+// splitmix64: rápido, sin estado global y con la misma salida en cualquier máquina
+uint64_t aleatorio(uint64_t* estado) {
+    uint64_t z = (*estado += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+int aleatorio_entre(uint64_t* estado, int minimo, int maximo) {
+    return minimo + (int)(aleatorio(estado) % (uint64_t)(maximo - minimo + 1));
+}
+
+// Empieza un tramo nuevo; los dos tipos tienen casi la misma longitud media
+static void nuevo_tramo(GeneradorBases* generador) {
+    generador->posicion = 0;
+    if (aleatorio_entre(&generador->estado, 1, 100) <= generador->repeticiones) {
+        generador->largo_unidad = aleatorio_entre(&generador->estado, 0, 1) ? 1 : aleatorio_entre(&generador->estado, 2, 4);
+        for (int i = 0; i < generador->largo_unidad; i++) {
+            generador->unidad[i] = BASES[aleatorio(&generador->estado) & 3];
+        }
+        generador->restante = aleatorio_entre(&generador->estado, 2, generador->longitud);
+    } else {
+        generador->largo_unidad = 0;
+        generador->restante = aleatorio_entre(&generador->estado, 1, generador->longitud);
+    }
+}
+
+char siguiente_base(GeneradorBases* generador) {
+    if (generador->restante == 0) {
+        nuevo_tramo(generador);
+    }
+    generador->restante--;
+    if (generador->largo_unidad == 0) {
+        return BASES[aleatorio(&generador->estado) & 3];
+    }
+    char base = generador->unidad[generador->posicion];
+    generador->posicion = (generador->posicion + 1) % generador->largo_unidad;
+    return base;
+}
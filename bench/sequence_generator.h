@@ -0,0 +1,55 @@
+#ifndef SEQUENCE_GENERATOR_H
+#define SEQUENCE_GENERATOR_H
+
+#include <stdint.h>
+
+/**
+ * Secuencia determinista de bases por tramos: aleatorios o repeticiones
+ *
+ * Los tramos repetidos son homopolímeros o repeticiones en tándem de 2 a 4
+ * bases, que son las que aprovecha RLE. Con la misma semilla y los mismos
+ * parámetros la secuencia es idéntica en cualquier máquina.
+ */
+typedef struct {
+    uint64_t estado;
+    int repeticiones;           // Porcentaje aproximado de bases en repeticiones
+    int longitud;               // Longitud máxima de cada tramo
+    char unidad[4];
+    int largo_unidad;           // 0 en un tramo aleatorio
+    int posicion;
+    int restante;
+} GeneradorBases;
+
+/**
+ * Inicializa un generador de bases
+ * @param generador Generador a inicializar
+ * @param semilla Semilla de la secuencia
+ * @param repeticiones Porcentaje aproximado de bases en repeticiones (0-100)
+ * @param longitud Longitud máxima de cada tramo (2 o más)
+ */
+void iniciar_generador_bases(GeneradorBases* generador, uint64_t semilla, int repeticiones, int longitud);
+
+/**
+ * Siguiente número pseudoaleatorio (splitmix64)
+ * @param estado Estado del generador
+ * @return Número de 64 bits
+ */
+uint64_t aleatorio(uint64_t* estado);
+
+/**
+ * Entero pseudoaleatorio uniforme en [minimo, maximo]
+ * @param estado Estado del generador
+ * @param minimo Valor mínimo
+ * @param maximo Valor máximo
+ * @return Entero en el intervalo
+ */
+int aleatorio_entre(uint64_t* estado, int minimo, int maximo);
+
+/**
+ * Siguiente base de la secuencia
+ * @param generador Generador de bases
+ * @return 'A', 'C', 'G' o 'T'
+ */
+char siguiente_base(GeneradorBases* generador);
+
+#endif
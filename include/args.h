@@ -2,6 +2,7 @@
 #define ARGS_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 /**
  * Estructura para almacenar los argumentos parseados de la línea de comandos
@@ -12,12 +13,29 @@ typedef struct {
     bool encriptar;        // -e: encriptar archivo
     bool desencriptar;     // -u: desencriptar archivo
     char* operacion_combinada; // -ce, -de, -ec, -du: operaciones combinadas
+    char* pipeline;        // --pipeline: etapas a encadenar ("rle,vigenere")
     
     char* algoritmo_comp;  // --comp-alg: algoritmo de compresión
     char* algoritmo_enc;   // --enc-alg: algoritmo de encriptación
     char* archivo_entrada; // -i: archivo de entrada
     char* archivo_salida;  // -o: archivo de salida
     char* clave;           // -k: clave para encriptación
+    
+    int num_hilos;         // -t, --hilos: hilos trabajadores (0 = núcleos disponibles)
+    int hilos_lectura;     // --lectores: hilos de la etapa de lectura (0 = sin etapas)
+    int hilos_escritura;   // --escritores: hilos de la etapa de escritura (0 = sin etapas)
+    bool fijar_nodos;      // --fijar-nodos, --pin: fijar los trabajadores a nodos NUMA
+    bool orden_fifo;       // --orden fifo: procesar en orden de lectura del directorio
+    size_t umbral_bloques; // --umbral-bloques: tamaño a partir del cual se divide un archivo
+    size_t tamano_bloque;  // --tamano-bloque: tamaño de cada bloque
+    bool paginas_enormes;  // --paginas-enormes: buffers de trabajador con MADV_HUGEPAGE
+    size_t limite_memoria; // --limite-memoria: memoria máxima para datos en curso (0 = sin límite)
+    int nivel_log;         // -q, -v: 0 solo resumen, 1 un mensaje por archivo, 2 detalle
+    bool estadisticas_json; // --stats=json: escribir las estadísticas de la ejecución en JSON
+    char* archivo_estadisticas; // --stats=json:ARCHIVO: archivo para el JSON (NULL = stdout)
+    char* archivo_traza;   // --trace: archivo para la traza de los hilos (NULL = sin traza)
+    bool contadores_hw;    // --perf-counters: contadores de hardware por operación
+    int progreso;          // --progreso: 0 sin informe, 1 en la terminal, 2 por líneas
 } Argumentos;
 
 /**
@@ -0,0 +1,69 @@
+#ifndef BLOCK_PROCESSOR_H
+#define BLOCK_PROCESSOR_H
+
+#include <stddef.h>
+#include "scheduler.h"
+#include "memory_budget.h"
+
+/**
+ * Tamaño a partir del cual un archivo se divide en bloques por defecto
+ */
+#define UMBRAL_BLOQUES_POR_DEFECTO ((size_t)64 * 1024 * 1024)
+
+/**
+ * Tamaño nominal de cada bloque por defecto
+ */
+#define TAMANO_BLOQUE_POR_DEFECTO ((size_t)8 * 1024 * 1024)
+
+/**
+ * Función llamada cuando termina el último bloque de un archivo
+ * @param contexto Contexto indicado al dividir el archivo
+ * @param resultado 0 si todos los bloques se procesaron, -1 si hubo error
+ */
+typedef void (*FinArchivoBloques)(void* contexto, int resultado);
+
+/**
+ * Divide un archivo grande en tareas de bloque dentro de un planificador
+ *
+ * Los bloques comparten el pool con el resto de tareas, de modo que un
+ * archivo enorme ocupa todos los núcleos y convive con archivos pequeños.
+ * Las fronteras de RLE se ajustan a inicios de repetición (compresión) o
+ * de token (descompresión), por lo que la salida es idéntica a la del
+ * procesamiento secuencial. En Vigenère los bloques cuentan primero sus
+ * letras para conocer la posición de la clave en que empieza cada uno.
+ *
+ * Con presupuesto, cada bloque reserva su memoria en el peor caso al
+ * enviarse y la devuelve al escribirse, y el tamaño de bloque se reduce
+ * para que un bloque quepa en el presupuesto. Los bloques se envían a
+ * medida que hay sitio, sin que ningún trabajador espere con memoria de
+ * un bloque retenida, así que el archivo sigue usando todos los núcleos
+ * sin superar el límite.
+ *
+ * Los archivos menores que el umbral, dispersos, ya comprimidos o en
+ * contenedor disperso no se dividen: se devuelve 1 para que el llamador
+ * use procesar_archivo_individual.
+ *
+ * @param planificador Planificador donde se encolan los bloques
+ * @param id_origen Trabajador que divide el archivo, -1 desde fuera del pool
+ * @param ruta_entrada Ruta del archivo de entrada
+ * @param ruta_salida Ruta del archivo de salida
+ * @param operacion Operación a realizar ('c', 'd', 'e', 'u')
+ * @param algoritmo_comp Algoritmo de compresión
+ * @param algoritmo_enc Algoritmo de encriptación
+ * @param clave Clave para encriptación (debe vivir hasta que termine el archivo)
+ * @param umbral Tamaño mínimo para dividir el archivo
+ * @param tamano_bloque Tamaño nominal de cada bloque
+ * @param presupuesto Presupuesto de memoria compartido (NULL = sin límite)
+ * @param fin Función a llamar al terminar el último bloque
+ * @param contexto Contexto para la función de fin
+ * @return 0 si los bloques se encolaron, 1 si el archivo no se divide, -1 si hay error
+ */
+int procesar_archivo_en_bloques(Planificador* planificador, int id_origen,
+                                const char* ruta_entrada, const char* ruta_salida,
+                                char operacion, const char* algoritmo_comp,
+                                const char* algoritmo_enc, const char* clave,
+                                size_t umbral, size_t tamano_bloque,
+                                PresupuestoMemoria* presupuesto,
+                                FinArchivoBloques fin, void* contexto);
+
+#endif
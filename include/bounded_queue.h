@@ -0,0 +1,66 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <stddef.h>
+
+/**
+ * Cola FIFO acotada de punteros entre hilos
+ *
+ * Admite varios productores y varios consumidores. Encolar espera mientras
+ * la cola está llena, así que un productor rápido no puede adelantarse más
+ * de la capacidad a un consumidor lento y la memoria en vuelo queda acotada.
+ */
+typedef struct ColaAcotada ColaAcotada;
+
+/**
+ * Crea una cola acotada
+ * @param capacidad Número máximo de elementos en la cola (mayor que 0)
+ * @return Cola creada, NULL si hay error
+ */
+ColaAcotada* crear_cola_acotada(size_t capacidad);
+
+/**
+ * Añade un elemento al final, esperando mientras la cola está llena
+ * @param cola Cola destino
+ * @param elemento Elemento a encolar
+ * @return 0 si es exitoso, -1 si la cola se canceló (el elemento no se encola)
+ */
+int encolar_acotada(ColaAcotada* cola, void* elemento);
+
+/**
+ * Saca el primer elemento, esperando mientras la cola está vacía
+ * @param cola Cola origen
+ * @param elemento Puntero donde se almacenará el elemento
+ * @return 0 si se obtuvo un elemento, 1 si la cola está cerrada y vacía o cancelada
+ */
+int desencolar_acotada(ColaAcotada* cola, void** elemento);
+
+/**
+ * Indica que no se encolarán más elementos; los consumidores vacían la
+ * cola y después reciben 1 de desencolar_acotada
+ * @param cola Cola a cerrar
+ */
+void cerrar_cola_acotada(ColaAcotada* cola);
+
+/**
+ * Cancela la cola tras un error: despierta a todos los hilos que esperan,
+ * encolar devuelve -1 y desencolar devuelve 1 aunque queden elementos
+ * @param cola Cola a cancelar
+ */
+void cancelar_cola_acotada(ColaAcotada* cola);
+
+/**
+ * Obtiene el máximo de elementos que llegó a tener la cola
+ * @param cola Cola a consultar
+ * @return Ocupación máxima
+ */
+size_t ocupacion_maxima_cola(ColaAcotada* cola);
+
+/**
+ * Libera la cola y los elementos que queden en ella (tras una cancelación)
+ * @param cola Cola a liberar
+ * @param liberar_elemento Función que libera cada elemento restante (puede ser NULL)
+ */
+void destruir_cola_acotada(ColaAcotada* cola, void (*liberar_elemento)(void*));
+
+#endif
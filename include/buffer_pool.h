@@ -0,0 +1,63 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <stddef.h>
+
+/**
+ * Buffers que mantiene cada arena de trabajador
+ */
+typedef enum {
+    BUFFER_ENTRADA,  // Contenido leído del archivo
+    BUFFER_SALIDA,   // Resultado de la operación
+    NUM_BUFFERS_ARENA
+} TipoBuffer;
+
+/**
+ * Arena de buffers reutilizables de un hilo trabajador
+ *
+ * Cada buffer crece hasta el mayor tamaño pedido y se reutiliza en los
+ * archivos siguientes, así que un trabajador que procesa miles de archivos
+ * solo pide memoria al sistema cuando aparece uno más grande que los
+ * anteriores. La arena no está sincronizada: pertenece a un único hilo.
+ */
+typedef struct {
+    char* buffers[NUM_BUFFERS_ARENA];
+    size_t capacidades[NUM_BUFFERS_ARENA];
+    int paginas_enormes;    // Pedir MADV_HUGEPAGE para los buffers grandes
+    size_t reservas;        // Veces que se pidió memoria al sistema
+    size_t reutilizaciones; // Veces que bastó la capacidad existente
+} ArenaTrabajador;
+
+/**
+ * Inicializa una arena vacía (no reserva memoria hasta el primer uso)
+ * @param arena Arena a inicializar
+ * @param paginas_enormes 1 para pedir páginas enormes transparentes
+ */
+void iniciar_arena_trabajador(ArenaTrabajador* arena, int paginas_enormes);
+
+/**
+ * Obtiene un buffer de la arena con al menos la capacidad indicada
+ *
+ * El contenido previo del buffer no se conserva al crecer.
+ *
+ * @param arena Arena del trabajador
+ * @param tipo Buffer a obtener
+ * @param tamano Capacidad mínima en bytes
+ * @return Buffer válido hasta el siguiente uso del mismo tipo, NULL si hay error
+ */
+char* obtener_buffer_arena(ArenaTrabajador* arena, TipoBuffer tipo, size_t tamano);
+
+/**
+ * Obtiene la memoria reservada actualmente por la arena
+ * @param arena Arena a consultar
+ * @return Bytes reservados entre todos los buffers
+ */
+size_t memoria_arena_trabajador(const ArenaTrabajador* arena);
+
+/**
+ * Libera los buffers de la arena
+ * @param arena Arena a liberar
+ */
+void liberar_arena_trabajador(ArenaTrabajador* arena);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef CGROUP_H
+#define CGROUP_H
+
+#include <stddef.h>
+
+/**
+ * Parte de memory.max que se usa como límite de memoria por defecto; el
+ * resto queda para los buffers que conservan los hilos y para el proceso
+ */
+#define FRACCION_MEMORIA_CGROUP 2
+
+/**
+ * Límites de recursos del cgroup del proceso
+ */
+typedef struct {
+    double cpus;      // CPUs de la cuota (cpu.max: cuota/periodo; 0 = sin cuota)
+    size_t memoria;   // Bytes de memory.max (0 = sin límite)
+    int version;      // Versión de cgroup donde se encontraron (2, 1 en sistemas híbridos; 0 = ninguno)
+} LimitesCgroup;
+
+/**
+ * Obtiene los límites del cgroup del proceso
+ *
+ * Se leen una sola vez: cpu.max y memory.max del cgroup v2 del proceso y
+ * de sus antecesores, quedándose con el más restrictivo de cada uno. Si no
+ * hay jerarquía v2 con esos controladores se usan los equivalentes de v1
+ * (cpu.cfs_quota_us/cpu.cfs_period_us y memory.limit_in_bytes).
+ *
+ * @return Límites encontrados (nunca NULL; sin límites todo vale 0)
+ */
+const LimitesCgroup* obtener_limites_cgroup(void);
+
+/**
+ * Límite de memoria por defecto cuando no se indica --limite-memoria
+ * @return memory.max / FRACCION_MEMORIA_CGROUP, 0 si el cgroup no limita la memoria
+ */
+size_t limite_memoria_por_defecto(void);
+
+/**
+ * Escribe la descripción legible de los límites del cgroup
+ * @param destino Buffer donde se almacenará la descripción
+ * @param tamano Tamaño del buffer
+ */
+void describir_limites_cgroup(char* destino, size_t tamano);
+
+#endif
@@ -3,6 +3,9 @@
 
 #include <stddef.h>
 
+// Las funciones de compresión no escriben mensajes: el llamador informa de
+// los errores y del resultado
+
 /**
  * Comprime datos usando el algoritmo RLE (Run-Length Encoding)
  * @param datos Datos originales a comprimir
@@ -25,6 +28,189 @@ int comprimir_rle(const char* datos, size_t tamano_original,
 int descomprimir_rle(const char* datos_comprimidos, size_t tamano_comprimido,
                      char** datos_originales, size_t* tamano_original);
 
+/**
+ * Comprime datos con RLE sobre un buffer del llamador
+ * 
+ * Permite reutilizar el mismo buffer entre archivos en lugar de reservar
+ * el peor caso y una copia exacta en cada llamada.
+ * 
+ * @param datos Datos originales a comprimir
+ * @param tamano_original Tamaño de los datos originales
+ * @param salida Buffer de al menos 2 * tamano_original bytes
+ * @param tamano_comprimido Puntero donde se almacenará el tamaño comprimido
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int comprimir_rle_en(const char* datos, size_t tamano_original, char* salida, size_t* tamano_comprimido);
+
+/**
+ * Descomprime datos RLE sobre un buffer del llamador
+ * 
+ * @param datos_comprimidos Datos comprimidos
+ * @param tamano_comprimido Tamaño de los datos comprimidos
+ * @param salida Buffer de al menos cota_descompresion_rle(tamano_comprimido) bytes
+ * @param tamano_original Puntero donde se almacenará el tamaño original
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int descomprimir_rle_en(const char* datos_comprimidos, size_t tamano_comprimido,
+                        char* salida, size_t* tamano_original);
+
+/**
+ * Comprime un bloque con RLE sobre un buffer ya reservado, sin mensajes
+ * 
+ * Concatenar los bloques de un archivo partido en fronteras de repetición
+ * (donde un byte difiere del anterior) da el mismo resultado que comprimir_rle.
+ * 
+ * @param datos Datos del bloque
+ * @param tamano Tamaño del bloque
+ * @param siguiente Primer byte tras el bloque, -1 si el bloque termina el archivo
+ * @param salida Buffer de al menos 2 * tamano bytes
+ * @return Número de bytes escritos en la salida
+ */
+size_t comprimir_rle_bloque(const char* datos, size_t tamano, int siguiente, char* salida);
+
+/**
+ * Descomprime un bloque RLE sobre un buffer ya reservado, sin mensajes
+ * 
+ * El bloque debe empezar en un token: cualquier byte que no sea un dígito
+ * '1'..'9' lo es, porque los contadores siempre son dígitos.
+ * 
+ * @param datos Datos comprimidos del bloque
+ * @param tamano Tamaño del bloque
+ * @param salida Buffer de al menos cota_descompresion_rle(tamano) bytes
+ * @return Número de bytes escritos en la salida
+ */
+size_t descomprimir_rle_bloque(const char* datos, size_t tamano, char* salida);
+
+/**
+ * Cota superior del tamaño comprimido con RLE
+ * @param tamano Tamaño de los datos originales
+ * @return Número máximo de bytes que puede producir la compresión
+ */
+size_t cota_compresion_rle(size_t tamano);
+
+/**
+ * Cota superior del tamaño descomprimido de un bloque RLE
+ * @param tamano Tamaño de los datos comprimidos
+ * @return Número máximo de bytes que puede producir la descompresión
+ */
+size_t cota_descompresion_rle(size_t tamano);
+
+/**
+ * Estado de una compresión o descompresión RLE por trozos
+ * 
+ * Guarda la repetición (o el token) que quedó abierta al final del trozo
+ * anterior, de modo que procesar un archivo por trozos de cualquier tamaño
+ * da el mismo resultado que procesarlo entero.
+ */
+typedef struct {
+    int caracter;  // Carácter pendiente, -1 si no hay
+    int contador;  // Repeticiones acumuladas del carácter pendiente (compresión)
+} FlujoRle;
+
+/**
+ * Inicializa el estado de un flujo RLE
+ * @param flujo Estado a inicializar
+ */
+void iniciar_flujo_rle(FlujoRle* flujo);
+
+/**
+ * Comprime un trozo de un flujo RLE, sin mensajes
+ * @param flujo Estado del flujo
+ * @param datos Datos del trozo
+ * @param tamano Tamaño del trozo
+ * @param salida Buffer de al menos 2 * tamano + 2 bytes
+ * @return Número de bytes escritos en la salida
+ */
+size_t comprimir_rle_flujo(FlujoRle* flujo, const char* datos, size_t tamano, char* salida);
+
+/**
+ * Emite la repetición pendiente al terminar un flujo de compresión
+ * @param flujo Estado del flujo
+ * @param salida Buffer de al menos 2 bytes
+ * @return Número de bytes escritos en la salida
+ */
+size_t finalizar_compresion_rle_flujo(FlujoRle* flujo, char* salida);
+
+/**
+ * Descomprime un trozo de un flujo RLE, sin mensajes
+ * @param flujo Estado del flujo
+ * @param datos Datos comprimidos del trozo
+ * @param tamano Tamaño del trozo
+ * @param salida Buffer de al menos cota_descompresion_rle(tamano + 1) bytes
+ * @return Número de bytes escritos en la salida
+ */
+size_t descomprimir_rle_flujo(FlujoRle* flujo, const char* datos, size_t tamano, char* salida);
+
+/**
+ * Emite el carácter pendiente al terminar un flujo de descompresión
+ * @param flujo Estado del flujo
+ * @param salida Buffer de al menos 1 byte
+ * @return Número de bytes escritos en la salida
+ */
+size_t finalizar_descompresion_rle_flujo(FlujoRle* flujo, char* salida);
+
+/**
+ * Número de bytes iniciales necesarios para reconocer un formato ya comprimido
+ */
+#define TAMANO_FIRMA_COMPRIMIDO 16
+
+/**
+ * Reconoce datos en un formato ya comprimido (gzip, bzip2, xz, zstd, zip, 7z)
+ * 
+ * Estos datos no se benefician de RLE, así que al comprimir se guardan sin
+ * transformar en un contenedor almacenado. Al descomprimir no se usa: solo
+ * la cabecera del contenedor decide cómo se tratan los datos.
+ * 
+ * @param datos Primeros bytes del archivo
+ * @param tamano Número de bytes disponibles
+ * @return 1 si es un formato ya comprimido, 0 si no
+ */
+int es_formato_comprimido(const char* datos, size_t tamano);
+
+/**
+ * Tamaño de la cabecera de un contenedor: '\0', "GSEA" y una etiqueta de 3 letras
+ */
+#define TAMANO_CABECERA_CONTENEDOR 8
+
+/**
+ * Tipo de una salida comprimida según sus primeros bytes
+ * 
+ * Una salida comprimida que empieza por '\0' es siempre un contenedor con
+ * cabecera; cualquier otra es RLE simple. Como el RLE simple empieza por el
+ * primer byte de la entrada, las entradas que empiezan por '\0' se guardan
+ * en un contenedor RLE y ninguna salida se confunde con otro tipo.
+ */
+typedef enum {
+    CONTENEDOR_NINGUNO,     // RLE simple, sin cabecera
+    CONTENEDOR_RLE,         // RLE simple tras la cabecera
+    CONTENEDOR_DISPERSO,    // Archivo con huecos (ver serializar_mapa_disperso)
+    CONTENEDOR_ALMACENADO,  // Formato ya comprimido guardado sin transformar (ver almacenar_archivo)
+    CONTENEDOR_DESCONOCIDO  // Empieza por '\0' sin una cabecera válida
+} TipoContenedor;
+
+/**
+ * Identifica el tipo de una salida comprimida por su cabecera
+ * @param datos Primeros bytes de la salida comprimida
+ * @param tamano Número de bytes disponibles
+ * @return Tipo de contenedor (CONTENEDOR_NINGUNO para RLE simple)
+ */
+TipoContenedor identificar_contenedor(const char* datos, size_t tamano);
+
+/**
+ * Escribe la cabecera de un contenedor
+ * @param tipo Tipo de contenedor (distinto de CONTENEDOR_NINGUNO y CONTENEDOR_DESCONOCIDO)
+ * @param destino Buffer de al menos TAMANO_CABECERA_CONTENEDOR bytes
+ */
+void escribir_cabecera_contenedor(TipoContenedor tipo, char* destino);
+
+/**
+ * Indica si una entrada debe comprimirse dentro de un contenedor RLE
+ * @param datos Primeros bytes de la entrada
+ * @param tamano Número de bytes disponibles
+ * @return 1 si la entrada empieza por '\0', 0 si no
+ */
+int requiere_contenedor_rle(const char* datos, size_t tamano);
+
 /**
  * Libera la memoria asignada para datos comprimidos o descomprimidos
  * @param datos Puntero a los datos a liberar
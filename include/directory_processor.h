@@ -2,6 +2,38 @@
 #define DIRECTORY_PROCESSOR_H
 
 #include <stddef.h>
+#include "path_arena.h"
+#include "buffer_pool.h"
+#include "pipeline.h"
+#include "progress.h"
+
+/**
+ * Hilos por defecto de las etapas de lectura y escritura cuando solo se
+ * indica el tamaño de una de ellas
+ */
+#define HILOS_ETAPA_ES_POR_DEFECTO 2
+
+/**
+ * Parte del límite de memoria que las arenas de los trabajadores pueden
+ * conservar entre archivos; el resto es el presupuesto de los archivos en curso
+ */
+#define FRACCION_MEMORIA_ARENAS 2
+
+/**
+ * Opciones de concurrencia para el procesamiento de directorios
+ */
+typedef struct {
+    int num_hilos;          // Hilos trabajadores del pool (0 = núcleos disponibles)
+    int orden_fifo;         // 1: orden de lectura del directorio; 0: archivos más grandes primero
+    size_t umbral_bloques;  // Tamaño a partir del cual un archivo se divide en bloques (0 = por defecto)
+    size_t tamano_bloque;   // Tamaño nominal de cada bloque (0 = por defecto)
+    int paginas_enormes;    // 1: pedir páginas enormes para los buffers de cada trabajador
+    size_t limite_memoria;  // Memoria máxima para datos de archivos en curso (0 = sin límite)
+    int hilos_lectura;      // Hilos de la etapa de lectura (0 en ambos = sin etapas)
+    int hilos_escritura;    // Hilos de la etapa de escritura
+    int fijar_nodos;        // 1: fijar cada trabajador a las CPUs de un nodo NUMA
+    FormatoProgreso progreso; // Informe de progreso en stderr (PROGRESO_DESACTIVADO = sin informe)
+} OpcionesConcurrencia;
 
 /**
  * Procesa un directorio completo aplicando la operación especificada
@@ -10,27 +42,65 @@
  * aplicando la operación de compresión, descompresión, encriptación o desencriptación
  * según los parámetros proporcionados.
  * 
+ * Con hilos_lectura o hilos_escritura en las opciones, cada archivo pasa
+ * por tres etapas conectadas por colas acotadas: los trabajadores del
+ * planificador leen, num_hilos hilos transforman y otro grupo escribe, de
+ * modo que la E/S de unos archivos se solapa con el cálculo de otros.
+ * 
  * @param ruta_directorio Ruta del directorio a procesar
  * @param ruta_salida Ruta del directorio de salida
  * @param operacion Operación a realizar ('c', 'd', 'e', 'u')
  * @param algoritmo_comp Algoritmo de compresión (solo 'rle' disponible)
  * @param algoritmo_enc Algoritmo de encriptación (solo 'vigenere' disponible)
  * @param clave Clave para encriptación (opcional)
+ * @param opciones Opciones de concurrencia (NULL = valores por defecto)
  * @return 0 si es exitoso, -1 si hay error
  */
 int procesar_directorio(const char* ruta_directorio, const char* ruta_salida,
                         char operacion, const char* algoritmo_comp, 
-                        const char* algoritmo_enc, const char* clave);
+                        const char* algoritmo_enc, const char* clave,
+                        const OpcionesConcurrencia* opciones);
 
 /**
- * Lista todos los archivos regulares en un directorio
+ * Procesa un directorio completo aplicando una operación combinada
+ * 
+ * Usa el mismo recorrido concurrente que procesar_directorio; cada archivo
+ * encadena los dos pasos por trozos en su hilo trabajador, sin archivo
+ * intermedio. Con límite de memoria cada archivo reserva la memoria de sus
+ * trozos (o la del camino por pasos si no puede procesarse en flujo).
  * 
- * @param ruta_directorio Ruta del directorio a listar
- * @param archivos Array donde se almacenarán las rutas de los archivos
- * @param num_archivos Puntero donde se almacenará el número de archivos
+ * @param ruta_directorio Ruta del directorio a procesar
+ * @param ruta_salida Ruta del directorio de salida
+ * @param operaciones Operación combinada (-ce, -de, -ec, -du)
+ * @param algoritmo_comp Algoritmo de compresión
+ * @param algoritmo_enc Algoritmo de encriptación
+ * @param clave Clave para encriptación
+ * @param opciones Opciones de concurrencia (NULL = valores por defecto)
  * @return 0 si es exitoso, -1 si hay error
  */
-int listar_archivos_directorio(const char* ruta_directorio, char*** archivos, size_t* num_archivos);
+int procesar_directorio_combinado(const char* ruta_directorio, const char* ruta_salida,
+                                  const char* operaciones, const char* algoritmo_comp,
+                                  const char* algoritmo_enc, const char* clave,
+                                  const OpcionesConcurrencia* opciones);
+
+/**
+ * Procesa un directorio completo pasando cada archivo por un pipeline
+ * 
+ * Usa el mismo recorrido concurrente que procesar_directorio; dentro de
+ * cada trabajador las etapas se aplican trozo a trozo sin hilos propios.
+ * Con límite de memoria el tamaño de trozo se reduce hasta que la memoria
+ * en vuelo del pipeline cabe en el límite.
+ * 
+ * @param ruta_directorio Ruta del directorio a procesar
+ * @param ruta_salida Ruta del directorio de salida
+ * @param especificacion Etapas a aplicar
+ * @param clave Clave para las etapas de encriptación (puede ser NULL si no hay)
+ * @param opciones Opciones de concurrencia (NULL = valores por defecto)
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int procesar_directorio_pipeline(const char* ruta_directorio, const char* ruta_salida,
+                                 const EspecificacionPipeline* especificacion, const char* clave,
+                                 const OpcionesConcurrencia* opciones);
 
 /**
  * Crea un directorio de salida si no existe
@@ -49,15 +119,26 @@ int crear_directorio_salida(const char* ruta_directorio);
 int es_directorio(const char* ruta);
 
 /**
- * Libera la memoria asignada para la lista de archivos
+ * Procesa un archivo individual aplicando la operación especificada
  * 
- * @param archivos Array de archivos a liberar
- * @param num_archivos Número de archivos en el array
+ * @param archivo_entrada Ruta del archivo de entrada
+ * @param archivo_salida Ruta del archivo de salida
+ * @param operacion Operación a realizar ('c', 'd', 'e', 'u')
+ * @param algoritmo_comp Algoritmo de compresión
+ * @param algoritmo_enc Algoritmo de encriptación
+ * @param clave Clave para encriptación
+ * @return 0 si es exitoso, -1 si hay error
  */
-void liberar_lista_archivos(char** archivos, size_t num_archivos);
+int procesar_archivo_individual(const char* archivo_entrada, const char* archivo_salida,
+                               char operacion, const char* algoritmo_comp,
+                               const char* algoritmo_enc, const char* clave);
 
 /**
- * Procesa un archivo individual aplicando la operación especificada
+ * Procesa un archivo individual reutilizando los buffers de una arena
+ * 
+ * La lectura y el resultado usan los buffers de la arena, que crecen hasta
+ * el mayor archivo visto y se conservan para el siguiente, en lugar de
+ * reservar y liberar memoria en cada archivo.
  * 
  * @param archivo_entrada Ruta del archivo de entrada
  * @param archivo_salida Ruta del archivo de salida
@@ -65,15 +146,42 @@ void liberar_lista_archivos(char** archivos, size_t num_archivos);
  * @param algoritmo_comp Algoritmo de compresión
  * @param algoritmo_enc Algoritmo de encriptación
  * @param clave Clave para encriptación
+ * @param arena Arena del hilo que procesa el archivo
  * @return 0 si es exitoso, -1 si hay error
  */
-int procesar_archivo_individual(const char* archivo_entrada, const char* archivo_salida,
+int procesar_archivo_con_arena(const char* archivo_entrada, const char* archivo_salida,
                                char operacion, const char* algoritmo_comp,
-                               const char* algoritmo_enc, const char* clave);
+                               const char* algoritmo_enc, const char* clave,
+                               ArenaTrabajador* arena);
+
+/**
+ * Procesa un archivo individual usando todos los núcleos si es grande
+ * 
+ * Los archivos que superan el umbral de bloques se dividen en tareas de
+ * bloque sobre un pool de hilos; el resto se procesa con
+ * procesar_archivo_individual. Con límite de memoria, un archivo cuya
+ * memoria en el peor caso no cabe en el límite se procesa por trozos.
+ * 
+ * @param archivo_entrada Ruta del archivo de entrada
+ * @param archivo_salida Ruta del archivo de salida
+ * @param operacion Operación a realizar ('c', 'd', 'e', 'u')
+ * @param algoritmo_comp Algoritmo de compresión
+ * @param algoritmo_enc Algoritmo de encriptación
+ * @param clave Clave para encriptación
+ * @param opciones Opciones de concurrencia (NULL = valores por defecto)
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int procesar_archivo_concurrente(const char* archivo_entrada, const char* archivo_salida,
+                                 char operacion, const char* algoritmo_comp,
+                                 const char* algoritmo_enc, const char* clave,
+                                 const OpcionesConcurrencia* opciones);
 
 /**
  * Procesa operaciones combinadas (-ce, -de, -ec, -du)
  * 
+ * Los dos pasos se encadenan trozo a trozo en memoria, sin archivo
+ * intermedio: la entrada se lee una vez y la salida se escribe una vez.
+ * 
  * @param ruta_entrada Ruta del archivo de entrada
  * @param ruta_salida Ruta del archivo de salida
  * @param operaciones Operación combinada (-ce, -de, -ec, -du)
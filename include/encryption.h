@@ -3,6 +3,9 @@
 
 #include <stddef.h>
 
+// Las funciones de encriptación no escriben mensajes: el llamador valida la
+// clave e informa de los errores
+
 /**
  * Encripta datos usando el algoritmo Vigenère
  * 
@@ -35,6 +38,105 @@ int encriptar_vigenere(const char* datos, size_t tamano_original, const char* cl
 int desencriptar_vigenere(const char* datos_encriptados, size_t tamano_encriptado, const char* clave,
                           char** datos_originales, size_t* tamano_original);
 
+/**
+ * Encripta datos con Vigenère sobre un buffer del llamador
+ * 
+ * @param datos Datos originales a encriptar
+ * @param tamano Tamaño de los datos originales
+ * @param clave Clave secreta para la encriptación
+ * @param salida Buffer de al menos tamano bytes
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int encriptar_vigenere_en(const char* datos, size_t tamano, const char* clave, char* salida);
+
+/**
+ * Desencripta datos con Vigenère sobre un buffer del llamador
+ * 
+ * @param datos_encriptados Datos encriptados
+ * @param tamano Tamaño de los datos encriptados
+ * @param clave Clave secreta para la desencriptación
+ * @param salida Buffer de al menos tamano bytes
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int desencriptar_vigenere_en(const char* datos_encriptados, size_t tamano, const char* clave, char* salida);
+
+/**
+ * Encripta datos con Vigenère sobre el mismo buffer
+ * 
+ * Vigenère conserva el tamaño de los datos, así que no hace falta un
+ * segundo buffer: sirve tanto el buffer de lectura como una proyección
+ * MAP_SHARED del archivo de salida.
+ * 
+ * @param datos Datos a encriptar; al terminar contienen el resultado
+ * @param tamano Tamaño de los datos
+ * @param clave Clave secreta para la encriptación
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int encriptar_vigenere_en_sitio(char* datos, size_t tamano, const char* clave);
+
+/**
+ * Desencripta datos con Vigenère sobre el mismo buffer
+ * 
+ * @param datos Datos a desencriptar; al terminar contienen el resultado
+ * @param tamano Tamaño de los datos
+ * @param clave Clave secreta para la desencriptación
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int desencriptar_vigenere_en_sitio(char* datos, size_t tamano, const char* clave);
+
+/**
+ * Aplica Vigenère a un bloque sobre un buffer ya reservado, sin mensajes
+ * 
+ * La clave solo avanza con las letras, así que un bloque intermedio de un
+ * archivo necesita la posición de la clave tras las letras de los bloques
+ * anteriores (ver contar_letras).
+ * 
+ * @param entrada Datos del bloque
+ * @param salida Buffer de al menos tamano bytes (puede ser igual a entrada)
+ * @param tamano Tamaño del bloque
+ * @param clave Clave válida (ver validar_clave)
+ * @param posicion_clave Número de letras procesadas antes del bloque
+ * @param desencriptar 0 para encriptar, 1 para desencriptar
+ */
+void aplicar_vigenere_bloque(const char* entrada, char* salida, size_t tamano,
+                             const char* clave, size_t posicion_clave, int desencriptar);
+
+/**
+ * Cuenta las letras de un bloque (las posiciones que consumen clave)
+ * 
+ * @param datos Datos del bloque
+ * @param tamano Tamaño del bloque
+ * @return Número de letras (a-z, A-Z)
+ */
+size_t contar_letras(const char* datos, size_t tamano);
+
+/**
+ * Estado de una encriptación o desencriptación Vigenère por trozos
+ */
+typedef struct {
+    const char* clave;      // Clave válida (debe vivir mientras dure el flujo)
+    size_t posicion_clave;  // Letras procesadas en los trozos anteriores
+    int desencriptar;       // 0 para encriptar, 1 para desencriptar
+} FlujoVigenere;
+
+/**
+ * Inicializa un flujo Vigenère validando la clave
+ * @param flujo Estado a inicializar
+ * @param clave Clave para la operación
+ * @param desencriptar 0 para encriptar, 1 para desencriptar
+ * @return 0 si es exitoso, -1 si la clave no es válida
+ */
+int iniciar_flujo_vigenere(FlujoVigenere* flujo, const char* clave, int desencriptar);
+
+/**
+ * Aplica Vigenère a un trozo de un flujo, continuando la clave donde la dejó el anterior
+ * @param flujo Estado del flujo
+ * @param entrada Datos del trozo
+ * @param salida Buffer de al menos tamano bytes (puede ser igual a entrada)
+ * @param tamano Tamaño del trozo
+ */
+void aplicar_vigenere_flujo(FlujoVigenere* flujo, const char* entrada, char* salida, size_t tamano);
+
 /**
  * Valida que una clave sea válida para encriptación
  * 
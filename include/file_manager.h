@@ -2,6 +2,56 @@
 #define FILE_MANAGER_H
 
 #include <sys/types.h>
+#include <stddef.h>
+#include "buffer_pool.h"
+
+/**
+ * Región con datos dentro de un archivo disperso
+ */
+typedef struct {
+    off_t desplazamiento;  // Posición de la región dentro del archivo
+    size_t longitud;       // Número de bytes de datos de la región
+} ExtensionDatos;
+
+/**
+ * Mapa de las regiones con datos de un archivo (lo demás son huecos)
+ */
+typedef struct {
+    ExtensionDatos* extensiones; // Regiones con datos, en orden creciente
+    size_t num_extensiones;      // Número de regiones con datos
+    size_t tamano_logico;        // Tamaño aparente del archivo (con huecos)
+    int tiene_huecos;            // 1 si el archivo contiene al menos un hueco
+} MapaDisperso;
+
+/**
+ * Tamaño mínimo del resultado para escribirlo directamente en una proyección
+ * de la salida en lugar de en un buffer propio
+ */
+#define UMBRAL_SALIDA_PROYECTADA ((size_t)8 * 1024 * 1024)
+
+/**
+ * Archivo de salida proyectado en memoria para construir el resultado en él
+ */
+typedef struct {
+    int fd;            // Descriptor del archivo de salida
+    char* datos;       // Proyección MAP_SHARED del archivo
+    size_t capacidad;  // Bytes proyectados (cota del tamaño del resultado)
+} SalidaProyectada;
+
+/**
+ * Tamaño de la cabecera de un contenedor almacenado: la cabecera de
+ * contenedor y la posición de los datos
+ */
+#define TAMANO_CABECERA_ALMACENADA 16
+
+/**
+ * Mecanismo usado para copiar un archivo sin transformarlo
+ */
+typedef enum {
+    COPIA_FICLONE,          // Clonado de metadatos (reflink), sin copiar datos
+    COPIA_COPY_FILE_RANGE,  // Copia dentro del kernel con copy_file_range()
+    COPIA_READ_WRITE        // Copia en espacio de usuario con read()/write()
+} MetodoCopia;
 
 /**
  * Lee un archivo completo usando llamadas al sistema
@@ -12,6 +62,21 @@
  */
 int leer_archivo(const char* ruta, char** contenido, size_t* tamano);
 
+/**
+ * Lee un archivo completo en el buffer de entrada de una arena
+ * 
+ * El contenido pertenece a la arena: no debe liberarse y deja de ser
+ * válido al volver a pedir el buffer de entrada. Sin arena equivale a
+ * leer_archivo.
+ * 
+ * @param ruta Ruta del archivo a leer
+ * @param arena Arena del trabajador (NULL para reservar con asignar_memoria)
+ * @param contenido Puntero donde se almacenará el contenido
+ * @param tamano Puntero donde se almacenará el tamaño del archivo
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int leer_archivo_en_arena(const char* ruta, ArenaTrabajador* arena, char** contenido, size_t* tamano);
+
 /**
  * Escribe contenido a un archivo usando llamadas al sistema
  * @param ruta Ruta del archivo a escribir
@@ -35,4 +100,204 @@ int archivo_existe(const char* ruta);
  */
 ssize_t obtener_tamano_archivo(const char* ruta);
 
+/**
+ * Lee exactamente un rango de un archivo abierto con pread()
+ * @param fd Descriptor del archivo
+ * @param destino Buffer de al menos longitud bytes
+ * @param longitud Número de bytes a leer
+ * @param desplazamiento Posición del rango en el archivo
+ * @return 0 si es exitoso, -1 si hay error (errno indica la causa)
+ */
+int leer_rango_archivo(int fd, char* destino, size_t longitud, off_t desplazamiento);
+
+/**
+ * Escribe exactamente un rango de un archivo abierto con pwrite()
+ * @param fd Descriptor del archivo
+ * @param origen Datos a escribir
+ * @param longitud Número de bytes a escribir
+ * @param desplazamiento Posición del rango en el archivo
+ * @return 0 si es exitoso, -1 si hay error (errno indica la causa)
+ */
+int escribir_rango_archivo(int fd, const char* origen, size_t longitud, off_t desplazamiento);
+
+/**
+ * Sincroniza un archivo con el disco (fsync) y registra la duración en las estadísticas
+ * @param fd Descriptor del archivo
+ * @param bytes Bytes escritos que se sincronizan
+ * @return 0 si es exitoso, -1 si hay error (errno indica la causa)
+ */
+int sincronizar_archivo(int fd, size_t bytes);
+
+/**
+ * Crea el archivo de salida con el tamaño de la cota y lo proyecta en memoria
+ * 
+ * El codificador escribe directamente en salida->datos, sin buffer propio ni
+ * copia con write(). Si el sistema de archivos no permite la proyección o no
+ * tiene espacio libre para la cota (escribir en una página sin espacio daría
+ * SIGBUS) se devuelve 1 y el llamador escribe de la forma habitual.
+ * 
+ * @param ruta Ruta del archivo de salida
+ * @param capacidad Cota superior del tamaño del resultado
+ * @param salida Estructura donde se almacenará la proyección
+ * @return 0 si es exitoso, 1 si no se puede proyectar, -1 si hay error
+ */
+int abrir_salida_proyectada(const char* ruta, size_t capacidad, SalidaProyectada* salida);
+
+/**
+ * Recorta el archivo proyectado al tamaño final del resultado y lo cierra
+ * @param salida Salida abierta con abrir_salida_proyectada
+ * @param tamano_final Bytes del resultado (como mucho la capacidad)
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int cerrar_salida_proyectada(SalidaProyectada* salida, size_t tamano_final);
+
+/**
+ * Deshace una salida proyectada tras un error, borrando el archivo
+ * @param salida Salida abierta con abrir_salida_proyectada
+ * @param ruta Ruta del archivo de salida
+ */
+void descartar_salida_proyectada(SalidaProyectada* salida, const char* ruta);
+
+/**
+ * Lee los primeros bytes de un archivo sin cargarlo completo
+ * @param ruta Ruta del archivo
+ * @param destino Buffer donde se almacenarán los bytes
+ * @param tamano Número máximo de bytes a leer
+ * @return Número de bytes leídos, -1 si hay error
+ */
+ssize_t leer_cabecera_archivo(const char* ruta, char* destino, size_t tamano);
+
+/**
+ * Guarda un archivo sin transformar dentro de un contenedor almacenado
+ * Intenta primero un clonado FICLONERANGE (reflink), luego copy_file_range()
+ * y por último recurre a read()/write() por bloques.
+ * @param origen Ruta del archivo a guardar
+ * @param destino Ruta del contenedor a crear
+ * @param metodo Puntero donde se almacenará el mecanismo usado (puede ser NULL)
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int almacenar_archivo(const char* origen, const char* destino, MetodoCopia* metodo);
+
+/**
+ * Extrae los datos de un contenedor almacenado con los mismos mecanismos de copia
+ * @param origen Ruta del contenedor
+ * @param destino Ruta del archivo a crear
+ * @param metodo Puntero donde se almacenará el mecanismo usado (puede ser NULL)
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int extraer_archivo_almacenado(const char* origen, const char* destino, MetodoCopia* metodo);
+
+/**
+ * Serializa la cabecera de un contenedor almacenado
+ * @param desplazamiento Posición de los datos en el contenedor
+ * @param destino Buffer de al menos TAMANO_CABECERA_ALMACENADA bytes
+ * @return Número de bytes escritos
+ */
+size_t serializar_cabecera_almacenada(off_t desplazamiento, char* destino);
+
+/**
+ * Reconoce y lee la cabecera de un contenedor almacenado
+ * @param datos Datos que pueden comenzar con la cabecera
+ * @param tamano Tamaño de los datos
+ * @param desplazamiento Puntero donde se almacenará la posición de los datos
+ * @return 1 si hay cabecera, 0 si los datos no son un contenedor almacenado, -1 si está corrupta
+ */
+int deserializar_cabecera_almacenada(const char* datos, size_t tamano, off_t* desplazamiento);
+
+/**
+ * Obtiene el nombre legible de un mecanismo de copia
+ * @param metodo Mecanismo de copia
+ * @return Nombre del mecanismo
+ */
+const char* nombre_metodo_copia(MetodoCopia metodo);
+
+/**
+ * Lee solo las regiones con datos de un archivo, saltando sus huecos
+ * 
+ * Usa lseek(SEEK_DATA/SEEK_HOLE) para localizar los huecos. Las regiones con
+ * datos se devuelven empaquetadas de forma contigua en el contenido y su
+ * posición original queda registrada en el mapa. Si el archivo no tiene
+ * huecos (o el sistema de archivos no los reporta) el resultado es idéntico
+ * al de leer_archivo y mapa->tiene_huecos vale 0.
+ * 
+ * @param ruta Ruta del archivo a leer
+ * @param contenido Puntero donde se almacenarán los datos empaquetados
+ * @param tamano Puntero donde se almacenará el número de bytes de datos
+ * @param mapa Mapa donde se registrarán las regiones con datos
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int leer_archivo_disperso(const char* ruta, char** contenido, size_t* tamano, MapaDisperso* mapa);
+
+/**
+ * Lee solo las regiones con datos en el buffer de entrada de una arena
+ * 
+ * Igual que leer_archivo_disperso, pero el contenido pertenece a la arena
+ * (ver leer_archivo_en_arena).
+ * 
+ * @param ruta Ruta del archivo a leer
+ * @param arena Arena del trabajador (NULL para reservar con asignar_memoria)
+ * @param contenido Puntero donde se almacenarán los datos empaquetados
+ * @param tamano Puntero donde se almacenará el número de bytes de datos
+ * @param mapa Mapa donde se registrarán las regiones con datos
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int leer_archivo_disperso_en_arena(const char* ruta, ArenaTrabajador* arena, char** contenido,
+                                   size_t* tamano, MapaDisperso* mapa);
+
+/**
+ * Escribe datos empaquetados recreando los huecos descritos por el mapa
+ * 
+ * Solo se escriben las regiones con datos; el tamaño final se fija con
+ * ftruncate() y los huecos se liberan con fallocate(PUNCH_HOLE) cuando el
+ * sistema de archivos lo permite. Sin huecos equivale a escribir_archivo.
+ * 
+ * @param ruta Ruta del archivo a escribir
+ * @param contenido Datos empaquetados de las regiones
+ * @param tamano Número de bytes de datos empaquetados
+ * @param mapa Mapa con la posición de cada región
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int escribir_archivo_disperso(const char* ruta, const char* contenido, size_t tamano,
+                              const MapaDisperso* mapa);
+
+/**
+ * Calcula el tamaño de la cabecera de contenedor que describe un mapa disperso
+ * @param mapa Mapa a serializar
+ * @return Número de bytes de la cabecera
+ */
+size_t tamano_cabecera_dispersa(const MapaDisperso* mapa);
+
+/**
+ * Serializa un mapa disperso como cabecera de contenedor
+ * @param mapa Mapa a serializar
+ * @param destino Buffer de al menos tamano_cabecera_dispersa(mapa) bytes
+ * @return Número de bytes escritos
+ */
+size_t serializar_mapa_disperso(const MapaDisperso* mapa, char* destino);
+
+/**
+ * Reconoce y lee la cabecera de contenedor de un archivo disperso
+ * @param datos Datos que pueden comenzar con la cabecera
+ * @param tamano Tamaño de los datos
+ * @param mapa Mapa donde se almacenarán las regiones leídas
+ * @param consumidos Puntero donde se almacenará el tamaño de la cabecera
+ * @return 1 si hay cabecera, 0 si los datos no son un contenedor disperso, -1 si está corrupta
+ */
+int deserializar_mapa_disperso(const char* datos, size_t tamano, MapaDisperso* mapa,
+                               size_t* consumidos);
+
+/**
+ * Indica si un archivo abierto contiene huecos
+ * @param fd Descriptor del archivo
+ * @param tamano Tamaño aparente del archivo
+ * @return 1 si tiene huecos, 0 si no (o si el sistema de archivos no los reporta)
+ */
+int descriptor_tiene_huecos(int fd, off_t tamano);
+
+/**
+ * Libera la memoria asignada a un mapa disperso
+ * @param mapa Mapa a liberar
+ */
+void liberar_mapa_disperso(MapaDisperso* mapa);
+
 #endif
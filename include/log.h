@@ -0,0 +1,80 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdio.h>
+
+/**
+ * Niveles de los mensajes: un mensaje se muestra si su nivel no supera el
+ * nivel elegido en la línea de comandos
+ */
+typedef enum {
+    NIVEL_LOG_RESUMEN = 0,   // Encabezados y resumen final (también con -q)
+    NIVEL_LOG_INFO = 1,      // Un mensaje por archivo (por defecto)
+    NIVEL_LOG_DETALLE = 2    // Detalle por hilo y por fase (-v)
+} NivelLog;
+
+/**
+ * Bytes del anillo de mensajes de cada hilo
+ */
+#define TAMANO_ANILLO_LOG ((size_t)64 * 1024)
+
+/**
+ * Longitud máxima de un mensaje (los más largos se recortan)
+ */
+#define LONGITUD_MENSAJE_LOG 8192
+
+/**
+ * Milisegundos entre dos vaciados de los anillos por el hilo escritor
+ */
+#define PERIODO_VACIADO_LOG_MS 50
+
+/**
+ * Arranca el registro asíncrono de mensajes
+ *
+ * Cada hilo escribe sus mensajes en su propio anillo sin pasar por el
+ * cerrojo de stdout, y un único hilo en segundo plano los vacía al destino.
+ * El hilo que llama a esta función escribe directamente, después
+ * de vaciar lo pendiente, para que sus mensajes (encabezados, resumen) no
+ * se adelanten a los de los trabajadores. Registra terminar_log con atexit.
+ *
+ * @param nivel Nivel máximo de los mensajes a mostrar
+ * @param destino Flujo de los mensajes: stdout, o stderr si stdout lleva datos
+ *                que se procesan aparte (por ejemplo el JSON de --stats)
+ * @return 0 si es exitoso, -1 si hay error (los mensajes se escriben entonces directamente)
+ */
+int iniciar_log(NivelLog nivel, FILE* destino);
+
+/**
+ * Vacía los mensajes pendientes y detiene el hilo escritor
+ *
+ * Los hilos que registran mensajes ya deben haber terminado.
+ */
+void terminar_log(void);
+
+/**
+ * Comprueba si los mensajes de un nivel se muestran
+ * @param nivel Nivel a consultar
+ * @return 1 si se muestran, 0 si no
+ */
+int log_activo(NivelLog nivel);
+
+/**
+ * Registra un mensaje con formato de printf; se añade el salto de línea
+ *
+ * Si el anillo del hilo está lleno, el hilo espera a que el escritor lo
+ * vacíe: los mensajes no se pierden.
+ *
+ * @param nivel Nivel del mensaje
+ * @param formato Formato del mensaje
+ */
+void escribir_log(NivelLog nivel, const char* formato, ...)
+#ifdef __GNUC__
+    __attribute__((format(printf, 2, 3)))
+#endif
+    ;
+
+#define LOG_RESUMEN(...) escribir_log(NIVEL_LOG_RESUMEN, __VA_ARGS__)
+#define LOG_INFO(...) escribir_log(NIVEL_LOG_INFO, __VA_ARGS__)
+#define LOG_DETALLE(...) escribir_log(NIVEL_LOG_DETALLE, __VA_ARGS__)
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+#include <stddef.h>
+
+/**
+ * Subsistemas a los que se atribuye la memoria
+ */
+typedef enum {
+    MEMORIA_ARCHIVOS = 0,     // Contenido leído por leer_archivo y mapas de extensiones
+    MEMORIA_BUFFERS,          // Buffers de las arenas de los trabajadores (mmap)
+    MEMORIA_COMPRESION,       // Buffers de trabajo y resultados de RLE
+    MEMORIA_ENCRIPTACION,     // Resultados de Vigenère
+    MEMORIA_BLOQUES,          // Trabajos y bloques del procesamiento por bloques
+    MEMORIA_FLUJO,            // Trozos del procesamiento en flujo y del pipeline
+    MEMORIA_DIRECTORIOS,      // Tareas, rutas y estado del recorrido de directorios
+    MEMORIA_PLANIFICADOR,     // Planificador, colas y presupuesto de memoria
+    MEMORIA_PILAS,            // Pilas de los hilos creados (reservadas, no necesariamente tocadas)
+    NUM_SUBSISTEMAS_MEMORIA
+} SubsistemaMemoria;
+
+/**
+ * Contadores de memoria de un subsistema
+ */
+typedef struct {
+    size_t actual;        // Bytes en uso ahora mismo
+    size_t pico;          // Máximo de bytes en uso a la vez
+    size_t total;         // Bytes asignados en toda la ejecución
+    size_t asignaciones;  // Número de asignaciones
+    size_t liberaciones;  // Número de liberaciones
+} ContadorMemoria;
+
+/**
+ * Estado de la memoria de la ejecución
+ */
+typedef struct {
+    ContadorMemoria subsistemas[NUM_SUBSISTEMAS_MEMORIA];
+    size_t actual;        // Bytes en uso de todos los subsistemas
+    size_t pico;          // Máximo de bytes en uso de todos los subsistemas a la vez
+    size_t rss;           // Memoria residente del proceso (VmRSS), 0 si no se pudo leer
+    size_t pico_rss;      // Máximo de memoria residente del proceso (VmHWM)
+} EstadisticasMemoria;
+
+/**
+ * Empieza a contabilizar la memoria
+ *
+ * Antes de llamarla las funciones de asignación solo añaden su cabecera,
+ * sin tocar los contadores. Debe llamarse antes de crear los hilos.
+ * Después cada hilo cuenta sus asignaciones en contadores propios y solo
+ * los bytes en uso y los picos se comparten, con operaciones atómicas.
+ */
+void iniciar_contabilidad_memoria(void);
+
+/**
+ * Asigna memoria atribuyéndola a un subsistema (como malloc)
+ *
+ * El bloque lleva una cabecera con su tamaño y su subsistema, así que
+ * debe liberarse con liberar_asignacion, nunca con free.
+ *
+ * @param subsistema Subsistema al que se atribuye
+ * @param bytes Bytes a asignar
+ * @return Memoria asignada, NULL si hay error
+ */
+void* asignar_memoria(SubsistemaMemoria subsistema, size_t bytes);
+
+/**
+ * Asigna memoria inicializada a cero (como calloc)
+ * @param subsistema Subsistema al que se atribuye
+ * @param numero Número de elementos
+ * @param tamano Tamaño de cada elemento
+ * @return Memoria asignada, NULL si hay error o desbordamiento
+ */
+void* asignar_memoria_ceros(SubsistemaMemoria subsistema, size_t numero, size_t tamano);
+
+/**
+ * Cambia el tamaño de una asignación (como realloc)
+ * @param subsistema Subsistema al que se atribuye
+ * @param memoria Asignación previa o NULL
+ * @param bytes Nuevo tamaño
+ * @return Memoria redimensionada, NULL si hay error (la original sigue válida)
+ */
+void* reasignar_memoria(SubsistemaMemoria subsistema, void* memoria, size_t bytes);
+
+/**
+ * Libera una asignación de asignar_memoria (no hace nada con NULL)
+ * @param memoria Memoria a liberar
+ */
+void liberar_asignacion(void* memoria);
+
+/**
+ * Contabiliza memoria obtenida por otra vía (mmap, pilas de hilos)
+ * @param subsistema Subsistema al que se atribuye
+ * @param bytes Bytes obtenidos
+ */
+void sumar_memoria(SubsistemaMemoria subsistema, size_t bytes);
+
+/**
+ * Descuenta memoria contabilizada con sumar_memoria
+ * @param subsistema Subsistema al que se atribuyó
+ * @param bytes Bytes devueltos
+ */
+void restar_memoria(SubsistemaMemoria subsistema, size_t bytes);
+
+/**
+ * Tamaño de pila que reciben los hilos creados con los atributos por defecto
+ * @return Bytes de pila por hilo
+ */
+size_t tamano_pila_hilos(void);
+
+/**
+ * Lee la memoria residente del proceso de /proc/self/status
+ * @param rss Donde guardar VmRSS en bytes
+ * @param pico_rss Donde guardar VmHWM en bytes
+ * @return 0 si es exitoso, -1 si no se pudo leer
+ */
+int leer_memoria_proceso(size_t* rss, size_t* pico_rss);
+
+/**
+ * Obtiene los contadores de todos los subsistemas y la memoria del proceso
+ *
+ * Puede llamarse con los hilos en marcha: cada contador se lee de forma
+ * atómica, aunque el conjunto no es una instantánea coherente.
+ *
+ * @param estadisticas Donde guardar el resultado
+ */
+void obtener_estadisticas_memoria(EstadisticasMemoria* estadisticas);
+
+/**
+ * Nombre de un subsistema para los informes
+ * @param subsistema Subsistema
+ * @return Nombre en minúsculas y sin espacios
+ */
+const char* nombre_subsistema_memoria(SubsistemaMemoria subsistema);
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include <stddef.h>
+
+/**
+ * Estadísticas de uso de un presupuesto de memoria
+ */
+typedef struct {
+    size_t limite;   // Bytes que pueden estar reservados a la vez
+    size_t pico;     // Máximo de bytes reservados simultáneamente
+    size_t esperas;  // Reservas que tuvieron que esperar a que se liberara memoria
+} EstadisticasPresupuesto;
+
+/**
+ * Semáforo de bytes compartido por los hilos trabajadores
+ *
+ * Cada trabajador reserva la memoria que va a usar antes de admitir un
+ * archivo o un bloque y la devuelve al terminar; si no cabe, espera a que
+ * otros la liberen. Así el pico de memoria en uso no supera el límite.
+ */
+typedef struct PresupuestoMemoria PresupuestoMemoria;
+
+/**
+ * Crea un presupuesto de memoria
+ * @param limite Bytes que pueden estar reservados a la vez (mayor que 0)
+ * @return Presupuesto creado, NULL si hay error
+ */
+PresupuestoMemoria* crear_presupuesto_memoria(size_t limite);
+
+/**
+ * Reserva memoria del presupuesto, esperando a que haya suficiente libre
+ *
+ * Una reserva mayor que el límite se recorta al límite: espera a que el
+ * presupuesto esté vacío y lo ocupa entero.
+ *
+ * @param presupuesto Presupuesto compartido
+ * @param bytes Bytes a reservar
+ * @return Bytes efectivamente reservados (a devolver con liberar_memoria)
+ */
+size_t reservar_memoria(PresupuestoMemoria* presupuesto, size_t bytes);
+
+/**
+ * Intenta reservar memoria sin esperar
+ *
+ * La usa quien ya retiene memoria del presupuesto y no puede bloquearse
+ * sin arriesgar un interbloqueo: la admisión de bloques de un archivo
+ * reserva así cada bloque tras el primero, y un bloque amplía su reserva
+ * cuando la frontera de rachas lo alarga. A diferencia de reservar_memoria
+ * no recorta la petición al límite ni cuenta una espera.
+ *
+ * @param presupuesto Presupuesto compartido
+ * @param bytes Bytes a reservar
+ * @return 0 si se reservaron, -1 si no caben ahora mismo
+ */
+int intentar_reservar_memoria(PresupuestoMemoria* presupuesto, size_t bytes);
+
+/**
+ * Devuelve memoria al presupuesto y despierta a los hilos que esperan
+ * @param presupuesto Presupuesto compartido
+ * @param bytes Bytes reservados previamente
+ */
+void liberar_memoria(PresupuestoMemoria* presupuesto, size_t bytes);
+
+/**
+ * Obtiene el límite del presupuesto
+ * @param presupuesto Presupuesto a consultar
+ * @return Bytes que pueden estar reservados a la vez
+ */
+size_t obtener_limite_memoria(const PresupuestoMemoria* presupuesto);
+
+/**
+ * Obtiene las estadísticas del presupuesto
+ * @param presupuesto Presupuesto a consultar
+ * @param estadisticas Estructura donde se almacenarán las estadísticas
+ */
+void obtener_estadisticas_presupuesto(PresupuestoMemoria* presupuesto,
+                                      EstadisticasPresupuesto* estadisticas);
+
+/**
+ * Libera el presupuesto
+ * @param presupuesto Presupuesto a liberar
+ */
+void destruir_presupuesto_memoria(PresupuestoMemoria* presupuesto);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef NUMA_TOPOLOGY_H
+#define NUMA_TOPOLOGY_H
+
+#include <pthread.h>
+
+/**
+ * Número máximo de nodos NUMA y de CPUs que se consideran
+ */
+#define MAX_NODOS_NUMA 64
+#define MAX_CPUS_NUMA 1024
+
+/**
+ * Nodos NUMA con las CPUs que el proceso puede usar en cada uno
+ */
+typedef struct {
+    int num_nodos;
+    int ids[MAX_NODOS_NUMA];        // Número de cada nodo en el sistema
+    int num_cpus[MAX_NODOS_NUMA];   // CPUs permitidas de cada nodo
+    unsigned long cpus[MAX_NODOS_NUMA][MAX_CPUS_NUMA / (8 * sizeof(unsigned long))];
+} TopologiaNuma;
+
+/**
+ * Lee los nodos NUMA de /sys/devices/system/node
+ *
+ * Solo se conservan las CPUs de la máscara de afinidad del proceso, y los
+ * nodos sin ninguna quedan fuera. Sin información de NUMA (o en un sistema
+ * de un solo nodo) se devuelve un único nodo con todas las CPUs permitidas.
+ *
+ * @param topologia Estructura donde se almacenarán los nodos
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int leer_topologia_numa(TopologiaNuma* topologia);
+
+/**
+ * Fija un hilo a las CPUs de un nodo
+ *
+ * La memoria que el hilo toque por primera vez después de fijarlo se sirve
+ * desde su nodo (política de primer acceso del kernel).
+ *
+ * @param topologia Topología leída con leer_topologia_numa
+ * @param indice Índice del nodo en la topología (no el número de nodo)
+ * @param hilo Hilo a fijar
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int fijar_hilo_en_nodo(const TopologiaNuma* topologia, int indice, pthread_t hilo);
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef PATH_ARENA_H
+#define PATH_ARENA_H
+
+#include <stddef.h>
+
+/**
+ * Tamaño de cada bloque de la arena (mayor que PATH_MAX, así que
+ * cualquier ruta cabe en un solo bloque)
+ */
+#define TAMANO_BLOQUE_ARENA ((size_t)64 * 1024)
+
+/**
+ * Referencia a una ruta almacenada en una arena
+ */
+typedef struct {
+    size_t desplazamiento;  // Posición global dentro de la arena
+    size_t longitud;        // Longitud sin contar el terminador
+} RefRuta;
+
+/**
+ * Arena de rutas: las cadenas se empaquetan una tras otra en bloques
+ * grandes que nunca se mueven, de modo que el consumo es proporcional a
+ * la longitud real de las rutas y no hay una asignación por nombre.
+ *
+ * La arena no está sincronizada: si varios hilos la usan, el llamador
+ * debe protegerla con su propio mutex.
+ */
+typedef struct {
+    char** bloques;
+    size_t num_bloques;
+    size_t capacidad_bloques;
+    size_t usado;  // Bytes ocupados en el último bloque
+} ArenaRutas;
+
+/**
+ * Inicializa una arena vacía (no asigna memoria hasta el primer uso)
+ * @param arena Arena a inicializar
+ */
+void iniciar_arena_rutas(ArenaRutas* arena);
+
+/**
+ * Agrega una ruta a la arena, uniendo opcionalmente un prefijo y un nombre
+ *
+ * @param arena Arena destino
+ * @param prefijo Directorio a anteponer con '/' (NULL o "" para ninguno)
+ * @param nombre Nombre a agregar
+ * @param ref Referencia donde se almacenará la posición de la ruta
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int agregar_ruta_arena(ArenaRutas* arena, const char* prefijo, const char* nombre, RefRuta* ref);
+
+/**
+ * Obtiene la cadena de una ruta almacenada
+ *
+ * El puntero sigue siendo válido mientras viva la arena.
+ *
+ * @param arena Arena que contiene la ruta
+ * @param ref Referencia devuelta por agregar_ruta_arena
+ * @return Cadena terminada en '\0'
+ */
+const char* obtener_ruta_arena(const ArenaRutas* arena, RefRuta ref);
+
+/**
+ * Obtiene la memoria reservada por la arena
+ * @param arena Arena a consultar
+ * @return Bytes reservados en bloques
+ */
+size_t memoria_arena_rutas(const ArenaRutas* arena);
+
+/**
+ * Libera todos los bloques de la arena
+ * @param arena Arena a liberar
+ */
+void liberar_arena_rutas(ArenaRutas* arena);
+
+#endif
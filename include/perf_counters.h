@@ -0,0 +1,58 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Contadores de hardware que se leen alrededor de cada transformación
+ */
+typedef enum {
+    CONTADOR_CICLOS = 0,
+    CONTADOR_INSTRUCCIONES,
+    CONTADOR_FALLOS_CACHE,      // Accesos que fallan en la caché de último nivel
+    CONTADOR_FALLOS_SALTO,      // Saltos mal predichos
+    NUM_CONTADORES_HW
+} ContadorHw;
+
+/**
+ * Valores de los contadores del hilo en un instante
+ */
+typedef struct {
+    uint64_t valores[NUM_CONTADORES_HW];
+    int valida;                 // 0 si los contadores no están activos en el hilo
+} LecturaContadoresHw;
+
+/**
+ * Activa los contadores de hardware (--perf-counters)
+ *
+ * Cada hilo abre con perf_event_open, en su primera lectura, un grupo con
+ * los contadores de su propia actividad en modo usuario. Si el kernel no lo
+ * permite (perf_event_paranoid, contenedores sin acceso a la PMU) se avisa
+ * y el programa sigue sin contadores.
+ *
+ * @return 0 si están disponibles, -1 si no
+ */
+int iniciar_contadores_hw(void);
+
+/**
+ * Lee los contadores del hilo llamador
+ * @param lectura Donde guardar los valores (valida = 0 si no hay contadores)
+ */
+void leer_contadores_hw(LecturaContadoresHw* lectura);
+
+/**
+ * Acumula la diferencia desde una lectura previa en los totales de una operación
+ * @param operacion Operación medida ('c', 'd', 'e', 'u')
+ * @param inicio Lectura tomada antes de la transformación
+ * @param bytes Bytes de entrada transformados
+ */
+void registrar_contadores_hw(char operacion, const LecturaContadoresHw* inicio, size_t bytes);
+
+/**
+ * Muestra, por operación, ciclos por byte, instrucciones por ciclo y fallos
+ * de caché y de predicción de saltos por KiB. Los hilos ya deben haber terminado.
+ */
+void informar_contadores_hw(void);
+
+#endif
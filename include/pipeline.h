@@ -0,0 +1,108 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stddef.h>
+
+/**
+ * Número máximo de etapas de un pipeline
+ */
+#define MAX_ETAPAS_PIPELINE 16
+
+/**
+ * Trozos que pueden esperar entre dos etapas consecutivas
+ */
+#define CAPACIDAD_COLA_PIPELINE 4
+
+/**
+ * Transformación registrada que puede usarse como etapa (rle, vigenere...)
+ */
+typedef struct DefinicionEtapa DefinicionEtapa;
+
+/**
+ * Etapa de un pipeline: una transformación registrada en sentido directo
+ * (comprimir, encriptar) o inverso (descomprimir, desencriptar)
+ */
+typedef struct {
+    const DefinicionEtapa* definicion;
+    int inversa;
+} EtapaPipeline;
+
+/**
+ * Cadena de etapas que se aplican en orden a cada trozo de la entrada
+ */
+typedef struct {
+    EtapaPipeline etapas[MAX_ETAPAS_PIPELINE];
+    size_t num_etapas;
+} EspecificacionPipeline;
+
+/**
+ * Interpreta una especificación de pipeline
+ *
+ * La especificación es una lista de etapas registradas separadas por comas,
+ * en el orden en que se aplican; un '-' delante de una etapa la aplica en
+ * sentido inverso. Por ejemplo "rle,vigenere" equivale a -ce y
+ * "-vigenere,-rle" a -du.
+ *
+ * @param texto Especificación a interpretar
+ * @param especificacion Estructura donde se almacenarán las etapas
+ * @return 0 si es válida, -1 si hay error
+ */
+int parsear_pipeline(const char* texto, EspecificacionPipeline* especificacion);
+
+/**
+ * Comprueba si alguna etapa del pipeline necesita clave
+ * @param especificacion Pipeline a consultar
+ * @return 1 si alguna etapa necesita clave, 0 si no
+ */
+int pipeline_requiere_clave(const EspecificacionPipeline* especificacion);
+
+/**
+ * Escribe la descripción legible de un pipeline ("rle -> vigenere")
+ * @param especificacion Pipeline a describir
+ * @param destino Buffer donde se almacenará la descripción
+ * @param tamano Tamaño del buffer
+ */
+void describir_pipeline(const EspecificacionPipeline* especificacion, char* destino, size_t tamano);
+
+/**
+ * Escribe la lista de etapas registradas separadas por comas
+ * @param destino Buffer donde se almacenará la lista
+ * @param tamano Tamaño del buffer
+ */
+void listar_etapas_pipeline(char* destino, size_t tamano);
+
+/**
+ * Memoria en vuelo de un trozo que atraviesa el pipeline
+ * @param especificacion Etapas a aplicar
+ * @param tamano_trozo Bytes de entrada por trozo
+ * @return Bytes del trozo y de los resultados de las etapas que no transforman en el sitio
+ */
+size_t memoria_pipeline(const EspecificacionPipeline* especificacion, size_t tamano_trozo);
+
+/**
+ * Procesa un archivo pasando sus trozos por las etapas del pipeline
+ *
+ * Con hilos, cada etapa se ejecuta en su propio hilo y se comunica con la siguiente
+ * por una cola acotada, así que las etapas trabajan a la vez sobre trozos
+ * distintos y la memoria en vuelo no depende del tamaño del archivo. Las
+ * etapas conservan su estado entre trozos: la salida es idéntica a aplicar
+ * las transformaciones una tras otra al archivo completo.
+ *
+ * Como -c y -d, una etapa RLE deja pasar sin transformar los formatos ya
+ * comprimidos. Los contenedores dispersos deben descomprimirse con -d.
+ *
+ * @param ruta_entrada Ruta del archivo de entrada
+ * @param ruta_salida Ruta del archivo de salida
+ * @param especificacion Etapas a aplicar
+ * @param clave Clave para las etapas de encriptación (puede ser NULL si no hay)
+ * @param tamano_trozo Bytes de entrada por trozo
+ * @param con_hilos 1: un hilo por etapa; 0: todas las etapas en el hilo
+ *                  llamador (cuando el paralelismo viene de procesar varios
+ *                  archivos a la vez)
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int procesar_archivo_pipeline(const char* ruta_entrada, const char* ruta_salida,
+                              const EspecificacionPipeline* especificacion,
+                              const char* clave, size_t tamano_trozo, int con_hilos);
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <stddef.h>
+
+/**
+ * Formatos del informe de progreso
+ */
+typedef enum {
+    PROGRESO_DESACTIVADO = 0,
+    PROGRESO_TERMINAL,      // Una línea que se reescribe con \r
+    PROGRESO_LINEAS         // Una línea clave=valor por informe, para recolectores de logs
+} FormatoProgreso;
+
+/**
+ * Milisegundos entre dos informes en la terminal
+ */
+#define INTERVALO_PROGRESO_TERMINAL_MS 1000
+
+/**
+ * Milisegundos entre dos informes en formato de líneas (no inundar los logs)
+ */
+#define INTERVALO_PROGRESO_LINEAS_MS 10000
+
+/**
+ * Progreso de un trabajo sobre un directorio
+ *
+ * Los trabajadores solo suman a contadores atómicos; un hilo propio los
+ * lee a intervalos fijos y escribe en stderr los archivos terminados sobre
+ * los descubiertos, los MB/s y el tiempo estimado restante. Mientras quedan
+ * directorios por recorrer el total todavía crece y se marca con '+'.
+ */
+typedef struct Progreso Progreso;
+
+/**
+ * Arranca el hilo que informa del progreso
+ * @param formato Formato del informe (PROGRESO_DESACTIVADO devuelve NULL)
+ * @return Progreso creado, NULL si está desactivado o hay error
+ */
+Progreso* iniciar_progreso(FormatoProgreso formato);
+
+/**
+ * Anota un directorio pendiente de recorrer (+1) o ya recorrido (-1)
+ * @param progreso Progreso del trabajo (NULL no hace nada)
+ * @param delta +1 al encolarlo, -1 al terminar su recorrido
+ */
+void anotar_directorio_progreso(Progreso* progreso, int delta);
+
+/**
+ * Anota un archivo descubierto
+ * @param progreso Progreso del trabajo (NULL no hace nada)
+ * @param bytes Tamaño del archivo
+ */
+void anotar_archivo_progreso(Progreso* progreso, size_t bytes);
+
+/**
+ * Anota un archivo terminado, con o sin error
+ * @param progreso Progreso del trabajo (NULL no hace nada)
+ * @param bytes Tamaño del archivo
+ */
+void avanzar_progreso(Progreso* progreso, size_t bytes);
+
+/**
+ * Escribe el último informe, detiene el hilo y libera el progreso
+ * @param progreso Progreso del trabajo (NULL no hace nada)
+ */
+void terminar_progreso(Progreso* progreso);
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef RUN_STATS_H
+#define RUN_STATS_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * Medidas que se registran durante una ejecución
+ */
+typedef enum {
+    MEDIDA_LECTURA = 0,       // Leer la entrada (archivo, bloque o trozo)
+    MEDIDA_TRANSFORMACION,    // Comprimir, encriptar o sus inversas
+    MEDIDA_ESCRITURA,         // Escribir el resultado (incluye la sincronización)
+    MEDIDA_SINCRONIZACION,    // fsync() de la salida
+    MEDIDA_ARCHIVO,           // Un archivo completo, de principio a fin
+    NUM_MEDIDAS
+} TipoMedida;
+
+/**
+ * Subdivisiones de cada potencia de 2 en los histogramas (error relativo
+ * de los percentiles por debajo del 12,5%)
+ */
+#define BITS_SUBCUBETA 3
+#define SUBCUBETAS (1 << BITS_SUBCUBETA)
+#define NUM_CUBETAS (64 * SUBCUBETAS)
+
+/**
+ * Límites con los que se ejecuta la operación, para el informe JSON
+ */
+typedef struct {
+    int version_cgroup;      // Versión de cgroup de los límites (0 = ninguno)
+    double cpus_cgroup;      // CPUs de la cuota cpu.max (0 = sin cuota)
+    size_t memoria_cgroup;   // Bytes de memory.max (0 = sin límite)
+    int hilos;               // Hilos trabajadores elegidos
+    size_t limite_memoria;   // Presupuesto de memoria de los archivos en curso (0 = sin límite)
+    int limite_por_defecto;  // 1: el presupuesto sale de memory.max, no de --limite-memoria
+    size_t memoria_arenas;   // Memoria que las arenas pueden conservar entre archivos (0 = sin tope)
+} LimitesEjecucion;
+
+/**
+ * Activa la recogida de estadísticas y toma el instante de inicio
+ *
+ * Cada hilo acumula sus medidas en sus propios histogramas sin cerrojos;
+ * se combinan al escribirlas. Sin activar, las funciones de medida no
+ * hacen nada. También activa la contabilidad de memoria.
+ */
+void iniciar_estadisticas(void);
+
+/**
+ * Comprueba si se están recogiendo estadísticas
+ * @return 1 si están activas, 0 si no
+ */
+int estadisticas_activas(void);
+
+/**
+ * Instante de inicio de una medida
+ * @return Segundos de reloj monótono, 0 si ni las estadísticas ni la traza están activas
+ */
+double iniciar_medida(void);
+
+/**
+ * Registra la duración de una medida en el histograma del hilo llamador
+ * y, con --trace, como evento de la traza
+ * @param tipo Medida a registrar
+ * @param inicio Valor devuelto por iniciar_medida
+ * @param bytes Bytes tratados (entrada al leer y transformar, salida al escribir)
+ */
+void registrar_medida(TipoMedida tipo, double inicio, size_t bytes);
+
+/**
+ * Guarda los límites elegidos para escribirlos con las estadísticas
+ * @param limites Límites de la ejecución (se copian)
+ */
+void registrar_limites_ejecucion(const LimitesEjecucion* limites);
+
+/**
+ * Escribe las estadísticas de la ejecución en JSON
+ *
+ * Combina los histogramas de todos los hilos, que ya deben haber terminado.
+ * Por cada medida se escriben el número de operaciones, los bytes, el tiempo
+ * ocupado, los MB/s y los percentiles 50 y 99 de la duración; después, los
+ * límites registrados con registrar_limites_ejecucion, la memoria residente
+ * del proceso y la contabilizada por cada subsistema.
+ *
+ * @param destino Archivo donde escribir
+ * @param operacion Operación realizada (por ejemplo "-c" o "--pipeline rle,vigenere")
+ * @param entrada Ruta de entrada
+ * @param resultado Resultado de la operación (0 si fue exitosa)
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int escribir_estadisticas_json(FILE* destino, const char* operacion, const char* entrada, int resultado);
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stddef.h>
+
+/**
+ * Función que ejecuta una tarea del planificador
+ * @param datos Datos propios de la tarea
+ * @param id_trabajador Índice del hilo trabajador que la ejecuta
+ */
+typedef void (*FuncionTarea)(void* datos, int id_trabajador);
+
+/**
+ * Orden en que los trabajadores toman las tareas
+ */
+typedef enum {
+    ORDEN_LPT,   // Mayor costo primero (Longest Processing Time first)
+    ORDEN_FIFO   // Orden de llegada
+} OrdenTareas;
+
+/**
+ * Estadísticas acumuladas de un planificador
+ */
+typedef struct {
+    size_t tareas_ejecutadas;  // Tareas terminadas por todos los trabajadores
+    size_t tareas_robadas;     // Tareas tomadas de la cola de otro trabajador
+    double tiempo_total;       // Segundos desde la creación hasta la última espera
+    double tiempo_ocupado_max; // Segundos ejecutando tareas del trabajador más cargado
+    double tiempo_ocupado_medio; // Media de segundos ejecutando tareas por trabajador
+} EstadisticasPlanificador;
+
+/**
+ * Estadísticas de los trabajadores fijados a un nodo NUMA
+ */
+typedef struct {
+    int nodo;              // Número del nodo en el sistema
+    int trabajadores;      // Trabajadores fijados al nodo
+    size_t bytes;          // Bytes registrados con sumar_bytes_trabajador
+    double tiempo_ocupado; // Segundos ejecutando tareas, sumados entre sus trabajadores
+} EstadisticasNodo;
+
+/**
+ * Pool de hilos con una cola de prioridad por trabajador y robo de trabajo
+ */
+typedef struct Planificador Planificador;
+
+/**
+ * Crea un planificador y arranca sus hilos trabajadores
+ *
+ * @param num_trabajadores Número de hilos (0 = número de núcleos disponibles)
+ * @param orden Orden en que se toman las tareas de cada cola
+ * @return Planificador creado, NULL si hay error
+ */
+Planificador* crear_planificador(int num_trabajadores, OrdenTareas orden);
+
+/**
+ * Envía una tarea al planificador
+ *
+ * Desde fuera del pool la tarea se asigna al trabajador con menos costo
+ * pendiente; desde una tarea en ejecución se encola en el propio trabajador
+ * y los trabajadores ociosos pueden robarla.
+ *
+ * @param planificador Planificador destino
+ * @param id_origen Trabajador que envía la tarea, -1 si se envía desde fuera del pool
+ * @param funcion Función a ejecutar
+ * @param datos Datos que recibirá la función
+ * @param costo Costo estimado (por ejemplo, bytes a procesar)
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int enviar_tarea(Planificador* planificador, int id_origen, FuncionTarea funcion,
+                 void* datos, size_t costo);
+
+/**
+ * Envía una tarea que se ejecuta antes que las ordinarias
+ *
+ * Un trabajador no toma una tarea ordinaria mientras su cola tenga tareas
+ * prioritarias, en orden LPT y en FIFO. Sirve para tareas que retienen
+ * memoria de un presupuesto ya reservada: como se ejecutan antes que las
+ * tareas que pueden quedarse esperando memoria, un trabajador nunca espera
+ * con una de ellas pendiente en su propia cola.
+ *
+ * @param planificador Planificador destino
+ * @param id_origen Trabajador que envía la tarea, -1 si se envía desde fuera del pool
+ * @param funcion Función a ejecutar
+ * @param datos Datos que recibirá la función
+ * @param costo Costo estimado (ordena las prioritarias entre sí)
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int enviar_tarea_prioritaria(Planificador* planificador, int id_origen, FuncionTarea funcion,
+                             void* datos, size_t costo);
+
+/**
+ * Espera a que terminen todas las tareas enviadas, incluidas las que
+ * envíen las propias tareas mientras se ejecutan
+ * @param planificador Planificador a esperar
+ */
+void esperar_planificador(Planificador* planificador);
+
+/**
+ * Obtiene el número de hilos trabajadores del planificador
+ * @param planificador Planificador a consultar
+ * @return Número de trabajadores
+ */
+int obtener_num_trabajadores(const Planificador* planificador);
+
+/**
+ * Obtiene las estadísticas acumuladas del planificador
+ * @param planificador Planificador a consultar
+ * @param estadisticas Estructura donde se almacenarán las estadísticas
+ */
+void obtener_estadisticas_planificador(Planificador* planificador,
+                                       EstadisticasPlanificador* estadisticas);
+
+/**
+ * Detiene los hilos trabajadores y libera el planificador
+ *
+ * Las tareas pendientes se ejecutan antes de detener los hilos.
+ *
+ * @param planificador Planificador a destruir
+ */
+void destruir_planificador(Planificador* planificador);
+
+/**
+ * Fija cada trabajador a las CPUs de un nodo NUMA
+ *
+ * Los trabajadores se reparten por turnos entre los nodos con CPUs
+ * permitidas. Debe llamarse antes de enviar tareas: los buffers que cada
+ * trabajador toque por primera vez quedan en la memoria de su nodo.
+ *
+ * @param planificador Planificador cuyos trabajadores se fijan
+ * @return Número de nodos usados, -1 si hay error
+ */
+int fijar_trabajadores_por_nodo(Planificador* planificador);
+
+/**
+ * Suma bytes procesados a un trabajador, para las estadísticas por nodo
+ *
+ * Solo debe llamarla la tarea que se ejecuta en ese trabajador.
+ *
+ * @param planificador Planificador del trabajador
+ * @param id_trabajador Trabajador que ejecuta la tarea (-1 = ninguno, se ignora)
+ * @param bytes Bytes procesados
+ */
+void sumar_bytes_trabajador(Planificador* planificador, int id_trabajador, size_t bytes);
+
+/**
+ * Obtiene las estadísticas de cada nodo con trabajadores fijados
+ * @param planificador Planificador a consultar (después de esperar_planificador)
+ * @param nodos Array donde se almacenarán las estadísticas
+ * @param max_nodos Capacidad del array
+ * @return Número de nodos, 0 si los trabajadores no están fijados
+ */
+int obtener_estadisticas_nodos(Planificador* planificador, EstadisticasNodo* nodos, int max_nodos);
+
+/**
+ * Obtiene el número de núcleos disponibles para el proceso
+ * @return Número de núcleos (al menos 1)
+ */
+int obtener_num_nucleos(void);
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef STREAM_PROCESSOR_H
+#define STREAM_PROCESSOR_H
+
+#include <stddef.h>
+
+/**
+ * Tamaño por defecto de cada trozo leído al procesar en flujo
+ */
+#define TAMANO_TROZO_FLUJO ((size_t)1024 * 1024)
+
+/**
+ * Tamaño mínimo de trozo, aunque el límite de memoria sea menor
+ */
+#define TAMANO_TROZO_MINIMO ((size_t)4096)
+
+/**
+ * Memoria que necesita un archivo procesado entero en memoria
+ *
+ * Incluye el buffer de lectura y el del resultado en el peor caso de la
+ * operación (RLE duplica al comprimir y multiplica por 4.5 al descomprimir;
+ * Vigenère transforma el propio buffer de lectura).
+ *
+ * @param operacion Operación a realizar ('c', 'd', 'e', 'u')
+ * @param tamano Tamaño del archivo
+ * @return Bytes de memoria en el peor caso
+ */
+size_t memoria_por_archivo(char operacion, size_t tamano);
+
+/**
+ * Tamaño de trozo para procesar en flujo dentro de un límite de memoria
+ * @param operacion Operación a realizar ('c', 'd', 'e', 'u')
+ * @param limite Memoria disponible para el flujo (0 = sin límite)
+ * @return Bytes por trozo (como mucho TAMANO_TROZO_FLUJO)
+ */
+size_t trozo_para_limite(char operacion, size_t limite);
+
+/**
+ * Procesa un archivo por trozos con memoria acotada
+ *
+ * Lee, transforma y escribe el archivo trozo a trozo conservando entre
+ * trozos el estado de RLE o de la clave de Vigenère, así que la salida es
+ * idéntica a la del procesamiento en memoria y la memoria usada no depende
+ * del tamaño del archivo (ver memoria_por_archivo con el tamaño del trozo).
+ *
+ * Los archivos dispersos, los contenedores dispersos a descomprimir y los
+ * formatos ya comprimidos no se procesan en flujo: se devuelve 1 para que
+ * el llamador use procesar_archivo_individual.
+ *
+ * @param ruta_entrada Ruta del archivo de entrada
+ * @param ruta_salida Ruta del archivo de salida
+ * @param operacion Operación a realizar ('c', 'd', 'e', 'u')
+ * @param algoritmo_comp Algoritmo de compresión
+ * @param algoritmo_enc Algoritmo de encriptación
+ * @param clave Clave para encriptación
+ * @param tamano_trozo Bytes de entrada por trozo
+ * @return 0 si es exitoso, 1 si el archivo no se procesa en flujo, -1 si hay error
+ */
+int procesar_archivo_en_flujo(const char* ruta_entrada, const char* ruta_salida,
+                              char operacion, const char* algoritmo_comp,
+                              const char* algoritmo_enc, const char* clave,
+                              size_t tamano_trozo);
+
+/**
+ * Procesa por trozos una operación combinada en una sola pasada
+ *
+ * Cada trozo pasa por las dos etapas encadenadas (por ejemplo, RLE y
+ * después Vigenère en -ce) sin archivo intermedio: la entrada se lee una
+ * vez y la salida se escribe una vez, con el mismo resultado que aplicar
+ * las dos operaciones por separado.
+ *
+ * Devuelve 1 en los mismos casos que procesar_archivo_en_flujo, también
+ * cuando la entrada de la segunda etapa sería un formato ya comprimido o
+ * un contenedor disperso.
+ *
+ * @param ruta_entrada Ruta del archivo de entrada
+ * @param ruta_salida Ruta del archivo de salida
+ * @param primera Operación que se aplica primero ('c', 'd', 'e', 'u')
+ * @param segunda Operación que se aplica después (una de RLE y otra de Vigenère)
+ * @param algoritmo_comp Algoritmo de compresión
+ * @param algoritmo_enc Algoritmo de encriptación
+ * @param clave Clave para encriptación
+ * @param tamano_trozo Bytes de entrada por trozo
+ * @return 0 si es exitoso, 1 si el archivo no se procesa en flujo, -1 si hay error
+ */
+int procesar_combinada_en_flujo(const char* ruta_entrada, const char* ruta_salida,
+                                char primera, char segunda, const char* algoritmo_comp,
+                                const char* algoritmo_enc, const char* clave,
+                                size_t tamano_trozo);
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stddef.h>
+
+/**
+ * Eventos que puede guardar cada hilo; los siguientes se descartan y se
+ * cuentan en los metadatos de la traza
+ */
+#define MAX_EVENTOS_TRAZA_HILO ((size_t)1 << 20)
+
+/**
+ * Activa la traza de la actividad de los hilos (--trace)
+ *
+ * Cada medida registrada con registrar_medida se guarda también como un
+ * evento con su inicio y su duración en un buffer propio del hilo, sin
+ * cerrojos. Debe llamarse antes de crear los hilos.
+ *
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int iniciar_traza(void);
+
+/**
+ * Comprueba si la traza está activa
+ * @return 1 si está activa, 0 si no
+ */
+int traza_activa(void);
+
+/**
+ * Indica el archivo en el que trabaja el hilo llamador
+ *
+ * Los eventos siguientes del hilo llevan esta etiqueta hasta la próxima
+ * llamada. Repetir la misma etiqueta no ocupa memoria.
+ *
+ * @param etiqueta Ruta del archivo (se copia)
+ */
+void etiquetar_traza(const char* etiqueta);
+
+/**
+ * Guarda un evento en el buffer del hilo llamador
+ * @param nombre Nombre del evento (cadena estática: "lectura", "escritura"...)
+ * @param inicio Instante de inicio en segundos de reloj monótono
+ * @param fin Instante de fin en segundos de reloj monótono
+ * @param bytes Bytes tratados
+ * @param asincrono 1 si el evento puede empezar y terminar en hilos distintos (un archivo completo)
+ */
+void anotar_evento_traza(const char* nombre, double inicio, double fin, size_t bytes, int asincrono);
+
+/**
+ * Escribe los eventos de todos los hilos en el formato de eventos de
+ * Chrome (chrome://tracing, Perfetto)
+ *
+ * Las fases son eventos completos ("X") en la fila de su hilo; los archivos
+ * completos son eventos asíncronos ("b"/"e") porque con etapas o bloques
+ * empiezan y terminan en hilos distintos. Los hilos ya deben haber terminado.
+ *
+ * @param ruta Archivo de destino
+ * @return 0 si es exitoso, -1 si hay error
+ */
+int escribir_traza(const char* ruta);
+
+#endif
@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 /**
  * Implementación propia de strdup para compatibilidad con C99
@@ -22,6 +23,34 @@ char* mi_strdup(const char* s) {
     return dup;  // Retornar la cadena duplicada
 }
 
+/**
+ * Interpreta un tamaño en bytes con sufijo opcional K, M o G (potencias de 1024)
+ * 
+ * @param texto Texto a interpretar (por ejemplo "64M")
+ * @param tamano Puntero donde se almacenará el tamaño en bytes
+ * @return 0 si es válido, -1 si no
+ */
+static int parsear_tamano(const char* texto, size_t* tamano) {
+    char* fin;
+    unsigned long long valor = strtoull(texto, &fin, 10);
+    if (fin == texto || texto[0] == '-') {
+        return -1;
+    }
+    
+    switch (*fin) {
+        case 'k': case 'K': valor <<= 10; fin++; break;
+        case 'm': case 'M': valor <<= 20; fin++; break;
+        case 'g': case 'G': valor <<= 30; fin++; break;
+        default: break;
+    }
+    
+    if (*fin != '\0' || valor == 0) {
+        return -1;
+    }
+    *tamano = (size_t)valor;
+    return 0;
+}
+
 /**
  * Parsea los argumentos de la línea de comandos
  */
@@ -44,11 +73,27 @@ Argumentos* parsear_argumentos(int argc, char* argv[]) {
     args->encriptar = false;
     args->desencriptar = false;
     args->operacion_combinada = NULL;
+    args->pipeline = NULL;
     args->algoritmo_comp = NULL;
     args->algoritmo_enc = NULL;
     args->archivo_entrada = NULL;
     args->archivo_salida = NULL;
     args->clave = NULL;
+    args->num_hilos = 0;
+    args->hilos_lectura = 0;
+    args->hilos_escritura = 0;
+    args->orden_fifo = false;
+    args->umbral_bloques = 0;
+    args->tamano_bloque = 0;
+    args->paginas_enormes = false;
+    args->fijar_nodos = false;
+    args->limite_memoria = 0;
+    args->nivel_log = 1;
+    args->estadisticas_json = false;
+    args->archivo_estadisticas = NULL;
+    args->archivo_traza = NULL;
+    args->contadores_hw = false;
+    args->progreso = 0;
     
     // Parsear argumentos
     for (int i = 1; i < argc; i++) {
@@ -118,6 +163,115 @@ Argumentos* parsear_argumentos(int argc, char* argv[]) {
                 return NULL;
             }
         }
+        else if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--hilos") == 0 ||
+                 strcmp(argv[i], "--lectores") == 0 || strcmp(argv[i], "--escritores") == 0) {
+            int* destino = strcmp(argv[i], "--lectores") == 0 ? &args->hilos_lectura :
+                           strcmp(argv[i], "--escritores") == 0 ? &args->hilos_escritura : &args->num_hilos;
+            if (i + 1 < argc) {
+                char* fin;
+                long valor = strtol(argv[++i], &fin, 10);
+                if (*fin != '\0' || valor < 1 || valor > 4096) {
+                    fprintf(stderr, "Error: %s requiere un número de hilos entre 1 y 4096\n", argv[i - 1]);
+                    liberar_argumentos(args);
+                    return NULL;
+                }
+                *destino = (int)valor;
+            } else {
+                fprintf(stderr, "Error: %s requiere un número de hilos\n", argv[i]);
+                liberar_argumentos(args);
+                return NULL;
+            }
+        }
+        else if (strcmp(argv[i], "--orden") == 0) {
+            if (i + 1 < argc && (strcmp(argv[i + 1], "lpt") == 0 || strcmp(argv[i + 1], "fifo") == 0)) {
+                args->orden_fifo = strcmp(argv[++i], "fifo") == 0;
+            } else {
+                fprintf(stderr, "Error: --orden requiere 'lpt' o 'fifo'\n");
+                liberar_argumentos(args);
+                return NULL;
+            }
+        }
+        else if (strcmp(argv[i], "--limite-memoria") == 0 || strcmp(argv[i], "--mem-limit") == 0) {
+            if (i + 1 >= argc || parsear_tamano(argv[i + 1], &args->limite_memoria) != 0) {
+                fprintf(stderr, "Error: %s requiere un tamaño mayor que 0 (por ejemplo 512M)\n", argv[i]);
+                liberar_argumentos(args);
+                return NULL;
+            }
+            i++;
+        }
+        else if (strcmp(argv[i], "--umbral-bloques") == 0 || strcmp(argv[i], "--tamano-bloque") == 0) {
+            size_t* destino = strcmp(argv[i], "--umbral-bloques") == 0 ?
+                              &args->umbral_bloques : &args->tamano_bloque;
+            if (i + 1 >= argc || parsear_tamano(argv[i + 1], destino) != 0) {
+                fprintf(stderr, "Error: %s requiere un tamaño (por ejemplo 64M)\n", argv[i]);
+                liberar_argumentos(args);
+                return NULL;
+            }
+            i++;
+        }
+        else if (strcmp(argv[i], "--pipeline") == 0) {
+            if (i + 1 < argc) {
+                free(args->pipeline);
+                args->pipeline = mi_strdup(argv[++i]);
+            } else {
+                fprintf(stderr, "Error: --pipeline requiere una lista de etapas (por ejemplo rle,vigenere)\n");
+                liberar_argumentos(args);
+                return NULL;
+            }
+        }
+        else if (strcmp(argv[i], "--paginas-enormes") == 0) {
+            args->paginas_enormes = true;
+        }
+        else if (strcmp(argv[i], "--fijar-nodos") == 0 || strcmp(argv[i], "--pin") == 0) {
+            args->fijar_nodos = true;
+        }
+        else if (strncmp(argv[i], "--stats=", 8) == 0 || strncmp(argv[i], "--estadisticas=", 15) == 0) {
+            // Formato y, opcionalmente, archivo de destino: json o json:ARCHIVO
+            const char* valor = strchr(argv[i], '=') + 1;
+            if (strncmp(valor, "json", 4) != 0 || (valor[4] != '\0' && (valor[4] != ':' || valor[5] == '\0'))) {
+                fprintf(stderr, "Error: %s no es válido (use --stats=json o --stats=json:ARCHIVO)\n", argv[i]);
+                liberar_argumentos(args);
+                return NULL;
+            }
+            args->estadisticas_json = true;
+            free(args->archivo_estadisticas);
+            args->archivo_estadisticas = valor[4] == ':' ? mi_strdup(valor + 5) : NULL;
+        }
+        else if (strcmp(argv[i], "--trace") == 0 || strcmp(argv[i], "--traza") == 0) {
+            if (i + 1 < argc) {
+                free(args->archivo_traza);
+                args->archivo_traza = mi_strdup(argv[++i]);
+            } else {
+                fprintf(stderr, "Error: %s requiere un archivo\n", argv[i]);
+                liberar_argumentos(args);
+                return NULL;
+            }
+        }
+        else if (strcmp(argv[i], "--perf-counters") == 0 || strcmp(argv[i], "--contadores-hw") == 0) {
+            args->contadores_hw = true;
+        }
+        else if (strcmp(argv[i], "--progreso") == 0 || strcmp(argv[i], "--progress") == 0) {
+            // Sin formato: en la terminal si stderr lo es, por líneas si se redirige
+            args->progreso = isatty(STDERR_FILENO) ? 1 : 2;
+        }
+        else if (strncmp(argv[i], "--progreso=", 11) == 0 || strncmp(argv[i], "--progress=", 11) == 0) {
+            const char* valor = argv[i] + 11;
+            if (strcmp(valor, "tty") == 0 || strcmp(valor, "terminal") == 0) {
+                args->progreso = 1;
+            } else if (strcmp(valor, "lineas") == 0 || strcmp(valor, "lines") == 0) {
+                args->progreso = 2;
+            } else {
+                fprintf(stderr, "Error: %s no es válido (use --progreso, --progreso=tty o --progreso=lineas)\n", argv[i]);
+                liberar_argumentos(args);
+                return NULL;
+            }
+        }
+        else if (strcmp(argv[i], "-q") == 0 || strcmp(argv[i], "--silencioso") == 0) {
+            args->nivel_log = 0;
+        }
+        else if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--detallado") == 0) {
+            args->nivel_log = 2;
+        }
         else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             mostrar_ayuda();
             liberar_argumentos(args);
@@ -131,8 +285,23 @@ Argumentos* parsear_argumentos(int argc, char* argv[]) {
     }
     
     // Validar argumentos requeridos
-    if (!args->comprimir && !args->descomprimir && !args->encriptar && !args->desencriptar && !args->operacion_combinada) {
-        fprintf(stderr, "Error: Debe especificar una operación (-c, -d, -e, -u) o operación combinada (-ce, -de, -ec, -du)\n");
+    bool hay_operacion = args->comprimir || args->descomprimir || args->encriptar || args->desencriptar ||
+                         args->operacion_combinada;
+    if (!hay_operacion && !args->pipeline) {
+        fprintf(stderr, "Error: Debe especificar una operación (-c, -d, -e, -u), operación combinada (-ce, -de, -ec, -du) o --pipeline\n");
+        liberar_argumentos(args);
+        return NULL;
+    }
+    
+    if (hay_operacion && args->pipeline) {
+        fprintf(stderr, "Error: --pipeline no se combina con -c, -d, -e, -u ni operaciones combinadas\n");
+        liberar_argumentos(args);
+        return NULL;
+    }
+    
+    // Con etapas los archivos cambian de hilo: no hay nodo local al que fijarlos
+    if (args->fijar_nodos && (args->hilos_lectura || args->hilos_escritura)) {
+        fprintf(stderr, "Error: --fijar-nodos no se combina con --lectores ni --escritores\n");
         liberar_argumentos(args);
         return NULL;
     }
@@ -150,13 +319,13 @@ Argumentos* parsear_argumentos(int argc, char* argv[]) {
     }
     
     // Validar algoritmos
-    if ((args->comprimir || args->descomprimir) && !args->algoritmo_comp) {
+    if ((args->comprimir || args->descomprimir || args->operacion_combinada) && !args->algoritmo_comp) {
         fprintf(stderr, "Error: Debe especificar un algoritmo de compresión (--comp-alg)\n");
         liberar_argumentos(args);
         return NULL;
     }
     
-    if ((args->encriptar || args->desencriptar) && !args->algoritmo_enc) {
+    if ((args->encriptar || args->desencriptar || args->operacion_combinada) && !args->algoritmo_enc) {
         fprintf(stderr, "Error: Debe especificar un algoritmo de encriptación (--enc-alg)\n");
         liberar_argumentos(args);
         return NULL;
@@ -176,6 +345,9 @@ void liberar_argumentos(Argumentos* args) {
     if (args->archivo_entrada) free(args->archivo_entrada);
     if (args->archivo_salida) free(args->archivo_salida);
     if (args->clave) free(args->clave);
+    if (args->pipeline) free(args->pipeline);
+    if (args->archivo_estadisticas) free(args->archivo_estadisticas);
+    if (args->archivo_traza) free(args->archivo_traza);
     
     free(args);
 }
@@ -197,6 +369,36 @@ void mostrar_ayuda(void) {
     printf("  -i ARCHIVO            Archivo de entrada\n");
     printf("  -o ARCHIVO            Archivo de salida\n");
     printf("  -k CLAVE              Clave para encriptación (no implementado)\n");
+    printf("  -t, --hilos N         Hilos trabajadores para directorios (por defecto: núcleos, sin\n");
+    printf("                        superar la cuota cpu.max del cgroup)\n");
+    printf("  --lectores N          Leer los archivos de un directorio en N hilos y transformarlos\n");
+    printf("                        en los de -t (por defecto 2 si se pide --escritores)\n");
+    printf("  --escritores N        Escribir los resultados en N hilos (por defecto 2 si se pide\n");
+    printf("                        --lectores)\n");
+    printf("  --orden lpt|fifo      Orden de los archivos: más grandes primero (lpt) o de lectura\n");
+    printf("  --umbral-bloques TAM  Dividir en bloques los archivos desde TAM (por defecto 64M)\n");
+    printf("  --tamano-bloque TAM   Tamaño de cada bloque (por defecto 8M)\n");
+    printf("  --paginas-enormes     Pedir páginas enormes para los buffers de cada hilo\n");
+    printf("  --fijar-nodos         Fijar cada hilo a un nodo NUMA con sus buffers en la memoria\n");
+    printf("                        local, e informar el rendimiento por nodo (alias: --pin)\n");
+    printf("  --limite-memoria TAM  Memoria máxima para datos en curso; lo que no cabe se procesa\n");
+    printf("                        por trozos y los bloques esperan sitio (alias: --mem-limit; por\n");
+    printf("                        defecto: la mitad de memory.max del cgroup, si lo hay)\n");
+    printf("  --pipeline ETAPAS     Encadenar etapas en paralelo, en orden (rle, vigenere; '-' delante\n");
+    printf("                        aplica la inversa): --pipeline rle,vigenere equivale a -ce\n");
+    printf("  --stats=json[:ARCHIVO] Escribir al final las estadísticas de la ejecución en JSON\n");
+    printf("                        (latencia p50/p99 por archivo, MB/s de lectura, transformación,\n");
+    printf("                        escritura y fsync, bytes de entrada y salida) en stdout o ARCHIVO\n");
+    printf("  --trace ARCHIVO       Guardar la actividad de cada hilo (lectura, transformación,\n");
+    printf("                        escritura y fsync por archivo o bloque) en formato de eventos\n");
+    printf("                        de Chrome, para chrome://tracing o Perfetto (alias: --traza)\n");
+    printf("  --perf-counters       Medir con perf_event_open ciclos/byte, IPC, fallos de caché y\n");
+    printf("                        saltos mal predichos de cada operación (alias: --contadores-hw)\n");
+    printf("  --progreso[=tty|lineas] Informar en stderr del avance de un directorio: archivos,\n");
+    printf("                        MB/s y tiempo restante, en una línea que se reescribe (tty)\n");
+    printf("                        o en líneas clave=valor cada 10 s (alias: --progress)\n");
+    printf("  -q, --silencioso      Mostrar solo el resumen y los errores\n");
+    printf("  -v, --detallado       Mostrar también el trabajo de cada hilo y cada fase\n");
     printf("  -h, --help            Mostrar esta ayuda\n\n");
     printf("Ejemplos:\n");
     printf("  ./gsea -c --comp-alg rle -i archivo.txt -o archivo.txt.rle\n");
@@ -0,0 +1,652 @@
+#define _GNU_SOURCE // pread(), pwrite() y fallocate()
+#include "../include/block_processor.h"
+#include "../include/file_manager.h"
+#include "../include/compression.h"
+#include "../include/encryption.h"
+#include "../include/log.h"
+#include "../include/run_stats.h"
+#include "../include/trace.h"
+#include "../include/perf_counters.h"
+#include "../include/memory_accounting.h"
+#include "../include/stream_processor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Tamaño de lectura al buscar la frontera de un bloque
+#define TAMANO_LECTURA_FRONTERA (64 * 1024)
+
+typedef struct TrabajoBloques TrabajoBloques;
+
+// Bloque de un archivo dividido
+typedef struct {
+    TrabajoBloques* trabajo;
+    size_t indice;
+    off_t inicio;          // Posición del bloque en la entrada (ajustada a una frontera)
+    size_t longitud;       // Bytes de entrada del bloque
+    char* datos;           // Resultado (RLE) o datos leídos a transformar (Vigenère)
+    char* mapa;            // Proyección de la salida que contiene los datos (Vigenère), NULL si no hay
+    size_t tamano_mapa;    // Bytes proyectados desde el inicio de página anterior al bloque
+    size_t tamano_datos;   // Bytes válidos en datos
+    size_t letras;         // Letras del bloque (Vigenère)
+    size_t posicion_clave; // Letras anteriores al bloque (Vigenère)
+    off_t destino;         // Posición del resultado en la salida
+    size_t reservado;      // Memoria del presupuesto retenida hasta escribir el bloque
+    int listo;             // Fase de cálculo terminada
+    int fallo;             // Error al leer o transformar el bloque
+} Bloque;
+
+// Estado compartido por todos los bloques de un archivo
+struct TrabajoBloques {
+    Planificador* planificador;
+    int fd_entrada;
+    int fd_salida;
+    char* ruta_entrada;
+    char* ruta_salida;
+    char operacion;
+    const char* clave;
+    int salida_proyectada;     // Vigenère sobre proyecciones MAP_SHARED de la salida
+    off_t inicio_datos;        // Bytes de cabecera de contenedor RLE al inicio de la entrada
+    size_t tamano;
+    size_t tamano_bloque;
+    size_t num_bloques;
+    Bloque* bloques;
+
+    pthread_mutex_t mutex;     // Protege los campos siguientes
+    size_t siguiente;          // Primer bloque cuya posición de salida aún no se conoce
+    off_t cursor_salida;       // Posición de salida del siguiente bloque (RLE)
+    size_t letras_acumuladas;  // Letras antes del siguiente bloque (Vigenère)
+    size_t bloques_pendientes; // Bloques que aún no se han escrito
+    size_t admitidos;          // Bloques con memoria reservada y enviados (en orden)
+    size_t retenidos;          // Bloques admitidos que aún retienen su reserva
+    int admision_aplazada;     // Hay una tarea esperando memoria para el siguiente bloque
+    int error;
+
+    PresupuestoMemoria* presupuesto; // NULL = sin presupuesto: todos los bloques se envían a la vez
+
+    FinArchivoBloques fin;
+    void* contexto;
+};
+
+// Implementación propia de strdup para compatibilidad con C99
+static char* duplicar_cadena(const char* s) {
+    size_t len = strlen(s) + 1;
+    char* dup = asignar_memoria(MEMORIA_BLOQUES, len);
+    if (dup) {
+        memcpy(dup, s, len);
+    }
+    return dup;
+}
+
+static int es_vigenere(const TrabajoBloques* t) {
+    return t->operacion == 'e' || t->operacion == 'u';
+}
+
+/**
+ * Busca la primera frontera válida a partir de una posición
+ *
+ * Al comprimir, una frontera es un byte distinto del anterior (inicio de
+ * repetición); al descomprimir, un byte que no es un dígito '1'..'9' (inicio
+ * de token). Vigenère admite cualquier posición. Como la búsqueda es
+ * determinista, el bloque anterior y el siguiente calculan la misma frontera.
+ * Ninguna frontera cae antes del inicio de los datos (tras la cabecera).
+ */
+static off_t buscar_frontera(int fd, off_t desde, size_t tamano, char operacion, off_t inicio_datos) {
+    if (desde <= inicio_datos) {
+        return inicio_datos;
+    }
+    if ((size_t)desde >= tamano) {
+        return (off_t)tamano;
+    }
+    if (operacion != 'c' && operacion != 'd') {
+        return desde;
+    }
+
+    unsigned char buffer[TAMANO_LECTURA_FRONTERA];
+    int anterior = -1;
+    off_t pos = operacion == 'c' ? desde - 1 : desde; // Comprimir necesita el byte anterior
+
+    while ((size_t)pos < tamano) {
+        ssize_t n = pread(fd, buffer, sizeof(buffer), pos);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        for (ssize_t k = 0; k < n; k++) {
+            off_t actual = pos + k;
+            if (operacion == 'c') {
+                if (actual >= desde && buffer[k] != anterior) {
+                    return actual;
+                }
+                anterior = buffer[k];
+            } else if (buffer[k] < '1' || buffer[k] > '9') {
+                return actual;
+            }
+        }
+        pos += n;
+    }
+
+    return (off_t)tamano;
+}
+
+/**
+ * Lee un bloque Vigenère directamente en una proyección MAP_SHARED de la salida
+ *
+ * La transformación se hará después sobre la misma proyección, de modo que
+ * los datos solo viven en la caché de páginas del archivo de salida y el
+ * bloque no usa memoria del heap.
+ *
+ * @return 0 si es exitoso, 1 si no se pudo proyectar (se usa el heap), -1 si hay error
+ */
+static int proyectar_bloque(TrabajoBloques* t, Bloque* b) {
+    off_t pagina = (off_t)sysconf(_SC_PAGESIZE);
+    off_t base = b->inicio - b->inicio % pagina;
+    size_t desplazamiento = (size_t)(b->inicio - base);
+    size_t tamano_mapa = desplazamiento + b->longitud;
+
+    void* mapa = mmap(NULL, tamano_mapa, PROT_READ | PROT_WRITE, MAP_SHARED, t->fd_salida, base);
+    if (mapa == MAP_FAILED) {
+        return 1;
+    }
+
+    b->mapa = mapa;
+    b->tamano_mapa = tamano_mapa;
+    b->datos = (char*)mapa + desplazamiento;
+    double inicio = iniciar_medida();
+    if (leer_rango_archivo(t->fd_entrada, b->datos, b->longitud, b->inicio) != 0) {
+        fprintf(stderr, "Error: No se pudo leer el bloque %zu de '%s': %s\n",
+                b->indice, t->ruta_entrada, strerror(errno));
+        munmap(b->mapa, b->tamano_mapa);
+        b->mapa = NULL;
+        b->datos = NULL;
+        return -1;
+    }
+
+    registrar_medida(MEDIDA_LECTURA, inicio, b->longitud);
+
+    b->tamano_datos = b->longitud;
+    b->letras = contar_letras(b->datos, b->longitud);
+    return 0;
+}
+
+// Lee el bloque y calcula su resultado (RLE) o cuenta sus letras (Vigenère)
+static int calcular_bloque(TrabajoBloques* t, Bloque* b) {
+    if (b->longitud == 0) {
+        return 0;
+    }
+
+    if (t->salida_proyectada) {
+        int resultado = proyectar_bloque(t, b);
+        if (resultado != 1) {
+            return resultado;
+        }
+    }
+
+    // Al comprimir se lee un byte más: el primero del bloque siguiente
+    off_t fin = b->inicio + (off_t)b->longitud;
+    size_t a_leer = b->longitud + (t->operacion == 'c' && (size_t)fin < t->tamano ? 1 : 0);
+
+    char* entrada = asignar_memoria(MEMORIA_BLOQUES, a_leer);
+    if (!entrada) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para el bloque %zu\n", b->indice);
+        return -1;
+    }
+    double inicio = iniciar_medida();
+    if (leer_rango_archivo(t->fd_entrada, entrada, a_leer, b->inicio) != 0) {
+        fprintf(stderr, "Error: No se pudo leer el bloque %zu de '%s': %s\n",
+                b->indice, t->ruta_entrada, strerror(errno));
+        liberar_asignacion(entrada);
+        return -1;
+    }
+    registrar_medida(MEDIDA_LECTURA, inicio, b->longitud);
+
+    if (es_vigenere(t)) {
+        b->datos = entrada;
+        b->tamano_datos = b->longitud;
+        b->letras = contar_letras(entrada, b->longitud);
+        return 0;
+    }
+
+    size_t capacidad = t->operacion == 'c' ? cota_compresion_rle(b->longitud) : cota_descompresion_rle(b->longitud);
+    char* salida = asignar_memoria(MEMORIA_BLOQUES, capacidad);
+    if (!salida) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para el bloque %zu\n", b->indice);
+        liberar_asignacion(entrada);
+        return -1;
+    }
+
+    inicio = iniciar_medida();
+    LecturaContadoresHw contadores;
+    leer_contadores_hw(&contadores);
+    if (t->operacion == 'c') {
+        int siguiente = a_leer > b->longitud ? (unsigned char)entrada[b->longitud] : -1;
+        b->tamano_datos = comprimir_rle_bloque(entrada, b->longitud, siguiente, salida);
+    } else {
+        b->tamano_datos = descomprimir_rle_bloque(entrada, b->longitud, salida);
+    }
+    registrar_contadores_hw(t->operacion, &contadores, b->longitud);
+    registrar_medida(MEDIDA_TRANSFORMACION, inicio, b->longitud);
+
+    liberar_asignacion(entrada);
+    b->datos = salida;
+    return 0;
+}
+
+// Cierra los archivos, informa el resultado y libera el trabajo
+static void finalizar_trabajo(TrabajoBloques* t) {
+    int resultado = t->error ? -1 : 0;
+    off_t tamano_salida = es_vigenere(t) ? (off_t)t->tamano : t->cursor_salida;
+
+    if (sincronizar_archivo(t->fd_salida, (size_t)tamano_salida) == -1) {
+        fprintf(stderr, "Advertencia: No se pudo sincronizar el archivo con el disco: %s\n", strerror(errno));
+    }
+    close(t->fd_salida);
+    close(t->fd_entrada);
+
+    if (resultado == 0) {
+        LOG_INFO("Procesamiento por bloques completado: %s (%zu bloques, %zu -> %lld bytes)",
+                 t->ruta_entrada, t->num_bloques, t->tamano, (long long)tamano_salida);
+    } else {
+        fprintf(stderr, "Error: Falló el procesamiento por bloques de '%s'\n", t->ruta_entrada);
+        unlink(t->ruta_salida);
+    }
+
+    if (t->fin) {
+        t->fin(t->contexto, resultado);
+    }
+
+    pthread_mutex_destroy(&t->mutex);
+    liberar_asignacion(t->bloques);
+    liberar_asignacion(t->ruta_entrada);
+    liberar_asignacion(t->ruta_salida);
+    liberar_asignacion(t);
+}
+
+static void admitir_bloques(TrabajoBloques* t, int id_trabajador, int esperar);
+
+// Escribe un bloque ya ubicado en la salida y, si es el último, cierra el archivo
+static void escribir_bloque(Bloque* b, int id_trabajador) {
+    TrabajoBloques* t = b->trabajo;
+    int error = b->fallo;
+
+    if (b->mapa) {
+        // Los datos ya están en su sitio en la salida: basta transformarlos
+        double inicio = iniciar_medida();
+        LecturaContadoresHw contadores;
+        leer_contadores_hw(&contadores);
+        aplicar_vigenere_bloque(b->datos, b->datos, b->longitud, t->clave,
+                                b->posicion_clave, t->operacion == 'u');
+        registrar_contadores_hw(t->operacion, &contadores, b->longitud);
+        registrar_medida(MEDIDA_TRANSFORMACION, inicio, b->longitud);
+        munmap(b->mapa, b->tamano_mapa);
+        b->mapa = NULL;
+        b->datos = NULL;
+    } else if (b->datos) {
+        if (es_vigenere(t)) {
+            double inicio = iniciar_medida();
+            LecturaContadoresHw contadores;
+            leer_contadores_hw(&contadores);
+            aplicar_vigenere_bloque(b->datos, b->datos, b->longitud, t->clave,
+                                    b->posicion_clave, t->operacion == 'u');
+            registrar_contadores_hw(t->operacion, &contadores, b->longitud);
+            registrar_medida(MEDIDA_TRANSFORMACION, inicio, b->longitud);
+        }
+        double inicio = iniciar_medida();
+        if (!error && escribir_rango_archivo(t->fd_salida, b->datos, b->tamano_datos, b->destino) != 0) {
+            fprintf(stderr, "Error: No se pudo escribir el bloque %zu en '%s': %s\n",
+                    b->indice, t->ruta_salida, strerror(errno));
+            error = 1;
+        } else if (!error) {
+            registrar_medida(MEDIDA_ESCRITURA, inicio, b->tamano_datos);
+        }
+        liberar_asignacion(b->datos);
+        b->datos = NULL;
+    }
+
+    // La memoria del bloque deja sitio a los siguientes; el bloque sigue contando
+    // como pendiente, así que el trabajo no puede terminar mientras se admiten
+    if (t->presupuesto) {
+        liberar_memoria(t->presupuesto, b->reservado);
+        b->reservado = 0;
+        pthread_mutex_lock(&t->mutex);
+        t->retenidos--;
+        pthread_mutex_unlock(&t->mutex);
+        admitir_bloques(t, id_trabajador, 0);
+    }
+
+    pthread_mutex_lock(&t->mutex);
+    if (error) {
+        t->error = 1;
+    }
+    int ultimo = --t->bloques_pendientes == 0;
+    pthread_mutex_unlock(&t->mutex);
+
+    if (ultimo) {
+        finalizar_trabajo(t);
+    }
+}
+
+// Tarea que transforma (Vigenère) y escribe un bloque cuya posición de clave ya se conoce
+static void tarea_escribir_bloque(void* arg, int id_trabajador) {
+    etiquetar_traza(((Bloque*)arg)->trabajo->ruta_entrada);
+    escribir_bloque((Bloque*)arg, id_trabajador);
+}
+
+// Envía una tarea de un bloque; con presupuesto, por delante de las que pueden esperar memoria
+static int enviar_tarea_bloque(TrabajoBloques* t, int id_trabajador, FuncionTarea funcion,
+                               Bloque* b, size_t costo) {
+    if (t->presupuesto) {
+        return enviar_tarea_prioritaria(t->planificador, id_trabajador, funcion, b, costo);
+    }
+    return enviar_tarea(t->planificador, id_trabajador, funcion, b, costo);
+}
+
+/**
+ * Ubica en la salida los bloques consecutivos ya calculados y los escribe
+ *
+ * La posición de un bloque depende de los anteriores: en RLE es la suma de
+ * sus tamaños comprimidos y en Vigenère la posición de la clave es la suma
+ * de sus letras. Cada bloque queda ubicado en cuanto todos los anteriores
+ * están calculados, sin esperar al resto del archivo.
+ */
+static void ubicar_bloques(Bloque* b, int id_trabajador) {
+    TrabajoBloques* t = b->trabajo;
+
+    pthread_mutex_lock(&t->mutex);
+    b->listo = 1;
+    size_t primero = t->siguiente;
+    while (t->siguiente < t->num_bloques && t->bloques[t->siguiente].listo) {
+        Bloque* r = &t->bloques[t->siguiente];
+        if (es_vigenere(t)) {
+            r->posicion_clave = t->letras_acumuladas;
+            r->destino = r->inicio;
+            t->letras_acumuladas += r->letras;
+        } else {
+            r->destino = t->cursor_salida;
+            t->cursor_salida += (off_t)r->tamano_datos;
+        }
+        t->siguiente++;
+    }
+    size_t ultimo = t->siguiente;
+    pthread_mutex_unlock(&t->mutex);
+
+    // Este hilo es el único dueño de los bloques [primero, ultimo)
+    for (size_t i = primero; i < ultimo; i++) {
+        Bloque* r = &t->bloques[i];
+        // En Vigenère la transformación de los otros bloques se reparte entre el pool
+        if (es_vigenere(t) && r != b &&
+            enviar_tarea_bloque(t, id_trabajador, tarea_escribir_bloque, r, r->longitud) == 0) {
+            continue;
+        }
+        escribir_bloque(r, id_trabajador);
+    }
+}
+
+// Tarea que procesa un bloque: ajusta sus fronteras, lo calcula y lo ubica en la salida
+static void tarea_bloque(void* arg, int id_trabajador) {
+    Bloque* b = (Bloque*)arg;
+    TrabajoBloques* t = b->trabajo;
+    etiquetar_traza(t->ruta_entrada);
+
+    off_t nominal_inicio = (off_t)(b->indice * t->tamano_bloque);
+    off_t nominal_fin = (off_t)((b->indice + 1) * t->tamano_bloque);
+    off_t inicio = buscar_frontera(t->fd_entrada, nominal_inicio, t->tamano, t->operacion, t->inicio_datos);
+    off_t fin = b->indice + 1 < t->num_bloques ?
+                buscar_frontera(t->fd_entrada, nominal_fin, t->tamano, t->operacion, t->inicio_datos) :
+                (off_t)t->tamano;
+
+    if (inicio < 0 || fin < 0) {
+        fprintf(stderr, "Error: No se pudo leer el bloque %zu de '%s': %s\n",
+                b->indice, t->ruta_entrada, strerror(errno));
+        b->fallo = 1;
+    } else {
+        b->inicio = inicio;
+        b->longitud = fin > inicio ? (size_t)(fin - inicio) : 0;
+        // Una repetición que cruza la frontera nominal alarga el bloque: se amplía la
+        // reserva si cabe, y si no el bloque se procesa igualmente sin esperar
+        size_t necesario = memoria_por_archivo(t->operacion, b->longitud);
+        if (t->presupuesto && necesario > b->reservado &&
+            intentar_reservar_memoria(t->presupuesto, necesario - b->reservado) == 0) {
+            b->reservado = necesario;
+        }
+        if (calcular_bloque(t, b) != 0) {
+            b->fallo = 1;
+        } else {
+            sumar_bytes_trabajador(t->planificador, id_trabajador, b->longitud);
+        }
+    }
+
+    ubicar_bloques(b, id_trabajador);
+}
+
+// Memoria de un bloque nominal en el peor caso, recortada al presupuesto
+static size_t memoria_bloque(const TrabajoBloques* t) {
+    size_t necesario = memoria_por_archivo(t->operacion, t->tamano_bloque);
+    size_t limite = obtener_limite_memoria(t->presupuesto);
+    return necesario < limite ? necesario : limite;
+}
+
+// Tarea que espera memoria para el siguiente bloque cuando ninguno del archivo retiene
+static void tarea_admitir_bloques(void* arg, int id_trabajador) {
+    admitir_bloques((TrabajoBloques*)arg, id_trabajador, 1);
+}
+
+/**
+ * Envía los bloques siguientes del archivo que quepan en el presupuesto
+ *
+ * Los bloques se admiten en orden y cada uno retiene su reserva hasta que
+ * se escribe, así que los bloques anteriores a uno admitido siempre están
+ * admitidos y el archivo avanza. Solo se espera memoria (esperar = 1) en
+ * una tarea que no retiene nada: al dividir el archivo, o en una tarea
+ * ordinaria encolada cuando ningún bloque del archivo retiene memoria y no
+ * queda sitio. Los bloques admitidos se envían como tareas prioritarias, de
+ * modo que ningún trabajador espera memoria con uno de ellos en su cola.
+ */
+static void admitir_bloques(TrabajoBloques* t, int id_trabajador, int esperar) {
+    size_t reservado = 0;
+    if (esperar) {
+        reservado = reservar_memoria(t->presupuesto, memoria_bloque(t));
+    }
+
+    pthread_mutex_lock(&t->mutex);
+    size_t primero = t->admitidos;
+    if (esperar) {
+        t->bloques[t->admitidos++].reservado = reservado;
+        t->retenidos++;
+        t->admision_aplazada = 0;
+    }
+    while (t->admitidos < t->num_bloques) {
+        size_t necesario = memoria_bloque(t);
+        if (intentar_reservar_memoria(t->presupuesto, necesario) != 0) {
+            break;
+        }
+        t->bloques[t->admitidos++].reservado = necesario;
+        t->retenidos++;
+    }
+    size_t ultimo = t->admitidos;
+    int aplazar = t->retenidos == 0 && t->admitidos < t->num_bloques && !t->admision_aplazada;
+    if (aplazar) {
+        t->admision_aplazada = 1;
+    }
+    pthread_mutex_unlock(&t->mutex);
+
+    for (size_t i = primero; i < ultimo; i++) {
+        if (enviar_tarea_bloque(t, id_trabajador, tarea_bloque, &t->bloques[i], t->tamano_bloque) != 0) {
+            tarea_bloque(&t->bloques[i], id_trabajador); // Sin memoria para encolar: procesar aquí
+        }
+    }
+    // Los bloques pendientes mantienen vivo el trabajo hasta que la tarea lo admita
+    if (aplazar && enviar_tarea(t->planificador, id_trabajador, tarea_admitir_bloques, t, t->tamano_bloque) != 0) {
+        admitir_bloques(t, id_trabajador, 1);
+    }
+}
+
+/**
+ * Divide un archivo grande en tareas de bloque dentro de un planificador
+ */
+int procesar_archivo_en_bloques(Planificador* planificador, int id_origen,
+                                const char* ruta_entrada, const char* ruta_salida,
+                                char operacion, const char* algoritmo_comp,
+                                const char* algoritmo_enc, const char* clave,
+                                size_t umbral, size_t tamano_bloque,
+                                PresupuestoMemoria* presupuesto,
+                                FinArchivoBloques fin, void* contexto) {
+    if (!planificador || !ruta_entrada || !ruta_salida) {
+        fprintf(stderr, "Error: Parámetros inválidos para procesar_archivo_en_bloques\n");
+        return -1;
+    }
+
+    // Solo RLE y Vigenère (con clave válida) se dividen; el resto sigue el camino normal
+    if (operacion == 'c' || operacion == 'd') {
+        if (!algoritmo_comp || strcmp(algoritmo_comp, "rle") != 0) return 1;
+    } else if (operacion == 'e' || operacion == 'u') {
+        if (!algoritmo_enc || strcmp(algoritmo_enc, "vigenere") != 0 || !validar_clave(clave)) return 1;
+    } else {
+        return 1;
+    }
+
+    if (tamano_bloque == 0) {
+        tamano_bloque = TAMANO_BLOQUE_POR_DEFECTO;
+    }
+    // Con presupuesto, cada bloque debe caber entero en él
+    if (presupuesto) {
+        size_t trozo = trozo_para_limite(operacion, obtener_limite_memoria(presupuesto));
+        if (tamano_bloque > trozo) {
+            tamano_bloque = trozo;
+        }
+    }
+
+    int fd_entrada = open(ruta_entrada, O_RDONLY);
+    if (fd_entrada == -1) {
+        return 1; // El camino normal informa el error
+    }
+
+    struct stat st;
+    if (fstat(fd_entrada, &st) == -1 || st.st_size == 0 || (size_t)st.st_size < umbral ||
+        descriptor_tiene_huecos(fd_entrada, st.st_size)) {
+        close(fd_entrada);
+        return 1;
+    }
+
+    // Los formatos ya comprimidos y los demás contenedores tienen su propio camino;
+    // la cabecera del contenedor RLE se escribe (o se salta) aquí y los bloques
+    // solo ven los datos
+    char cabecera[TAMANO_FIRMA_COMPRIMIDO];
+    ssize_t leidos = pread(fd_entrada, cabecera, sizeof(cabecera), 0);
+    TipoContenedor contenedor = CONTENEDOR_NINGUNO;
+    if (leidos > 0 && (operacion == 'c' || operacion == 'd')) {
+        if (operacion == 'c' && es_formato_comprimido(cabecera, (size_t)leidos)) {
+            close(fd_entrada);
+            return 1;
+        }
+        if (operacion == 'c') {
+            contenedor = requiere_contenedor_rle(cabecera, (size_t)leidos) ? CONTENEDOR_RLE : CONTENEDOR_NINGUNO;
+        } else {
+            contenedor = identificar_contenedor(cabecera, (size_t)leidos);
+        }
+        if (contenedor != CONTENEDOR_NINGUNO && contenedor != CONTENEDOR_RLE) {
+            close(fd_entrada);
+            return 1;
+        }
+    }
+
+    TrabajoBloques* t = asignar_memoria_ceros(MEMORIA_BLOQUES, 1, sizeof(TrabajoBloques));
+    size_t num_bloques = ((size_t)st.st_size + tamano_bloque - 1) / tamano_bloque;
+    Bloque* bloques = asignar_memoria_ceros(MEMORIA_BLOQUES, num_bloques, sizeof(Bloque));
+    char* copia_entrada = duplicar_cadena(ruta_entrada);
+    char* copia_salida = duplicar_cadena(ruta_salida);
+    if (!t || !bloques || !copia_entrada || !copia_salida) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para dividir '%s' en bloques\n", ruta_entrada);
+        liberar_asignacion(t);
+        liberar_asignacion(bloques);
+        liberar_asignacion(copia_entrada);
+        liberar_asignacion(copia_salida);
+        close(fd_entrada);
+        return -1;
+    }
+
+    // Vigenère necesita poder leer la salida para proyectarla
+    int fd_salida = open(ruta_salida, (operacion == 'e' || operacion == 'u' ? O_RDWR : O_WRONLY) |
+                         O_CREAT | O_TRUNC, 0644);
+    if (fd_salida == -1) {
+        fprintf(stderr, "Error: No se pudo crear/abrir el archivo '%s': %s\n", ruta_salida, strerror(errno));
+        liberar_asignacion(t);
+        liberar_asignacion(bloques);
+        liberar_asignacion(copia_entrada);
+        liberar_asignacion(copia_salida);
+        close(fd_entrada);
+        return -1;
+    }
+
+    // Vigenère conserva el tamaño: la salida se reserva entera y cada bloque se
+    // transforma sobre su proyección. Sin espacio reservado, escribir en una
+    // proyección con el disco lleno daría SIGBUS, así que se usa pwrite()
+    if (operacion == 'e' || operacion == 'u') {
+        t->salida_proyectada = fallocate(fd_salida, 0, 0, st.st_size) == 0;
+    }
+
+    if (contenedor == CONTENEDOR_RLE && operacion == 'c') {
+        char cabecera_salida[TAMANO_CABECERA_CONTENEDOR];
+        escribir_cabecera_contenedor(CONTENEDOR_RLE, cabecera_salida);
+        if (escribir_rango_archivo(fd_salida, cabecera_salida, sizeof(cabecera_salida), 0) != 0) {
+            fprintf(stderr, "Error: No se pudo escribir al archivo '%s': %s\n", ruta_salida, strerror(errno));
+            liberar_asignacion(t);
+            liberar_asignacion(bloques);
+            liberar_asignacion(copia_entrada);
+            liberar_asignacion(copia_salida);
+            close(fd_salida);
+            close(fd_entrada);
+            unlink(ruta_salida);
+            return -1;
+        }
+        t->cursor_salida = TAMANO_CABECERA_CONTENEDOR;
+    } else if (contenedor == CONTENEDOR_RLE) {
+        t->inicio_datos = TAMANO_CABECERA_CONTENEDOR;
+    }
+
+    t->planificador = planificador;
+    t->fd_entrada = fd_entrada;
+    t->fd_salida = fd_salida;
+    t->ruta_entrada = copia_entrada;
+    t->ruta_salida = copia_salida;
+    t->operacion = operacion;
+    t->clave = clave;
+    t->tamano = (size_t)st.st_size;
+    t->tamano_bloque = tamano_bloque;
+    t->num_bloques = num_bloques;
+    t->bloques = bloques;
+    t->bloques_pendientes = num_bloques;
+    t->presupuesto = presupuesto;
+    t->fin = fin;
+    t->contexto = contexto;
+    pthread_mutex_init(&t->mutex, NULL);
+
+    for (size_t i = 0; i < num_bloques; i++) {
+        bloques[i].trabajo = t;
+        bloques[i].indice = i;
+    }
+
+    LOG_DETALLE("Archivo grande dividido en %zu bloques: %s", num_bloques, ruta_entrada);
+
+    // Desde este punto el trabajo puede terminar en cualquier hilo: no se usa 't' después
+    if (presupuesto) {
+        admitir_bloques(t, id_origen, 1);
+        return 0;
+    }
+    for (size_t i = 0; i < num_bloques; i++) {
+        if (enviar_tarea(planificador, id_origen, tarea_bloque, &bloques[i], tamano_bloque) != 0) {
+            tarea_bloque(&bloques[i], id_origen); // Sin memoria para encolar: procesar aquí
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include "../include/bounded_queue.h"
+#include "../include/memory_accounting.h"
+#include <stdlib.h>
+#include <pthread.h>
+
+struct ColaAcotada {
+    pthread_mutex_t mutex;     // Protege los campos siguientes
+    pthread_cond_t no_llena;   // Señala que se sacó un elemento
+    pthread_cond_t no_vacia;   // Señala que se añadió un elemento o se cerró la cola
+    void** elementos;          // Buffer circular de capacidad elementos
+    size_t capacidad;
+    size_t inicio;             // Posición del primer elemento
+    size_t num_elementos;
+    size_t ocupacion_maxima;
+    int cerrada;
+    int cancelada;
+};
+
+ColaAcotada* crear_cola_acotada(size_t capacidad) {
+    if (capacidad == 0) {
+        return NULL;
+    }
+
+    ColaAcotada* cola = asignar_memoria_ceros(MEMORIA_PLANIFICADOR, 1, sizeof(ColaAcotada));
+    if (!cola) {
+        return NULL;
+    }
+    cola->elementos = asignar_memoria(MEMORIA_PLANIFICADOR, capacidad * sizeof(void*));
+    if (!cola->elementos) {
+        liberar_asignacion(cola);
+        return NULL;
+    }
+
+    pthread_mutex_init(&cola->mutex, NULL);
+    pthread_cond_init(&cola->no_llena, NULL);
+    pthread_cond_init(&cola->no_vacia, NULL);
+    cola->capacidad = capacidad;
+    return cola;
+}
+
+int encolar_acotada(ColaAcotada* cola, void* elemento) {
+    pthread_mutex_lock(&cola->mutex);
+    while (cola->num_elementos == cola->capacidad && !cola->cancelada) {
+        pthread_cond_wait(&cola->no_llena, &cola->mutex);
+    }
+    if (cola->cancelada) {
+        pthread_mutex_unlock(&cola->mutex);
+        return -1;
+    }
+
+    cola->elementos[(cola->inicio + cola->num_elementos) % cola->capacidad] = elemento;
+    cola->num_elementos++;
+    if (cola->num_elementos > cola->ocupacion_maxima) {
+        cola->ocupacion_maxima = cola->num_elementos;
+    }
+    pthread_cond_signal(&cola->no_vacia);
+    pthread_mutex_unlock(&cola->mutex);
+    return 0;
+}
+
+int desencolar_acotada(ColaAcotada* cola, void** elemento) {
+    pthread_mutex_lock(&cola->mutex);
+    while (cola->num_elementos == 0 && !cola->cerrada && !cola->cancelada) {
+        pthread_cond_wait(&cola->no_vacia, &cola->mutex);
+    }
+    if (cola->cancelada || cola->num_elementos == 0) {
+        pthread_mutex_unlock(&cola->mutex);
+        return 1;
+    }
+
+    *elemento = cola->elementos[cola->inicio];
+    cola->inicio = (cola->inicio + 1) % cola->capacidad;
+    cola->num_elementos--;
+    pthread_cond_signal(&cola->no_llena);
+    pthread_mutex_unlock(&cola->mutex);
+    return 0;
+}
+
+void cerrar_cola_acotada(ColaAcotada* cola) {
+    pthread_mutex_lock(&cola->mutex);
+    cola->cerrada = 1;
+    pthread_cond_broadcast(&cola->no_vacia);
+    pthread_mutex_unlock(&cola->mutex);
+}
+
+void cancelar_cola_acotada(ColaAcotada* cola) {
+    pthread_mutex_lock(&cola->mutex);
+    cola->cancelada = 1;
+    pthread_cond_broadcast(&cola->no_vacia);
+    pthread_cond_broadcast(&cola->no_llena);
+    pthread_mutex_unlock(&cola->mutex);
+}
+
+size_t ocupacion_maxima_cola(ColaAcotada* cola) {
+    pthread_mutex_lock(&cola->mutex);
+    size_t ocupacion = cola->ocupacion_maxima;
+    pthread_mutex_unlock(&cola->mutex);
+    return ocupacion;
+}
+
+void destruir_cola_acotada(ColaAcotada* cola, void (*liberar_elemento)(void*)) {
+    if (!cola) return;
+
+    if (liberar_elemento) {
+        for (size_t i = 0; i < cola->num_elementos; i++) {
+            liberar_elemento(cola->elementos[(cola->inicio + i) % cola->capacidad]);
+        }
+    }
+    pthread_cond_destroy(&cola->no_vacia);
+    pthread_cond_destroy(&cola->no_llena);
+    pthread_mutex_destroy(&cola->mutex);
+    liberar_asignacion(cola->elementos);
+    liberar_asignacion(cola);
+}
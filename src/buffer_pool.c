@@ -0,0 +1,108 @@
+#define _GNU_SOURCE // MAP_ANONYMOUS y MADV_HUGEPAGE
+#include "../include/buffer_pool.h"
+#include "../include/memory_accounting.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Tamaño de una página enorme en x86-64 y arm64 (4K de página base)
+#define TAMANO_PAGINA_ENORME ((size_t)2 * 1024 * 1024)
+
+// Redondea un tamaño hacia arriba a un múltiplo de la granularidad
+static size_t redondear(size_t tamano, size_t granularidad) {
+    return (tamano + granularidad - 1) / granularidad * granularidad;
+}
+
+// Proyecta memoria anónima cuyo inicio es múltiplo de la alineación: se
+// proyecta una alineación de más y se recortan los sobrantes de ambos extremos
+static void* proyectar_alineado(size_t capacidad, size_t alineacion) {
+    char* bruto = mmap(NULL, capacidad + alineacion, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (bruto == MAP_FAILED) {
+        return MAP_FAILED;
+    }
+    size_t delante = (alineacion - (uintptr_t)bruto % alineacion) % alineacion;
+    if (delante > 0) {
+        munmap(bruto, delante);
+    }
+    munmap(bruto + delante + capacidad, alineacion - delante);
+    return bruto + delante;
+}
+
+void iniciar_arena_trabajador(ArenaTrabajador* arena, int paginas_enormes) {
+    memset(arena, 0, sizeof(*arena));
+    arena->paginas_enormes = paginas_enormes;
+}
+
+char* obtener_buffer_arena(ArenaTrabajador* arena, TipoBuffer tipo, size_t tamano) {
+    if (!arena || tipo >= NUM_BUFFERS_ARENA) {
+        return NULL;
+    }
+    if (tamano == 0) {
+        tamano = 1;
+    }
+
+    if (arena->buffers[tipo] && arena->capacidades[tipo] >= tamano) {
+        arena->reutilizaciones++;
+        return arena->buffers[tipo];
+    }
+
+    // Los buffers grandes empiezan y terminan en una frontera de página enorme,
+    // de modo que MADV_HUGEPAGE cubre el buffer entero y no solo su interior
+    size_t granularidad = (size_t)sysconf(_SC_PAGESIZE);
+    int enorme = arena->paginas_enormes && tamano >= TAMANO_PAGINA_ENORME;
+    if (enorme) {
+        granularidad = TAMANO_PAGINA_ENORME;
+    }
+    size_t capacidad = redondear(tamano, granularidad);
+
+    // El contenido anterior no se conserva: se descarta el buffer viejo en lugar de copiarlo
+    if (arena->buffers[tipo]) {
+        munmap(arena->buffers[tipo], arena->capacidades[tipo]);
+        restar_memoria(MEMORIA_BUFFERS, arena->capacidades[tipo]);
+        arena->buffers[tipo] = NULL;
+        arena->capacidades[tipo] = 0;
+    }
+
+    void* buffer = enorme ? proyectar_alineado(capacidad, TAMANO_PAGINA_ENORME)
+                          : mmap(NULL, capacidad, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffer == MAP_FAILED) {
+        fprintf(stderr, "Error: No se pudo reservar un buffer de %zu bytes: %s\n", capacidad, strerror(errno));
+        return NULL;
+    }
+#ifdef MADV_HUGEPAGE
+    if (enorme) {
+        madvise(buffer, capacidad, MADV_HUGEPAGE); // Es solo una sugerencia: se ignora el error
+    }
+#endif
+
+    sumar_memoria(MEMORIA_BUFFERS, capacidad);
+    arena->buffers[tipo] = buffer;
+    arena->capacidades[tipo] = capacidad;
+    arena->reservas++;
+    return buffer;
+}
+
+size_t memoria_arena_trabajador(const ArenaTrabajador* arena) {
+    size_t total = 0;
+    for (int i = 0; i < NUM_BUFFERS_ARENA; i++) {
+        total += arena->capacidades[i];
+    }
+    return total;
+}
+
+void liberar_arena_trabajador(ArenaTrabajador* arena) {
+    if (!arena) return;
+
+    for (int i = 0; i < NUM_BUFFERS_ARENA; i++) {
+        if (arena->buffers[i]) {
+            munmap(arena->buffers[i], arena->capacidades[i]);
+            restar_memoria(MEMORIA_BUFFERS, arena->capacidades[i]);
+        }
+        arena->buffers[i] = NULL;
+        arena->capacidades[i] = 0;
+    }
+}
@@ -0,0 +1,248 @@
+#include "../include/cgroup.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+// Longitud máxima de una línea de /proc y de una ruta de cgroup
+#define LINEA_MAXIMA 4096
+
+// Límites de memoria de v1 a partir de los cuales se considera que no hay límite
+#define SIN_LIMITE_V1 ((unsigned long long)1 << 62)
+
+// Archivos a consultar en cada nivel de la jerarquía
+#define LEER_CPU 1
+#define LEER_MEMORIA 2
+
+static LimitesCgroup limites;
+static pthread_once_t limites_leidos = PTHREAD_ONCE_INIT;
+
+// Comprueba si una lista separada por comas contiene un nombre
+static int lista_contiene(const char* lista, const char* nombre) {
+    size_t largo = strlen(nombre);
+    while (*lista) {
+        size_t elemento = strcspn(lista, ",");
+        if (elemento == largo && strncmp(lista, nombre, largo) == 0) {
+            return 1;
+        }
+        lista += elemento;
+        if (*lista == ',') {
+            lista++;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Busca la ruta del proceso dentro de una jerarquía de cgroup
+ *
+ * @param controlador Controlador de v1 ("cpu", "memory"); NULL para la jerarquía v2
+ * @param ruta Buffer donde se almacenará la ruta (de LINEA_MAXIMA bytes)
+ * @return 0 si se encontró, -1 si no
+ */
+static int ruta_del_proceso(const char* controlador, char* ruta) {
+    FILE* archivo = fopen("/proc/self/cgroup", "r");
+    if (!archivo) {
+        return -1;
+    }
+
+    // Cada línea es "id:controladores:ruta"; la de v2 es "0::ruta"
+    char linea[LINEA_MAXIMA];
+    int resultado = -1;
+    while (resultado != 0 && fgets(linea, sizeof(linea), archivo)) {
+        linea[strcspn(linea, "\n")] = '\0';
+        char* controladores = strchr(linea, ':');
+        char* ruta_linea = controladores ? strchr(controladores + 1, ':') : NULL;
+        if (!ruta_linea) {
+            continue;
+        }
+        *controladores++ = '\0';
+        *ruta_linea++ = '\0';
+
+        int coincide = controlador ? lista_contiene(controladores, controlador)
+                                   : strcmp(linea, "0") == 0 && *controladores == '\0';
+        if (coincide) {
+            snprintf(ruta, LINEA_MAXIMA, "%s", ruta_linea);
+            resultado = 0;
+        }
+    }
+
+    fclose(archivo);
+    return resultado;
+}
+
+/**
+ * Busca dónde está montada una jerarquía de cgroup y la raíz que expone
+ *
+ * @param controlador Controlador de v1; NULL para la jerarquía v2
+ * @param montaje Buffer para el punto de montaje (de LINEA_MAXIMA bytes)
+ * @param raiz Buffer para la ruta de la jerarquía montada (de LINEA_MAXIMA bytes)
+ * @return 0 si se encontró, -1 si no
+ */
+static int punto_de_montaje(const char* controlador, char* montaje, char* raiz) {
+    FILE* archivo = fopen("/proc/self/mountinfo", "r");
+    if (!archivo) {
+        return -1;
+    }
+
+    // "id padre mayor:menor raíz montaje opciones... - tipo origen superopciones"
+    char linea[LINEA_MAXIMA];
+    int resultado = -1;
+    while (resultado != 0 && fgets(linea, sizeof(linea), archivo)) {
+        char* separador = strstr(linea, " - ");
+        if (!separador) {
+            continue;
+        }
+        char tipo[64];
+        char origen[256];
+        char opciones[1024];
+        if (sscanf(separador + 3, "%63s %255s %1023s", tipo, origen, opciones) != 3) {
+            continue;
+        }
+        int coincide = controlador ? strcmp(tipo, "cgroup") == 0 && lista_contiene(opciones, controlador)
+                                   : strcmp(tipo, "cgroup2") == 0;
+        if (coincide && sscanf(linea, "%*s %*s %*s %4095s %4095s", raiz, montaje) == 2) {
+            resultado = 0;
+        }
+    }
+
+    fclose(archivo);
+    return resultado;
+}
+
+// Lee la primera línea de un archivo de control del cgroup
+static int leer_control(const char* directorio, const char* nombre, char* valor, size_t tamano) {
+    char ruta[LINEA_MAXIMA * 2];
+    snprintf(ruta, sizeof(ruta), "%s/%s", directorio, nombre);
+    FILE* archivo = fopen(ruta, "r");
+    if (!archivo) {
+        return -1;
+    }
+    int resultado = fgets(valor, (int)tamano, archivo) ? 0 : -1;
+    fclose(archivo);
+    return resultado;
+}
+
+// CPUs de la cuota de un nivel de la jerarquía (0 = sin cuota)
+static double leer_cpus(const char* directorio, int version) {
+    char valor[128];
+    if (version == 2) {
+        // cpu.max: "cuota periodo" o "max periodo"
+        char cuota[32];
+        double periodo;
+        if (leer_control(directorio, "cpu.max", valor, sizeof(valor)) != 0 ||
+            sscanf(valor, "%31s %lf", cuota, &periodo) != 2 || strcmp(cuota, "max") == 0 || periodo <= 0.0) {
+            return 0.0;
+        }
+        return strtod(cuota, NULL) / periodo;
+    }
+
+    // v1: cpu.cfs_quota_us vale -1 sin cuota
+    char periodo[128];
+    if (leer_control(directorio, "cpu.cfs_quota_us", valor, sizeof(valor)) != 0 ||
+        leer_control(directorio, "cpu.cfs_period_us", periodo, sizeof(periodo)) != 0) {
+        return 0.0;
+    }
+    double cuota = strtod(valor, NULL);
+    double microsegundos = strtod(periodo, NULL);
+    return cuota > 0.0 && microsegundos > 0.0 ? cuota / microsegundos : 0.0;
+}
+
+// Bytes de memoria de un nivel de la jerarquía (0 = sin límite)
+static size_t leer_memoria(const char* directorio, int version) {
+    char valor[128];
+    if (leer_control(directorio, version == 2 ? "memory.max" : "memory.limit_in_bytes",
+                     valor, sizeof(valor)) != 0 || strncmp(valor, "max", 3) == 0) {
+        return 0;
+    }
+    unsigned long long bytes = strtoull(valor, NULL, 10);
+    if (bytes >= SIN_LIMITE_V1 || bytes > (unsigned long long)(size_t)-1) {
+        return 0;
+    }
+    return (size_t)bytes;
+}
+
+/**
+ * Recorre el cgroup del proceso y sus antecesores quedándose con el límite
+ * más restrictivo: un cgroup hijo no puede usar más que su padre
+ */
+static void recorrer_jerarquia(const char* controlador, int version, int leer) {
+    char montaje[LINEA_MAXIMA];
+    char raiz[LINEA_MAXIMA];
+    char ruta[LINEA_MAXIMA];
+    if (punto_de_montaje(controlador, montaje, raiz) != 0 || ruta_del_proceso(controlador, ruta) != 0) {
+        return;
+    }
+
+    // Si el montaje expone solo una parte de la jerarquía, la ruta es relativa a ella
+    const char* relativa = ruta;
+    size_t largo_raiz = strlen(raiz);
+    if (strcmp(raiz, "/") != 0 && strncmp(ruta, raiz, largo_raiz) == 0) {
+        relativa = ruta + largo_raiz;
+    }
+
+    char directorio[LINEA_MAXIMA * 2];
+    snprintf(directorio, sizeof(directorio), "%s%s", montaje, relativa);
+    size_t largo_montaje = strlen(montaje);
+    for (;;) {
+        if (leer & LEER_CPU) {
+            double cpus = leer_cpus(directorio, version);
+            if (cpus > 0.0 && (limites.cpus == 0.0 || cpus < limites.cpus)) {
+                limites.cpus = cpus;
+                limites.version = version;
+            }
+        }
+        if (leer & LEER_MEMORIA) {
+            size_t memoria = leer_memoria(directorio, version);
+            if (memoria > 0 && (limites.memoria == 0 || memoria < limites.memoria)) {
+                limites.memoria = memoria;
+                limites.version = version;
+            }
+        }
+
+        // Subir al cgroup padre sin salir del punto de montaje
+        char* barra = strrchr(directorio, '/');
+        if (!barra || (size_t)(barra - directorio) < largo_montaje) {
+            break;
+        }
+        *barra = '\0';
+    }
+}
+
+static void leer_limites_cgroup(void) {
+    recorrer_jerarquia(NULL, 2, LEER_CPU | LEER_MEMORIA);
+
+    // En sistemas híbridos los controladores pueden seguir en la jerarquía v1
+    if (limites.cpus == 0.0) {
+        recorrer_jerarquia("cpu", 1, LEER_CPU);
+    }
+    if (limites.memoria == 0) {
+        recorrer_jerarquia("memory", 1, LEER_MEMORIA);
+    }
+}
+
+const LimitesCgroup* obtener_limites_cgroup(void) {
+    pthread_once(&limites_leidos, leer_limites_cgroup);
+    return &limites;
+}
+
+size_t limite_memoria_por_defecto(void) {
+    return obtener_limites_cgroup()->memoria / FRACCION_MEMORIA_CGROUP;
+}
+
+void describir_limites_cgroup(char* destino, size_t tamano) {
+    const LimitesCgroup* cgroup = obtener_limites_cgroup();
+    char cpus[64];
+    char memoria[64];
+    if (cgroup->cpus > 0.0) {
+        snprintf(cpus, sizeof(cpus), "cuota de %.2f CPU", cgroup->cpus);
+    } else {
+        snprintf(cpus, sizeof(cpus), "sin cuota de CPU");
+    }
+    if (cgroup->memoria > 0) {
+        snprintf(memoria, sizeof(memoria), "memoria máxima de %zu bytes", cgroup->memoria);
+    } else {
+        snprintf(memoria, sizeof(memoria), "sin límite de memoria");
+    }
+    snprintf(destino, tamano, "cgroup v%d: %s, %s", cgroup->version, cpus, memoria);
+}
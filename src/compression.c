@@ -1,5 +1,5 @@
 #include "../include/compression.h"
-#include <stdio.h>
+#include "../include/memory_accounting.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -25,61 +25,79 @@
 int comprimir_rle(const char* datos, size_t tamano_original, 
                   char** datos_comprimidos, size_t* tamano_comprimido) {
     if (!datos || !datos_comprimidos || !tamano_comprimido || tamano_original == 0) {
-        fprintf(stderr, "Error: Parámetros inválidos para comprimir_rle\n");
         return -1;
     }
     
     // Buffer temporal para almacenar la compresión
-    char* buffer = malloc(tamano_original * 2 + 1); // Peor caso: cada carácter se duplica
+    char* buffer = asignar_memoria(MEMORIA_COMPRESION, cota_compresion_rle(tamano_original)); // Peor caso: cada carácter se duplica
     if (!buffer) {
-        fprintf(stderr, "Error: No se pudo asignar memoria para la compresión\n");
         return -1;
     }
     
+    size_t pos_buffer = 0;
+    comprimir_rle_en(datos, tamano_original, buffer, &pos_buffer);
+    
+    // Asignar memoria exacta para el resultado
+    *datos_comprimidos = asignar_memoria(MEMORIA_COMPRESION, pos_buffer);
+    if (!*datos_comprimidos) {
+        liberar_asignacion(buffer);
+        return -1;
+    }
+    
+    // Copiar el resultado
+    memcpy(*datos_comprimidos, buffer, pos_buffer);
+    *tamano_comprimido = pos_buffer;
+    
+    liberar_asignacion(buffer);
+    return 0;
+}
+
+int comprimir_rle_en(const char* datos, size_t tamano_original, char* salida, size_t* tamano_comprimido) {
+    if (!datos || !salida || !tamano_comprimido || tamano_original == 0) {
+        return -1;
+    }
+    
+    *tamano_comprimido = comprimir_rle_bloque(datos, tamano_original, -1, salida);
+    return 0;
+}
+
+/**
+ * Comprime un bloque con RLE sobre un buffer ya reservado
+ */
+size_t comprimir_rle_bloque(const char* datos, size_t tamano, int siguiente, char* salida) {
     size_t pos_buffer = 0;
     size_t i = 0;
     
-    while (i < tamano_original) {
+    while (i < tamano) {
         char caracter_actual = datos[i];
         int contador = 1;
         
-        // Contar caracteres consecutivos iguales
-        while (i + contador < tamano_original && datos[i + contador] == caracter_actual) {
+        // Contar caracteres consecutivos iguales (el contador es un solo dígito: máximo 9)
+        while (i + contador < tamano && datos[i + contador] == caracter_actual &&
+               contador < 9) {
             contador++;
         }
         
+        // Un dígito '1'..'9' tras un carácter se interpreta como contador al descomprimir,
+        // así que si el siguiente carácter es un dígito el contador se escribe aunque sea 1
+        size_t pos_siguiente = i + contador;
+        int byte_siguiente = pos_siguiente < tamano ? (unsigned char)datos[pos_siguiente] : siguiente;
+        int siguiente_es_digito = byte_siguiente >= '1' && byte_siguiente <= '9';
+        
         // Escribir el carácter y su contador al buffer
-        if (contador == 1) {
+        if (contador == 1 && !siguiente_es_digito) {
             // Si solo hay un carácter, escribirlo directamente
-            buffer[pos_buffer++] = caracter_actual;
+            salida[pos_buffer++] = caracter_actual;
         } else {
             // Si hay múltiples caracteres, escribir carácter + contador
-            buffer[pos_buffer++] = caracter_actual;
-            buffer[pos_buffer++] = (char)contador;
+            salida[pos_buffer++] = caracter_actual;
+            salida[pos_buffer++] = (char)('0' + contador);
         }
         
         i += contador;
     }
     
-    // Asignar memoria exacta para el resultado
-    *datos_comprimidos = malloc(pos_buffer);
-    if (!*datos_comprimidos) {
-        fprintf(stderr, "Error: No se pudo asignar memoria para el resultado\n");
-        free(buffer);
-        return -1;
-    }
-    
-    // Copiar el resultado
-    memcpy(*datos_comprimidos, buffer, pos_buffer);
-    *tamano_comprimido = pos_buffer;
-    
-    free(buffer);
-    
-    printf("Compresión RLE completada: %zu bytes -> %zu bytes (%.2f%% de reducción)\n", 
-           tamano_original, *tamano_comprimido, 
-           (1.0 - (double)*tamano_comprimido / tamano_original) * 100);
-    
-    return 0;
+    return pos_buffer;
 }
 
 /**
@@ -91,71 +109,268 @@ int comprimir_rle(const char* datos, size_t tamano_original,
 int descomprimir_rle(const char* datos_comprimidos, size_t tamano_comprimido,
                      char** datos_originales, size_t* tamano_original) {
     if (!datos_comprimidos || !datos_originales || !tamano_original || tamano_comprimido == 0) {
-        fprintf(stderr, "Error: Parámetros inválidos para descomprimir_rle\n");
         return -1;
     }
     
     // Buffer temporal para almacenar la descompresión
-    char* buffer = malloc(tamano_comprimido * 10); // Estimación generosa
+    char* buffer = asignar_memoria(MEMORIA_COMPRESION, cota_descompresion_rle(tamano_comprimido));
     if (!buffer) {
-        fprintf(stderr, "Error: No se pudo asignar memoria para la descompresión\n");
         return -1;
     }
     
+    size_t pos_buffer = 0;
+    descomprimir_rle_en(datos_comprimidos, tamano_comprimido, buffer, &pos_buffer);
+    
+    // Asignar memoria exacta para el resultado
+    *datos_originales = asignar_memoria(MEMORIA_COMPRESION, pos_buffer + 1);
+    if (!*datos_originales) {
+        liberar_asignacion(buffer);
+        return -1;
+    }
+    
+    // Copiar el resultado y agregar terminador nulo
+    memcpy(*datos_originales, buffer, pos_buffer);
+    (*datos_originales)[pos_buffer] = '\0';
+    *tamano_original = pos_buffer;
+    
+    liberar_asignacion(buffer);
+    return 0;
+}
+
+int descomprimir_rle_en(const char* datos_comprimidos, size_t tamano_comprimido,
+                        char* salida, size_t* tamano_original) {
+    if (!datos_comprimidos || !salida || !tamano_original || tamano_comprimido == 0) {
+        return -1;
+    }
+    
+    *tamano_original = descomprimir_rle_bloque(datos_comprimidos, tamano_comprimido, salida);
+    return 0;
+}
+
+/**
+ * Descomprime un bloque RLE sobre un buffer ya reservado
+ */
+size_t descomprimir_rle_bloque(const char* datos, size_t tamano, char* salida) {
     size_t pos_buffer = 0;
     size_t i = 0;
     
-    while (i < tamano_comprimido) {
-        char caracter = datos_comprimidos[i++];
+    while (i < tamano) {
+        char caracter = datos[i++];
         
-        if (i < tamano_comprimido) {
-            char siguiente = datos_comprimidos[i];
+        // Si el siguiente carácter es un número (contador), repetir el carácter
+        if (i < tamano && datos[i] >= '1' && datos[i] <= '9') {
+            int contador = datos[i] - '0';
+            i++; // Saltar el contador
             
-            // Si el siguiente carácter es un número (contador)
-            if (siguiente >= '1' && siguiente <= '9') {
-                int contador = siguiente - '0';
-                i++; // Saltar el contador
-                
-                // Repetir el carácter el número de veces indicado
-                for (int j = 0; j < contador; j++) {
-                    buffer[pos_buffer++] = caracter;
-                }
-            } else {
-                // Si no hay contador, solo escribir el carácter una vez
-                buffer[pos_buffer++] = caracter;
+            for (int j = 0; j < contador; j++) {
+                salida[pos_buffer++] = caracter;
             }
         } else {
-            // Último carácter sin contador
-            buffer[pos_buffer++] = caracter;
+            // Si no hay contador, solo escribir el carácter una vez
+            salida[pos_buffer++] = caracter;
         }
     }
     
-    // Asignar memoria exacta para el resultado
-    *datos_originales = malloc(pos_buffer + 1);
-    if (!*datos_originales) {
-        fprintf(stderr, "Error: No se pudo asignar memoria para el resultado\n");
-        free(buffer);
-        return -1;
+    return pos_buffer;
+}
+
+// Cota superior del tamaño comprimido: cada carácter suelto puede llevar su contador
+size_t cota_compresion_rle(size_t tamano) {
+    return tamano * 2 + 1;
+}
+
+/**
+ * Cota superior del tamaño descomprimido de un bloque RLE
+ * 
+ * Cada par [carácter][dígito] de 2 bytes produce como mucho 9 bytes y cada
+ * carácter suelto produce 1, así que la expansión máxima es 4.5 veces.
+ */
+size_t cota_descompresion_rle(size_t tamano) {
+    return tamano / 2 * 9 + tamano % 2 + 1;
+}
+
+void iniciar_flujo_rle(FlujoRle* flujo) {
+    flujo->caracter = -1;
+    flujo->contador = 0;
+}
+
+// Escribe una repetición terminada; siguiente es el byte que la sigue (-1 al final)
+static size_t emitir_repeticion(int caracter, int contador, int siguiente, char* salida) {
+    int siguiente_es_digito = siguiente >= '1' && siguiente <= '9';
+    salida[0] = (char)caracter;
+    if (contador == 1 && !siguiente_es_digito) {
+        return 1;
     }
+    salida[1] = (char)('0' + contador);
+    return 2;
+}
+
+/**
+ * Comprime un trozo de un flujo RLE
+ * 
+ * Una repetición solo se escribe cuando se conoce el byte que la sigue
+ * (que decide si el contador 1 es explícito) o cuando llega a 9, igual que
+ * comprimir_rle_bloque; la última queda pendiente para el trozo siguiente.
+ */
+size_t comprimir_rle_flujo(FlujoRle* flujo, const char* datos, size_t tamano, char* salida) {
+    size_t pos_buffer = 0;
     
-    // Copiar el resultado y agregar terminador nulo
-    memcpy(*datos_originales, buffer, pos_buffer);
-    (*datos_originales)[pos_buffer] = '\0';
-    *tamano_original = pos_buffer;
+    for (size_t i = 0; i < tamano; i++) {
+        int caracter = (unsigned char)datos[i];
+        if (flujo->contador > 0 && caracter == flujo->caracter && flujo->contador < 9) {
+            flujo->contador++;
+            continue;
+        }
+        if (flujo->contador > 0) {
+            pos_buffer += emitir_repeticion(flujo->caracter, flujo->contador, caracter, salida + pos_buffer);
+        }
+        flujo->caracter = caracter;
+        flujo->contador = 1;
+    }
+    
+    return pos_buffer;
+}
+
+size_t finalizar_compresion_rle_flujo(FlujoRle* flujo, char* salida) {
+    size_t escritos = 0;
+    if (flujo->contador > 0) {
+        escritos = emitir_repeticion(flujo->caracter, flujo->contador, -1, salida);
+    }
+    iniciar_flujo_rle(flujo);
+    return escritos;
+}
+
+/**
+ * Descomprime un trozo de un flujo RLE
+ * 
+ * El último carácter de un trozo puede recibir su contador en el trozo
+ * siguiente, así que queda pendiente hasta ver el byte que lo sigue.
+ */
+size_t descomprimir_rle_flujo(FlujoRle* flujo, const char* datos, size_t tamano, char* salida) {
+    size_t pos_buffer = 0;
+    
+    for (size_t i = 0; i < tamano; i++) {
+        int byte = (unsigned char)datos[i];
+        if (flujo->caracter == -1) {
+            flujo->caracter = byte;
+            continue;
+        }
+        
+        // Un dígito tras el carácter pendiente es su contador
+        if (byte >= '1' && byte <= '9') {
+            memset(salida + pos_buffer, flujo->caracter, (size_t)(byte - '0'));
+            pos_buffer += (size_t)(byte - '0');
+            flujo->caracter = -1;
+        } else {
+            salida[pos_buffer++] = (char)flujo->caracter;
+            flujo->caracter = byte;
+        }
+    }
     
-    free(buffer);
+    return pos_buffer;
+}
+
+size_t finalizar_descompresion_rle_flujo(FlujoRle* flujo, char* salida) {
+    size_t escritos = 0;
+    if (flujo->caracter != -1) {
+        salida[0] = (char)flujo->caracter;
+        escritos = 1;
+    }
+    iniciar_flujo_rle(flujo);
+    return escritos;
+}
+
+/**
+ * Reconoce datos en un formato ya comprimido
+ * 
+ * Se comparan las firmas (magic numbers) de los formatos habituales. Para
+ * bzip2 se exige además la firma del primer bloque, de modo que un texto
+ * que empiece por "BZh" no se confunda con un archivo comprimido.
+ */
+int es_formato_comprimido(const char* datos, size_t tamano) {
+    static const struct {
+        const char* firma;
+        size_t longitud;
+    } firmas[] = {
+        { "\x1f\x8b\x08", 3 },                 // gzip (deflate)
+        { "\xfd" "7zXZ\x00", 6 },               // xz
+        { "\x28\xb5\x2f\xfd", 4 },             // zstd
+        { "PK\x03\x04", 4 },                    // zip
+        { "7z\xbc\xaf\x27\x1c", 6 },            // 7z
+    };
+    
+    if (!datos) {
+        return 0;
+    }
+    
+    for (size_t i = 0; i < sizeof(firmas) / sizeof(firmas[0]); i++) {
+        if (tamano >= firmas[i].longitud && memcmp(datos, firmas[i].firma, firmas[i].longitud) == 0) {
+            return 1;
+        }
+    }
     
-    printf("Descompresión RLE completada: %zu bytes -> %zu bytes\n", 
-           tamano_comprimido, *tamano_original);
+    // bzip2: "BZh" + nivel '1'..'9' + firma de bloque (dígitos de pi en BCD)
+    if (tamano >= 10 && memcmp(datos, "BZh", 3) == 0 && datos[3] >= '1' && datos[3] <= '9' &&
+        memcmp(datos + 4, "\x31\x41\x59\x26\x53\x59", 6) == 0) {
+        return 1;
+    }
     
     return 0;
 }
 
+// Etiqueta de cada tipo de contenedor, tras los bytes '\0' "GSEA"
+static const struct {
+    TipoContenedor tipo;
+    const char* etiqueta;
+} ETIQUETAS_CONTENEDOR[] = {
+    { CONTENEDOR_RLE, "RLE" },
+    { CONTENEDOR_DISPERSO, "HUE" },
+    { CONTENEDOR_ALMACENADO, "ALM" },
+};
+
+#define NUM_ETIQUETAS_CONTENEDOR (sizeof(ETIQUETAS_CONTENEDOR) / sizeof(ETIQUETAS_CONTENEDOR[0]))
+
+/**
+ * Identifica el tipo de una salida comprimida por su cabecera
+ * 
+ * Solo el primer byte decide si hay cabecera: una salida que empieza por
+ * '\0' con una etiqueta desconocida o truncada es un error, no RLE simple.
+ */
+TipoContenedor identificar_contenedor(const char* datos, size_t tamano) {
+    if (!datos || tamano == 0 || datos[0] != '\0') {
+        return CONTENEDOR_NINGUNO;
+    }
+    if (tamano < TAMANO_CABECERA_CONTENEDOR || memcmp(datos + 1, "GSEA", 4) != 0) {
+        return CONTENEDOR_DESCONOCIDO;
+    }
+    for (size_t i = 0; i < NUM_ETIQUETAS_CONTENEDOR; i++) {
+        if (memcmp(datos + 5, ETIQUETAS_CONTENEDOR[i].etiqueta, 3) == 0) {
+            return ETIQUETAS_CONTENEDOR[i].tipo;
+        }
+    }
+    return CONTENEDOR_DESCONOCIDO;
+}
+
+void escribir_cabecera_contenedor(TipoContenedor tipo, char* destino) {
+    for (size_t i = 0; i < NUM_ETIQUETAS_CONTENEDOR; i++) {
+        if (ETIQUETAS_CONTENEDOR[i].tipo == tipo) {
+            destino[0] = '\0';
+            memcpy(destino + 1, "GSEA", 4);
+            memcpy(destino + 5, ETIQUETAS_CONTENEDOR[i].etiqueta, 3);
+            return;
+        }
+    }
+}
+
+int requiere_contenedor_rle(const char* datos, size_t tamano) {
+    return datos && tamano > 0 && datos[0] == '\0';
+}
+
 /**
  * Libera la memoria asignada para datos comprimidos o descomprimidos
  */
 void liberar_datos(char* datos) {
     if (datos) {
-        free(datos);
+        liberar_asignacion(datos);
     }
 }
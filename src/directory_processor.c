@@ -1,15 +1,33 @@
+#define _GNU_SOURCE // openat(), fstatat(), mkdirat() y syscall()
 #include "../include/directory_processor.h"
 #include "../include/file_manager.h"
 #include "../include/compression.h"
 #include "../include/encryption.h"
+#include "../include/scheduler.h"
+#include "../include/block_processor.h"
+#include "../include/stream_processor.h"
+#include "../include/memory_budget.h"
+#include "../include/bounded_queue.h"
+#include "../include/cgroup.h"
+#include "../include/numa_topology.h"
+#include "../include/log.h"
+#include "../include/run_stats.h"
+#include "../include/progress.h"
+#include "../include/trace.h"
+#include "../include/perf_counters.h"
+#include "../include/memory_accounting.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <dirent.h>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 #include <errno.h>
 #include <limits.h>
 #include <pthread.h>
+#include <time.h>
 #include <unistd.h>
 
 #ifndef PATH_MAX
@@ -20,62 +38,945 @@
 #define DT_REG 8
 #endif
 
-// Implementación propia de strdup para compatibilidad con C99
-char* mi_strdup_dir(const char* s) {
-    if (!s) return NULL;
-    size_t len = strlen(s) + 1;
-    char* dup = malloc(len);
-    if (dup) {
-        strcpy(dup, s);
+// Tamaño del buffer de entradas de cada llamada a getdents64
+#define TAMANO_BUFFER_DIRECTORIO (256 * 1024)
+
+// Entrada de directorio tal como la devuelve getdents64
+struct entrada_dirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+// Destino del resultado de una transformación: el buffer de salida de la
+// arena o, para resultados grandes, una proyección del propio archivo de salida
+typedef struct {
+    ArenaTrabajador* arena;
+    const char* ruta_salida;
+    SalidaProyectada proyectada;
+    int proyectado;              // 1 si el resultado se construye en la proyección
+} DestinoResultado;
+
+// Archivo procesado por fases (lectura, transformación y escritura) con los
+// buffers de una arena; las fases pueden ejecutarse en hilos distintos
+typedef struct {
+    const char* ruta_entrada;
+    const char* ruta_salida;
+    char operacion;
+    const char* algoritmo_comp;
+    const char* algoritmo_enc;
+    const char* clave;
+    int almacenado;              // Formato ya comprimido copiado sin transformar
+    char* contenido;             // Buffer de entrada de la arena
+    size_t tamano;
+    MapaDisperso mapa;
+    DestinoResultado destino;
+    char* datos_procesados;
+    size_t tamano_procesado;
+} FasesArchivo;
+
+static void iniciar_fases_archivo(FasesArchivo* fases, const char* ruta_entrada, const char* ruta_salida,
+                                  char operacion, const char* algoritmo_comp, const char* algoritmo_enc,
+                                  const char* clave, ArenaTrabajador* arena);
+static int leer_fase_archivo(FasesArchivo* fases);
+static int transformar_fase_archivo(FasesArchivo* fases);
+static int escribir_fase_archivo(FasesArchivo* fases, int resultado);
+
+// Operaciones combinadas y el orden en que se aplican sus pasos
+typedef struct {
+    const char* nombre;
+    char primera;
+    char segunda;
+} OperacionCombinada;
+
+static const OperacionCombinada OPERACIONES_COMBINADAS[] = {
+    { "-ce", 'c', 'e' }, // Comprimir y encriptar
+    { "-de", 'd', 'e' }, // Descomprimir y encriptar
+    { "-ec", 'e', 'c' }, // Encriptar y comprimir
+    { "-du", 'u', 'd' }, // Desencriptar y descomprimir
+};
+
+// Busca una operación combinada por su nombre (-ce, -de, -ec, -du)
+static const OperacionCombinada* buscar_operacion_combinada(const char* nombre) {
+    for (size_t i = 0; i < sizeof(OPERACIONES_COMBINADAS) / sizeof(OPERACIONES_COMBINADAS[0]); i++) {
+        if (strcmp(nombre, OPERACIONES_COMBINADAS[i].nombre) == 0) {
+            return &OPERACIONES_COMBINADAS[i];
+        }
     }
-    return dup;
+    fprintf(stderr, "Error: Operación combinada no soportada: %s\n", nombre);
+    return NULL;
 }
 
-// Estructura para pasar datos a los hilos
+// Nombre de una operación para los mensajes de error
+static const char* nombre_operacion(char operacion) {
+    switch (operacion) {
+        case 'c': return "compresión";
+        case 'd': return "descompresión";
+        case 'e': return "encriptación";
+        default:  return "desencriptación";
+    }
+}
+
+// Indica si un paso guarda o extrae sin transformar unos datos que empiezan
+// por la cabecera dada, como hace leer_fase_archivo con los archivos
+static int paso_sin_transformar(const FasesArchivo* fases, const char* cabecera, size_t tamano) {
+    if ((fases->operacion != 'c' && fases->operacion != 'd') || !fases->algoritmo_comp ||
+        strcmp(fases->algoritmo_comp, "rle") != 0) {
+        return 0;
+    }
+    return fases->operacion == 'c' ? es_formato_comprimido(cabecera, tamano)
+                                   : identificar_contenedor(cabecera, tamano) == CONTENEDOR_ALMACENADO;
+}
+
+// Guarda en memoria datos densos sin transformar: al comprimir los envuelve
+// en un contenedor almacenado y al descomprimir extrae los del contenedor
+static int almacenar_en_memoria(FasesArchivo* fases, char* datos, size_t tamano) {
+    if (fases->operacion == 'c') {
+        char* salida = obtener_buffer_arena(fases->destino.arena, BUFFER_SALIDA,
+                                            TAMANO_CABECERA_ALMACENADA + tamano);
+        if (!salida) {
+            fprintf(stderr, "Error: No se pudo asignar memoria para el archivo almacenado\n");
+            return -1;
+        }
+        serializar_cabecera_almacenada(TAMANO_CABECERA_ALMACENADA, salida);
+        memcpy(salida + TAMANO_CABECERA_ALMACENADA, datos, tamano);
+        fases->datos_procesados = salida;
+        fases->tamano_procesado = TAMANO_CABECERA_ALMACENADA + tamano;
+        LOG_INFO("Archivo ya comprimido, almacenado sin transformar: %s", fases->ruta_entrada);
+        return 0;
+    }
+    
+    off_t desplazamiento = 0;
+    if (deserializar_cabecera_almacenada(datos, tamano, &desplazamiento) != 1 || (size_t)desplazamiento > tamano) {
+        fprintf(stderr, "Error: '%s' no es un archivo almacenado válido\n", fases->ruta_entrada);
+        return -1;
+    }
+    fases->datos_procesados = datos + desplazamiento;
+    fases->tamano_procesado = tamano - (size_t)desplazamiento;
+    LOG_INFO("Archivo almacenado, extraído sin transformar: %s", fases->ruta_entrada);
+    return 0;
+}
+
+// Rellena con ceros los huecos del contenido de un paso, en el buffer de
+// entrada de su arena, para los pasos que leen la entrada completa
+static int rellenar_huecos(FasesArchivo* fases) {
+    if (!fases->mapa.tiene_huecos) {
+        return 0;
+    }
+    size_t tamano = fases->mapa.tamano_logico;
+    char* denso = obtener_buffer_arena(fases->destino.arena, BUFFER_ENTRADA, tamano + 1);
+    if (!denso) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para el resultado intermedio\n");
+        return -1;
+    }
+    memset(denso, 0, tamano);
+    size_t posicion = 0;
+    for (size_t i = 0; i < fases->mapa.num_extensiones; i++) {
+        const ExtensionDatos* ext = &fases->mapa.extensiones[i];
+        memcpy(denso + ext->desplazamiento, fases->contenido + posicion, ext->longitud);
+        posicion += ext->longitud;
+    }
+    fases->contenido = denso;
+    fases->tamano = tamano;
+    liberar_mapa_disperso(&fases->mapa);
+    return 0;
+}
+
+// Primer paso por separado: lee la entrada y deja el resultado intermedio en
+// la arena del paso (sin ruta de salida, así que nunca se proyecta)
+static int primer_paso(FasesArchivo* fases) {
+    char cabecera[TAMANO_FIRMA_COMPRIMIDO];
+    ssize_t leidos = leer_cabecera_archivo(fases->ruta_entrada, cabecera, sizeof(cabecera));
+    if (leidos == -1) {
+        return -1;
+    }
+    if (paso_sin_transformar(fases, cabecera, (size_t)leidos)) {
+        if (leer_archivo_en_arena(fases->ruta_entrada, fases->destino.arena, &fases->contenido, &fases->tamano) != 0) {
+            return -1;
+        }
+        return almacenar_en_memoria(fases, fases->contenido, fases->tamano);
+    }
+    if (leer_fase_archivo(fases) != 0) {
+        return -1;
+    }
+    return transformar_fase_archivo(fases);
+}
+
+// Segundo paso por separado: transforma el resultado intermedio, con su mapa
+// de huecos, y escribe la salida
+static int segundo_paso(FasesArchivo* primero, FasesArchivo* fases) {
+    fases->contenido = primero->datos_procesados;
+    fases->tamano = primero->tamano_procesado;
+    fases->mapa = primero->mapa;
+    memset(&primero->mapa, 0, sizeof(primero->mapa));
+    
+    // La descompresión lee el contenedor completo; un hueco al principio se lee como ceros
+    if (fases->operacion == 'd' && rellenar_huecos(fases) != 0) {
+        return escribir_fase_archivo(fases, -1);
+    }
+    size_t cabecera = fases->tamano;
+    if (fases->mapa.tiene_huecos) {
+        const ExtensionDatos* primera = fases->mapa.num_extensiones ? &fases->mapa.extensiones[0] : NULL;
+        cabecera = primera && primera->desplazamiento == 0 ? primera->longitud : 0;
+    }
+    
+    int resultado;
+    if (paso_sin_transformar(fases, fases->contenido, cabecera)) {
+        resultado = rellenar_huecos(fases) == 0 ? almacenar_en_memoria(fases, fases->contenido, fases->tamano) : -1;
+    } else {
+        resultado = transformar_fase_archivo(fases);
+    }
+    return escribir_fase_archivo(fases, resultado);
+}
+
+// Aplica los dos pasos por separado dejando el resultado intermedio en
+// memoria: se usa con las entradas que necesitan el camino en memoria
+// (archivos dispersos, formatos ya comprimidos, contenedores)
+static int procesar_combinada_por_pasos(const char* ruta_entrada, const char* ruta_salida,
+                                        const OperacionCombinada* combinada,
+                                        const char* algoritmo_comp, const char* algoritmo_enc,
+                                        const char* clave) {
+    ArenaTrabajador arenas[2];
+    iniciar_arena_trabajador(&arenas[0], 0);
+    iniciar_arena_trabajador(&arenas[1], 0);
+    
+    FasesArchivo primero, segundo;
+    iniciar_fases_archivo(&primero, ruta_entrada, NULL, combinada->primera, algoritmo_comp,
+                          algoritmo_enc, clave, &arenas[0]);
+    iniciar_fases_archivo(&segundo, ruta_entrada, ruta_salida, combinada->segunda, algoritmo_comp,
+                          algoritmo_enc, clave, &arenas[1]);
+    
+    int resultado = 0;
+    if (primer_paso(&primero) != 0) {
+        fprintf(stderr, "Error en %s\n", nombre_operacion(combinada->primera));
+        liberar_mapa_disperso(&primero.mapa);
+        resultado = -1;
+    } else if (segundo_paso(&primero, &segundo) != 0) {
+        fprintf(stderr, "Error en %s\n", nombre_operacion(combinada->segunda));
+        resultado = -1;
+    }
+    
+    liberar_arena_trabajador(&arenas[0]);
+    liberar_arena_trabajador(&arenas[1]);
+    return resultado;
+}
+
+// Estado compartido por todas las tareas de un procesamiento de directorio
 typedef struct {
-    char ruta_entrada[PATH_MAX];
-    char ruta_salida[PATH_MAX];
+    Planificador* planificador;
+    const OpcionesConcurrencia* opciones;
+    const char* ruta_entrada;   // Raíz de entrada
+    const char* ruta_salida;    // Raíz de salida
+    int fd_entrada;             // Descriptor de la raíz de entrada (base de openat)
+    int fd_salida;              // Descriptor de la raíz de salida (base de mkdirat)
+    dev_t dispositivo_salida;   // Identidad de la raíz de salida, para no recorrerla
+    ino_t inodo_salida;
     char operacion;
+    const OperacionCombinada* combinada;          // Operación combinada por archivo (NULL si no hay)
+    const EspecificacionPipeline* pipeline;       // Pipeline por archivo (NULL si no hay)
     const char* algoritmo_comp;
     const char* algoritmo_enc;
     const char* clave;
-    int resultado;
+    ArenaTrabajador* arenas;    // Buffers reutilizables, uno por trabajador
+    PresupuestoMemoria* presupuesto; // Memoria para archivos en curso (NULL = sin límite)
+    size_t cuota_arena;         // Memoria que cada arena puede conservar entre archivos
+    int num_arenas;
+    
+    // Etapas de lectura, cálculo y escritura (cola_calculo NULL = sin etapas)
+    ColaAcotada* cola_calculo;  // Archivos leídos que esperan su transformación
+    ColaAcotada* cola_escritura; // Archivos transformados que esperan su escritura
+    ColaAcotada* arenas_libres; // Arenas sin archivo en curso: acotan los archivos en vuelo
+    pthread_t* hilos_etapas;    // Hilos de cálculo seguidos de los de escritura
+    int hilos_calculo;
+    int hilos_escritura;
+    double ocupado_lectura;     // Segundos leyendo, sumados entre hilos
+    double ocupado_calculo;     // Segundos transformando, sumados entre hilos
+    double ocupado_escritura;   // Segundos escribiendo, sumados entre hilos
+    Progreso* progreso;         // Informe de progreso (NULL = sin informe)
+    
+    pthread_mutex_t mutex;      // Protege los contadores y la arena de rutas
+    ArenaRutas rutas;           // Rutas relativas de archivos y directorios descubiertos
+    size_t archivos_encontrados;
+    size_t bytes_procesados;    // Bytes de entrada de los archivos procesados con éxito
+    size_t archivos_en_flujo;   // Archivos procesados por trozos por no caber en el presupuesto
+    size_t directorios;
+    size_t archivos_procesados;
+    size_t errores;
+} ContextoDirectorio;
+
+// Estructura para pasar datos a los hilos
+typedef struct {
+    RefRuta ruta;       // Ruta relativa a las raíces, guardada en la arena del contexto
+    size_t tamano;      // Tamaño del archivo, usado como costo para ordenar
+    double inicio;      // Instante en que un trabajador empezó el archivo (estadísticas)
+    ContextoDirectorio* contexto;
 } DatosHilo;
 
-// Función que ejecuta cada hilo
-void* procesar_archivo_hilo(void* arg) {
-    DatosHilo* datos = (DatosHilo*)arg;
+// Tarea de recorrido de un subdirectorio
+typedef struct {
+    ContextoDirectorio* contexto;
+    RefRuta ruta;       // Relativa a las raíces de entrada y salida ("" para la raíz)
+} TareaDirectorio;
+
+// Obtiene el umbral de división en bloques de unas opciones
+static size_t umbral_bloques(const OpcionesConcurrencia* opciones) {
+    return opciones && opciones->umbral_bloques ? opciones->umbral_bloques : UMBRAL_BLOQUES_POR_DEFECTO;
+}
+
+// Obtiene el tamaño nominal de bloque de unas opciones
+static size_t tamano_bloque(const OpcionesConcurrencia* opciones) {
+    return opciones && opciones->tamano_bloque ? opciones->tamano_bloque : TAMANO_BLOQUE_POR_DEFECTO;
+}
+
+// Suma uno a un contador del contexto
+static void incrementar_contador(ContextoDirectorio* contexto, size_t* contador) {
+    pthread_mutex_lock(&contexto->mutex);
+    (*contador)++;
+    pthread_mutex_unlock(&contexto->mutex);
+}
+
+// Copia a destino la ruta relativa de la arena, antepuesta de una raíz si se indica
+static int componer_ruta(ContextoDirectorio* contexto, const char* raiz, RefRuta ref,
+                         char* destino, size_t capacidad) {
+    pthread_mutex_lock(&contexto->mutex);
+    const char* relativa = obtener_ruta_arena(&contexto->rutas, ref);
+    int largo = raiz ? snprintf(destino, capacidad, "%s%s%s", raiz, ref.longitud ? "/" : "", relativa)
+                     : snprintf(destino, capacidad, "%s", relativa);
+    pthread_mutex_unlock(&contexto->mutex);
+    
+    if (largo < 0 || (size_t)largo >= capacidad) {
+        fprintf(stderr, "Error: Ruta demasiado larga bajo '%s'\n", raiz ? raiz : contexto->ruta_entrada);
+        return -1;
+    }
+    return 0;
+}
+
+// Registra el resultado de un archivo y libera sus datos; id_trabajador es el
+// trabajador que procesó el archivo entero (-1 si no fue uno solo)
+static void registrar_resultado(DatosHilo* datos, int id_trabajador, const char* ruta_entrada, int resultado) {
+    ContextoDirectorio* contexto = datos->contexto;
+    LOG_INFO("Archivo completado: %s (resultado: %d)", ruta_entrada, resultado);
+    avanzar_progreso(contexto->progreso, datos->tamano);
+    if (resultado == 0) {
+        sumar_bytes_trabajador(contexto->planificador, id_trabajador, datos->tamano);
+        registrar_medida(MEDIDA_ARCHIVO, datos->inicio, datos->tamano);
+    }
+    pthread_mutex_lock(&contexto->mutex);
+    if (resultado == 0) {
+        contexto->archivos_procesados++;
+        contexto->bytes_procesados += datos->tamano;
+    } else {
+        contexto->errores++;
+    }
+    pthread_mutex_unlock(&contexto->mutex);
+    liberar_asignacion(datos);
+}
+
+// Recibe el resultado de un archivo de directorio procesado por bloques
+static void fin_archivo_hilo_bloques(void* contexto, int resultado) {
+    DatosHilo* datos = (DatosHilo*)contexto;
+    char ruta_entrada[PATH_MAX];
+    if (componer_ruta(datos->contexto, datos->contexto->ruta_entrada, datos->ruta,
+                      ruta_entrada, sizeof(ruta_entrada)) != 0) {
+        ruta_entrada[0] = '\0';
+    }
+    registrar_resultado(datos, -1, ruta_entrada, resultado);
+}
+
+// Libera los buffers de una arena que superan su cuota al terminar un archivo
+static void ajustar_arena(const ContextoDirectorio* contexto, ArenaTrabajador* arena) {
+    if (contexto->presupuesto && memoria_arena_trabajador(arena) > contexto->cuota_arena) {
+        liberar_arena_trabajador(arena);
+    }
+}
+
+// Recibe el resultado de un archivo individual procesado por bloques
+static void fin_archivo_bloques(void* contexto, int resultado) {
+    *(int*)contexto = resultado;
+}
+
+// Procesa por trozos un archivo que no cabe en el presupuesto; devuelve 1 si
+// el archivo no puede procesarse en flujo
+static int procesar_en_flujo_con_presupuesto(ContextoDirectorio* contexto, const char* ruta_entrada,
+                                             const char* ruta_salida) {
+    size_t trozo = trozo_para_limite(contexto->operacion, obtener_limite_memoria(contexto->presupuesto));
+    size_t reservado = reservar_memoria(contexto->presupuesto, memoria_por_archivo(contexto->operacion, trozo));
+    int resultado = procesar_archivo_en_flujo(ruta_entrada, ruta_salida, contexto->operacion,
+                                              contexto->algoritmo_comp, contexto->algoritmo_enc,
+                                              contexto->clave, trozo);
+    liberar_memoria(contexto->presupuesto, reservado);
+    if (resultado == 0) {
+        incrementar_contador(contexto, &contexto->archivos_en_flujo);
+    }
+    return resultado;
+}
+
+/**
+ * Procesa un archivo de directorio dentro del presupuesto de memoria
+ * 
+ * El archivo reserva su memoria en el peor caso antes de leerse; si no
+ * cabe, el trabajador espera sin retener nada a que otros terminen. Los
+ * archivos que no caben en el presupuesto se procesan por trozos, y al
+ * terminar la arena solo conserva sus buffers si no superan su cuota.
+ */
+static int procesar_con_presupuesto(ContextoDirectorio* contexto, ArenaTrabajador* arena,
+                                    const char* ruta_entrada, const char* ruta_salida, size_t tamano) {
+    size_t necesario = memoria_por_archivo(contexto->operacion, tamano);
+    int resultado = 1;
     
-    printf("Hilo procesando: %s\n", datos->ruta_entrada);
+    if (necesario > obtener_limite_memoria(contexto->presupuesto)) {
+        resultado = procesar_en_flujo_con_presupuesto(contexto, ruta_entrada, ruta_salida);
+    }
     
-    // Procesar el archivo individual
-    datos->resultado = procesar_archivo_individual(
-        datos->ruta_entrada, 
-        datos->ruta_salida,
-        datos->operacion,
-        datos->algoritmo_comp,
-        datos->algoritmo_enc,
-        datos->clave
-    );
+    // Lo que no se puede procesar en flujo ocupa todo el presupuesto mientras dura
+    if (resultado == 1) {
+        size_t reservado = reservar_memoria(contexto->presupuesto, necesario);
+        resultado = procesar_archivo_con_arena(ruta_entrada, ruta_salida, contexto->operacion,
+                                               contexto->algoritmo_comp, contexto->algoritmo_enc,
+                                               contexto->clave, arena);
+        ajustar_arena(contexto, arena);
+        liberar_memoria(contexto->presupuesto, reservado);
+    }
     
-    printf("Hilo completado: %s (resultado: %d)\n", datos->ruta_entrada, datos->resultado);
+    return resultado;
+}
+
+// Tamaño de un resultado intermedio en el peor caso
+static size_t cota_intermedia(char operacion, size_t tamano) {
+    switch (operacion) {
+        case 'c': return cota_compresion_rle(tamano);
+        case 'd': return cota_descompresion_rle(tamano);
+        default:  return tamano;
+    }
+}
+
+// Aplica una operación combinada a un archivo dentro del presupuesto de memoria
+static int procesar_combinada_con_presupuesto(ContextoDirectorio* contexto, const char* ruta_entrada,
+                                              const char* ruta_salida, size_t tamano) {
+    const OperacionCombinada* combinada = contexto->combinada;
+    char operacion_rle = strchr("cd", combinada->primera) ? combinada->primera : combinada->segunda;
+    size_t trozo = trozo_para_limite(operacion_rle, obtener_limite_memoria(contexto->presupuesto));
+    
+    size_t reservado = reservar_memoria(contexto->presupuesto, memoria_por_archivo(operacion_rle, trozo));
+    int resultado = procesar_combinada_en_flujo(ruta_entrada, ruta_salida, combinada->primera,
+                                                combinada->segunda, contexto->algoritmo_comp,
+                                                contexto->algoritmo_enc, contexto->clave, trozo);
+    liberar_memoria(contexto->presupuesto, reservado);
+    
+    // Por pasos conviven el resultado intermedio y el paso que más memoria usa
+    if (resultado == 1) {
+        size_t intermedio = cota_intermedia(combinada->primera, tamano);
+        size_t primera = memoria_por_archivo(combinada->primera, tamano);
+        size_t segunda = memoria_por_archivo(combinada->segunda, intermedio);
+        reservado = reservar_memoria(contexto->presupuesto, intermedio + (primera > segunda ? primera : segunda));
+        resultado = procesar_combinada_por_pasos(ruta_entrada, ruta_salida, combinada, contexto->algoritmo_comp,
+                                                 contexto->algoritmo_enc, contexto->clave);
+        liberar_memoria(contexto->presupuesto, reservado);
+    }
+    return resultado;
+}
+
+// Aplica el pipeline a un archivo con trozos que quepan en el presupuesto
+static int procesar_pipeline_con_presupuesto(ContextoDirectorio* contexto, const char* ruta_entrada,
+                                             const char* ruta_salida) {
+    size_t limite = obtener_limite_memoria(contexto->presupuesto);
+    size_t trozo = TAMANO_TROZO_FLUJO;
+    while (trozo > TAMANO_TROZO_MINIMO && memoria_pipeline(contexto->pipeline, trozo) > limite) {
+        trozo /= 2;
+    }
+    
+    size_t reservado = reservar_memoria(contexto->presupuesto, memoria_pipeline(contexto->pipeline, trozo));
+    int resultado = procesar_archivo_pipeline(ruta_entrada, ruta_salida, contexto->pipeline,
+                                              contexto->clave, trozo, 0);
+    liberar_memoria(contexto->presupuesto, reservado);
+    return resultado;
+}
+
+/**
+ * Procesa un archivo de directorio con una operación combinada o un pipeline
+ * 
+ * Cada archivo se procesa por trozos en el hilo trabajador, encadenando las
+ * etapas en memoria: el paralelismo viene de procesar varios archivos a la
+ * vez, así que no se dividen en bloques ni se crean hilos por etapa.
+ */
+static int procesar_archivo_encadenado(ContextoDirectorio* contexto, const char* ruta_entrada,
+                                       const char* ruta_salida, size_t tamano) {
+    if (contexto->pipeline) {
+        if (contexto->presupuesto) {
+            return procesar_pipeline_con_presupuesto(contexto, ruta_entrada, ruta_salida);
+        }
+        return procesar_archivo_pipeline(ruta_entrada, ruta_salida, contexto->pipeline,
+                                         contexto->clave, TAMANO_TROZO_FLUJO, 0);
+    }
+    
+    if (contexto->presupuesto) {
+        return procesar_combinada_con_presupuesto(contexto, ruta_entrada, ruta_salida, tamano);
+    }
+    const OperacionCombinada* combinada = contexto->combinada;
+    int resultado = procesar_combinada_en_flujo(ruta_entrada, ruta_salida, combinada->primera,
+                                                combinada->segunda, contexto->algoritmo_comp,
+                                                contexto->algoritmo_enc, contexto->clave, TAMANO_TROZO_FLUJO);
+    if (resultado == 1) {
+        resultado = procesar_combinada_por_pasos(ruta_entrada, ruta_salida, combinada, contexto->algoritmo_comp,
+                                                 contexto->algoritmo_enc, contexto->clave);
+    }
+    return resultado;
+}
+
+// Archivo que atraviesa las etapas de lectura, cálculo y escritura
+typedef struct {
+    DatosHilo* datos;
+    char ruta_entrada[PATH_MAX];
+    char ruta_salida[PATH_MAX];
+    size_t reservado;           // Memoria del presupuesto retenida hasta escribirlo
+    int resultado;
+    FasesArchivo fases;
+} ArchivoEtapas;
+
+static double segundos_monotonicos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Devuelve la arena y la memoria de un archivo y registra su resultado
+static void terminar_archivo_etapas(ContextoDirectorio* contexto, ArchivoEtapas* archivo) {
+    ArenaTrabajador* arena = archivo->fases.destino.arena;
+    ajustar_arena(contexto, arena);
+    encolar_acotada(contexto->arenas_libres, arena);
+    if (contexto->presupuesto) {
+        liberar_memoria(contexto->presupuesto, archivo->reservado);
+    }
+    registrar_resultado(archivo->datos, -1, archivo->ruta_entrada, archivo->resultado);
+    liberar_asignacion(archivo);
+}
+
+/**
+ * Etapa de lectura: la ejecutan los trabajadores del planificador
+ * 
+ * Reserva la memoria del archivo, toma una arena libre (espera si todas
+ * tienen un archivo en vuelo), lee el archivo y lo pasa a la cola de
+ * cálculo, que también espera si los hilos de cálculo van por detrás.
+ */
+static void leer_archivo_etapas(ContextoDirectorio* contexto, DatosHilo* datos,
+                                const char* ruta_entrada, const char* ruta_salida) {
+    size_t reservado = 0;
+    if (contexto->presupuesto) {
+        // Lo que no cabe en el presupuesto se procesa por trozos en el propio lector
+        size_t necesario = memoria_por_archivo(contexto->operacion, datos->tamano);
+        if (necesario > obtener_limite_memoria(contexto->presupuesto)) {
+            int resultado = procesar_en_flujo_con_presupuesto(contexto, ruta_entrada, ruta_salida);
+            if (resultado != 1) {
+                registrar_resultado(datos, -1, ruta_entrada, resultado);
+                return;
+            }
+        }
+        reservado = reservar_memoria(contexto->presupuesto, necesario);
+    }
+    
+    ArchivoEtapas* archivo = asignar_memoria(MEMORIA_DIRECTORIOS, sizeof(ArchivoEtapas));
+    if (!archivo) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para %s\n", ruta_entrada);
+        if (contexto->presupuesto) {
+            liberar_memoria(contexto->presupuesto, reservado);
+        }
+        registrar_resultado(datos, -1, ruta_entrada, -1);
+        return;
+    }
+    archivo->datos = datos;
+    archivo->reservado = reservado;
+    snprintf(archivo->ruta_entrada, sizeof(archivo->ruta_entrada), "%s", ruta_entrada);
+    snprintf(archivo->ruta_salida, sizeof(archivo->ruta_salida), "%s", ruta_salida);
+    
+    void* arena;
+    desencolar_acotada(contexto->arenas_libres, &arena); // La cola no se cierra mientras hay lectores
+    iniciar_fases_archivo(&archivo->fases, archivo->ruta_entrada, archivo->ruta_salida, contexto->operacion,
+                          contexto->algoritmo_comp, contexto->algoritmo_enc, contexto->clave, arena);
+    
+    double inicio = segundos_monotonicos();
+    archivo->resultado = leer_fase_archivo(&archivo->fases);
+    double ocupado = segundos_monotonicos() - inicio;
+    pthread_mutex_lock(&contexto->mutex);
+    contexto->ocupado_lectura += ocupado;
+    pthread_mutex_unlock(&contexto->mutex);
+    if (archivo->resultado != 0 || archivo->fases.almacenado) {
+        terminar_archivo_etapas(contexto, archivo); // No queda nada que transformar ni escribir
+        return;
+    }
+    encolar_acotada(contexto->cola_calculo, archivo);
+}
+
+// Hilo de la etapa de cálculo: transforma los archivos leídos
+static void* hilo_calculo(void* arg) {
+    ContextoDirectorio* contexto = arg;
+    double ocupado = 0.0;
+    void* elemento;
+    
+    while (desencolar_acotada(contexto->cola_calculo, &elemento) == 0) {
+        ArchivoEtapas* archivo = elemento;
+        etiquetar_traza(archivo->ruta_entrada);
+        double inicio = segundos_monotonicos();
+        archivo->resultado = transformar_fase_archivo(&archivo->fases);
+        ocupado += segundos_monotonicos() - inicio;
+        encolar_acotada(contexto->cola_escritura, archivo);
+    }
+    
+    pthread_mutex_lock(&contexto->mutex);
+    contexto->ocupado_calculo += ocupado;
+    pthread_mutex_unlock(&contexto->mutex);
+    return NULL;
+}
+
+// Hilo de la etapa de escritura: escribe los resultados y libera sus arenas
+static void* hilo_escritura(void* arg) {
+    ContextoDirectorio* contexto = arg;
+    double ocupado = 0.0;
+    void* elemento;
+    
+    while (desencolar_acotada(contexto->cola_escritura, &elemento) == 0) {
+        ArchivoEtapas* archivo = elemento;
+        etiquetar_traza(archivo->ruta_entrada);
+        double inicio = segundos_monotonicos();
+        archivo->resultado = escribir_fase_archivo(&archivo->fases, archivo->resultado);
+        ocupado += segundos_monotonicos() - inicio;
+        terminar_archivo_etapas(contexto, archivo);
+    }
+    
+    pthread_mutex_lock(&contexto->mutex);
+    contexto->ocupado_escritura += ocupado;
+    pthread_mutex_unlock(&contexto->mutex);
     return NULL;
 }
 
 /**
- * Procesa un directorio completo aplicando la operación especificada CON CONCURRENCIA
+ * Arranca las etapas de cálculo y escritura
+ * 
+ * Cada cola entre etapas admite un archivo por hilo consumidor y hay una
+ * arena por cada archivo que puede estar en vuelo (en un lector, en una
+ * cola o en un hilo), así que la memoria retenida no depende del número
+ * de archivos del directorio.
  * 
- * Esta función utiliza pthreads para procesar múltiples archivos en paralelo,
- * mejorando el rendimiento en sistemas multinúcleo.
+ * @return 0 si es exitoso, -1 si hay error
  */
-int procesar_directorio(const char* ruta_directorio, const char* ruta_salida,
-                        char operacion, const char* algoritmo_comp, 
-                        const char* algoritmo_enc, const char* clave) {
-    if (!ruta_directorio || !ruta_salida) {
-        fprintf(stderr, "Error: Parámetros inválidos para procesar_directorio\n");
+static int iniciar_etapas(ContextoDirectorio* contexto) {
+    int total = contexto->hilos_calculo + contexto->hilos_escritura;
+    contexto->cola_calculo = crear_cola_acotada((size_t)contexto->hilos_calculo);
+    contexto->cola_escritura = crear_cola_acotada((size_t)contexto->hilos_escritura);
+    contexto->arenas_libres = crear_cola_acotada((size_t)contexto->num_arenas);
+    contexto->hilos_etapas = asignar_memoria(MEMORIA_DIRECTORIOS, (size_t)total * sizeof(pthread_t));
+    if (!contexto->cola_calculo || !contexto->cola_escritura || !contexto->arenas_libres || !contexto->hilos_etapas) {
+        fprintf(stderr, "Error: No se pudieron crear las colas entre etapas\n");
+        destruir_cola_acotada(contexto->cola_calculo, NULL);
+        destruir_cola_acotada(contexto->cola_escritura, NULL);
+        destruir_cola_acotada(contexto->arenas_libres, NULL);
+        liberar_asignacion(contexto->hilos_etapas);
+        contexto->cola_calculo = NULL;
         return -1;
     }
+    for (int i = 0; i < contexto->num_arenas; i++) {
+        encolar_acotada(contexto->arenas_libres, &contexto->arenas[i]);
+    }
+    
+    int creados = 0;
+    for (; creados < total; creados++) {
+        void* (*funcion)(void*) = creados < contexto->hilos_calculo ? hilo_calculo : hilo_escritura;
+        if (pthread_create(&contexto->hilos_etapas[creados], NULL, funcion, contexto) != 0) {
+            break;
+        }
+        sumar_memoria(MEMORIA_PILAS, tamano_pila_hilos());
+    }
+    if (creados < total) {
+        fprintf(stderr, "Error: No se pudieron crear los hilos de las etapas\n");
+        cerrar_cola_acotada(contexto->cola_calculo);
+        cerrar_cola_acotada(contexto->cola_escritura);
+        for (int i = 0; i < creados; i++) {
+            pthread_join(contexto->hilos_etapas[i], NULL);
+            restar_memoria(MEMORIA_PILAS, tamano_pila_hilos());
+        }
+        destruir_cola_acotada(contexto->cola_calculo, NULL);
+        destruir_cola_acotada(contexto->cola_escritura, NULL);
+        destruir_cola_acotada(contexto->arenas_libres, NULL);
+        liberar_asignacion(contexto->hilos_etapas);
+        contexto->cola_calculo = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+// Vacía las etapas en orden una vez que terminaron los lectores
+static void terminar_etapas(ContextoDirectorio* contexto) {
+    cerrar_cola_acotada(contexto->cola_calculo);
+    for (int i = 0; i < contexto->hilos_calculo; i++) {
+        pthread_join(contexto->hilos_etapas[i], NULL);
+        restar_memoria(MEMORIA_PILAS, tamano_pila_hilos());
+    }
+    cerrar_cola_acotada(contexto->cola_escritura);
+    for (int i = contexto->hilos_calculo; i < contexto->hilos_calculo + contexto->hilos_escritura; i++) {
+        pthread_join(contexto->hilos_etapas[i], NULL);
+        restar_memoria(MEMORIA_PILAS, tamano_pila_hilos());
+    }
+    destruir_cola_acotada(contexto->cola_calculo, NULL);
+    destruir_cola_acotada(contexto->cola_escritura, NULL);
+    destruir_cola_acotada(contexto->arenas_libres, NULL);
+    liberar_asignacion(contexto->hilos_etapas);
+}
+
+// Tarea que ejecuta un hilo trabajador del pool por cada archivo
+static void procesar_archivo_hilo(void* arg, int id_trabajador) {
+    DatosHilo* datos = (DatosHilo*)arg;
+    ContextoDirectorio* contexto = datos->contexto;
+    datos->inicio = iniciar_medida();
+    
+    // Las rutas completas solo existen mientras se procesa el archivo
+    char ruta_entrada[PATH_MAX];
+    char ruta_salida[PATH_MAX];
+    if (componer_ruta(contexto, contexto->ruta_entrada, datos->ruta, ruta_entrada, sizeof(ruta_entrada)) != 0 ||
+        componer_ruta(contexto, contexto->ruta_salida, datos->ruta, ruta_salida, sizeof(ruta_salida)) != 0) {
+        registrar_resultado(datos, id_trabajador, "", -1);
+        return;
+    }
+    
+    LOG_DETALLE("Hilo %d procesando: %s", id_trabajador, ruta_entrada);
+    etiquetar_traza(ruta_entrada);
+    
+    if (contexto->combinada || contexto->pipeline) {
+        int resultado = procesar_archivo_encadenado(contexto, ruta_entrada, ruta_salida, datos->tamano);
+        registrar_resultado(datos, id_trabajador, ruta_entrada, resultado);
+        return;
+    }
+    
+    // Con etapas, el trabajador solo lee: transformar y escribir son de otros hilos
+    if (contexto->cola_calculo) {
+        leer_archivo_etapas(contexto, datos, ruta_entrada, ruta_salida);
+        return;
+    }
+    
+    // Los archivos grandes se dividen en bloques que comparten el pool con el resto;
+    // con límite de memoria cada bloque reserva su parte del presupuesto
+    if (datos->tamano >= umbral_bloques(contexto->opciones)) {
+        int division = procesar_archivo_en_bloques(contexto->planificador, id_trabajador,
+                                                   ruta_entrada, ruta_salida,
+                                                   contexto->operacion, contexto->algoritmo_comp,
+                                                   contexto->algoritmo_enc, contexto->clave,
+                                                   umbral_bloques(contexto->opciones),
+                                                   tamano_bloque(contexto->opciones),
+                                                   contexto->presupuesto, fin_archivo_hilo_bloques, datos);
+        if (division == 0) {
+            return; // El último bloque informa el resultado
+        }
+        if (division == -1) {
+            registrar_resultado(datos, id_trabajador, ruta_entrada, -1);
+            return;
+        }
+    }
+    
+    // Con límite de memoria cada archivo se admite según lo que necesita
+    if (contexto->presupuesto) {
+        int resultado = procesar_con_presupuesto(contexto, &contexto->arenas[id_trabajador],
+                                                 ruta_entrada, ruta_salida, datos->tamano);
+        registrar_resultado(datos, id_trabajador, ruta_entrada, resultado);
+        return;
+    }
+    
+    // Procesar el archivo con los buffers reutilizables del trabajador
+    int resultado = procesar_archivo_con_arena(
+        ruta_entrada, 
+        ruta_salida,
+        contexto->operacion,
+        contexto->algoritmo_comp,
+        contexto->algoritmo_enc,
+        contexto->clave,
+        &contexto->arenas[id_trabajador]
+    );
+    
+    registrar_resultado(datos, id_trabajador, ruta_entrada, resultado);
+}
+
+// Guarda en la arena la ruta relativa de una entrada descubierta
+static int guardar_ruta(ContextoDirectorio* contexto, const char* relativa, const char* nombre, RefRuta* ref) {
+    pthread_mutex_lock(&contexto->mutex);
+    int resultado = agregar_ruta_arena(&contexto->rutas, relativa, nombre, ref);
+    pthread_mutex_unlock(&contexto->mutex);
+    
+    if (resultado != 0) {
+        fprintf(stderr, "Error: No se pudo registrar '%s/%s'\n", relativa, nombre);
+        incrementar_contador(contexto, &contexto->errores);
+    }
+    return resultado;
+}
+
+static void explorar_directorio_hilo(void* arg, int id_trabajador);
+
+// Crea el subdirectorio espejo en la salida y encola su recorrido
+static void encolar_subdirectorio(ContextoDirectorio* contexto, const char* relativa,
+                                  const char* nombre, int id_trabajador) {
+    TareaDirectorio* tarea = asignar_memoria(MEMORIA_DIRECTORIOS, sizeof(TareaDirectorio));
+    if (!tarea) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para recorrer '%s/%s'\n", relativa, nombre);
+        incrementar_contador(contexto, &contexto->errores);
+        return;
+    }
+    if (guardar_ruta(contexto, relativa, nombre, &tarea->ruta) != 0) {
+        liberar_asignacion(tarea);
+        return;
+    }
+    tarea->contexto = contexto;
+    
+    // El espejo se crea antes de encolar: los archivos del subdirectorio ya tienen destino
+    char ruta_hija[PATH_MAX];
+    if (componer_ruta(contexto, NULL, tarea->ruta, ruta_hija, sizeof(ruta_hija)) != 0 ||
+        (mkdirat(contexto->fd_salida, ruta_hija, 0755) == -1 && errno != EEXIST)) {
+        fprintf(stderr, "Error: No se pudo crear el directorio '%s/%s/%s': %s\n",
+                contexto->ruta_salida, relativa, nombre, strerror(errno));
+        liberar_asignacion(tarea);
+        incrementar_contador(contexto, &contexto->errores);
+        return;
+    }
+    
+    // Los recorridos van por delante de los archivos para descubrir trabajo cuanto antes
+    anotar_directorio_progreso(contexto->progreso, 1);
+    if (enviar_tarea(contexto->planificador, id_trabajador, explorar_directorio_hilo, tarea,
+                     (size_t)-1) != 0) {
+        explorar_directorio_hilo(tarea, id_trabajador);
+    }
+}
+
+// Prepara la tarea de un archivo regular descubierto y la encola
+static void encolar_archivo(ContextoDirectorio* contexto, const char* relativa,
+                            const char* nombre, size_t tamano, int id_trabajador) {
+    incrementar_contador(contexto, &contexto->archivos_encontrados);
+    
+    DatosHilo* datos = asignar_memoria(MEMORIA_DIRECTORIOS, sizeof(DatosHilo));
+    if (!datos) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para '%s/%s'\n", relativa, nombre);
+        incrementar_contador(contexto, &contexto->errores);
+        return;
+    }
+    if (guardar_ruta(contexto, relativa, nombre, &datos->ruta) != 0) {
+        liberar_asignacion(datos);
+        return;
+    }
+    
+    datos->tamano = tamano;
+    datos->contexto = contexto;
+    
+    anotar_archivo_progreso(contexto->progreso, tamano);
+    if (enviar_tarea(contexto->planificador, id_trabajador, procesar_archivo_hilo, datos, tamano) != 0) {
+        fprintf(stderr, "Error: No se pudo encolar %s/%s\n", relativa, nombre);
+        avanzar_progreso(contexto->progreso, tamano);
+        liberar_asignacion(datos);
+        incrementar_contador(contexto, &contexto->errores);
+    }
+}
+
+/**
+ * Tarea que recorre un directorio y encola lo que encuentra
+ * 
+ * Abre el directorio con openat() relativo a la raíz y lee sus entradas con
+ * getdents64 en un buffer grande. Cada archivo regular se encola en cuanto se
+ * descubre, sin esperar a terminar el recorrido, y cada subdirectorio se
+ * recorre como una tarea más del pool, así que el árbol se explora en
+ * paralelo. fstatat() da el tamaño de cada archivo (costo para el orden LPT)
+ * y el tipo de las entradas con d_type == DT_UNKNOWN.
+ */
+static void explorar_directorio_hilo(void* arg, int id_trabajador) {
+    TareaDirectorio* tarea = (TareaDirectorio*)arg;
+    ContextoDirectorio* contexto = tarea->contexto;
+    
+    incrementar_contador(contexto, &contexto->directorios);
+    
+    char relativa[PATH_MAX];
+    int fd = -1;
+    if (componer_ruta(contexto, NULL, tarea->ruta, relativa, sizeof(relativa)) == 0) {
+        fd = openat(contexto->fd_entrada, relativa[0] ? relativa : ".",
+                    O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    } else {
+        relativa[0] = '\0';
+        errno = ENAMETOOLONG;
+    }
+    char* buffer = asignar_memoria(MEMORIA_DIRECTORIOS, TAMANO_BUFFER_DIRECTORIO);
+    if (fd == -1 || !buffer) {
+        fprintf(stderr, "Error: No se pudo abrir el directorio '%s/%s': %s\n",
+                contexto->ruta_entrada, relativa, fd == -1 ? strerror(errno) : "sin memoria");
+        incrementar_contador(contexto, &contexto->errores);
+        if (fd != -1) close(fd);
+        liberar_asignacion(buffer);
+        liberar_asignacion(tarea);
+        anotar_directorio_progreso(contexto->progreso, -1);
+        return;
+    }
     
+    for (;;) {
+        long leidos = syscall(SYS_getdents64, fd, buffer, TAMANO_BUFFER_DIRECTORIO);
+        if (leidos == -1) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "Error: No se pudo leer el directorio '%s/%s': %s\n",
+                    contexto->ruta_entrada, relativa, strerror(errno));
+            incrementar_contador(contexto, &contexto->errores);
+            break;
+        }
+        if (leidos == 0) {
+            break;
+        }
+        
+        for (long pos = 0; pos < leidos;) {
+            struct entrada_dirent64* entrada = (struct entrada_dirent64*)(buffer + pos);
+            pos += entrada->d_reclen;
+            
+            // Saltar entradas especiales
+            if (strcmp(entrada->d_name, ".") == 0 || strcmp(entrada->d_name, "..") == 0) {
+                continue;
+            }
+            
+            // Solo interesan archivos regulares y directorios (los enlaces no se siguen)
+            if (entrada->d_type != DT_REG && entrada->d_type != DT_DIR &&
+                entrada->d_type != DT_UNKNOWN) {
+                continue;
+            }
+            
+            struct stat st;
+            if (fstatat(fd, entrada->d_name, &st, AT_SYMLINK_NOFOLLOW) == -1) {
+                fprintf(stderr, "Error: No se pudo obtener información de '%s/%s': %s\n",
+                        relativa, entrada->d_name, strerror(errno));
+                incrementar_contador(contexto, &contexto->errores);
+                continue;
+            }
+            
+            if (S_ISREG(st.st_mode)) {
+                encolar_archivo(contexto, relativa, entrada->d_name, (size_t)st.st_size, id_trabajador);
+            } else if (S_ISDIR(st.st_mode)) {
+                // No recorrer la salida si está dentro de la entrada
+                if (st.st_dev == contexto->dispositivo_salida && st.st_ino == contexto->inodo_salida) {
+                    continue;
+                }
+                encolar_subdirectorio(contexto, relativa, entrada->d_name, id_trabajador);
+            }
+        }
+    }
+    
+    close(fd);
+    liberar_asignacion(buffer);
+    liberar_asignacion(tarea);
+    anotar_directorio_progreso(contexto->progreso, -1);
+}
+
+/**
+ * Procesa un directorio completo aplicando la operación especificada CON CONCURRENCIA
+ * 
+ * Esta función recorre el árbol de directorios de forma recursiva y en
+ * paralelo dentro de un pool fijo de hilos trabajadores, replicando los
+ * subdirectorios en la salida. Los archivos se encolan a medida que se
+ * descubren, sin una pasada previa de conteo; cada trabajador tiene su
+ * propia cola ordenada por tamaño (los más grandes primero, salvo que se
+ * pida el orden de lectura) y los que quedan ociosos roban tareas de la cola
+ * más cargada. Los archivos que superan el umbral se dividen en bloques que
+ * se reparten en el mismo pool; con una operación combinada o un pipeline
+ * cada archivo se procesa por trozos en su trabajador.
+ */
+static int ejecutar_directorio(const ContextoDirectorio* plantilla, const char* ruta_directorio,
+                               const char* ruta_salida, const OpcionesConcurrencia* opciones) {
     // Verificar que el directorio de entrada existe
     if (!es_directorio(ruta_directorio)) {
         fprintf(stderr, "Error: '%s' no es un directorio válido\n", ruta_directorio);
@@ -88,233 +989,359 @@ int procesar_directorio(const char* ruta_directorio, const char* ruta_salida,
         return -1;
     }
     
-    // Abrir directorio de entrada
-    DIR* dir = opendir(ruta_directorio);
-    if (!dir) {
+    ContextoDirectorio contexto = *plantilla;
+    contexto.opciones = opciones;
+    contexto.ruta_entrada = ruta_directorio;
+    contexto.ruta_salida = ruta_salida;
+    
+    // Abrir las raíces: todo el recorrido es relativo a estos descriptores
+    struct stat st_salida;
+    contexto.fd_entrada = open(ruta_directorio, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    contexto.fd_salida = open(ruta_salida, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (contexto.fd_entrada == -1 || contexto.fd_salida == -1 || fstat(contexto.fd_salida, &st_salida) == -1) {
         fprintf(stderr, "Error: No se pudo abrir el directorio '%s': %s\n", 
-                ruta_directorio, strerror(errno));
+                contexto.fd_entrada == -1 ? ruta_directorio : ruta_salida, strerror(errno));
+        if (contexto.fd_entrada != -1) close(contexto.fd_entrada);
+        if (contexto.fd_salida != -1) close(contexto.fd_salida);
         return -1;
     }
+    contexto.dispositivo_salida = st_salida.st_dev;
+    contexto.inodo_salida = st_salida.st_ino;
     
-    // Contar archivos para crear hilos
-    struct dirent* entrada;
-    int num_archivos = 0;
+    // Con etapas los trabajadores del planificador son los lectores; los hilos
+    // pedidos con -t pasan a la etapa de cálculo. Las operaciones combinadas y
+    // los pipelines ya encadenan lectura, cálculo y escritura por trozos
+    int num_hilos = opciones ? opciones->num_hilos : 0;
+    int con_etapas = opciones && (opciones->hilos_lectura > 0 || opciones->hilos_escritura > 0) &&
+                     !contexto.combinada && !contexto.pipeline;
+    int hilos_planificador = num_hilos;
+    if (con_etapas) {
+        hilos_planificador = opciones->hilos_lectura > 0 ? opciones->hilos_lectura : HILOS_ETAPA_ES_POR_DEFECTO;
+        contexto.hilos_calculo = num_hilos > 0 ? num_hilos : obtener_num_nucleos();
+        contexto.hilos_escritura = opciones->hilos_escritura > 0 ? opciones->hilos_escritura
+                                                                 : HILOS_ETAPA_ES_POR_DEFECTO;
+    }
     
-    // Primera pasada: contar archivos
-    while ((entrada = readdir(dir)) != NULL) {
-        if (strcmp(entrada->d_name, ".") != 0 && strcmp(entrada->d_name, "..") != 0 &&
-            entrada->d_type == DT_REG) {
-            num_archivos++;
-        }
+    int orden_fifo = opciones ? opciones->orden_fifo : 0;
+    contexto.planificador = crear_planificador(hilos_planificador, orden_fifo ? ORDEN_FIFO : ORDEN_LPT);
+    int nodos_fijados = 0;
+    if (contexto.planificador && opciones && opciones->fijar_nodos) {
+        nodos_fijados = fijar_trabajadores_por_nodo(contexto.planificador);
+    }
+    iniciar_arena_rutas(&contexto.rutas);
+    int num_arenas = contexto.planificador ? obtener_num_trabajadores(contexto.planificador) : 0;
+    if (con_etapas) {
+        // Una arena por archivo en vuelo: en un lector, en una cola o en un hilo de cálculo o escritura
+        num_arenas += 2 * (contexto.hilos_calculo + contexto.hilos_escritura);
+    }
+    contexto.num_arenas = num_arenas;
+    contexto.arenas = asignar_memoria(MEMORIA_DIRECTORIOS, (size_t)(num_arenas > 0 ? num_arenas : 1) * sizeof(ArenaTrabajador));
+    TareaDirectorio* raiz = asignar_memoria(MEMORIA_DIRECTORIOS, sizeof(TareaDirectorio));
+    if (!contexto.planificador || nodos_fijados < 0 || !contexto.arenas || !raiz ||
+        agregar_ruta_arena(&contexto.rutas, NULL, "", &raiz->ruta) != 0) {
+        fprintf(stderr, "Error: No se pudo preparar el procesamiento del directorio\n");
+        destruir_planificador(contexto.planificador);
+        liberar_arena_rutas(&contexto.rutas);
+        liberar_asignacion(contexto.arenas);
+        liberar_asignacion(raiz);
+        close(contexto.fd_entrada);
+        close(contexto.fd_salida);
+        return -1;
+    }
+    for (int i = 0; i < num_arenas; i++) {
+        iniciar_arena_trabajador(&contexto.arenas[i], opciones ? opciones->paginas_enormes : 0);
     }
     
-    if (num_archivos == 0) {
-        printf("No se encontraron archivos para procesar\n");
-        closedir(dir);
-        return 0;
+    // Una parte del límite es para los buffers que las arenas conservan entre
+    // archivos y el resto para los archivos en curso
+    size_t limite_memoria = opciones ? opciones->limite_memoria : 0;
+    if (limite_memoria > 0) {
+        contexto.cuota_arena = limite_memoria / FRACCION_MEMORIA_ARENAS / (size_t)num_arenas;
+        contexto.presupuesto = crear_presupuesto_memoria(limite_memoria - contexto.cuota_arena * (size_t)num_arenas);
+        if (!contexto.presupuesto) {
+            fprintf(stderr, "Error: No se pudo crear el presupuesto de memoria\n");
+            destruir_planificador(contexto.planificador);
+            liberar_arena_rutas(&contexto.rutas);
+            liberar_asignacion(contexto.arenas);
+            liberar_asignacion(raiz);
+            close(contexto.fd_entrada);
+            close(contexto.fd_salida);
+            return -1;
+        }
+    }
+    pthread_mutex_init(&contexto.mutex, NULL);
+    if (con_etapas && iniciar_etapas(&contexto) != 0) {
+        pthread_mutex_destroy(&contexto.mutex);
+        destruir_presupuesto_memoria(contexto.presupuesto);
+        destruir_planificador(contexto.planificador);
+        liberar_arena_rutas(&contexto.rutas);
+        liberar_asignacion(contexto.arenas);
+        liberar_asignacion(raiz);
+        close(contexto.fd_entrada);
+        close(contexto.fd_salida);
+        return -1;
     }
     
-    printf("Procesando directorio con CONCURRENCIA: %s\n", ruta_directorio);
-    printf("Archivos encontrados: %d\n", num_archivos);
-    printf("Usando hilos para procesamiento paralelo\n");
+    LOG_RESUMEN("Procesando directorio con CONCURRENCIA: %s", ruta_directorio);
+    LOG_RESUMEN("Usando %d hilos trabajadores (orden: %s)", obtener_num_trabajadores(contexto.planificador),
+                orden_fifo ? "lectura del directorio" : "más grandes primero");
+    if (nodos_fijados > 0) {
+        LOG_RESUMEN("Trabajadores fijados a %d nodos NUMA (buffers en la memoria local de cada nodo)", nodos_fijados);
+    }
+    if (con_etapas) {
+        LOG_RESUMEN("Etapas: %d lectores, %d hilos de cálculo, %d escritores",
+                    obtener_num_trabajadores(contexto.planificador), contexto.hilos_calculo, contexto.hilos_escritura);
+    }
+    if (contexto.presupuesto) {
+        LOG_RESUMEN("Límite de memoria: %zu bytes (%zu para archivos en curso, %zu por arena)",
+                    limite_memoria, obtener_limite_memoria(contexto.presupuesto), contexto.cuota_arena);
+    }
     
-    // Crear arrays para hilos y datos
-    pthread_t* hilos = malloc(num_archivos * sizeof(pthread_t));
-    DatosHilo* datos_hilos = malloc(num_archivos * sizeof(DatosHilo));
+    // El recorrido de la raíz descubre y encola el resto del árbol
+    contexto.progreso = iniciar_progreso(opciones ? opciones->progreso : PROGRESO_DESACTIVADO);
+    anotar_directorio_progreso(contexto.progreso, 1);
+    raiz->contexto = &contexto;
+    if (enviar_tarea(contexto.planificador, -1, explorar_directorio_hilo, raiz, (size_t)-1) != 0) {
+        explorar_directorio_hilo(raiz, -1);
+    }
     
-    if (!hilos || !datos_hilos) {
-        fprintf(stderr, "Error: No se pudo asignar memoria para hilos\n");
-        closedir(dir);
-        free(hilos);
-        free(datos_hilos);
-        return -1;
+    // Esperar a que terminen todas las tareas
+    LOG_DETALLE("Esperando a que terminen todos los hilos...");
+    esperar_planificador(contexto.planificador);
+    if (con_etapas) {
+        terminar_etapas(&contexto);
     }
+    terminar_progreso(contexto.progreso);
     
-    // Segunda pasada: crear hilos para cada archivo
-    rewinddir(dir);
-    int indice = 0;
+    EstadisticasPlanificador estadisticas;
+    obtener_estadisticas_planificador(contexto.planificador, &estadisticas);
+    EstadisticasNodo nodos[MAX_NODOS_NUMA];
+    int num_nodos = obtener_estadisticas_nodos(contexto.planificador, nodos, MAX_NODOS_NUMA);
+    int hilos_usados = obtener_num_trabajadores(contexto.planificador);
+    destruir_planificador(contexto.planificador);
+    size_t memoria_rutas = memoria_arena_rutas(&contexto.rutas);
+    liberar_arena_rutas(&contexto.rutas);
     
-    while ((entrada = readdir(dir)) != NULL) {
-        if (strcmp(entrada->d_name, ".") != 0 && strcmp(entrada->d_name, "..") != 0 &&
-            entrada->d_type == DT_REG) {
-            
-            // Configurar datos del hilo
-            snprintf(datos_hilos[indice].ruta_entrada, sizeof(datos_hilos[indice].ruta_entrada),
-                    "%s/%s", ruta_directorio, entrada->d_name);
-            snprintf(datos_hilos[indice].ruta_salida, sizeof(datos_hilos[indice].ruta_salida),
-                    "%s/%s", ruta_salida, entrada->d_name);
-            datos_hilos[indice].operacion = operacion;
-            datos_hilos[indice].algoritmo_comp = algoritmo_comp;
-            datos_hilos[indice].algoritmo_enc = algoritmo_enc;
-            datos_hilos[indice].clave = clave;
-            datos_hilos[indice].resultado = -1;
-            
-            // Crear hilo
-            if (pthread_create(&hilos[indice], NULL, procesar_archivo_hilo, &datos_hilos[indice]) != 0) {
-                fprintf(stderr, "Error: No se pudo crear hilo para %s\n", entrada->d_name);
-                datos_hilos[indice].resultado = -1;
-            }
-            
-            indice++;
-        }
+    // Los trabajadores ya terminaron: se pueden leer y liberar sus arenas
+    size_t reservas_buffers = 0;
+    size_t reutilizaciones_buffers = 0;
+    size_t memoria_buffers = 0;
+    for (int i = 0; i < num_arenas; i++) {
+        reservas_buffers += contexto.arenas[i].reservas;
+        reutilizaciones_buffers += contexto.arenas[i].reutilizaciones;
+        memoria_buffers += memoria_arena_trabajador(&contexto.arenas[i]);
+        liberar_arena_trabajador(&contexto.arenas[i]);
     }
+    liberar_asignacion(contexto.arenas);
     
-    closedir(dir);
+    EstadisticasPresupuesto uso_memoria;
+    memset(&uso_memoria, 0, sizeof(uso_memoria));
+    if (contexto.presupuesto) {
+        obtener_estadisticas_presupuesto(contexto.presupuesto, &uso_memoria);
+        destruir_presupuesto_memoria(contexto.presupuesto);
+    }
+    pthread_mutex_destroy(&contexto.mutex);
+    close(contexto.fd_entrada);
+    close(contexto.fd_salida);
     
-    // Esperar a que todos los hilos terminen
-    printf("Esperando a que terminen todos los hilos...\n");
-    int archivos_procesados = 0;
-    int errores = 0;
+    if (contexto.archivos_encontrados == 0 && contexto.errores == 0) {
+        LOG_RESUMEN("No se encontraron archivos para procesar");
+        return 0;
+    }
     
-    for (int i = 0; i < num_archivos; i++) {
-        pthread_join(hilos[i], NULL);
-        
-        if (datos_hilos[i].resultado == 0) {
-            archivos_procesados++;
-        } else {
-            errores++;
-        }
+    LOG_RESUMEN("\nResumen del procesamiento CONCURRENTE:");
+    LOG_RESUMEN("- Directorios recorridos: %zu", contexto.directorios);
+    LOG_RESUMEN("- Archivos encontrados: %zu", contexto.archivos_encontrados);
+    LOG_RESUMEN("- Memoria de rutas: %zu KiB", memoria_rutas / 1024);
+    LOG_RESUMEN("- Archivos procesados: %zu", contexto.archivos_procesados);
+    LOG_RESUMEN("- Errores: %zu", contexto.errores);
+    LOG_RESUMEN("- Hilos utilizados: %d", hilos_usados);
+    if (obtener_limites_cgroup()->version > 0) {
+        char limites[256];
+        describir_limites_cgroup(limites, sizeof(limites));
+        LOG_RESUMEN("- Límites del %s", limites);
+    }
+    LOG_RESUMEN("- Tareas robadas entre hilos: %zu", estadisticas.tareas_robadas);
+    LOG_RESUMEN("- Buffers: %zu reservas, %zu reutilizaciones, %zu KiB retenidos al final",
+                reservas_buffers, reutilizaciones_buffers, memoria_buffers / 1024);
+    if (uso_memoria.limite > 0) {
+        LOG_RESUMEN("- Memoria de archivos en curso: pico %zu de %zu bytes, %zu esperas, %zu archivos en flujo",
+                    uso_memoria.pico, uso_memoria.limite, uso_memoria.esperas, contexto.archivos_en_flujo);
+    }
+    if (con_etapas) {
+        LOG_RESUMEN("- Ocupación media por hilo: lectura %.3f s, cálculo %.3f s, escritura %.3f s",
+                    contexto.ocupado_lectura / hilos_usados, contexto.ocupado_calculo / contexto.hilos_calculo,
+                    contexto.ocupado_escritura / contexto.hilos_escritura);
+    }
+    LOG_RESUMEN("- Tiempo total: %.3f s", estadisticas.tiempo_total);
+    if (estadisticas.tiempo_total > 0.0) {
+        LOG_RESUMEN("- Rendimiento: %.2f MB/s",
+                    (double)contexto.bytes_procesados / (1024.0 * 1024.0) / estadisticas.tiempo_total);
+    }
+    for (int i = 0; i < num_nodos && estadisticas.tiempo_total > 0.0; i++) {
+        double megabytes = (double)nodos[i].bytes / (1024.0 * 1024.0);
+        LOG_RESUMEN("- Nodo NUMA %d: %d hilos, %.2f MB, %.2f MB/s (%.2f MB/s por segundo ocupado)",
+                    nodos[i].nodo, nodos[i].trabajadores, megabytes, megabytes / estadisticas.tiempo_total,
+                    nodos[i].tiempo_ocupado > 0.0 ? megabytes / nodos[i].tiempo_ocupado : 0.0);
+    }
+    if (estadisticas.tiempo_ocupado_medio > 0.0) {
+        LOG_RESUMEN("- Desequilibrio de carga (máximo/medio ocupado): %.2f",
+                    estadisticas.tiempo_ocupado_max / estadisticas.tiempo_ocupado_medio);
     }
     
-    // Liberar memoria
-    free(hilos);
-    free(datos_hilos);
+    if (contexto.errores > 0) {
+        LOG_RESUMEN("Advertencia: Se encontraron %zu errores durante el procesamiento", contexto.errores);
+        return -1;
+    }
     
-    printf("\nResumen del procesamiento CONCURRENTE:\n");
-    printf("- Archivos procesados: %d\n", archivos_procesados);
-    printf("- Errores: %d\n", errores);
-    printf("- Hilos utilizados: %d\n", num_archivos);
+    return 0;
+}
+
+// Contexto de directorio con la configuración de los algoritmos
+static ContextoDirectorio contexto_directorio(const char* algoritmo_comp, const char* algoritmo_enc,
+                                              const char* clave) {
+    ContextoDirectorio contexto;
+    memset(&contexto, 0, sizeof(contexto));
+    contexto.algoritmo_comp = algoritmo_comp;
+    contexto.algoritmo_enc = algoritmo_enc;
+    contexto.clave = clave;
+    return contexto;
+}
+
+int procesar_directorio(const char* ruta_directorio, const char* ruta_salida,
+                        char operacion, const char* algoritmo_comp, 
+                        const char* algoritmo_enc, const char* clave,
+                        const OpcionesConcurrencia* opciones) {
+    if (!ruta_directorio || !ruta_salida) {
+        fprintf(stderr, "Error: Parámetros inválidos para procesar_directorio\n");
+        return -1;
+    }
     
-    if (errores > 0) {
-        printf("Advertencia: Se encontraron %d errores durante el procesamiento\n", errores);
+    ContextoDirectorio contexto = contexto_directorio(algoritmo_comp, algoritmo_enc, clave);
+    contexto.operacion = operacion;
+    return ejecutar_directorio(&contexto, ruta_directorio, ruta_salida, opciones);
+}
+
+int procesar_directorio_combinado(const char* ruta_directorio, const char* ruta_salida,
+                                  const char* operaciones, const char* algoritmo_comp,
+                                  const char* algoritmo_enc, const char* clave,
+                                  const OpcionesConcurrencia* opciones) {
+    if (!ruta_directorio || !ruta_salida || !operaciones) {
+        fprintf(stderr, "Error: Parámetros inválidos para procesar_directorio_combinado\n");
         return -1;
     }
     
-    return 0;
+    ContextoDirectorio contexto = contexto_directorio(algoritmo_comp, algoritmo_enc, clave);
+    contexto.combinada = buscar_operacion_combinada(operaciones);
+    if (!contexto.combinada) {
+        return -1;
+    }
+    return ejecutar_directorio(&contexto, ruta_directorio, ruta_salida, opciones);
 }
 
-// Implementar operaciones combinadas
-int procesar_operacion_combinada(const char* ruta_entrada, const char* ruta_salida,
-                                 const char* operaciones, const char* algoritmo_comp,
-                                 const char* algoritmo_enc, const char* clave) {
-    if (!ruta_entrada || !ruta_salida || !operaciones) {
-        fprintf(stderr, "Error: Parámetros inválidos para operación combinada\n");
+int procesar_directorio_pipeline(const char* ruta_directorio, const char* ruta_salida,
+                                 const EspecificacionPipeline* especificacion, const char* clave,
+                                 const OpcionesConcurrencia* opciones) {
+    if (!ruta_directorio || !ruta_salida || !especificacion) {
+        fprintf(stderr, "Error: Parámetros inválidos para procesar_directorio_pipeline\n");
         return -1;
     }
     
-    printf("Procesando operación combinada: %s\n", operaciones);
+    ContextoDirectorio contexto = contexto_directorio(NULL, NULL, clave);
+    contexto.pipeline = especificacion;
+    return ejecutar_directorio(&contexto, ruta_directorio, ruta_salida, opciones);
+}
+
+/**
+ * Procesa un archivo individual usando todos los núcleos si es grande
+ */
+int procesar_archivo_concurrente(const char* ruta_entrada, const char* ruta_salida,
+                                 char operacion, const char* algoritmo_comp,
+                                 const char* algoritmo_enc, const char* clave,
+                                 const OpcionesConcurrencia* opciones) {
+    ssize_t tamano = obtener_tamano_archivo(ruta_entrada);
+    size_t limite_memoria = opciones ? opciones->limite_memoria : 0;
     
-    // -ce: comprimir y encriptar
-    if (strcmp(operaciones, "-ce") == 0) {
-        char ruta_intermedia[PATH_MAX];
-        snprintf(ruta_intermedia, sizeof(ruta_intermedia), "%s.temp", ruta_salida);
-        
-        // Paso 1: Comprimir
-        printf("Paso 1: Comprimiendo archivo...\n");
-        if (procesar_archivo_individual(ruta_entrada, ruta_intermedia, 'c', 
-                                      algoritmo_comp, NULL, NULL) != 0) {
-            fprintf(stderr, "Error en compresión\n");
+    // Con límite de memoria los bloques en vuelo no lo superan
+    if (tamano > 0 && (size_t)tamano >= umbral_bloques(opciones)) {
+        Planificador* planificador = crear_planificador(opciones ? opciones->num_hilos : 0, ORDEN_LPT);
+        if (planificador && opciones && opciones->fijar_nodos && fijar_trabajadores_por_nodo(planificador) < 0) {
+            destruir_planificador(planificador);
             return -1;
         }
-        
-        // Paso 2: Encriptar
-        printf("Paso 2: Encriptando archivo comprimido...\n");
-        if (procesar_archivo_individual(ruta_intermedia, ruta_salida, 'e',
-                                      NULL, algoritmo_enc, clave) != 0) {
-            fprintf(stderr, "Error en encriptación\n");
-            unlink(ruta_intermedia); // Limpiar archivo temporal
-            return -1;
+        PresupuestoMemoria* presupuesto = limite_memoria > 0 ? crear_presupuesto_memoria(limite_memoria) : NULL;
+        if (planificador && (limite_memoria == 0 || presupuesto)) {
+            int resultado = -1;
+            int division = procesar_archivo_en_bloques(planificador, -1, ruta_entrada, ruta_salida,
+                                                       operacion, algoritmo_comp, algoritmo_enc, clave,
+                                                       umbral_bloques(opciones), tamano_bloque(opciones),
+                                                       presupuesto, fin_archivo_bloques, &resultado);
+            if (division == 0) {
+                esperar_planificador(planificador);
+            }
+            destruir_planificador(planificador);
+            destruir_presupuesto_memoria(presupuesto);
+            
+            if (division == 0) {
+                return resultado;
+            }
+            if (division == -1) {
+                return -1;
+            }
+        } else {
+            destruir_planificador(planificador);
+            destruir_presupuesto_memoria(presupuesto);
         }
-        
-        // Limpiar archivo temporal
-        unlink(ruta_intermedia);
-        printf("Operación -ce completada exitosamente\n");
-        return 0;
     }
     
-    // -de: descomprimir y encriptar
-    if (strcmp(operaciones, "-de") == 0) {
-        char ruta_intermedia[PATH_MAX];
-        snprintf(ruta_intermedia, sizeof(ruta_intermedia), "%s.temp", ruta_salida);
-        
-        // Paso 1: Descomprimir
-        printf("Paso 1: Descomprimiendo archivo...\n");
-        if (procesar_archivo_individual(ruta_entrada, ruta_intermedia, 'd',
-                                      algoritmo_comp, NULL, NULL) != 0) {
-            fprintf(stderr, "Error en descompresión\n");
-            return -1;
-        }
-        
-        // Paso 2: Encriptar
-        printf("Paso 2: Encriptando archivo descomprimido...\n");
-        if (procesar_archivo_individual(ruta_intermedia, ruta_salida, 'e',
-                                      NULL, algoritmo_enc, clave) != 0) {
-            fprintf(stderr, "Error en encriptación\n");
-            unlink(ruta_intermedia);
-            return -1;
+    // Con límite de memoria, un archivo que no cabe entero se procesa por trozos
+    if (tamano > 0 && limite_memoria > 0 && memoria_por_archivo(operacion, (size_t)tamano) > limite_memoria) {
+        int flujo = procesar_archivo_en_flujo(ruta_entrada, ruta_salida, operacion, algoritmo_comp,
+                                              algoritmo_enc, clave, trozo_para_limite(operacion, limite_memoria));
+        if (flujo != 1) {
+            return flujo;
         }
-        
-        unlink(ruta_intermedia);
-        printf("Operación -de completada exitosamente\n");
-        return 0;
     }
     
-    // -ec: encriptar y comprimir
-    if (strcmp(operaciones, "-ec") == 0) {
-        char ruta_intermedia[PATH_MAX];
-        snprintf(ruta_intermedia, sizeof(ruta_intermedia), "%s.temp", ruta_salida);
-        
-        // Paso 1: Encriptar
-        printf("Paso 1: Encriptando archivo...\n");
-        if (procesar_archivo_individual(ruta_entrada, ruta_intermedia, 'e',
-                                      NULL, algoritmo_enc, clave) != 0) {
-            fprintf(stderr, "Error en encriptación\n");
-            return -1;
-        }
-        
-        // Paso 2: Comprimir
-        printf("Paso 2: Comprimiendo archivo encriptado...\n");
-        if (procesar_archivo_individual(ruta_intermedia, ruta_salida, 'c',
-                                      algoritmo_comp, NULL, NULL) != 0) {
-            fprintf(stderr, "Error en compresión\n");
-            unlink(ruta_intermedia);
-            return -1;
-        }
-        
-        unlink(ruta_intermedia);
-        printf("Operación -ec completada exitosamente\n");
-        return 0;
+    return procesar_archivo_individual(ruta_entrada, ruta_salida, operacion,
+                                       algoritmo_comp, algoritmo_enc, clave);
+}
+
+/**
+ * Procesa una operación combinada en una sola pasada
+ * 
+ * Cada trozo de la entrada pasa por los dos pasos encadenados en memoria,
+ * así que la entrada se lee una vez y la salida se escribe una vez, sin
+ * archivo temporal ni sincronización intermedia.
+ */
+int procesar_operacion_combinada(const char* ruta_entrada, const char* ruta_salida,
+                                 const char* operaciones, const char* algoritmo_comp,
+                                 const char* algoritmo_enc, const char* clave) {
+    if (!ruta_entrada || !ruta_salida || !operaciones) {
+        fprintf(stderr, "Error: Parámetros inválidos para operación combinada\n");
+        return -1;
     }
     
-    // -du: desencriptar y descomprimir
-    if (strcmp(operaciones, "-du") == 0) {
-        char ruta_intermedia[PATH_MAX];
-        snprintf(ruta_intermedia, sizeof(ruta_intermedia), "%s.temp", ruta_salida);
-        
-        // Paso 1: Desencriptar
-        printf("Paso 1: Desencriptando archivo...\n");
-        if (procesar_archivo_individual(ruta_entrada, ruta_intermedia, 'u',
-                                      NULL, algoritmo_enc, clave) != 0) {
-            fprintf(stderr, "Error en desencriptación\n");
-            return -1;
-        }
-        
-        // Paso 2: Descomprimir
-        printf("Paso 2: Descomprimiendo archivo desencriptado...\n");
-        if (procesar_archivo_individual(ruta_intermedia, ruta_salida, 'd',
-                                      algoritmo_comp, NULL, NULL) != 0) {
-            fprintf(stderr, "Error en descompresión\n");
-            unlink(ruta_intermedia);
-            return -1;
-        }
-        
-        unlink(ruta_intermedia);
-        printf("Operación -du completada exitosamente\n");
-        return 0;
+    const OperacionCombinada* combinada = buscar_operacion_combinada(operaciones);
+    if (!combinada) {
+        return -1;
+    }
+    
+    LOG_INFO("Procesando operación combinada: %s", operaciones);
+    
+    int resultado = procesar_combinada_en_flujo(ruta_entrada, ruta_salida, combinada->primera,
+                                                combinada->segunda, algoritmo_comp, algoritmo_enc,
+                                                clave, TAMANO_TROZO_FLUJO);
+    if (resultado == 1) {
+        resultado = procesar_combinada_por_pasos(ruta_entrada, ruta_salida, combinada,
+                                                 algoritmo_comp, algoritmo_enc, clave);
+    }
+    if (resultado != 0) {
+        return -1;
     }
     
-    fprintf(stderr, "Error: Operación combinada no soportada: %s\n", operaciones);
-    return -1;
+    LOG_INFO("Operación %s completada exitosamente", operaciones);
+    return 0;
 }
 
 // Resto de funciones existentes...
@@ -337,7 +1364,7 @@ int crear_directorio_salida(const char* ruta) {
     }
     
     if (mkdir(ruta, 0755) == 0) {
-        printf("Directorio creado: %s\n", ruta);
+        LOG_DETALLE("Directorio creado: %s", ruta);
         return 0;
     } else {
         fprintf(stderr, "Error: No se pudo crear el directorio '%s': %s\n", 
@@ -346,26 +1373,207 @@ int crear_directorio_salida(const char* ruta) {
     }
 }
 
+// Obtiene un buffer de al menos cota bytes donde construir el resultado (sin
+// ruta de salida, siempre en la arena)
+static char* obtener_destino(DestinoResultado* destino, size_t cota) {
+    if (destino->ruta_salida && cota >= UMBRAL_SALIDA_PROYECTADA) {
+        int apertura = abrir_salida_proyectada(destino->ruta_salida, cota, &destino->proyectada);
+        if (apertura == 0) {
+            destino->proyectado = 1;
+            return destino->proyectada.datos;
+        }
+        if (apertura == -1) {
+            return NULL;
+        }
+    }
+    return obtener_buffer_arena(destino->arena, BUFFER_SALIDA, cota);
+}
+
+// Comprime datos empaquetados en el destino; si el original tenía huecos
+// antepone la cabecera de contenedor disperso y, si empieza por '\0', la de
+// contenedor RLE
+static int comprimir_con_huecos(const char* datos, size_t tamano, const MapaDisperso* mapa,
+                                DestinoResultado* destino, char** salida, size_t* tamano_salida) {
+    size_t tamano_cabecera = mapa->tiene_huecos ? tamano_cabecera_dispersa(mapa) :
+                             requiere_contenedor_rle(datos, tamano) ? TAMANO_CABECERA_CONTENEDOR : 0;
+    *salida = obtener_destino(destino, tamano_cabecera + cota_compresion_rle(tamano));
+    if (!*salida) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para la compresión\n");
+        return -1;
+    }
+    
+    if (!mapa->tiene_huecos && tamano_cabecera == 0) {
+        return comprimir_rle_en(datos, tamano, *salida, tamano_salida);
+    }
+    
+    // La cabecera se escribe delante y los datos se comprimen detrás, sin copias intermedias
+    if (mapa->tiene_huecos) {
+        serializar_mapa_disperso(mapa, *salida);
+    } else {
+        escribir_cabecera_contenedor(CONTENEDOR_RLE, *salida);
+    }
+    size_t tamano_comprimido = 0;
+    if (tamano > 0 && comprimir_rle_en(datos, tamano, *salida + tamano_cabecera, &tamano_comprimido) != 0) {
+        return -1;
+    }
+    *tamano_salida = tamano_cabecera + tamano_comprimido;
+    
+    if (mapa->tiene_huecos) {
+        LOG_DETALLE("Archivo disperso: %zu regiones con datos, %zu de %zu bytes",
+                    mapa->num_extensiones, tamano, mapa->tamano_logico);
+    }
+    return 0;
+}
+
+// Descomprime datos en el destino; si son un contenedor disperso, llena el
+// mapa para recrear los huecos
+static int descomprimir_con_huecos(const char* datos, size_t tamano, MapaDisperso* mapa,
+                                   DestinoResultado* destino, char** salida, size_t* tamano_salida) {
+    TipoContenedor tipo = identificar_contenedor(datos, tamano);
+    if (tipo == CONTENEDOR_DESCONOCIDO) {
+        fprintf(stderr, "Error: Cabecera de contenedor desconocida: la entrada no es una salida de -c\n");
+        return -1;
+    }
+    
+    size_t tamano_cabecera = 0;
+    int contenedor = deserializar_mapa_disperso(datos, tamano, mapa, &tamano_cabecera);
+    if (contenedor == -1) {
+        return -1;
+    }
+    if (tipo == CONTENEDOR_RLE) {
+        tamano_cabecera = TAMANO_CABECERA_CONTENEDOR;
+    }
+    
+    // Los huecos se recrean al escribir, así que un contenedor disperso no se proyecta
+    size_t cota = cota_descompresion_rle(tamano - tamano_cabecera);
+    *salida = contenedor == 1 ? obtener_buffer_arena(destino->arena, BUFFER_SALIDA, cota)
+                              : obtener_destino(destino, cota);
+    if (!*salida) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para la descompresión\n");
+        liberar_mapa_disperso(mapa);
+        return -1;
+    }
+    
+    // Archivo formado solo por huecos: no hay datos que descomprimir
+    if (tipo != CONTENEDOR_NINGUNO && tamano == tamano_cabecera) {
+        *tamano_salida = 0;
+        return 0;
+    }
+    
+    if (descomprimir_rle_en(datos + tamano_cabecera, tamano - tamano_cabecera, *salida, tamano_salida) != 0) {
+        liberar_mapa_disperso(mapa);
+        return -1;
+    }
+    return 0;
+}
+
 int procesar_archivo_individual(const char* ruta_entrada, const char* ruta_salida,
                                char operacion, const char* algoritmo_comp,
                                const char* algoritmo_enc, const char* clave) {
-    // Leer archivo
-    char* contenido;
-    size_t tamano;
+    ArenaTrabajador arena;
+    iniciar_arena_trabajador(&arena, 0);
+    int resultado = procesar_archivo_con_arena(ruta_entrada, ruta_salida, operacion,
+                                               algoritmo_comp, algoritmo_enc, clave, &arena);
+    liberar_arena_trabajador(&arena);
+    return resultado;
+}
+
+// Inicializa las fases de un archivo que se procesa con los buffers de una arena
+static void iniciar_fases_archivo(FasesArchivo* fases, const char* ruta_entrada, const char* ruta_salida,
+                                  char operacion, const char* algoritmo_comp, const char* algoritmo_enc,
+                                  const char* clave, ArenaTrabajador* arena) {
+    memset(fases, 0, sizeof(*fases));
+    fases->ruta_entrada = ruta_entrada;
+    fases->ruta_salida = ruta_salida;
+    fases->operacion = operacion;
+    fases->algoritmo_comp = algoritmo_comp;
+    fases->algoritmo_enc = algoritmo_enc;
+    fases->clave = clave;
+    fases->destino.arena = arena;
+    fases->destino.ruta_salida = ruta_salida;
+    fases->destino.proyectada.fd = -1;
+}
+
+/**
+ * Fase de lectura: lee el archivo en el buffer de entrada de la arena
+ * 
+ * Los formatos ya comprimidos se almacenan (o se extraen) sin transformar en
+ * esta misma fase (fases->almacenado queda en 1 y no hay más fases).
+ * 
+ * @return 0 si es exitoso, -1 si hay error
+ */
+static int leer_fase_archivo(FasesArchivo* fases) {
+    const char* ruta_entrada = fases->ruta_entrada;
+    char operacion = fases->operacion;
     
-    if (leer_archivo(ruta_entrada, &contenido, &tamano) != 0) {
-        return -1;
+    // Los formatos ya comprimidos se guardan sin transformar en un contenedor
+    // almacenado, y al descomprimir solo la cabecera de ese contenedor los
+    // identifica. La copia se hace en el kernel (o como clonado de metadatos)
+    // sin pasar por memoria
+    if ((operacion == 'c' || operacion == 'd') && fases->algoritmo_comp &&
+        strcmp(fases->algoritmo_comp, "rle") == 0) {
+        char cabecera[TAMANO_FIRMA_COMPRIMIDO];
+        ssize_t leidos = leer_cabecera_archivo(ruta_entrada, cabecera, sizeof(cabecera));
+        if (leidos == -1) {
+            return -1;
+        }
+        MetodoCopia metodo;
+        if (operacion == 'c' && es_formato_comprimido(cabecera, (size_t)leidos)) {
+            if (almacenar_archivo(ruta_entrada, fases->ruta_salida, &metodo) != 0) {
+                return -1;
+            }
+            LOG_INFO("Archivo ya comprimido, almacenado sin transformar: %s [%s]",
+                     ruta_entrada, nombre_metodo_copia(metodo));
+            fases->almacenado = 1;
+            return 0;
+        }
+        if (operacion == 'd' && identificar_contenedor(cabecera, (size_t)leidos) == CONTENEDOR_ALMACENADO) {
+            if (extraer_archivo_almacenado(ruta_entrada, fases->ruta_salida, &metodo) != 0) {
+                return -1;
+            }
+            LOG_INFO("Archivo almacenado, extraído sin transformar: %s [%s]",
+                     ruta_entrada, nombre_metodo_copia(metodo));
+            fases->almacenado = 1;
+            return 0;
+        }
     }
     
-    char* datos_procesados = NULL;
-    size_t tamano_procesado = 0;
+    // La entrada a descomprimir se lee tal cual (el contenedor describe los huecos);
+    // las demás operaciones leen solo las regiones con datos
+    double inicio = iniciar_medida();
+    int resultado = operacion == 'd'
+                    ? leer_archivo_en_arena(ruta_entrada, fases->destino.arena, &fases->contenido, &fases->tamano)
+                    : leer_archivo_disperso_en_arena(ruta_entrada, fases->destino.arena, &fases->contenido,
+                                                     &fases->tamano, &fases->mapa);
+    if (resultado == 0) {
+        registrar_medida(MEDIDA_LECTURA, inicio, fases->tamano);
+    }
+    return resultado;
+}
+
+/**
+ * Fase de transformación: aplica la operación al contenido leído
+ * 
+ * El resultado queda en el buffer de salida de la arena o, si es grande,
+ * directamente en el archivo de salida proyectado.
+ * 
+ * @return 0 si es exitoso, -1 si hay error
+ */
+static int transformar_fase_archivo(FasesArchivo* fases) {
+    const char* algoritmo_comp = fases->algoritmo_comp;
+    const char* algoritmo_enc = fases->algoritmo_enc;
+    double inicio = iniciar_medida();
+    LecturaContadoresHw contadores;
+    leer_contadores_hw(&contadores);
     int resultado = 0;
     
-    // Aplicar operación
-    switch (operacion) {
+    switch (fases->operacion) {
         case 'c': // Comprimir
             if (strcmp(algoritmo_comp, "rle") == 0) {
-                resultado = comprimir_rle(contenido, tamano, &datos_procesados, &tamano_procesado);
+                resultado = comprimir_con_huecos(fases->contenido, fases->tamano, &fases->mapa, &fases->destino,
+                                                 &fases->datos_procesados, &fases->tamano_procesado);
+                // El contenedor ya registra los huecos: la salida comprimida es densa
+                liberar_mapa_disperso(&fases->mapa);
             } else {
                 fprintf(stderr, "Error: Algoritmo de compresión no soportado: %s\n", algoritmo_comp);
                 resultado = -1;
@@ -374,7 +1582,8 @@ int procesar_archivo_individual(const char* ruta_entrada, const char* ruta_salid
             
         case 'd': // Descomprimir
             if (strcmp(algoritmo_comp, "rle") == 0) {
-                resultado = descomprimir_rle(contenido, tamano, &datos_procesados, &tamano_procesado);
+                resultado = descomprimir_con_huecos(fases->contenido, fases->tamano, &fases->mapa, &fases->destino,
+                                                    &fases->datos_procesados, &fases->tamano_procesado);
             } else {
                 fprintf(stderr, "Error: Algoritmo de compresión no soportado: %s\n", algoritmo_comp);
                 resultado = -1;
@@ -382,27 +1591,26 @@ int procesar_archivo_individual(const char* ruta_entrada, const char* ruta_salid
             break;
             
         case 'e': // Encriptar
+        case 'u': // Desencriptar
             if (strcmp(algoritmo_enc, "vigenere") == 0) {
-                if (!clave) {
-                    fprintf(stderr, "Error: Se requiere una clave para encriptación\n");
+                if (!fases->clave) {
+                    fprintf(stderr, "Error: Se requiere una clave para %s\n",
+                            fases->operacion == 'e' ? "encriptación" : "desencriptación");
                     resultado = -1;
-                } else {
-                    resultado = encriptar_vigenere(contenido, tamano, clave, &datos_procesados, &tamano_procesado);
+                    break;
                 }
-            } else {
-                fprintf(stderr, "Error: Algoritmo de encriptación no soportado: %s\n", algoritmo_enc);
-                resultado = -1;
-            }
-            break;
-            
-        case 'u': // Desencriptar
-            if (strcmp(algoritmo_enc, "vigenere") == 0) {
-                if (!clave) {
-                    fprintf(stderr, "Error: Se requiere una clave para desencriptación\n");
+                if (!validar_clave(fases->clave)) {
+                    fprintf(stderr, "Error: La clave no es válida. Debe contener solo letras.\n");
                     resultado = -1;
-                } else {
-                    resultado = desencriptar_vigenere(contenido, tamano, clave, &datos_procesados, &tamano_procesado);
+                    break;
                 }
+                // Vigenère conserva el tamaño: se transforma el propio buffer de lectura.
+                // No altera los bytes nulos, así que los huecos se conservan tal cual
+                resultado = fases->operacion == 'e'
+                            ? encriptar_vigenere_en_sitio(fases->contenido, fases->tamano, fases->clave)
+                            : desencriptar_vigenere_en_sitio(fases->contenido, fases->tamano, fases->clave);
+                fases->datos_procesados = fases->contenido;
+                fases->tamano_procesado = fases->tamano;
             } else {
                 fprintf(stderr, "Error: Algoritmo de encriptación no soportado: %s\n", algoritmo_enc);
                 resultado = -1;
@@ -410,56 +1618,65 @@ int procesar_archivo_individual(const char* ruta_entrada, const char* ruta_salid
             break;
             
         default:
-            fprintf(stderr, "Error: Operación no válida: %c\n", operacion);
+            fprintf(stderr, "Error: Operación no válida: %c\n", fases->operacion);
             resultado = -1;
     }
     
-    // Escribir resultado si fue exitoso
-    if (resultado == 0 && datos_procesados) {
-        if (escribir_archivo(ruta_salida, datos_procesados, tamano_procesado) != 0) {
-            resultado = -1;
-        }
-        free(datos_procesados);
+    if (resultado == 0) {
+        registrar_medida(MEDIDA_TRANSFORMACION, inicio, fases->tamano);
+        registrar_contadores_hw(fases->operacion, &contadores, fases->tamano);
+        LOG_DETALLE("Terminada la %s de %s (%zu -> %zu bytes)", nombre_operacion(fases->operacion),
+                    fases->ruta_entrada, fases->tamano, fases->tamano_procesado);
     }
-    
-    free(contenido);
     return resultado;
 }
 
-int listar_archivos_directorio(const char* ruta_directorio, char*** archivos, size_t* num_archivos) {
-    DIR* dir = opendir(ruta_directorio);
-    if (!dir) {
-        return -1;
-    }
-    
-    char** lista_archivos = malloc(100 * sizeof(char*));
-    if (!lista_archivos) {
-        closedir(dir);
-        return -1;
+/**
+ * Fase de escritura: escribe el resultado, recreando los huecos si los hay
+ * 
+ * El resultado proyectado ya está en el archivo y solo falta recortarlo;
+ * si la transformación falló se descarta.
+ * 
+ * @param resultado Resultado de la transformación
+ * @return 0 si es exitoso, -1 si hay error
+ */
+static int escribir_fase_archivo(FasesArchivo* fases, int resultado) {
+    double inicio = iniciar_medida();
+    if (fases->destino.proyectado) {
+        if (resultado == 0) {
+            resultado = cerrar_salida_proyectada(&fases->destino.proyectada, fases->tamano_procesado);
+        } else {
+            descartar_salida_proyectada(&fases->destino.proyectada, fases->ruta_salida);
+        }
+    } else if (resultado == 0 && fases->datos_procesados) {
+        if (escribir_archivo_disperso(fases->ruta_salida, fases->datos_procesados,
+                                      fases->tamano_procesado, &fases->mapa) != 0) {
+            resultado = -1;
+        }
     }
     
-    size_t contador = 0;
-    struct dirent* entrada;
-    
-    while ((entrada = readdir(dir)) != NULL && contador < 100) {
-        if (strcmp(entrada->d_name, ".") != 0 && strcmp(entrada->d_name, "..") != 0 &&
-            entrada->d_type == DT_REG) {
-            lista_archivos[contador] = mi_strdup_dir(entrada->d_name);
-            contador++;
-        }
+    if (resultado == 0) {
+        registrar_medida(MEDIDA_ESCRITURA, inicio, fases->tamano_procesado);
     }
     
-    closedir(dir);
-    *archivos = lista_archivos;
-    *num_archivos = contador;
-    return 0;
+    // Los buffers pertenecen a la arena y se reutilizan en el siguiente archivo
+    liberar_mapa_disperso(&fases->mapa);
+    return resultado;
 }
 
-void liberar_lista_archivos(char** archivos, size_t num_archivos) {
-    if (!archivos) return;
-    
-    for (size_t i = 0; i < num_archivos; i++) {
-        free(archivos[i]);
+int procesar_archivo_con_arena(const char* ruta_entrada, const char* ruta_salida,
+                               char operacion, const char* algoritmo_comp,
+                               const char* algoritmo_enc, const char* clave,
+                               ArenaTrabajador* arena) {
+    FasesArchivo fases;
+    iniciar_fases_archivo(&fases, ruta_entrada, ruta_salida, operacion, algoritmo_comp,
+                          algoritmo_enc, clave, arena);
+    if (leer_fase_archivo(&fases) != 0) {
+        return -1;
     }
-    free(archivos);
+    if (fases.almacenado) {
+        return 0;
+    }
+    return escribir_fase_archivo(&fases, transformar_fase_archivo(&fases));
 }
+
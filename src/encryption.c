@@ -1,5 +1,5 @@
 #include "../include/encryption.h"
-#include <stdio.h>
+#include "../include/memory_accounting.h"
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
@@ -21,61 +21,42 @@ int encriptar_vigenere(const char* datos, size_t tamano_original, const char* cl
                        char** datos_encriptados, size_t* tamano_encriptado) {
     // Verificar que los parámetros sean válidos
     if (!datos || !clave || !datos_encriptados || !tamano_encriptado) {
-        fprintf(stderr, "Error: Parámetros inválidos para encriptar_vigenere\n");
         return -1;
     }
     
-    // Validar la clave
+    // Validar la clave antes de reservar memoria
     if (!validar_clave(clave)) {
-        fprintf(stderr, "Error: La clave no es válida. Debe contener solo letras.\n");
         return -1;
     }
     
-    // Asignar memoria para los datos encriptados
-    *datos_encriptados = malloc(tamano_original + 1);
+    // Asignar memoria para los datos resultantes
+    *datos_encriptados = asignar_memoria(MEMORIA_ENCRIPTACION, tamano_original + 1);
     if (!*datos_encriptados) {
-        fprintf(stderr, "Error: No se pudo asignar memoria para la encriptación\n");
         return -1;
     }
     
-    size_t longitud_clave = strlen(clave);
-    size_t posicion_clave = 0; // Posición actual en la clave
-    
-    // Procesar cada carácter del texto original
-    for (size_t i = 0; i < tamano_original; i++) {
-        char caracter_original = datos[i];
-        
-        // Solo encriptar letras (a-z, A-Z)
-        if (isalpha(caracter_original)) {
-            // Determinar si es mayúscula o minúscula
-            int es_mayuscula = isupper(caracter_original);
-            char base = es_mayuscula ? 'A' : 'a';
-            
-            // Obtener el carácter de la clave (cíclicamente)
-            char caracter_clave = clave[posicion_clave % longitud_clave];
-            caracter_clave = tolower(caracter_clave); // Convertir a minúscula para consistencia
-            
-            // Calcular el desplazamiento
-            int desplazamiento = caracter_clave - 'a';
-            
-            // Aplicar el cifrado Vigenère
-            char caracter_encriptado = ((caracter_original - base + desplazamiento) % 26) + base;
-            
-            (*datos_encriptados)[i] = caracter_encriptado;
-            
-            // Avanzar en la clave
-            posicion_clave++;
-        } else {
-            // Mantener caracteres que no son letras sin cambios
-            (*datos_encriptados)[i] = caracter_original;
-        }
-    }
+    encriptar_vigenere_en(datos, tamano_original, clave, *datos_encriptados);
     
     // Agregar terminador nulo
     (*datos_encriptados)[tamano_original] = '\0';
     *tamano_encriptado = tamano_original;
     
-    printf("Encriptación Vigenère completada: %zu bytes procesados\n", tamano_original);
+    return 0;
+}
+
+int encriptar_vigenere_en(const char* datos, size_t tamano, const char* clave, char* salida) {
+    // Verificar que los parámetros sean válidos
+    if (!datos || !clave || !salida) {
+        return -1;
+    }
+    
+    // Validar la clave
+    if (!validar_clave(clave)) {
+        return -1;
+    }
+    
+    // Procesar cada carácter
+    aplicar_vigenere_bloque(datos, salida, tamano, clave, 0, 0);
     
     return 0;
 }
@@ -94,65 +75,118 @@ int desencriptar_vigenere(const char* datos_encriptados, size_t tamano_encriptad
                           char** datos_originales, size_t* tamano_original) {
     // Verificar que los parámetros sean válidos
     if (!datos_encriptados || !clave || !datos_originales || !tamano_original) {
-        fprintf(stderr, "Error: Parámetros inválidos para desencriptar_vigenere\n");
         return -1;
     }
     
-    // Validar la clave
+    // Validar la clave antes de reservar memoria
     if (!validar_clave(clave)) {
-        fprintf(stderr, "Error: La clave no es válida. Debe contener solo letras.\n");
         return -1;
     }
     
-    // Asignar memoria para los datos originales
-    *datos_originales = malloc(tamano_encriptado + 1);
+    // Asignar memoria para los datos resultantes
+    *datos_originales = asignar_memoria(MEMORIA_ENCRIPTACION, tamano_encriptado + 1);
     if (!*datos_originales) {
-        fprintf(stderr, "Error: No se pudo asignar memoria para la desencriptación\n");
         return -1;
     }
     
-    size_t longitud_clave = strlen(clave);
-    size_t posicion_clave = 0; // Posición actual en la clave
-    
-    // Procesar cada carácter del texto encriptado
-    for (size_t i = 0; i < tamano_encriptado; i++) {
-        char caracter_encriptado = datos_encriptados[i];
-        
-        // Solo desencriptar letras (a-z, A-Z)
-        if (isalpha(caracter_encriptado)) {
-            // Determinar si es mayúscula o minúscula
-            int es_mayuscula = isupper(caracter_encriptado);
-            char base = es_mayuscula ? 'A' : 'a';
-            
-            // Obtener el carácter de la clave (cíclicamente)
-            char caracter_clave = clave[posicion_clave % longitud_clave];
-            caracter_clave = tolower(caracter_clave); // Convertir a minúscula para consistencia
-            
-            // Calcular el desplazamiento
-            int desplazamiento = caracter_clave - 'a';
-            
-            // Aplicar el descifrado Vigenère (operación inversa)
-            char caracter_original = ((caracter_encriptado - base - desplazamiento + 26) % 26) + base;
-            
-            (*datos_originales)[i] = caracter_original;
-            
-            // Avanzar en la clave
-            posicion_clave++;
-        } else {
-            // Mantener caracteres que no son letras sin cambios
-            (*datos_originales)[i] = caracter_encriptado;
-        }
-    }
+    desencriptar_vigenere_en(datos_encriptados, tamano_encriptado, clave, *datos_originales);
     
     // Agregar terminador nulo
     (*datos_originales)[tamano_encriptado] = '\0';
     *tamano_original = tamano_encriptado;
     
-    printf("Desencriptación Vigenère completada: %zu bytes procesados\n", *tamano_original);
+    return 0;
+}
+
+int desencriptar_vigenere_en(const char* datos_encriptados, size_t tamano, const char* clave, char* salida) {
+    // Verificar que los parámetros sean válidos
+    if (!datos_encriptados || !clave || !salida) {
+        return -1;
+    }
+    
+    // Validar la clave
+    if (!validar_clave(clave)) {
+        return -1;
+    }
+    
+    // Procesar cada carácter
+    aplicar_vigenere_bloque(datos_encriptados, salida, tamano, clave, 0, 1);
+    
+    return 0;
+}
+
+int encriptar_vigenere_en_sitio(char* datos, size_t tamano, const char* clave) {
+    return encriptar_vigenere_en(datos, tamano, clave, datos);
+}
+
+int desencriptar_vigenere_en_sitio(char* datos, size_t tamano, const char* clave) {
+    return desencriptar_vigenere_en(datos, tamano, clave, datos);
+}
+
+/**
+ * Aplica Vigenère a un bloque sobre un buffer ya reservado
+ * 
+ * Solo se transforman las letras (a-z, A-Z); el resto de bytes se copian sin
+ * cambios y no consumen clave. Encriptar suma el desplazamiento de la clave y
+ * desencriptar lo resta: C = (P + K) mod 26, P = (C - K + 26) mod 26.
+ */
+void aplicar_vigenere_bloque(const char* entrada, char* salida, size_t tamano,
+                             const char* clave, size_t posicion_clave, int desencriptar) {
+    size_t longitud_clave = strlen(clave);
+    
+    for (size_t i = 0; i < tamano; i++) {
+        unsigned char caracter = (unsigned char)entrada[i];
+        
+        // Mantener caracteres que no son letras sin cambios
+        if (!isalpha(caracter)) {
+            salida[i] = (char)caracter;
+            continue;
+        }
+        
+        // Determinar si es mayúscula o minúscula
+        char base = isupper(caracter) ? 'A' : 'a';
+        
+        // Obtener el desplazamiento del carácter de la clave (cíclicamente)
+        int desplazamiento = tolower((unsigned char)clave[posicion_clave % longitud_clave]) - 'a';
+        if (desencriptar) {
+            desplazamiento = 26 - desplazamiento;
+        }
+        
+        salida[i] = (char)(((caracter - base + desplazamiento) % 26) + base);
+        
+        // Avanzar en la clave
+        posicion_clave++;
+    }
+}
+
+/**
+ * Cuenta las letras de un bloque (las posiciones que consumen clave)
+ */
+size_t contar_letras(const char* datos, size_t tamano) {
+    size_t letras = 0;
+    for (size_t i = 0; i < tamano; i++) {
+        letras += isalpha((unsigned char)datos[i]) ? 1 : 0;
+    }
+    return letras;
+}
+
+int iniciar_flujo_vigenere(FlujoVigenere* flujo, const char* clave, int desencriptar) {
+    if (!flujo || !validar_clave(clave)) {
+        return -1;
+    }
     
+    flujo->clave = clave;
+    flujo->posicion_clave = 0;
+    flujo->desencriptar = desencriptar;
     return 0;
 }
 
+void aplicar_vigenere_flujo(FlujoVigenere* flujo, const char* entrada, char* salida, size_t tamano) {
+    aplicar_vigenere_bloque(entrada, salida, tamano, flujo->clave, flujo->posicion_clave, flujo->desencriptar);
+    // Las letras siguen siendo letras tras el cifrado: contar en la salida sirve aunque sea la misma memoria
+    flujo->posicion_clave += contar_letras(salida, tamano);
+}
+
 /**
  * Valida que una clave sea válida para encriptación
  * 
@@ -181,6 +215,6 @@ int validar_clave(const char* clave) {
  */
 void liberar_datos_encriptados(char* datos) {
     if (datos) {
-        free(datos);
+        liberar_asignacion(datos);
     }
 }
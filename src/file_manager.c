@@ -1,12 +1,33 @@
+#define _GNU_SOURCE // SEEK_DATA, SEEK_HOLE, fallocate() y copy_file_range()
 #include "../include/file_manager.h"
+#include "../include/run_stats.h"
+#include "../include/memory_accounting.h"
+#include "../include/compression.h"
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
 #include <errno.h>
 
+// Reserva el buffer de contenido en la arena, o con asignar_memoria si no hay arena
+static char* reservar_contenido(ArenaTrabajador* arena, size_t tamano) {
+    return arena ? obtener_buffer_arena(arena, BUFFER_ENTRADA, tamano) : asignar_memoria(MEMORIA_ARCHIVOS, tamano);
+}
+
+// Libera un buffer de contenido si no pertenece a una arena
+static void liberar_contenido(ArenaTrabajador* arena, char* contenido) {
+    if (!arena) {
+        liberar_asignacion(contenido);
+    }
+}
+
 /**
  * Lee un archivo completo usando llamadas al sistema
  * 
@@ -21,6 +42,10 @@
  * @return 0 si es exitoso, -1 si hay error
  */
 int leer_archivo(const char* ruta, char** contenido, size_t* tamano) {
+    return leer_archivo_en_arena(ruta, NULL, contenido, tamano);
+}
+
+int leer_archivo_en_arena(const char* ruta, ArenaTrabajador* arena, char** contenido, size_t* tamano) {
     // Verificar que todos los parámetros sean válidos
     if (!ruta || !contenido || !tamano) {
         fprintf(stderr, "Error: Parámetros inválidos para leer_archivo\n");
@@ -46,7 +71,7 @@ int leer_archivo(const char* ruta, char** contenido, size_t* tamano) {
     
     // Si el archivo está vacío, retornar éxito con contenido vacío
     if (*tamano == 0) {
-        *contenido = malloc(1);
+        *contenido = reservar_contenido(arena, 1);
         if (!*contenido) {
             fprintf(stderr, "Error: No se pudo asignar memoria\n");
             close(fd);
@@ -58,7 +83,7 @@ int leer_archivo(const char* ruta, char** contenido, size_t* tamano) {
     }
     
     // Asignar memoria para el contenido
-    *contenido = malloc(*tamano + 1);
+    *contenido = reservar_contenido(arena, *tamano + 1);
     if (!*contenido) {
         fprintf(stderr, "Error: No se pudo asignar memoria para el archivo\n");
         close(fd);
@@ -69,14 +94,14 @@ int leer_archivo(const char* ruta, char** contenido, size_t* tamano) {
     ssize_t bytes_leidos = read(fd, *contenido, *tamano);
     if (bytes_leidos == -1) {
         fprintf(stderr, "Error: No se pudo leer el archivo '%s': %s\n", ruta, strerror(errno));
-        free(*contenido);
+        liberar_contenido(arena, *contenido);
         close(fd);
         return -1;
     }
     
     if (bytes_leidos != (ssize_t)*tamano) {
         fprintf(stderr, "Error: No se leyeron todos los bytes del archivo\n");
-        free(*contenido);
+        liberar_contenido(arena, *contenido);
         close(fd);
         return -1;
     }
@@ -119,7 +144,7 @@ int escribir_archivo(const char* ruta, const char* contenido, size_t tamano) {
     }
     
     // Sincronizar el archivo con el disco
-    if (fsync(fd) == -1) {
+    if (sincronizar_archivo(fd, tamano) == -1) {
         fprintf(stderr, "Advertencia: No se pudo sincronizar el archivo con el disco: %s\n", strerror(errno));
     }
     
@@ -162,3 +187,672 @@ ssize_t obtener_tamano_archivo(const char* ruta) {
     
     return st.st_size;
 }
+
+
+/**
+ * Lee un rango de un archivo abierto
+ * 
+ * Repite pread() hasta completar el rango, ya que puede devolver menos bytes.
+ */
+int leer_rango_archivo(int fd, char* destino, size_t longitud, off_t desplazamiento) {
+    size_t leidos = 0;
+    while (leidos < longitud) {
+        ssize_t n = pread(fd, destino + leidos, longitud - leidos, desplazamiento + (off_t)leidos);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) {
+            errno = EIO; // El archivo se acortó mientras se leía
+            return -1;
+        }
+        leidos += (size_t)n;
+    }
+    return 0;
+}
+
+/**
+ * Escribe un rango de un archivo abierto
+ * 
+ * Repite pwrite() hasta completar el rango, ya que puede escribir menos bytes.
+ */
+int escribir_rango_archivo(int fd, const char* origen, size_t longitud, off_t desplazamiento) {
+    size_t escritos = 0;
+    while (escritos < longitud) {
+        ssize_t n = pwrite(fd, origen + escritos, longitud - escritos, desplazamiento + (off_t)escritos);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        escritos += (size_t)n;
+    }
+    return 0;
+}
+
+int sincronizar_archivo(int fd, size_t bytes) {
+    double inicio = iniciar_medida();
+    int resultado = fsync(fd);
+    registrar_medida(MEDIDA_SINCRONIZACION, inicio, bytes);
+    return resultado;
+}
+
+/**
+ * Crea y proyecta el archivo de salida con el tamaño de la cota
+ * 
+ * El archivo queda disperso hasta que el codificador toca sus páginas, así
+ * que la cota no ocupa disco; solo se exige que haya espacio libre para ella.
+ */
+int abrir_salida_proyectada(const char* ruta, size_t capacidad, SalidaProyectada* salida) {
+    if (!ruta || !salida || capacidad == 0) {
+        fprintf(stderr, "Error: Parámetros inválidos para abrir_salida_proyectada\n");
+        return -1;
+    }
+    
+    int fd = open(ruta, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        fprintf(stderr, "Error: No se pudo crear/abrir el archivo '%s': %s\n", ruta, strerror(errno));
+        return -1;
+    }
+    
+    struct statvfs vfs;
+    if (fstatvfs(fd, &vfs) == -1 || (uint64_t)vfs.f_bavail * vfs.f_frsize < capacidad) {
+        close(fd);
+        return 1;
+    }
+    
+    if (ftruncate(fd, (off_t)capacidad) == -1) {
+        close(fd);
+        return 1;
+    }
+    
+    void* datos = mmap(NULL, capacidad, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (datos == MAP_FAILED) {
+        // El llamador reescribe el archivo desde cero con write()
+        close(fd);
+        return 1;
+    }
+    
+    salida->fd = fd;
+    salida->datos = datos;
+    salida->capacidad = capacidad;
+    return 0;
+}
+
+int cerrar_salida_proyectada(SalidaProyectada* salida, size_t tamano_final) {
+    int resultado = 0;
+    
+    munmap(salida->datos, salida->capacidad);
+    if (ftruncate(salida->fd, (off_t)tamano_final) == -1) {
+        fprintf(stderr, "Error: No se pudo ajustar el tamaño del archivo de salida: %s\n", strerror(errno));
+        resultado = -1;
+    } else if (sincronizar_archivo(salida->fd, tamano_final) == -1) {
+        fprintf(stderr, "Advertencia: No se pudo sincronizar el archivo con el disco: %s\n", strerror(errno));
+    }
+    
+    close(salida->fd);
+    salida->fd = -1;
+    salida->datos = NULL;
+    salida->capacidad = 0;
+    return resultado;
+}
+
+void descartar_salida_proyectada(SalidaProyectada* salida, const char* ruta) {
+    munmap(salida->datos, salida->capacidad);
+    close(salida->fd);
+    unlink(ruta);
+    salida->fd = -1;
+    salida->datos = NULL;
+    salida->capacidad = 0;
+}
+
+/**
+ * Lee los primeros bytes de un archivo sin cargarlo completo
+ */
+ssize_t leer_cabecera_archivo(const char* ruta, char* destino, size_t tamano) {
+    if (!ruta || !destino) {
+        return -1;
+    }
+    
+    int fd = open(ruta, O_RDONLY);
+    if (fd == -1) {
+        fprintf(stderr, "Error: No se pudo abrir el archivo '%s': %s\n", ruta, strerror(errno));
+        return -1;
+    }
+    
+    ssize_t leidos;
+    do {
+        leidos = read(fd, destino, tamano);
+    } while (leidos == -1 && errno == EINTR);
+    
+    if (leidos == -1) {
+        fprintf(stderr, "Error: No se pudo leer el archivo '%s': %s\n", ruta, strerror(errno));
+    }
+    
+    close(fd);
+    return leidos;
+}
+
+// Escribe un entero de 64 bits en little-endian
+static void escribir_u64(char* destino, uint64_t valor) {
+    for (int i = 0; i < 8; i++) {
+        destino[i] = (char)((valor >> (8 * i)) & 0xFF);
+    }
+}
+
+// Lee un entero de 64 bits en little-endian
+static uint64_t leer_u64(const char* origen) {
+    uint64_t valor = 0;
+    for (int i = 0; i < 8; i++) {
+        valor |= (uint64_t)(unsigned char)origen[i] << (8 * i);
+    }
+    return valor;
+}
+
+/**
+ * Copia un rango de un archivo a otro sin pasar por memoria de usuario cuando es posible
+ * 
+ * FICLONERANGE comparte los bloques del origen (Btrfs, XFS, bcachefs) y no
+ * copia datos, pero exige posiciones alineadas a bloques del sistema de
+ * archivos; copy_file_range() copia dentro del kernel (o delega en el
+ * servidor en NFS/SMB). Si ninguno está disponible se copia con read()/write().
+ */
+static int copiar_rango(int fd_origen, off_t desde, int fd_destino, off_t hacia, size_t total,
+                        MetodoCopia* usado) {
+    size_t copiados = 0;
+    
+    // 1. Clonado de metadatos hasta el final del origen: el destino comparte sus bloques
+    struct file_clone_range clonado = { fd_origen, (uint64_t)desde, 0, (uint64_t)hacia };
+    *usado = COPIA_FICLONE;
+    if (ioctl(fd_destino, FICLONERANGE, &clonado) == 0) {
+        return 0;
+    }
+    
+    // 2. Copia dentro del kernel
+    *usado = COPIA_COPY_FILE_RANGE;
+    loff_t pos_origen = desde;
+    loff_t pos_destino = hacia;
+    while (copiados < total) {
+        ssize_t n = copy_file_range(fd_origen, &pos_origen, fd_destino, &pos_destino, total - copiados, 0);
+        if (n == -1 && errno == EINTR) continue;
+        if (n <= 0) break; // No soportado entre estos archivos: seguir con read/write
+        copiados += (size_t)n;
+    }
+    if (copiados == total) {
+        return 0;
+    }
+    
+    // 3. Copia en espacio de usuario desde donde se haya quedado la copia anterior
+    *usado = COPIA_READ_WRITE;
+    size_t tamano_bloque = 1 << 20;
+    char* bloque = asignar_memoria(MEMORIA_ARCHIVOS, tamano_bloque);
+    if (!bloque) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para la copia\n");
+        return -1;
+    }
+    while (copiados < total) {
+        size_t pedir = total - copiados < tamano_bloque ? total - copiados : tamano_bloque;
+        ssize_t n = pread(fd_origen, bloque, pedir, desde + (off_t)copiados);
+        if (n == -1 && errno == EINTR) continue;
+        if (n <= 0 || escribir_rango_archivo(fd_destino, bloque, (size_t)n, hacia + (off_t)copiados) != 0) {
+            fprintf(stderr, "Error: No se pudo copiar el archivo: %s\n",
+                    n == 0 ? "fin de archivo inesperado" : strerror(errno));
+            liberar_asignacion(bloque);
+            return -1;
+        }
+        copiados += (size_t)n;
+    }
+    liberar_asignacion(bloque);
+    return 0;
+}
+
+// Abre el origen y el destino de una copia; devuelve el tamaño del origen o -1
+static off_t abrir_copia(const char* origen, const char* destino, int* fd_origen, int* fd_destino,
+                         blksize_t* bloque_destino) {
+    *fd_origen = open(origen, O_RDONLY);
+    if (*fd_origen == -1) {
+        fprintf(stderr, "Error: No se pudo abrir el archivo '%s': %s\n", origen, strerror(errno));
+        return -1;
+    }
+    
+    struct stat st;
+    if (fstat(*fd_origen, &st) == -1) {
+        fprintf(stderr, "Error: No se pudo obtener información del archivo '%s': %s\n", origen, strerror(errno));
+        close(*fd_origen);
+        return -1;
+    }
+    
+    *fd_destino = open(destino, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    struct stat st_destino;
+    if (*fd_destino == -1 || fstat(*fd_destino, &st_destino) == -1) {
+        fprintf(stderr, "Error: No se pudo crear/abrir el archivo '%s': %s\n", destino, strerror(errno));
+        if (*fd_destino != -1) close(*fd_destino);
+        close(*fd_origen);
+        return -1;
+    }
+    *bloque_destino = st_destino.st_blksize;
+    return st.st_size;
+}
+
+// Sincroniza y cierra los archivos de una copia
+static int cerrar_copia(int fd_origen, int fd_destino, size_t bytes, int resultado) {
+    if (resultado == 0 && sincronizar_archivo(fd_destino, bytes) == -1) {
+        fprintf(stderr, "Advertencia: No se pudo sincronizar el archivo con el disco: %s\n", strerror(errno));
+    }
+    close(fd_origen);
+    close(fd_destino);
+    return resultado;
+}
+
+/**
+ * Serializa la cabecera de un contenedor almacenado
+ * 
+ * Formato: cabecera de contenedor (8 bytes) y posición de los datos (8), en
+ * little-endian. Entre la cabecera y los datos puede haber relleno.
+ */
+size_t serializar_cabecera_almacenada(off_t desplazamiento, char* destino) {
+    escribir_cabecera_contenedor(CONTENEDOR_ALMACENADO, destino);
+    escribir_u64(destino + TAMANO_CABECERA_CONTENEDOR, (uint64_t)desplazamiento);
+    return TAMANO_CABECERA_ALMACENADA;
+}
+
+int deserializar_cabecera_almacenada(const char* datos, size_t tamano, off_t* desplazamiento) {
+    if (identificar_contenedor(datos, tamano) != CONTENEDOR_ALMACENADO) {
+        return 0;
+    }
+    uint64_t valor = tamano >= TAMANO_CABECERA_ALMACENADA ? leer_u64(datos + TAMANO_CABECERA_CONTENEDOR) : 0;
+    if (valor < TAMANO_CABECERA_ALMACENADA || valor > (uint64_t)INT64_MAX) {
+        fprintf(stderr, "Error: Cabecera de archivo almacenado corrupta\n");
+        return -1;
+    }
+    *desplazamiento = (off_t)valor;
+    return 1;
+}
+
+/**
+ * Guarda un archivo sin transformar dentro de un contenedor almacenado
+ * 
+ * Los datos se clonan en el primer bloque del sistema de archivos tras la
+ * cabecera, que es la posición que admite FICLONERANGE; el hueco entre la
+ * cabecera y los datos no ocupa disco. Sin clonado, los datos siguen a la
+ * cabecera y se copian con copy_file_range() o read()/write().
+ */
+int almacenar_archivo(const char* origen, const char* destino, MetodoCopia* metodo) {
+    if (!origen || !destino) {
+        fprintf(stderr, "Error: Parámetros inválidos para almacenar_archivo\n");
+        return -1;
+    }
+    
+    int fd_origen, fd_destino;
+    blksize_t bloque;
+    off_t total = abrir_copia(origen, destino, &fd_origen, &fd_destino, &bloque);
+    if (total == -1) {
+        return -1;
+    }
+    
+    MetodoCopia usado = COPIA_FICLONE;
+    off_t desplazamiento = bloque >= TAMANO_CABECERA_ALMACENADA ? (off_t)bloque : TAMANO_CABECERA_ALMACENADA;
+    struct file_clone_range clonado = { fd_origen, 0, 0, (uint64_t)desplazamiento };
+    if (ioctl(fd_destino, FICLONERANGE, &clonado) != 0) {
+        desplazamiento = TAMANO_CABECERA_ALMACENADA;
+        if (copiar_rango(fd_origen, 0, fd_destino, desplazamiento, (size_t)total, &usado) != 0) {
+            return cerrar_copia(fd_origen, fd_destino, 0, -1);
+        }
+    }
+    
+    char cabecera[TAMANO_CABECERA_ALMACENADA];
+    serializar_cabecera_almacenada(desplazamiento, cabecera);
+    if (escribir_rango_archivo(fd_destino, cabecera, sizeof(cabecera), 0) != 0) {
+        fprintf(stderr, "Error: No se pudo escribir al archivo '%s': %s\n", destino, strerror(errno));
+        return cerrar_copia(fd_origen, fd_destino, 0, -1);
+    }
+    
+    if (metodo) {
+        *metodo = usado;
+    }
+    return cerrar_copia(fd_origen, fd_destino, (size_t)total, 0);
+}
+
+/**
+ * Extrae los datos de un contenedor almacenado
+ */
+int extraer_archivo_almacenado(const char* origen, const char* destino, MetodoCopia* metodo) {
+    if (!origen || !destino) {
+        fprintf(stderr, "Error: Parámetros inválidos para extraer_archivo_almacenado\n");
+        return -1;
+    }
+    
+    int fd_origen, fd_destino;
+    blksize_t bloque;
+    off_t total = abrir_copia(origen, destino, &fd_origen, &fd_destino, &bloque);
+    if (total == -1) {
+        return -1;
+    }
+    
+    char cabecera[TAMANO_CABECERA_ALMACENADA];
+    off_t desplazamiento = 0;
+    if (leer_rango_archivo(fd_origen, cabecera, sizeof(cabecera), 0) != 0 ||
+        deserializar_cabecera_almacenada(cabecera, sizeof(cabecera), &desplazamiento) != 1 ||
+        desplazamiento > total) {
+        fprintf(stderr, "Error: '%s' no es un archivo almacenado válido\n", origen);
+        return cerrar_copia(fd_origen, fd_destino, 0, -1);
+    }
+    
+    MetodoCopia usado;
+    if (copiar_rango(fd_origen, desplazamiento, fd_destino, 0, (size_t)(total - desplazamiento), &usado) != 0) {
+        return cerrar_copia(fd_origen, fd_destino, 0, -1);
+    }
+    
+    if (metodo) {
+        *metodo = usado;
+    }
+    return cerrar_copia(fd_origen, fd_destino, (size_t)(total - desplazamiento), 0);
+}
+
+/**
+ * Obtiene el nombre legible de un mecanismo de copia
+ */
+const char* nombre_metodo_copia(MetodoCopia metodo) {
+    switch (metodo) {
+        case COPIA_FICLONE:         return "FICLONE (reflink)";
+        case COPIA_COPY_FILE_RANGE: return "copy_file_range";
+        case COPIA_READ_WRITE:      return "read/write";
+    }
+    return "desconocido";
+}
+
+// Agrega una región con datos al mapa, haciendo crecer el array si es necesario
+static int agregar_extension(MapaDisperso* mapa, size_t* capacidad, off_t inicio, size_t longitud) {
+    if (mapa->num_extensiones == *capacidad) {
+        size_t nueva = *capacidad ? *capacidad * 2 : 8;
+        ExtensionDatos* tmp = reasignar_memoria(MEMORIA_ARCHIVOS, mapa->extensiones, nueva * sizeof(ExtensionDatos));
+        if (!tmp) {
+            return -1;
+        }
+        mapa->extensiones = tmp;
+        *capacidad = nueva;
+    }
+    mapa->extensiones[mapa->num_extensiones].desplazamiento = inicio;
+    mapa->extensiones[mapa->num_extensiones].longitud = longitud;
+    mapa->num_extensiones++;
+    return 0;
+}
+
+/**
+ * Lee solo las regiones con datos de un archivo, saltando sus huecos
+ * 
+ * Recorre el archivo alternando lseek(SEEK_DATA) y lseek(SEEK_HOLE): cada par
+ * delimita una región con datos que se lee con pread(). Los huecos no se leen
+ * ni ocupan memoria, así que el tiempo de lectura depende de los datos reales.
+ */
+int leer_archivo_disperso(const char* ruta, char** contenido, size_t* tamano, MapaDisperso* mapa) {
+    return leer_archivo_disperso_en_arena(ruta, NULL, contenido, tamano, mapa);
+}
+
+int leer_archivo_disperso_en_arena(const char* ruta, ArenaTrabajador* arena, char** contenido,
+                                   size_t* tamano, MapaDisperso* mapa) {
+    if (!ruta || !contenido || !tamano || !mapa) {
+        fprintf(stderr, "Error: Parámetros inválidos para leer_archivo_disperso\n");
+        return -1;
+    }
+    
+    memset(mapa, 0, sizeof(*mapa));
+    
+    int fd = open(ruta, O_RDONLY);
+    if (fd == -1) {
+        fprintf(stderr, "Error: No se pudo abrir el archivo '%s': %s\n", ruta, strerror(errno));
+        return -1;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        fprintf(stderr, "Error: No se pudo obtener información del archivo '%s': %s\n", ruta, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    
+    off_t tamano_logico = st.st_size;
+    mapa->tamano_logico = (size_t)tamano_logico;
+    
+    // Si el primer hueco está al final (o SEEK_HOLE no está soportado) no hay huecos
+    if (!descriptor_tiene_huecos(fd, tamano_logico)) {
+        close(fd);
+        return leer_archivo_en_arena(ruta, arena, contenido, tamano);
+    }
+    
+    // Localizar las regiones con datos
+    size_t capacidad = 0;
+    size_t total_datos = 0;
+    off_t posicion = 0;
+    while (posicion < tamano_logico) {
+        off_t inicio = lseek(fd, posicion, SEEK_DATA);
+        if (inicio == -1) {
+            if (errno == ENXIO) break; // El resto del archivo es un hueco
+            fprintf(stderr, "Error: No se pudieron localizar los datos de '%s': %s\n", ruta, strerror(errno));
+            liberar_mapa_disperso(mapa);
+            close(fd);
+            return -1;
+        }
+        off_t fin = lseek(fd, inicio, SEEK_HOLE);
+        if (fin == -1 || fin > tamano_logico) {
+            fin = tamano_logico;
+        }
+        if (agregar_extension(mapa, &capacidad, inicio, (size_t)(fin - inicio)) != 0) {
+            fprintf(stderr, "Error: No se pudo asignar memoria para el mapa de huecos\n");
+            liberar_mapa_disperso(mapa);
+            close(fd);
+            return -1;
+        }
+        total_datos += (size_t)(fin - inicio);
+        posicion = fin;
+    }
+    mapa->tamano_logico = (size_t)tamano_logico;
+    mapa->tiene_huecos = 1;
+    
+    // Leer solo las regiones con datos, empaquetadas una tras otra
+    *contenido = reservar_contenido(arena, total_datos + 1);
+    if (!*contenido) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para el archivo\n");
+        liberar_mapa_disperso(mapa);
+        close(fd);
+        return -1;
+    }
+    
+    size_t pos_contenido = 0;
+    for (size_t i = 0; i < mapa->num_extensiones; i++) {
+        ExtensionDatos* ext = &mapa->extensiones[i];
+        if (leer_rango_archivo(fd, *contenido + pos_contenido, ext->longitud, ext->desplazamiento) != 0) {
+            fprintf(stderr, "Error: No se pudo leer el archivo '%s': %s\n", ruta, strerror(errno));
+            liberar_contenido(arena, *contenido);
+            *contenido = NULL;
+            liberar_mapa_disperso(mapa);
+            close(fd);
+            return -1;
+        }
+        pos_contenido += ext->longitud;
+    }
+    
+    (*contenido)[total_datos] = '\0';
+    *tamano = total_datos;
+    
+    close(fd);
+    return 0;
+}
+
+/**
+ * Escribe datos empaquetados recreando los huecos descritos por el mapa
+ */
+int escribir_archivo_disperso(const char* ruta, const char* contenido, size_t tamano,
+                              const MapaDisperso* mapa) {
+    if (!mapa || !mapa->tiene_huecos) {
+        return escribir_archivo(ruta, contenido, tamano);
+    }
+    
+    if (!ruta || (!contenido && tamano > 0)) {
+        fprintf(stderr, "Error: Parámetros inválidos para escribir_archivo_disperso\n");
+        return -1;
+    }
+    
+    // Los datos empaquetados deben cubrir exactamente las regiones del mapa
+    size_t total_datos = 0;
+    for (size_t i = 0; i < mapa->num_extensiones; i++) {
+        total_datos += mapa->extensiones[i].longitud;
+    }
+    if (total_datos != tamano) {
+        fprintf(stderr, "Error: Los datos (%zu bytes) no coinciden con el mapa de huecos (%zu bytes)\n",
+                tamano, total_datos);
+        return -1;
+    }
+    
+    int fd = open(ruta, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        fprintf(stderr, "Error: No se pudo crear/abrir el archivo '%s': %s\n", ruta, strerror(errno));
+        return -1;
+    }
+    
+    // Fijar el tamaño aparente: todo el archivo nace como un hueco
+    if (ftruncate(fd, (off_t)mapa->tamano_logico) == -1) {
+        fprintf(stderr, "Error: No se pudo fijar el tamaño de '%s': %s\n", ruta, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    
+    // Escribir solo las regiones con datos
+    size_t pos_contenido = 0;
+    off_t fin_anterior = 0;
+    for (size_t i = 0; i < mapa->num_extensiones; i++) {
+        const ExtensionDatos* ext = &mapa->extensiones[i];
+        
+        // Liberar explícitamente el hueco previo por si el sistema de archivos lo reservó
+        if (ext->desplazamiento > fin_anterior) {
+            fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                      fin_anterior, ext->desplazamiento - fin_anterior);
+        }
+        
+        if (escribir_rango_archivo(fd, contenido + pos_contenido, ext->longitud, ext->desplazamiento) != 0) {
+            fprintf(stderr, "Error: No se pudo escribir al archivo '%s': %s\n", ruta, strerror(errno));
+            close(fd);
+            return -1;
+        }
+        pos_contenido += ext->longitud;
+        fin_anterior = ext->desplazamiento + (off_t)ext->longitud;
+    }
+    
+    // Sincronizar el archivo con el disco
+    if (sincronizar_archivo(fd, tamano) == -1) {
+        fprintf(stderr, "Advertencia: No se pudo sincronizar el archivo con el disco: %s\n", strerror(errno));
+    }
+    
+    close(fd);
+    return 0;
+}
+
+/**
+ * Calcula el tamaño de la cabecera de contenedor que describe un mapa disperso
+ * 
+ * Formato: cabecera de contenedor (8 bytes), tamaño lógico (8), número de regiones (8) y
+ * por cada región su desplazamiento (8) y su longitud (8), en little-endian.
+ */
+size_t tamano_cabecera_dispersa(const MapaDisperso* mapa) {
+    return TAMANO_CABECERA_CONTENEDOR + 16 + mapa->num_extensiones * 16;
+}
+
+/**
+ * Serializa un mapa disperso como cabecera de contenedor
+ */
+size_t serializar_mapa_disperso(const MapaDisperso* mapa, char* destino) {
+    size_t pos = 0;
+    escribir_cabecera_contenedor(CONTENEDOR_DISPERSO, destino);
+    pos += TAMANO_CABECERA_CONTENEDOR;
+    escribir_u64(destino + pos, (uint64_t)mapa->tamano_logico);
+    pos += 8;
+    escribir_u64(destino + pos, (uint64_t)mapa->num_extensiones);
+    pos += 8;
+    for (size_t i = 0; i < mapa->num_extensiones; i++) {
+        escribir_u64(destino + pos, (uint64_t)mapa->extensiones[i].desplazamiento);
+        escribir_u64(destino + pos + 8, (uint64_t)mapa->extensiones[i].longitud);
+        pos += 16;
+    }
+    return pos;
+}
+
+/**
+ * Reconoce y lee la cabecera de contenedor de un archivo disperso
+ */
+int deserializar_mapa_disperso(const char* datos, size_t tamano, MapaDisperso* mapa,
+                               size_t* consumidos) {
+    memset(mapa, 0, sizeof(*mapa));
+    *consumidos = 0;
+    
+    if (identificar_contenedor(datos, tamano) != CONTENEDOR_DISPERSO) {
+        return 0; // No es un contenedor disperso
+    }
+    if (tamano < TAMANO_CABECERA_CONTENEDOR + 16) {
+        fprintf(stderr, "Error: Cabecera de archivo disperso corrupta\n");
+        return -1;
+    }
+    
+    size_t pos = TAMANO_CABECERA_CONTENEDOR;
+    uint64_t tamano_logico = leer_u64(datos + pos);
+    uint64_t num_extensiones = leer_u64(datos + pos + 8);
+    pos += 16;
+    
+    if (num_extensiones > (tamano - pos) / 16) {
+        fprintf(stderr, "Error: Cabecera de archivo disperso corrupta\n");
+        return -1;
+    }
+    
+    if (num_extensiones > 0) {
+        mapa->extensiones = asignar_memoria(MEMORIA_ARCHIVOS, num_extensiones * sizeof(ExtensionDatos));
+        if (!mapa->extensiones) {
+            fprintf(stderr, "Error: No se pudo asignar memoria para el mapa de huecos\n");
+            return -1;
+        }
+    }
+    
+    uint64_t fin_anterior = 0;
+    for (uint64_t i = 0; i < num_extensiones; i++) {
+        uint64_t desplazamiento = leer_u64(datos + pos);
+        uint64_t longitud = leer_u64(datos + pos + 8);
+        pos += 16;
+        
+        // Las regiones deben estar ordenadas y dentro del tamaño lógico
+        if (desplazamiento < fin_anterior || longitud > tamano_logico ||
+            desplazamiento > tamano_logico - longitud) {
+            fprintf(stderr, "Error: Cabecera de archivo disperso corrupta\n");
+            liberar_mapa_disperso(mapa);
+            return -1;
+        }
+        mapa->extensiones[i].desplazamiento = (off_t)desplazamiento;
+        mapa->extensiones[i].longitud = (size_t)longitud;
+        fin_anterior = desplazamiento + longitud;
+    }
+    
+    mapa->num_extensiones = (size_t)num_extensiones;
+    mapa->tamano_logico = (size_t)tamano_logico;
+    mapa->tiene_huecos = 1;
+    *consumidos = pos;
+    return 1;
+}
+
+/**
+ * Indica si un archivo abierto contiene huecos
+ */
+int descriptor_tiene_huecos(int fd, off_t tamano) {
+    if (tamano <= 0) {
+        return 0;
+    }
+    off_t primer_hueco = lseek(fd, 0, SEEK_HOLE);
+    return primer_hueco != -1 && primer_hueco < tamano;
+}
+
+/**
+ * Libera la memoria asignada a un mapa disperso
+ */
+void liberar_mapa_disperso(MapaDisperso* mapa) {
+    if (!mapa) return;
+    
+    liberar_asignacion(mapa->extensiones);
+    mapa->extensiones = NULL;
+    mapa->num_extensiones = 0;
+    mapa->tiene_huecos = 0;
+}
@@ -0,0 +1,232 @@
+#define _GNU_SOURCE // clock_gettime() y pthread_cond_timedwait()
+#include "../include/log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include <time.h>
+
+// Anillo de mensajes de un hilo: solo lo escribe su hilo y solo lo vacía el escritor
+typedef struct AnilloLog {
+    pthread_mutex_t mutex;      // Protege los campos siguientes (solo compiten el hilo y el escritor)
+    pthread_cond_t espacio;     // Señala que el escritor vació el anillo
+    char datos[TAMANO_ANILLO_LOG];
+    size_t escritos;            // Bytes escritos desde el inicio (la posición es módulo el tamaño)
+    size_t leidos;              // Bytes vaciados desde el inicio
+    int abandonado;             // El hilo terminó: se libera al quedar vacío
+    struct AnilloLog* siguiente;
+} AnilloLog;
+
+static struct {
+    pthread_mutex_t mutex;      // Protege la lista de anillos y ordena las escrituras en stdout
+    pthread_cond_t aviso;       // Despierta al escritor antes de que acabe su periodo
+    pthread_key_t clave;        // Anillo de cada hilo
+    pthread_t escritor;
+    pthread_t principal;        // Hilo que escribe directamente
+    AnilloLog* anillos;
+    int nivel;
+    int activo;
+    int terminando;
+    FILE* destino;              // stdout, o stderr si stdout lleva otra salida (NULL = stdout)
+    char salida[TAMANO_ANILLO_LOG];
+} estado_log = { .mutex = PTHREAD_MUTEX_INITIALIZER, .aviso = PTHREAD_COND_INITIALIZER, .nivel = NIVEL_LOG_INFO };
+
+// Flujo en el que se escriben los mensajes
+static FILE* destino_log(void) {
+    return estado_log.destino ? estado_log.destino : stdout;
+}
+
+// Destructor de la clave: el escritor libera el anillo cuando lo vacíe
+static void abandonar_anillo(void* valor) {
+    AnilloLog* anillo = valor;
+    pthread_mutex_lock(&anillo->mutex);
+    anillo->abandonado = 1;
+    pthread_mutex_unlock(&anillo->mutex);
+}
+
+// Vuelca los anillos al destino y libera los abandonados (con estado_log.mutex tomado)
+static void vaciar_anillos(void) {
+    AnilloLog** enlace = &estado_log.anillos;
+    while (*enlace) {
+        AnilloLog* anillo = *enlace;
+
+        // Los mensajes se copian enteros, así que no se mezclan líneas de hilos distintos
+        pthread_mutex_lock(&anillo->mutex);
+        size_t pendientes = anillo->escritos - anillo->leidos;
+        size_t inicio = anillo->leidos % TAMANO_ANILLO_LOG;
+        size_t primero = pendientes < TAMANO_ANILLO_LOG - inicio ? pendientes : TAMANO_ANILLO_LOG - inicio;
+        memcpy(estado_log.salida, anillo->datos + inicio, primero);
+        memcpy(estado_log.salida + primero, anillo->datos, pendientes - primero);
+        anillo->leidos = anillo->escritos;
+        int abandonado = anillo->abandonado;
+        pthread_cond_broadcast(&anillo->espacio);
+        pthread_mutex_unlock(&anillo->mutex);
+
+        if (pendientes > 0) {
+            fwrite(estado_log.salida, 1, pendientes, destino_log());
+        }
+        if (abandonado) {
+            *enlace = anillo->siguiente;
+            pthread_cond_destroy(&anillo->espacio);
+            pthread_mutex_destroy(&anillo->mutex);
+            free(anillo);
+        } else {
+            enlace = &anillo->siguiente;
+        }
+    }
+    fflush(destino_log());
+}
+
+// Hilo escritor: vacía los anillos cada PERIODO_VACIADO_LOG_MS o cuando un hilo lo avisa
+static void* hilo_escritor_log(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&estado_log.mutex);
+    while (!estado_log.terminando) {
+        struct timespec limite;
+        clock_gettime(CLOCK_REALTIME, &limite);
+        limite.tv_nsec += (long)PERIODO_VACIADO_LOG_MS * 1000000L;
+        if (limite.tv_nsec >= 1000000000L) {
+            limite.tv_sec++;
+            limite.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&estado_log.aviso, &estado_log.mutex, &limite);
+        vaciar_anillos();
+    }
+    vaciar_anillos();
+    pthread_mutex_unlock(&estado_log.mutex);
+    return NULL;
+}
+
+// Anillo del hilo llamador, creado y registrado en su primer mensaje
+static AnilloLog* anillo_del_hilo(void) {
+    AnilloLog* anillo = pthread_getspecific(estado_log.clave);
+    if (anillo) {
+        return anillo;
+    }
+
+    anillo = calloc(1, sizeof(AnilloLog));
+    if (!anillo) {
+        return NULL;
+    }
+    pthread_mutex_init(&anillo->mutex, NULL);
+    pthread_cond_init(&anillo->espacio, NULL);
+    if (pthread_setspecific(estado_log.clave, anillo) != 0) {
+        pthread_cond_destroy(&anillo->espacio);
+        pthread_mutex_destroy(&anillo->mutex);
+        free(anillo);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&estado_log.mutex);
+    anillo->siguiente = estado_log.anillos;
+    estado_log.anillos = anillo;
+    pthread_mutex_unlock(&estado_log.mutex);
+    return anillo;
+}
+
+// Copia un mensaje al anillo, esperando a que el escritor haga sitio si está lleno
+static void encolar_mensaje(AnilloLog* anillo, const char* mensaje, size_t largo) {
+    pthread_mutex_lock(&anillo->mutex);
+    while (TAMANO_ANILLO_LOG - (anillo->escritos - anillo->leidos) < largo) {
+        pthread_cond_signal(&estado_log.aviso);
+        pthread_cond_wait(&anillo->espacio, &anillo->mutex);
+    }
+
+    size_t inicio = anillo->escritos % TAMANO_ANILLO_LOG;
+    size_t primero = largo < TAMANO_ANILLO_LOG - inicio ? largo : TAMANO_ANILLO_LOG - inicio;
+    memcpy(anillo->datos + inicio, mensaje, primero);
+    memcpy(anillo->datos, mensaje + primero, largo - primero);
+    anillo->escritos += largo;
+
+    // Con medio anillo ocupado no se espera al siguiente periodo
+    int avisar = anillo->escritos - anillo->leidos > TAMANO_ANILLO_LOG / 2;
+    pthread_mutex_unlock(&anillo->mutex);
+    if (avisar) {
+        pthread_cond_signal(&estado_log.aviso);
+    }
+}
+
+// Escribe un mensaje en el destino después de los que estaban pendientes
+static void escribir_directo(const char* mensaje, size_t largo) {
+    pthread_mutex_lock(&estado_log.mutex);
+    if (estado_log.activo) {
+        vaciar_anillos();
+    }
+    fwrite(mensaje, 1, largo, destino_log());
+    pthread_mutex_unlock(&estado_log.mutex);
+}
+
+int iniciar_log(NivelLog nivel, FILE* destino) {
+    estado_log.nivel = nivel;
+    estado_log.destino = destino;
+    if (estado_log.activo) {
+        return 0;
+    }
+
+    if (pthread_key_create(&estado_log.clave, abandonar_anillo) != 0) {
+        fprintf(stderr, "Error: No se pudo crear el registro de mensajes\n");
+        return -1;
+    }
+    estado_log.principal = pthread_self();
+    estado_log.terminando = 0;
+    if (pthread_create(&estado_log.escritor, NULL, hilo_escritor_log, NULL) != 0) {
+        fprintf(stderr, "Error: No se pudo crear el hilo escritor de mensajes\n");
+        pthread_key_delete(estado_log.clave);
+        return -1;
+    }
+    estado_log.activo = 1;
+    atexit(terminar_log);
+    return 0;
+}
+
+void terminar_log(void) {
+    pthread_mutex_lock(&estado_log.mutex);
+    if (!estado_log.activo) {
+        pthread_mutex_unlock(&estado_log.mutex);
+        return;
+    }
+    estado_log.terminando = 1;
+    pthread_cond_signal(&estado_log.aviso);
+    pthread_mutex_unlock(&estado_log.mutex);
+
+    // El escritor hace un último vaciado antes de salir
+    pthread_join(estado_log.escritor, NULL);
+    pthread_mutex_lock(&estado_log.mutex);
+    estado_log.activo = 0;
+    pthread_mutex_unlock(&estado_log.mutex);
+}
+
+int log_activo(NivelLog nivel) {
+    return (int)nivel <= estado_log.nivel;
+}
+
+void escribir_log(NivelLog nivel, const char* formato, ...) {
+    if (!log_activo(nivel)) {
+        return;
+    }
+
+    // Se deja sitio para el salto de línea
+    char mensaje[LONGITUD_MENSAJE_LOG];
+    va_list argumentos;
+    va_start(argumentos, formato);
+    int largo = vsnprintf(mensaje, sizeof(mensaje) - 1, formato, argumentos);
+    va_end(argumentos);
+    if (largo < 0) {
+        return;
+    }
+    if ((size_t)largo > sizeof(mensaje) - 2) {
+        largo = (int)sizeof(mensaje) - 2;
+    }
+    mensaje[largo++] = '\n';
+
+    AnilloLog* anillo = NULL;
+    if (estado_log.activo && !pthread_equal(pthread_self(), estado_log.principal)) {
+        anillo = anillo_del_hilo();
+    }
+    if (anillo) {
+        encolar_mensaje(anillo, mensaje, (size_t)largo);
+    } else {
+        escribir_directo(mensaje, (size_t)largo);
+    }
+}
@@ -3,10 +3,72 @@
 #include "../include/compression.h"
 #include "../include/encryption.h"
 #include "../include/directory_processor.h"
+#include "../include/pipeline.h"
+#include "../include/stream_processor.h"
+#include "../include/cgroup.h"
+#include "../include/scheduler.h"
+#include "../include/log.h"
+#include "../include/run_stats.h"
+#include "../include/trace.h"
+#include "../include/perf_counters.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+/**
+ * Escribe las estadísticas de la ejecución en JSON (--stats=json), la traza
+ * de los hilos (--trace) y los contadores de hardware (--perf-counters) si se
+ * pidieron
+ * 
+ * @param args Argumentos de la línea de comandos
+ * @param operacion Operación realizada ("-c", "-ce", "--pipeline rle,vigenere"...)
+ * @param es_dir 1 si la entrada es un directorio
+ * @param inicio Instante en que empezó la operación (iniciar_medida)
+ * @param resultado 0 si la operación fue exitosa
+ */
+static void emitir_estadisticas(const Argumentos* args, const char* operacion, int es_dir,
+                                double inicio, int resultado) {
+    // Con un archivo individual la operación entera es la latencia del archivo
+    if (!es_dir && resultado == 0) {
+        ssize_t tamano = obtener_tamano_archivo(args->archivo_entrada);
+        registrar_medida(MEDIDA_ARCHIVO, inicio, tamano > 0 ? (size_t)tamano : 0);
+    }
+    if (args->archivo_traza && escribir_traza(args->archivo_traza) == 0) {
+        LOG_INFO("Traza escrita en %s", args->archivo_traza);
+    }
+    if (args->contadores_hw) {
+        informar_contadores_hw();
+    }
+    if (!args->estadisticas_json) {
+        return;
+    }
+    
+    FILE* destino = stdout;
+    if (args->archivo_estadisticas) {
+        destino = fopen(args->archivo_estadisticas, "w");
+        if (!destino) {
+            fprintf(stderr, "Error: No se pudo crear el archivo de estadísticas '%s'\n", args->archivo_estadisticas);
+            return;
+        }
+    }
+    if (escribir_estadisticas_json(destino, operacion, args->archivo_entrada, resultado) != 0) {
+        fprintf(stderr, "Error: No se pudieron escribir las estadísticas\n");
+    }
+    if (destino != stdout) {
+        fclose(destino);
+    }
+}
+
+// Opción de línea de comandos de una operación simple
+static const char* opcion_operacion(char operacion) {
+    switch (operacion) {
+        case 'c': return "-c";
+        case 'd': return "-d";
+        case 'e': return "-e";
+        default:  return "-u";
+    }
+}
+
 /**
  * Función principal del programa GSEA
  * 
@@ -19,15 +81,33 @@
  * @return 0 si todo salió bien, 1 si hubo algún error
  */
 int main(int argc, char* argv[]) {
-    printf("GSEA - Utilidad de Gestión Segura y Eficiente de Archivos\n");
-    printf("Versión: 3.0 (Fase 3 - Concurrencia + Operaciones Combinadas)\n\n");
-    
     // Parsear argumentos de línea de comandos
     Argumentos* args = parsear_argumentos(argc, argv);
     if (!args) {
         return 1;
     }
     
+    // Los hilos dejan sus mensajes en anillos propios y un hilo en segundo plano los escribe;
+    // con --stats=json sin archivo, stdout queda solo para el JSON
+    int json_en_stdout = args->estadisticas_json && !args->archivo_estadisticas;
+    iniciar_log((NivelLog)args->nivel_log, json_en_stdout ? stderr : stdout);
+    
+    // El encabezado es informativo: -q lo omite
+    LOG_INFO("GSEA - Utilidad de Gestión Segura y Eficiente de Archivos");
+    LOG_INFO("Versión: 3.0 (Fase 3 - Concurrencia + Operaciones Combinadas)\n");
+    
+    // Cada hilo mide en sus propios histogramas; se combinan al final
+    if (args->estadisticas_json) {
+        iniciar_estadisticas();
+    }
+    if (args->archivo_traza && iniciar_traza() == 0) {
+        etiquetar_traza(args->archivo_entrada);
+    }
+    if (args->contadores_hw) {
+        iniciar_contadores_hw(); // Sin permiso avisa y sigue sin contadores
+    }
+    double inicio = iniciar_medida();
+    
     // Verificar que el archivo o directorio de entrada existe
     int existe = archivo_existe(args->archivo_entrada);
     if (existe == 0) {
@@ -40,30 +120,115 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
-    // Verificar operaciones combinadas primero
-    if (args->operacion_combinada) {
-        printf("Procesando operación combinada: %s\n", args->operacion_combinada);
+    // Opciones de concurrencia para directorios y archivos grandes
+    OpcionesConcurrencia opciones;
+    opciones.num_hilos = args->num_hilos;
+    opciones.orden_fifo = args->orden_fifo;
+    opciones.umbral_bloques = args->umbral_bloques;
+    opciones.tamano_bloque = args->tamano_bloque;
+    opciones.paginas_enormes = args->paginas_enormes;
+    // Sin --limite-memoria, el límite de memoria del cgroup fija el presupuesto
+    opciones.limite_memoria = args->limite_memoria ? args->limite_memoria : limite_memoria_por_defecto();
+    opciones.hilos_lectura = args->hilos_lectura;
+    opciones.hilos_escritura = args->hilos_escritura;
+    opciones.fijar_nodos = args->fijar_nodos;
+    opciones.progreso = (FormatoProgreso)args->progreso;
+    
+    // Los hilos por defecto ya respetan la cuota de CPU del cgroup
+    if (obtener_limites_cgroup()->version > 0) {
+        char limites[256];
+        describir_limites_cgroup(limites, sizeof(limites));
+        LOG_INFO("Límites del %s", limites);
+        if (!args->limite_memoria && opciones.limite_memoria > 0) {
+            LOG_INFO("Límite de memoria por defecto: %zu bytes (memory.max / %d)",
+                     opciones.limite_memoria, FRACCION_MEMORIA_CGROUP);
+        }
+    }
+    
+    // Verificar si la entrada es un directorio
+    int es_dir = es_directorio(args->archivo_entrada);
+    if (es_dir == -1) {
+        fprintf(stderr, "Error: No se pudo verificar el tipo de entrada '%s'\n", args->archivo_entrada);
+        liberar_argumentos(args);
+        return 1;
+    }
+    
+    // Los límites elegidos acompañan a las estadísticas; las arenas solo
+    // existen al procesar directorios
+    if (args->estadisticas_json) {
+        const LimitesCgroup* cgroup = obtener_limites_cgroup();
+        LimitesEjecucion limites;
+        limites.version_cgroup = cgroup->version;
+        limites.cpus_cgroup = cgroup->cpus;
+        limites.memoria_cgroup = cgroup->memoria;
+        limites.hilos = opciones.num_hilos > 0 ? opciones.num_hilos : obtener_num_nucleos();
+        limites.limite_memoria = opciones.limite_memoria;
+        limites.limite_por_defecto = !args->limite_memoria && opciones.limite_memoria > 0;
+        limites.memoria_arenas = es_dir ? opciones.limite_memoria / FRACCION_MEMORIA_ARENAS : 0;
+        registrar_limites_ejecucion(&limites);
+    }
+    
+    // Pipeline de etapas encadenadas
+    if (args->pipeline) {
+        EspecificacionPipeline especificacion;
+        if (parsear_pipeline(args->pipeline, &especificacion) != 0) {
+            liberar_argumentos(args);
+            return 1;
+        }
         
-        int resultado = procesar_operacion_combinada(args->archivo_entrada, args->archivo_salida,
-                                                    args->operacion_combinada, args->algoritmo_comp,
-                                                    args->algoritmo_enc, args->clave);
+        char descripcion[256];
+        describir_pipeline(&especificacion, descripcion, sizeof(descripcion));
+        LOG_RESUMEN("Procesando pipeline: %s", descripcion);
         
+        int resultado;
+        if (es_dir == 1) {
+            resultado = procesar_directorio_pipeline(args->archivo_entrada, args->archivo_salida,
+                                                     &especificacion, args->clave, &opciones);
+        } else {
+            resultado = procesar_archivo_pipeline(args->archivo_entrada, args->archivo_salida,
+                                                  &especificacion, args->clave, TAMANO_TROZO_FLUJO, 1);
+        }
+        
+        if (resultado == 0) {
+            LOG_RESUMEN("Pipeline completado exitosamente");
+        } else {
+            LOG_RESUMEN("Error en el pipeline");
+        }
+        char operacion[300];
+        snprintf(operacion, sizeof(operacion), "--pipeline %s", args->pipeline);
+        emitir_estadisticas(args, operacion, es_dir, inicio, resultado);
         liberar_argumentos(args);
+        return resultado == 0 ? 0 : 1;
+    }
+    
+    // Verificar operaciones combinadas primero
+    if (args->operacion_combinada) {
+        LOG_RESUMEN("Procesando operación combinada: %s", args->operacion_combinada);
+        
+        int resultado;
+        if (es_dir == 1) {
+            resultado = procesar_directorio_combinado(args->archivo_entrada, args->archivo_salida,
+                                                      args->operacion_combinada, args->algoritmo_comp,
+                                                      args->algoritmo_enc, args->clave, &opciones);
+        } else {
+            resultado = procesar_operacion_combinada(args->archivo_entrada, args->archivo_salida,
+                                                     args->operacion_combinada, args->algoritmo_comp,
+                                                     args->algoritmo_enc, args->clave);
+        }
         
         if (resultado == 0) {
-            printf("Operación combinada completada exitosamente\n");
-            return 0;
+            LOG_RESUMEN("Operación combinada completada exitosamente");
         } else {
-            printf("Error en la operación combinada\n");
-            return 1;
+            LOG_RESUMEN("Error en la operación combinada");
         }
+        emitir_estadisticas(args, args->operacion_combinada, es_dir, inicio, resultado);
+        liberar_argumentos(args);
+        return resultado == 0 ? 0 : 1;
     }
     
-    // Verificar si la entrada es un directorio
-    int es_dir = es_directorio(args->archivo_entrada);
     if (es_dir == 1) {
         // Procesar directorio completo CON CONCURRENCIA
-        printf("Procesando directorio CON CONCURRENCIA: %s\n", args->archivo_entrada);
+        LOG_RESUMEN("Procesando directorio CON CONCURRENCIA: %s", args->archivo_entrada);
         
         char operacion = 'c'; // Por defecto comprimir
         if (args->comprimir) operacion = 'c';
@@ -73,202 +238,70 @@ int main(int argc, char* argv[]) {
         
         int resultado = procesar_directorio(args->archivo_entrada, args->archivo_salida,
                                            operacion, args->algoritmo_comp, 
-                                           args->algoritmo_enc, args->clave);
-        
-        liberar_argumentos(args);
+                                           args->algoritmo_enc, args->clave, &opciones);
         
         if (resultado == 0) {
-            printf("Procesamiento concurrente de directorio completado exitosamente\n");
-            return 0;
+            LOG_RESUMEN("Procesamiento concurrente de directorio completado exitosamente");
         } else {
-            printf("Error en el procesamiento del directorio\n");
-            return 1;
+            LOG_RESUMEN("Error en el procesamiento del directorio");
         }
-    } else if (es_dir == -1) {
-        fprintf(stderr, "Error: No se pudo verificar el tipo de entrada '%s'\n", args->archivo_entrada);
+        emitir_estadisticas(args, opcion_operacion(operacion), es_dir, inicio, resultado);
         liberar_argumentos(args);
-        return 1;
+        return resultado == 0 ? 0 : 1;
     }
     
     // Si llegamos aquí, es un archivo individual
+    char operacion;
+    const char* descripcion;
     
-    // Leer el archivo de entrada
-    char* contenido_original = NULL;
-    size_t tamano_original = 0;
-    
-    printf("Leyendo archivo: %s\n", args->archivo_entrada);
-    if (leer_archivo(args->archivo_entrada, &contenido_original, &tamano_original) != 0) {
-        fprintf(stderr, "Error: No se pudo leer el archivo de entrada\n");
-        liberar_argumentos(args);
-        return 1;
-    }
-    
-    printf("Archivo leído exitosamente: %zu bytes\n", tamano_original);
-    
-    // Procesar según la operación solicitada
-    if (args->comprimir) {
-        printf("Iniciando compresión con algoritmo: %s\n", args->algoritmo_comp);
+    if (args->comprimir || args->descomprimir) {
+        operacion = args->comprimir ? 'c' : 'd';
+        descripcion = args->comprimir ? "Compresión" : "Descompresión";
+        LOG_INFO("Iniciando %s con algoritmo: %s",
+                 args->comprimir ? "compresión" : "descompresión", args->algoritmo_comp);
         
         // Verificar que el algoritmo sea RLE
         if (strcmp(args->algoritmo_comp, "rle") != 0) {
             fprintf(stderr, "Error: Solo se soporta el algoritmo 'rle' en esta versión\n");
-            liberar_datos(contenido_original);
-            liberar_argumentos(args);
-            return 1;
-        }
-        
-        // Comprimir los datos
-        char* datos_comprimidos = NULL;
-        size_t tamano_comprimido = 0;
-        
-        if (comprimir_rle(contenido_original, tamano_original, &datos_comprimidos, &tamano_comprimido) != 0) {
-            fprintf(stderr, "Error: No se pudo comprimir el archivo\n");
-            liberar_datos(contenido_original);
-            liberar_argumentos(args);
-            return 1;
-        }
-        
-        // Escribir el archivo comprimido
-        printf("Escribiendo archivo comprimido: %s\n", args->archivo_salida);
-        if (escribir_archivo(args->archivo_salida, datos_comprimidos, tamano_comprimido) != 0) {
-            fprintf(stderr, "Error: No se pudo escribir el archivo comprimido\n");
-            liberar_datos(contenido_original);
-            liberar_datos(datos_comprimidos);
             liberar_argumentos(args);
             return 1;
         }
-        
-        printf("Compresión completada exitosamente\n");
-        liberar_datos(datos_comprimidos);
-        
-    } else if (args->descomprimir) {
-        printf("Iniciando descompresión con algoritmo: %s\n", args->algoritmo_comp);
-        
-        // Verificar que el algoritmo sea RLE
-        if (strcmp(args->algoritmo_comp, "rle") != 0) {
-            fprintf(stderr, "Error: Solo se soporta el algoritmo 'rle' en esta versión\n");
-            liberar_datos(contenido_original);
-            liberar_argumentos(args);
-            return 1;
-        }
-        
-        // Descomprimir los datos
-        char* datos_descomprimidos = NULL;
-        size_t tamano_descomprimido = 0;
-        
-        if (descomprimir_rle(contenido_original, tamano_original, &datos_descomprimidos, &tamano_descomprimido) != 0) {
-            fprintf(stderr, "Error: No se pudo descomprimir el archivo\n");
-            liberar_datos(contenido_original);
-            liberar_argumentos(args);
-            return 1;
-        }
-        
-        // Escribir el archivo descomprimido
-        printf("Escribiendo archivo descomprimido: %s\n", args->archivo_salida);
-        if (escribir_archivo(args->archivo_salida, datos_descomprimidos, tamano_descomprimido) != 0) {
-            fprintf(stderr, "Error: No se pudo escribir el archivo descomprimido\n");
-            liberar_datos(contenido_original);
-            liberar_datos(datos_descomprimidos);
-            liberar_argumentos(args);
-            return 1;
-        }
-        
-        printf("Descompresión completada exitosamente\n");
-        liberar_datos(datos_descomprimidos);
-        
-    } else if (args->encriptar) {
-        printf("Iniciando encriptación con algoritmo: %s\n", args->algoritmo_enc);
+    } else {
+        operacion = args->encriptar ? 'e' : 'u';
+        descripcion = args->encriptar ? "Encriptación" : "Desencriptación";
+        LOG_INFO("Iniciando %s con algoritmo: %s",
+                 args->encriptar ? "encriptación" : "desencriptación", args->algoritmo_enc);
         
         // Verificar que el algoritmo sea Vigenère
         if (strcmp(args->algoritmo_enc, "vigenere") != 0) {
             fprintf(stderr, "Error: Solo se soporta el algoritmo 'vigenere' en esta versión\n");
-            liberar_datos(contenido_original);
             liberar_argumentos(args);
             return 1;
         }
         
         // Verificar que se proporcionó una clave
         if (!args->clave) {
-            fprintf(stderr, "Error: Se requiere una clave (-k) para encriptación\n");
-            liberar_datos(contenido_original);
-            liberar_argumentos(args);
-            return 1;
-        }
-        
-        // Encriptar los datos
-        char* datos_encriptados = NULL;
-        size_t tamano_encriptado = 0;
-        
-        if (encriptar_vigenere(contenido_original, tamano_original, args->clave, 
-                               &datos_encriptados, &tamano_encriptado) != 0) {
-            fprintf(stderr, "Error: No se pudo encriptar el archivo\n");
-            liberar_datos(contenido_original);
+            fprintf(stderr, "Error: Se requiere una clave (-k) para %s\n",
+                    args->encriptar ? "encriptación" : "desencriptación");
             liberar_argumentos(args);
             return 1;
         }
-        
-        // Escribir el archivo encriptado
-        printf("Escribiendo archivo encriptado: %s\n", args->archivo_salida);
-        if (escribir_archivo(args->archivo_salida, datos_encriptados, tamano_encriptado) != 0) {
-            fprintf(stderr, "Error: No se pudo escribir el archivo encriptado\n");
-            liberar_datos(contenido_original);
-            liberar_datos_encriptados(datos_encriptados);
-            liberar_argumentos(args);
-            return 1;
-        }
-        
-        printf("Encriptación completada exitosamente\n");
-        liberar_datos_encriptados(datos_encriptados);
-        
-    } else if (args->desencriptar) {
-        printf("Iniciando desencriptación con algoritmo: %s\n", args->algoritmo_enc);
-        
-        // Verificar que el algoritmo sea Vigenère
-        if (strcmp(args->algoritmo_enc, "vigenere") != 0) {
-            fprintf(stderr, "Error: Solo se soporta el algoritmo 'vigenere' en esta versión\n");
-            liberar_datos(contenido_original);
-            liberar_argumentos(args);
-            return 1;
-        }
-        
-        // Verificar que se proporcionó una clave
-        if (!args->clave) {
-            fprintf(stderr, "Error: Se requiere una clave (-k) para desencriptación\n");
-            liberar_datos(contenido_original);
-            liberar_argumentos(args);
-            return 1;
-        }
-        
-        // Desencriptar los datos
-        char* datos_desencriptados = NULL;
-        size_t tamano_desencriptado = 0;
-        
-        if (desencriptar_vigenere(contenido_original, tamano_original, args->clave,
-                                  &datos_desencriptados, &tamano_desencriptado) != 0) {
-            fprintf(stderr, "Error: No se pudo desencriptar el archivo\n");
-            liberar_datos(contenido_original);
-            liberar_argumentos(args);
-            return 1;
-        }
-        
-        // Escribir el archivo desencriptado
-        printf("Escribiendo archivo desencriptado: %s\n", args->archivo_salida);
-        if (escribir_archivo(args->archivo_salida, datos_desencriptados, tamano_desencriptado) != 0) {
-            fprintf(stderr, "Error: No se pudo escribir el archivo desencriptado\n");
-            liberar_datos(contenido_original);
-            liberar_datos_encriptados(datos_desencriptados);
-            liberar_argumentos(args);
-            return 1;
-        }
-        
-        printf("Desencriptación completada exitosamente\n");
-        liberar_datos_encriptados(datos_desencriptados);
     }
     
-    // Limpiar memoria
-    liberar_datos(contenido_original);
-    liberar_argumentos(args);
+    // Leer, transformar y escribir el archivo (los huecos de archivos dispersos se conservan)
+    LOG_INFO("Procesando archivo: %s -> %s", args->archivo_entrada, args->archivo_salida);
+    if (procesar_archivo_concurrente(args->archivo_entrada, args->archivo_salida, operacion,
+                                     args->algoritmo_comp, args->algoritmo_enc, args->clave,
+                                     &opciones) != 0) {
+        fprintf(stderr, "Error: No se pudo procesar el archivo '%s'\n", args->archivo_entrada);
+        emitir_estadisticas(args, opcion_operacion(operacion), es_dir, inicio, -1);
+        liberar_argumentos(args);
+        return 1;
+    }
     
-    printf("Operación completada exitosamente\n");
+    LOG_INFO("%s completada exitosamente", descripcion);
+    LOG_RESUMEN("Operación completada exitosamente");
+    emitir_estadisticas(args, opcion_operacion(operacion), es_dir, inicio, 0);
+    liberar_argumentos(args);
     return 0;
 }
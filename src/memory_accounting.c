@@ -0,0 +1,275 @@
+#include "../include/memory_accounting.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+// Cabecera de cada asignación; el tamaño de la unión mantiene la alineación de malloc
+typedef union {
+    struct {
+        size_t bytes;
+        unsigned int subsistema;
+        unsigned int contabilizada; // Se asignó con la contabilidad activa
+    } info;
+    long double alineacion_real;
+    long long alineacion_entera;
+    void* alineacion_puntero;
+} CabeceraAsignacion;
+
+static const char* const NOMBRES_SUBSISTEMAS[NUM_SUBSISTEMAS_MEMORIA] = {
+    "archivos", "buffers", "compresion", "encriptacion", "bloques",
+    "flujo", "directorios", "planificador", "pilas_hilos"
+};
+
+// Contadores de un hilo: solo los escribe su hilo y se suman al pedir las
+// estadísticas, que pueden leerse con los hilos en marcha (accesos atómicos)
+typedef struct ContadoresHilo {
+    size_t total[NUM_SUBSISTEMAS_MEMORIA];
+    size_t asignaciones[NUM_SUBSISTEMAS_MEMORIA];
+    size_t liberaciones[NUM_SUBSISTEMAS_MEMORIA];
+    struct ContadoresHilo* siguiente;
+} ContadoresHilo;
+
+static pthread_mutex_t mutex_memoria = PTHREAD_MUTEX_INITIALIZER; // Protege la lista de contadores
+static pthread_key_t clave_contadores;
+static ContadoresHilo* contadores_hilos = NULL;
+static ContadoresHilo contadores_compartidos; // Hilos sin contadores propios (con atómicas)
+
+// Un bloque puede liberarse en otro hilo, así que los bytes en uso y los picos
+// se comparten y se actualizan con atómicas; con signo por si una liberación
+// se adelanta a su asignación en otro hilo
+static long long actual_subsistemas[NUM_SUBSISTEMAS_MEMORIA];
+static long long pico_subsistemas[NUM_SUBSISTEMAS_MEMORIA];
+static long long actual_total = 0;
+static long long pico_total = 0;
+static int activa = 0;
+
+void iniciar_contabilidad_memoria(void) {
+    if (activa) {
+        return;
+    }
+    // Los contadores sobreviven a sus hilos: se suman al final
+    if (pthread_key_create(&clave_contadores, NULL) != 0) {
+        fprintf(stderr, "Advertencia: No se pudo activar la contabilidad de memoria\n");
+        return;
+    }
+    activa = 1;
+}
+
+// Contadores del hilo llamador, creados y registrados en su primera anotación
+static ContadoresHilo* contadores_del_hilo(void) {
+    ContadoresHilo* contadores = pthread_getspecific(clave_contadores);
+    if (contadores) {
+        return contadores;
+    }
+
+    // calloc y no asignar_memoria: los contadores no se contabilizan a sí mismos
+    contadores = calloc(1, sizeof(ContadoresHilo));
+    if (!contadores) {
+        return NULL;
+    }
+    if (pthread_setspecific(clave_contadores, contadores) != 0) {
+        free(contadores);
+        return NULL;
+    }
+    pthread_mutex_lock(&mutex_memoria);
+    contadores->siguiente = contadores_hilos;
+    contadores_hilos = contadores;
+    pthread_mutex_unlock(&mutex_memoria);
+    return contadores;
+}
+
+// Cuenta una operación en los contadores del hilo o, si no los tiene, en los compartidos
+static void contar(size_t* propio, size_t* compartido, size_t cantidad) {
+    if (propio) {
+        // Solo escribe este hilo: basta leer y escribir sin operación atómica compuesta
+        __atomic_store_n(propio, __atomic_load_n(propio, __ATOMIC_RELAXED) + cantidad, __ATOMIC_RELAXED);
+    } else {
+        __atomic_add_fetch(compartido, cantidad, __ATOMIC_RELAXED);
+    }
+}
+
+// Sube un pico hasta valor si lo supera
+static void elevar_pico(long long* pico, long long valor) {
+    long long anterior = __atomic_load_n(pico, __ATOMIC_RELAXED);
+    while (valor > anterior &&
+           !__atomic_compare_exchange_n(pico, &anterior, valor, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+static void anotar_asignacion(SubsistemaMemoria subsistema, size_t bytes) {
+    ContadoresHilo* contadores = contadores_del_hilo();
+    contar(contadores ? &contadores->total[subsistema] : NULL,
+           &contadores_compartidos.total[subsistema], bytes);
+    contar(contadores ? &contadores->asignaciones[subsistema] : NULL,
+           &contadores_compartidos.asignaciones[subsistema], 1);
+
+    long long cantidad = (long long)bytes;
+    elevar_pico(&pico_subsistemas[subsistema],
+                __atomic_add_fetch(&actual_subsistemas[subsistema], cantidad, __ATOMIC_RELAXED));
+    elevar_pico(&pico_total, __atomic_add_fetch(&actual_total, cantidad, __ATOMIC_RELAXED));
+}
+
+static void anotar_liberacion(SubsistemaMemoria subsistema, size_t bytes) {
+    ContadoresHilo* contadores = contadores_del_hilo();
+    contar(contadores ? &contadores->liberaciones[subsistema] : NULL,
+           &contadores_compartidos.liberaciones[subsistema], 1);
+
+    long long cantidad = (long long)bytes;
+    __atomic_sub_fetch(&actual_subsistemas[subsistema], cantidad, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&actual_total, cantidad, __ATOMIC_RELAXED);
+}
+
+void* asignar_memoria(SubsistemaMemoria subsistema, size_t bytes) {
+    if (subsistema >= NUM_SUBSISTEMAS_MEMORIA || bytes > (size_t)-1 - sizeof(CabeceraAsignacion)) {
+        return NULL;
+    }
+    CabeceraAsignacion* cabecera = malloc(sizeof(CabeceraAsignacion) + bytes);
+    if (!cabecera) {
+        return NULL;
+    }
+    cabecera->info.bytes = bytes;
+    cabecera->info.subsistema = (unsigned int)subsistema;
+    cabecera->info.contabilizada = (unsigned int)activa;
+    if (activa) {
+        anotar_asignacion(subsistema, bytes);
+    }
+    return cabecera + 1;
+}
+
+void* asignar_memoria_ceros(SubsistemaMemoria subsistema, size_t numero, size_t tamano) {
+    if (tamano != 0 && numero > (size_t)-1 / tamano) {
+        return NULL;
+    }
+    void* memoria = asignar_memoria(subsistema, numero * tamano);
+    if (memoria) {
+        memset(memoria, 0, numero * tamano);
+    }
+    return memoria;
+}
+
+void* reasignar_memoria(SubsistemaMemoria subsistema, void* memoria, size_t bytes) {
+    if (!memoria) {
+        return asignar_memoria(subsistema, bytes);
+    }
+    if (subsistema >= NUM_SUBSISTEMAS_MEMORIA || bytes > (size_t)-1 - sizeof(CabeceraAsignacion)) {
+        return NULL;
+    }
+    CabeceraAsignacion* anterior = (CabeceraAsignacion*)memoria - 1;
+    size_t bytes_anteriores = anterior->info.bytes;
+    SubsistemaMemoria subsistema_anterior = (SubsistemaMemoria)anterior->info.subsistema;
+    int contabilizada = (int)anterior->info.contabilizada;
+
+    CabeceraAsignacion* cabecera = realloc(anterior, sizeof(CabeceraAsignacion) + bytes);
+    if (!cabecera) {
+        return NULL;
+    }
+    if (contabilizada) {
+        anotar_liberacion(subsistema_anterior, bytes_anteriores);
+    }
+    cabecera->info.bytes = bytes;
+    cabecera->info.subsistema = (unsigned int)subsistema;
+    cabecera->info.contabilizada = (unsigned int)activa;
+    if (activa) {
+        anotar_asignacion(subsistema, bytes);
+    }
+    return cabecera + 1;
+}
+
+void liberar_asignacion(void* memoria) {
+    if (!memoria) {
+        return;
+    }
+    CabeceraAsignacion* cabecera = (CabeceraAsignacion*)memoria - 1;
+    if (cabecera->info.contabilizada) {
+        anotar_liberacion((SubsistemaMemoria)cabecera->info.subsistema, cabecera->info.bytes);
+    }
+    free(cabecera);
+}
+
+void sumar_memoria(SubsistemaMemoria subsistema, size_t bytes) {
+    if (activa && subsistema < NUM_SUBSISTEMAS_MEMORIA) {
+        anotar_asignacion(subsistema, bytes);
+    }
+}
+
+void restar_memoria(SubsistemaMemoria subsistema, size_t bytes) {
+    if (activa && subsistema < NUM_SUBSISTEMAS_MEMORIA) {
+        anotar_liberacion(subsistema, bytes);
+    }
+}
+
+static size_t tamano_pila = 0;
+static pthread_once_t pila_leida = PTHREAD_ONCE_INIT;
+
+static void leer_tamano_pila(void) {
+    pthread_attr_t atributos;
+    if (pthread_attr_init(&atributos) == 0) {
+        pthread_attr_getstacksize(&atributos, &tamano_pila);
+        pthread_attr_destroy(&atributos);
+    }
+}
+
+size_t tamano_pila_hilos(void) {
+    pthread_once(&pila_leida, leer_tamano_pila);
+    return tamano_pila;
+}
+
+int leer_memoria_proceso(size_t* rss, size_t* pico_rss) {
+    FILE* archivo = fopen("/proc/self/status", "r");
+    if (!archivo) {
+        return -1;
+    }
+    char linea[256];
+    int encontrados = 0;
+    while (fgets(linea, sizeof(linea), archivo)) {
+        unsigned long kb;
+        if (sscanf(linea, "VmRSS: %lu kB", &kb) == 1) {
+            *rss = (size_t)kb * 1024;
+            encontrados++;
+        } else if (sscanf(linea, "VmHWM: %lu kB", &kb) == 1) {
+            *pico_rss = (size_t)kb * 1024;
+            encontrados++;
+        }
+    }
+    fclose(archivo);
+    return encontrados == 2 ? 0 : -1;
+}
+
+// Bytes de un contador compartido, sin los negativos transitorios
+static size_t leer_bytes(long long* contador) {
+    long long valor = __atomic_load_n(contador, __ATOMIC_RELAXED);
+    return valor > 0 ? (size_t)valor : 0;
+}
+
+void obtener_estadisticas_memoria(EstadisticasMemoria* estadisticas) {
+    memset(estadisticas, 0, sizeof(*estadisticas));
+    for (int i = 0; i < NUM_SUBSISTEMAS_MEMORIA; i++) {
+        ContadorMemoria* contador = &estadisticas->subsistemas[i];
+        contador->total = __atomic_load_n(&contadores_compartidos.total[i], __ATOMIC_RELAXED);
+        contador->asignaciones = __atomic_load_n(&contadores_compartidos.asignaciones[i], __ATOMIC_RELAXED);
+        contador->liberaciones = __atomic_load_n(&contadores_compartidos.liberaciones[i], __ATOMIC_RELAXED);
+        contador->actual = leer_bytes(&actual_subsistemas[i]);
+        contador->pico = leer_bytes(&pico_subsistemas[i]);
+    }
+    pthread_mutex_lock(&mutex_memoria);
+    for (ContadoresHilo* hilo = contadores_hilos; hilo; hilo = hilo->siguiente) {
+        for (int i = 0; i < NUM_SUBSISTEMAS_MEMORIA; i++) {
+            estadisticas->subsistemas[i].total += __atomic_load_n(&hilo->total[i], __ATOMIC_RELAXED);
+            estadisticas->subsistemas[i].asignaciones += __atomic_load_n(&hilo->asignaciones[i], __ATOMIC_RELAXED);
+            estadisticas->subsistemas[i].liberaciones += __atomic_load_n(&hilo->liberaciones[i], __ATOMIC_RELAXED);
+        }
+    }
+    pthread_mutex_unlock(&mutex_memoria);
+    estadisticas->actual = leer_bytes(&actual_total);
+    estadisticas->pico = leer_bytes(&pico_total);
+
+    if (leer_memoria_proceso(&estadisticas->rss, &estadisticas->pico_rss) != 0) {
+        estadisticas->rss = 0;
+        estadisticas->pico_rss = 0;
+    }
+}
+
+const char* nombre_subsistema_memoria(SubsistemaMemoria subsistema) {
+    return subsistema < NUM_SUBSISTEMAS_MEMORIA ? NOMBRES_SUBSISTEMAS[subsistema] : "desconocido";
+}
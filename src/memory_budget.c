@@ -0,0 +1,98 @@
+#include "../include/memory_budget.h"
+#include "../include/memory_accounting.h"
+#include <stdlib.h>
+#include <pthread.h>
+
+struct PresupuestoMemoria {
+    pthread_mutex_t mutex;     // Protege los campos siguientes
+    pthread_cond_t liberado;   // Señala que se devolvió memoria
+    size_t limite;
+    size_t en_uso;
+    size_t pico;
+    size_t esperas;
+};
+
+PresupuestoMemoria* crear_presupuesto_memoria(size_t limite) {
+    if (limite == 0) {
+        return NULL;
+    }
+
+    PresupuestoMemoria* presupuesto = asignar_memoria_ceros(MEMORIA_PLANIFICADOR, 1, sizeof(PresupuestoMemoria));
+    if (!presupuesto) {
+        return NULL;
+    }
+
+    pthread_mutex_init(&presupuesto->mutex, NULL);
+    pthread_cond_init(&presupuesto->liberado, NULL);
+    presupuesto->limite = limite;
+    return presupuesto;
+}
+
+// Anota una reserva ya admitida (con el mutex tomado)
+static void anotar_reserva(PresupuestoMemoria* presupuesto, size_t bytes) {
+    presupuesto->en_uso += bytes;
+    if (presupuesto->en_uso > presupuesto->pico) {
+        presupuesto->pico = presupuesto->en_uso;
+    }
+}
+
+size_t reservar_memoria(PresupuestoMemoria* presupuesto, size_t bytes) {
+    if (bytes > presupuesto->limite) {
+        bytes = presupuesto->limite;
+    }
+
+    pthread_mutex_lock(&presupuesto->mutex);
+    if (presupuesto->en_uso + bytes > presupuesto->limite) {
+        presupuesto->esperas++;
+        while (presupuesto->en_uso + bytes > presupuesto->limite) {
+            pthread_cond_wait(&presupuesto->liberado, &presupuesto->mutex);
+        }
+    }
+    anotar_reserva(presupuesto, bytes);
+    pthread_mutex_unlock(&presupuesto->mutex);
+    return bytes;
+}
+
+int intentar_reservar_memoria(PresupuestoMemoria* presupuesto, size_t bytes) {
+    int resultado = -1;
+
+    pthread_mutex_lock(&presupuesto->mutex);
+    if (bytes <= presupuesto->limite && presupuesto->en_uso + bytes <= presupuesto->limite) {
+        anotar_reserva(presupuesto, bytes);
+        resultado = 0;
+    }
+    pthread_mutex_unlock(&presupuesto->mutex);
+    return resultado;
+}
+
+void liberar_memoria(PresupuestoMemoria* presupuesto, size_t bytes) {
+    if (bytes == 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&presupuesto->mutex);
+    presupuesto->en_uso -= bytes;
+    pthread_cond_broadcast(&presupuesto->liberado);
+    pthread_mutex_unlock(&presupuesto->mutex);
+}
+
+size_t obtener_limite_memoria(const PresupuestoMemoria* presupuesto) {
+    return presupuesto->limite;
+}
+
+void obtener_estadisticas_presupuesto(PresupuestoMemoria* presupuesto,
+                                      EstadisticasPresupuesto* estadisticas) {
+    pthread_mutex_lock(&presupuesto->mutex);
+    estadisticas->limite = presupuesto->limite;
+    estadisticas->pico = presupuesto->pico;
+    estadisticas->esperas = presupuesto->esperas;
+    pthread_mutex_unlock(&presupuesto->mutex);
+}
+
+void destruir_presupuesto_memoria(PresupuestoMemoria* presupuesto) {
+    if (!presupuesto) return;
+
+    pthread_cond_destroy(&presupuesto->liberado);
+    pthread_mutex_destroy(&presupuesto->mutex);
+    liberar_asignacion(presupuesto);
+}
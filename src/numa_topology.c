@@ -0,0 +1,122 @@
+#define _GNU_SOURCE // sched_getaffinity(), pthread_setaffinity_np() y CPU_SET
+#include "../include/numa_topology.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+
+#define BITS_POR_PALABRA (8 * sizeof(unsigned long))
+
+static void marcar_cpu(unsigned long* mapa, int cpu) {
+    mapa[cpu / BITS_POR_PALABRA] |= 1UL << (cpu % BITS_POR_PALABRA);
+}
+
+static int cpu_marcada(const unsigned long* mapa, int cpu) {
+    return (mapa[cpu / BITS_POR_PALABRA] >> (cpu % BITS_POR_PALABRA)) & 1UL;
+}
+
+/**
+ * Interpreta una lista de CPUs del kernel ("0-3,8-11") marcando en el nodo
+ * las que también están en la máscara de afinidad
+ *
+ * @return Número de CPUs marcadas, -1 si la lista no es válida
+ */
+static int interpretar_lista_cpus(const char* lista, const cpu_set_t* afinidad, unsigned long* mapa) {
+    int marcadas = 0;
+    const char* p = lista;
+    while (*p && *p != '\n') {
+        char* fin;
+        long primera = strtol(p, &fin, 10);
+        long ultima = primera;
+        if (fin == p || primera < 0) {
+            return -1;
+        }
+        if (*fin == '-') {
+            p = fin + 1;
+            ultima = strtol(p, &fin, 10);
+            if (fin == p || ultima < primera) {
+                return -1;
+            }
+        }
+        for (long cpu = primera; cpu <= ultima && cpu < MAX_CPUS_NUMA; cpu++) {
+            if (CPU_ISSET((int)cpu, afinidad)) {
+                marcar_cpu(mapa, (int)cpu);
+                marcadas++;
+            }
+        }
+        p = *fin == ',' ? fin + 1 : fin;
+    }
+    return marcadas;
+}
+
+int leer_topologia_numa(TopologiaNuma* topologia) {
+    if (!topologia) {
+        return -1;
+    }
+    memset(topologia, 0, sizeof(*topologia));
+
+    cpu_set_t afinidad;
+    if (sched_getaffinity(0, sizeof(afinidad), &afinidad) != 0) {
+        fprintf(stderr, "Error: No se pudo obtener la afinidad del proceso: %s\n", strerror(errno));
+        return -1;
+    }
+
+    // Los nodos se recorren por número para que el reparto sea estable
+    for (int id = 0; id < MAX_NODOS_NUMA; id++) {
+        char ruta[128];
+        char lista[4096];
+        snprintf(ruta, sizeof(ruta), "/sys/devices/system/node/node%d/cpulist", id);
+        FILE* archivo = fopen(ruta, "r");
+        if (!archivo) {
+            continue;
+        }
+        int leida = fgets(lista, sizeof(lista), archivo) != NULL;
+        fclose(archivo);
+
+        int indice = topologia->num_nodos;
+        int cpus = leida ? interpretar_lista_cpus(lista, &afinidad, topologia->cpus[indice]) : -1;
+        if (cpus > 0) {
+            topologia->ids[indice] = id;
+            topologia->num_cpus[indice] = cpus;
+            topologia->num_nodos++;
+        } else {
+            memset(topologia->cpus[indice], 0, sizeof(topologia->cpus[indice]));
+        }
+    }
+
+    // Sin nodos visibles, un único nodo con toda la máscara de afinidad
+    if (topologia->num_nodos == 0) {
+        for (int cpu = 0; cpu < MAX_CPUS_NUMA && cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &afinidad)) {
+                marcar_cpu(topologia->cpus[0], cpu);
+                topologia->num_cpus[0]++;
+            }
+        }
+        topologia->num_nodos = 1;
+    }
+
+    return 0;
+}
+
+int fijar_hilo_en_nodo(const TopologiaNuma* topologia, int indice, pthread_t hilo) {
+    if (!topologia || indice < 0 || indice >= topologia->num_nodos) {
+        return -1;
+    }
+
+    cpu_set_t conjunto;
+    CPU_ZERO(&conjunto);
+    for (int cpu = 0; cpu < MAX_CPUS_NUMA && cpu < CPU_SETSIZE; cpu++) {
+        if (cpu_marcada(topologia->cpus[indice], cpu)) {
+            CPU_SET(cpu, &conjunto);
+        }
+    }
+
+    int error = pthread_setaffinity_np(hilo, sizeof(conjunto), &conjunto);
+    if (error != 0) {
+        fprintf(stderr, "Error: No se pudo fijar un hilo al nodo %d: %s\n",
+                topologia->ids[indice], strerror(error));
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include "../include/path_arena.h"
+#include "../include/memory_accounting.h"
+#include <stdlib.h>
+#include <string.h>
+
+void iniciar_arena_rutas(ArenaRutas* arena) {
+    arena->bloques = NULL;
+    arena->num_bloques = 0;
+    arena->capacidad_bloques = 0;
+    arena->usado = 0;
+}
+
+// Agrega un bloque nuevo al final de la arena
+static int agregar_bloque(ArenaRutas* arena) {
+    if (arena->num_bloques == arena->capacidad_bloques) {
+        size_t nueva_capacidad = arena->capacidad_bloques ? arena->capacidad_bloques * 2 : 8;
+        char** bloques = reasignar_memoria(MEMORIA_DIRECTORIOS, arena->bloques, nueva_capacidad * sizeof(char*));
+        if (!bloques) {
+            return -1;
+        }
+        arena->bloques = bloques;
+        arena->capacidad_bloques = nueva_capacidad;
+    }
+
+    char* bloque = asignar_memoria(MEMORIA_DIRECTORIOS, TAMANO_BLOQUE_ARENA);
+    if (!bloque) {
+        return -1;
+    }
+    arena->bloques[arena->num_bloques++] = bloque;
+    arena->usado = 0;
+    return 0;
+}
+
+int agregar_ruta_arena(ArenaRutas* arena, const char* prefijo, const char* nombre, RefRuta* ref) {
+    if (!arena || !nombre || !ref) {
+        return -1;
+    }
+
+    size_t largo_prefijo = prefijo ? strlen(prefijo) : 0;
+    size_t largo_nombre = strlen(nombre);
+    size_t longitud = largo_prefijo + (largo_prefijo > 0) + largo_nombre;
+    if (longitud + 1 > TAMANO_BLOQUE_ARENA) {
+        return -1;
+    }
+
+    // Las rutas no cruzan bloques: si no cabe, se empieza uno nuevo
+    if (arena->num_bloques == 0 || arena->usado + longitud + 1 > TAMANO_BLOQUE_ARENA) {
+        if (agregar_bloque(arena) != 0) {
+            return -1;
+        }
+    }
+
+    char* destino = arena->bloques[arena->num_bloques - 1] + arena->usado;
+    if (largo_prefijo > 0) {
+        memcpy(destino, prefijo, largo_prefijo);
+        destino[largo_prefijo] = '/';
+        memcpy(destino + largo_prefijo + 1, nombre, largo_nombre + 1);
+    } else {
+        memcpy(destino, nombre, largo_nombre + 1);
+    }
+
+    ref->desplazamiento = (arena->num_bloques - 1) * TAMANO_BLOQUE_ARENA + arena->usado;
+    ref->longitud = longitud;
+    arena->usado += longitud + 1;
+    return 0;
+}
+
+const char* obtener_ruta_arena(const ArenaRutas* arena, RefRuta ref) {
+    return arena->bloques[ref.desplazamiento / TAMANO_BLOQUE_ARENA] +
+           ref.desplazamiento % TAMANO_BLOQUE_ARENA;
+}
+
+size_t memoria_arena_rutas(const ArenaRutas* arena) {
+    return arena->num_bloques * TAMANO_BLOQUE_ARENA;
+}
+
+void liberar_arena_rutas(ArenaRutas* arena) {
+    if (!arena) return;
+
+    for (size_t i = 0; i < arena->num_bloques; i++) {
+        liberar_asignacion(arena->bloques[i]);
+    }
+    liberar_asignacion(arena->bloques);
+    iniciar_arena_rutas(arena);
+}
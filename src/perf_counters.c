@@ -0,0 +1,265 @@
+#define _GNU_SOURCE // syscall()
+#include "../include/perf_counters.h"
+#include "../include/log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#define NUM_OPERACIONES_HW 4
+
+// Totales de una operación en un hilo
+typedef struct {
+    uint64_t valores[NUM_CONTADORES_HW];
+    uint64_t bytes;
+    uint64_t llamadas;
+} TotalesOperacion;
+
+// Grupo de contadores de un hilo: solo lo usa su hilo
+typedef struct ContadoresHilo {
+    int fds[NUM_CONTADORES_HW];         // -1 si el contador no se pudo abrir
+    int orden[NUM_CONTADORES_HW];       // Contador de cada posición en la lectura del grupo
+    int num_abiertos;
+    TotalesOperacion totales[NUM_OPERACIONES_HW];
+    struct ContadoresHilo* siguiente;
+} ContadoresHilo;
+
+static const uint64_t EVENTOS[NUM_CONTADORES_HW] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+};
+static const char* const NOMBRES_OPERACIONES[NUM_OPERACIONES_HW] = {
+    "compresión RLE", "descompresión RLE", "encriptación Vigenère", "desencriptación Vigenère"
+};
+
+static pthread_mutex_t mutex_contadores = PTHREAD_MUTEX_INITIALIZER; // Protege la lista
+static pthread_key_t clave_contadores;
+static ContadoresHilo* hilos = NULL;
+static int activos = 0;
+static int disponibles[NUM_CONTADORES_HW];  // Contadores que se pudieron abrir en el hilo principal
+
+static int indice_operacion(char operacion) {
+    switch (operacion) {
+        case 'c': return 0;
+        case 'd': return 1;
+        case 'e': return 2;
+        case 'u': return 3;
+        default:  return -1;
+    }
+}
+
+static int abrir_evento(uint64_t evento, int grupo) {
+    struct perf_event_attr atributos;
+    memset(&atributos, 0, sizeof(atributos));
+    atributos.type = PERF_TYPE_HARDWARE;
+    atributos.size = sizeof(atributos);
+    atributos.config = evento;
+    atributos.exclude_kernel = 1;   // Basta con perf_event_paranoid <= 2
+    atributos.exclude_hv = 1;
+    atributos.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &atributos, 0, -1, grupo, 0);
+}
+
+// Destructor de la clave: cierra los descriptores; los totales se conservan
+static void cerrar_contadores_hilo(void* valor) {
+    ContadoresHilo* contadores = valor;
+    for (int i = 0; i < NUM_CONTADORES_HW; i++) {
+        if (contadores->fds[i] != -1) {
+            close(contadores->fds[i]);
+            contadores->fds[i] = -1;
+        }
+    }
+    contadores->num_abiertos = 0;
+}
+
+// Abre el grupo de contadores del hilo llamador; el primero (ciclos) es el líder.
+// Sin ningún contador abierto (num_abiertos = 0) el hilo no vuelve a intentarlo
+static ContadoresHilo* abrir_contadores_hilo(void) {
+    ContadoresHilo* contadores = calloc(1, sizeof(ContadoresHilo));
+    if (!contadores) {
+        return NULL;
+    }
+    for (int i = 0; i < NUM_CONTADORES_HW; i++) {
+        contadores->fds[i] = -1;
+    }
+    for (int i = 0; i < NUM_CONTADORES_HW; i++) {
+        int lider = contadores->fds[CONTADOR_CICLOS];
+        if (i != CONTADOR_CICLOS && lider == -1) {
+            break;
+        }
+        contadores->fds[i] = abrir_evento(EVENTOS[i], i == CONTADOR_CICLOS ? -1 : lider);
+        if (contadores->fds[i] != -1) {
+            contadores->orden[contadores->num_abiertos++] = i;
+        }
+    }
+    if (contadores->num_abiertos > 0) {
+        ioctl(contadores->fds[CONTADOR_CICLOS], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    }
+    return contadores;
+}
+
+// Registra el grupo de un hilo para combinar sus totales al final
+static void registrar_contadores_hilo(ContadoresHilo* contadores) {
+    pthread_setspecific(clave_contadores, contadores);
+    pthread_mutex_lock(&mutex_contadores);
+    contadores->siguiente = hilos;
+    hilos = contadores;
+    pthread_mutex_unlock(&mutex_contadores);
+}
+
+// Lee el valor actual del perf_event_paranoid del sistema (-100 si no se puede)
+static int leer_paranoid(void) {
+    int valor = -100;
+    FILE* archivo = fopen("/proc/sys/kernel/perf_event_paranoid", "r");
+    if (archivo) {
+        if (fscanf(archivo, "%d", &valor) != 1) {
+            valor = -100;
+        }
+        fclose(archivo);
+    }
+    return valor;
+}
+
+int iniciar_contadores_hw(void) {
+    if (activos) {
+        return 0;
+    }
+    if (pthread_key_create(&clave_contadores, cerrar_contadores_hilo) != 0) {
+        fprintf(stderr, "Advertencia: No se pudieron activar los contadores de hardware\n");
+        return -1;
+    }
+
+    // El hilo principal comprueba qué contadores permite el sistema
+    errno = 0;
+    ContadoresHilo* contadores = abrir_contadores_hilo();
+    if (!contadores || contadores->num_abiertos == 0) {
+        int error = errno;
+        free(contadores);
+        int paranoid = leer_paranoid();
+        if (paranoid != -100) {
+            fprintf(stderr, "Advertencia: Contadores de hardware no disponibles (%s, perf_event_paranoid=%d); "
+                    "se continúa sin ellos\n", strerror(error), paranoid);
+        } else {
+            fprintf(stderr, "Advertencia: Contadores de hardware no disponibles (%s); se continúa sin ellos\n",
+                    strerror(error));
+        }
+        pthread_key_delete(clave_contadores);
+        return -1;
+    }
+    for (int i = 0; i < NUM_CONTADORES_HW; i++) {
+        disponibles[i] = contadores->fds[i] != -1;
+    }
+    registrar_contadores_hilo(contadores);
+    activos = 1;
+    return 0;
+}
+
+void leer_contadores_hw(LecturaContadoresHw* lectura) {
+    lectura->valida = 0;
+    if (!activos) {
+        return;
+    }
+    ContadoresHilo* contadores = pthread_getspecific(clave_contadores);
+    if (!contadores) {
+        contadores = abrir_contadores_hilo();
+        if (!contadores) {
+            return;
+        }
+        registrar_contadores_hilo(contadores);
+    }
+    if (contadores->num_abiertos == 0) {
+        return;
+    }
+
+    // Formato del grupo: número de contadores, tiempos habilitado y en marcha, valores
+    uint64_t datos[3 + NUM_CONTADORES_HW];
+    ssize_t leidos = read(contadores->fds[CONTADOR_CICLOS], datos, sizeof(datos));
+    if (leidos < (ssize_t)(3 * sizeof(uint64_t)) || datos[0] != (uint64_t)contadores->num_abiertos) {
+        return;
+    }
+    // Si la PMU se reparte entre grupos, se escala al tiempo total habilitado
+    double escala = datos[2] > 0 ? (double)datos[1] / (double)datos[2] : 0.0;
+    memset(lectura->valores, 0, sizeof(lectura->valores));
+    for (int i = 0; i < contadores->num_abiertos; i++) {
+        lectura->valores[contadores->orden[i]] = (uint64_t)((double)datos[3 + i] * escala);
+    }
+    lectura->valida = 1;
+}
+
+void registrar_contadores_hw(char operacion, const LecturaContadoresHw* inicio, size_t bytes) {
+    int indice = indice_operacion(operacion);
+    if (!activos || !inicio->valida || indice < 0) {
+        return;
+    }
+    LecturaContadoresHw fin;
+    leer_contadores_hw(&fin);
+    if (!fin.valida) {
+        return;
+    }
+
+    ContadoresHilo* contadores = pthread_getspecific(clave_contadores);
+    TotalesOperacion* totales = &contadores->totales[indice];
+    for (int i = 0; i < NUM_CONTADORES_HW; i++) {
+        if (fin.valores[i] > inicio->valores[i]) {
+            totales->valores[i] += fin.valores[i] - inicio->valores[i];
+        }
+    }
+    totales->bytes += bytes;
+    totales->llamadas++;
+}
+
+void informar_contadores_hw(void) {
+    if (!activos) {
+        return;
+    }
+
+    TotalesOperacion totales[NUM_OPERACIONES_HW];
+    memset(totales, 0, sizeof(totales));
+    pthread_mutex_lock(&mutex_contadores);
+    for (const ContadoresHilo* contadores = hilos; contadores; contadores = contadores->siguiente) {
+        for (int o = 0; o < NUM_OPERACIONES_HW; o++) {
+            for (int i = 0; i < NUM_CONTADORES_HW; i++) {
+                totales[o].valores[i] += contadores->totales[o].valores[i];
+            }
+            totales[o].bytes += contadores->totales[o].bytes;
+            totales[o].llamadas += contadores->totales[o].llamadas;
+        }
+    }
+    pthread_mutex_unlock(&mutex_contadores);
+
+    LOG_RESUMEN("\nContadores de hardware (modo usuario, por byte de entrada):");
+    int alguna = 0;
+    for (int o = 0; o < NUM_OPERACIONES_HW; o++) {
+        const TotalesOperacion* t = &totales[o];
+        if (t->bytes == 0) {
+            continue;
+        }
+        alguna = 1;
+        double bytes = (double)t->bytes;
+        double ciclos = (double)t->valores[CONTADOR_CICLOS];
+        char ipc[32] = "n/d";
+        char cache[32] = "n/d";
+        char saltos[32] = "n/d";
+        if (disponibles[CONTADOR_INSTRUCCIONES] && ciclos > 0.0) {
+            snprintf(ipc, sizeof(ipc), "%.2f", (double)t->valores[CONTADOR_INSTRUCCIONES] / ciclos);
+        }
+        if (disponibles[CONTADOR_FALLOS_CACHE]) {
+            snprintf(cache, sizeof(cache), "%.3f", (double)t->valores[CONTADOR_FALLOS_CACHE] * 1024.0 / bytes);
+        }
+        if (disponibles[CONTADOR_FALLOS_SALTO]) {
+            snprintf(saltos, sizeof(saltos), "%.3f", (double)t->valores[CONTADOR_FALLOS_SALTO] * 1024.0 / bytes);
+        }
+        LOG_RESUMEN("- %s: %.2f MB en %llu llamadas, %.3f ciclos/byte, IPC %s, "
+                    "%s fallos de caché/KiB, %s saltos mal predichos/KiB",
+                    NOMBRES_OPERACIONES[o], bytes / (1024.0 * 1024.0), (unsigned long long)t->llamadas,
+                    ciclos / bytes, ipc, cache, saltos);
+    }
+    if (!alguna) {
+        LOG_RESUMEN("- No se midió ninguna transformación");
+    }
+}
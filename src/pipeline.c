@@ -0,0 +1,777 @@
+#define _GNU_SOURCE // pread() y pwrite()
+#include "../include/pipeline.h"
+#include "../include/bounded_queue.h"
+#include "../include/compression.h"
+#include "../include/encryption.h"
+#include "../include/file_manager.h"
+#include "../include/log.h"
+#include "../include/run_stats.h"
+#include "../include/trace.h"
+#include "../include/perf_counters.h"
+#include "../include/memory_accounting.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * Trozo de datos que circula entre las etapas
+ */
+typedef struct {
+    size_t tamano;     // Bytes válidos
+    size_t capacidad;  // Bytes reservados en datos
+    char datos[];
+} Trozo;
+
+/**
+ * Estado que una etapa conserva entre trozos
+ */
+typedef struct {
+    FlujoRle rle;
+    FlujoVigenere vigenere;
+} EstadoEtapa;
+
+struct DefinicionEtapa {
+    const char* nombre;
+    int requiere_clave;
+    int en_el_sitio;        // Transforma el trozo sobre sí mismo sin cambiar su tamaño
+    int detecta_formatos;   // Deja pasar los formatos ya comprimidos, como -c y -d
+    size_t (*cota_salida)(int inversa, size_t tamano);
+    void (*iniciar)(EstadoEtapa* estado, int inversa, const char* clave);
+    size_t (*transformar)(EstadoEtapa* estado, int inversa, const char* datos, size_t tamano, char* salida);
+    size_t (*finalizar)(EstadoEtapa* estado, int inversa, char* salida);
+    const char* operaciones;    // Operación equivalente en sentido directo e inverso ("cd": -c y -d)
+};
+
+// Etapa RLE: comprimir en sentido directo, descomprimir en inverso
+
+static size_t cota_rle(int inversa, size_t tamano) {
+    // El estado pendiente del trozo anterior añade como mucho un byte de entrada
+    return inversa ? cota_descompresion_rle(tamano + 1) : tamano * 2 + 2;
+}
+
+static void iniciar_rle(EstadoEtapa* estado, int inversa, const char* clave) {
+    (void)inversa;
+    (void)clave;
+    iniciar_flujo_rle(&estado->rle);
+}
+
+static size_t transformar_rle(EstadoEtapa* estado, int inversa, const char* datos, size_t tamano, char* salida) {
+    return inversa ? descomprimir_rle_flujo(&estado->rle, datos, tamano, salida)
+                   : comprimir_rle_flujo(&estado->rle, datos, tamano, salida);
+}
+
+static size_t finalizar_rle(EstadoEtapa* estado, int inversa, char* salida) {
+    return inversa ? finalizar_descompresion_rle_flujo(&estado->rle, salida)
+                   : finalizar_compresion_rle_flujo(&estado->rle, salida);
+}
+
+// Etapa Vigenère: encriptar en sentido directo, desencriptar en inverso
+
+static size_t cota_vigenere(int inversa, size_t tamano) {
+    (void)inversa;
+    return tamano;
+}
+
+static void iniciar_vigenere(EstadoEtapa* estado, int inversa, const char* clave) {
+    iniciar_flujo_vigenere(&estado->vigenere, clave, inversa);
+}
+
+static size_t transformar_vigenere(EstadoEtapa* estado, int inversa, const char* datos, size_t tamano, char* salida) {
+    (void)inversa;
+    aplicar_vigenere_flujo(&estado->vigenere, datos, salida, tamano);
+    return tamano;
+}
+
+static size_t finalizar_vigenere(EstadoEtapa* estado, int inversa, char* salida) {
+    (void)estado;
+    (void)inversa;
+    (void)salida;
+    return 0;
+}
+
+// Registro de etapas disponibles; una transformación nueva solo necesita su entrada aquí
+static const DefinicionEtapa ETAPAS_REGISTRADAS[] = {
+    { "rle", 0, 0, 1, cota_rle, iniciar_rle, transformar_rle, finalizar_rle, "cd" },
+    { "vigenere", 1, 1, 0, cota_vigenere, iniciar_vigenere, transformar_vigenere, finalizar_vigenere, "eu" },
+};
+
+#define NUM_ETAPAS_REGISTRADAS (sizeof(ETAPAS_REGISTRADAS) / sizeof(ETAPAS_REGISTRADAS[0]))
+
+int parsear_pipeline(const char* texto, EspecificacionPipeline* especificacion) {
+    if (!texto || !especificacion) {
+        fprintf(stderr, "Error: Parámetros inválidos para parsear_pipeline\n");
+        return -1;
+    }
+
+    especificacion->num_etapas = 0;
+    const char* actual = texto;
+    for (;;) {
+        const char* fin = strchr(actual, ',');
+        size_t longitud = fin ? (size_t)(fin - actual) : strlen(actual);
+
+        int inversa = longitud > 0 && actual[0] == '-';
+        const char* nombre = actual + inversa;
+        size_t longitud_nombre = longitud - (size_t)inversa;
+
+        const DefinicionEtapa* definicion = NULL;
+        for (size_t i = 0; i < NUM_ETAPAS_REGISTRADAS; i++) {
+            if (strlen(ETAPAS_REGISTRADAS[i].nombre) == longitud_nombre &&
+                strncmp(ETAPAS_REGISTRADAS[i].nombre, nombre, longitud_nombre) == 0) {
+                definicion = &ETAPAS_REGISTRADAS[i];
+                break;
+            }
+        }
+        if (!definicion) {
+            char disponibles[128];
+            listar_etapas_pipeline(disponibles, sizeof(disponibles));
+            fprintf(stderr, "Error: Etapa de pipeline desconocida: '%.*s' (disponibles: %s)\n",
+                    (int)longitud, actual, disponibles);
+            return -1;
+        }
+        if (especificacion->num_etapas == MAX_ETAPAS_PIPELINE) {
+            fprintf(stderr, "Error: El pipeline admite como mucho %d etapas\n", MAX_ETAPAS_PIPELINE);
+            return -1;
+        }
+
+        especificacion->etapas[especificacion->num_etapas].definicion = definicion;
+        especificacion->etapas[especificacion->num_etapas].inversa = inversa;
+        especificacion->num_etapas++;
+
+        if (!fin) {
+            break;
+        }
+        actual = fin + 1;
+    }
+    return 0;
+}
+
+int pipeline_requiere_clave(const EspecificacionPipeline* especificacion) {
+    for (size_t i = 0; i < especificacion->num_etapas; i++) {
+        if (especificacion->etapas[i].definicion->requiere_clave) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void describir_pipeline(const EspecificacionPipeline* especificacion, char* destino, size_t tamano) {
+    size_t usado = 0;
+    destino[0] = '\0';
+    for (size_t i = 0; i < especificacion->num_etapas && usado < tamano; i++) {
+        int escritos = snprintf(destino + usado, tamano - usado, "%s%s%s", i > 0 ? " -> " : "",
+                                especificacion->etapas[i].inversa ? "-" : "",
+                                especificacion->etapas[i].definicion->nombre);
+        if (escritos < 0) {
+            break;
+        }
+        usado += (size_t)escritos;
+    }
+}
+
+void listar_etapas_pipeline(char* destino, size_t tamano) {
+    size_t usado = 0;
+    destino[0] = '\0';
+    for (size_t i = 0; i < NUM_ETAPAS_REGISTRADAS && usado < tamano; i++) {
+        int escritos = snprintf(destino + usado, tamano - usado, "%s%s", i > 0 ? ", " : "",
+                                ETAPAS_REGISTRADAS[i].nombre);
+        if (escritos < 0) {
+            break;
+        }
+        usado += (size_t)escritos;
+    }
+}
+
+size_t memoria_pipeline(const EspecificacionPipeline* especificacion, size_t tamano_trozo) {
+    // Un trozo de entrada más el resultado de cada etapa que no transforma en el sitio
+    size_t total = tamano_trozo;
+    size_t tamano = tamano_trozo;
+    for (size_t i = 0; i < especificacion->num_etapas; i++) {
+        const DefinicionEtapa* definicion = especificacion->etapas[i].definicion;
+        if (!definicion->en_el_sitio) {
+            tamano = definicion->cota_salida(especificacion->etapas[i].inversa, tamano);
+            total += tamano;
+        }
+    }
+    return total;
+}
+
+static double tiempo_actual(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static Trozo* crear_trozo(size_t capacidad) {
+    Trozo* trozo = asignar_memoria(MEMORIA_FLUJO, sizeof(Trozo) + (capacidad > 0 ? capacidad : 1));
+    if (trozo) {
+        trozo->tamano = 0;
+        trozo->capacidad = capacidad;
+    }
+    return trozo;
+}
+
+static void liberar_trozo(void* trozo) {
+    liberar_asignacion(trozo);
+}
+
+// Une dos trozos consecutivos en uno nuevo; cualquiera puede ser NULL
+static Trozo* unir_trozos(Trozo* primero, Trozo* segundo) {
+    if (!primero || !segundo) {
+        return primero ? primero : segundo;
+    }
+    Trozo* unido = crear_trozo(primero->tamano + segundo->tamano);
+    if (unido) {
+        memcpy(unido->datos, primero->datos, primero->tamano);
+        memcpy(unido->datos + primero->tamano, segundo->datos, segundo->tamano);
+        unido->tamano = primero->tamano + segundo->tamano;
+    }
+    liberar_asignacion(primero);
+    liberar_asignacion(segundo);
+    return unido;
+}
+
+/**
+ * Estado de una etapa durante la ejecución de un pipeline
+ */
+typedef struct {
+    const EtapaPipeline* etapa;
+    size_t indice;
+    EstadoEtapa estado;
+    int decidido;        // Ya se sabe si la etapa transforma o deja pasar los datos
+    int almacenar;       // 1: la entrada es un formato ya comprimido y pasa tal cual
+    char cabecera[TAMANO_CABECERA_ALMACENADA]; // Cabecera de contenedor a anteponer al resultado
+    size_t tamano_cabecera;
+    size_t saltar;       // Bytes de cabecera de contenedor que aún se quitan de la entrada
+    Trozo* retenido;     // Datos guardados hasta reunir la firma de formato
+    double ocupado;      // Segundos transformando
+} EjecucionEtapa;
+
+static void iniciar_ejecucion_etapa(EjecucionEtapa* ejecucion, const EtapaPipeline* etapa,
+                                    size_t indice, const char* clave) {
+    memset(ejecucion, 0, sizeof(*ejecucion));
+    ejecucion->etapa = etapa;
+    ejecucion->indice = indice;
+    ejecucion->decidido = !etapa->definicion->detecta_formatos;
+    etapa->definicion->iniciar(&ejecucion->estado, etapa->inversa, clave);
+}
+
+// Decide si la etapa transforma o deja pasar los datos. En sentido directo
+// la firma de un formato ya comprimido lo decide y la cabecera de contenedor
+// se anota para anteponerla al resultado; en sentido inverso lo decide la
+// cabecera de contenedor, que se quita de la entrada
+static int decidir_almacenar(EjecucionEtapa* ejecucion, const Trozo* trozo) {
+    const EtapaPipeline* etapa = ejecucion->etapa;
+    ejecucion->decidido = 1;
+    if (!etapa->inversa) {
+        if (es_formato_comprimido(trozo->datos, trozo->tamano)) {
+            LOG_DETALLE("Etapa %zu (%s): formato ya comprimido, se almacena sin transformar",
+                        ejecucion->indice + 1, etapa->definicion->nombre);
+            ejecucion->almacenar = 1;
+            ejecucion->tamano_cabecera = serializar_cabecera_almacenada(TAMANO_CABECERA_ALMACENADA,
+                                                                        ejecucion->cabecera);
+        } else if (requiere_contenedor_rle(trozo->datos, trozo->tamano)) {
+            escribir_cabecera_contenedor(CONTENEDOR_RLE, ejecucion->cabecera);
+            ejecucion->tamano_cabecera = TAMANO_CABECERA_CONTENEDOR;
+        }
+        return 0;
+    }
+    off_t desplazamiento;
+    switch (identificar_contenedor(trozo->datos, trozo->tamano)) {
+        case CONTENEDOR_NINGUNO:
+            return 0;
+        case CONTENEDOR_RLE:
+            ejecucion->saltar = TAMANO_CABECERA_CONTENEDOR;
+            return 0;
+        case CONTENEDOR_ALMACENADO:
+            if (deserializar_cabecera_almacenada(trozo->datos, trozo->tamano, &desplazamiento) != 1) {
+                return -1;
+            }
+            LOG_DETALLE("Etapa %zu (-%s): contenedor almacenado, se extrae sin transformar",
+                        ejecucion->indice + 1, etapa->definicion->nombre);
+            ejecucion->almacenar = 1;
+            ejecucion->saltar = (size_t)desplazamiento;
+            return 0;
+        case CONTENEDOR_DISPERSO:
+            fprintf(stderr, "Error: La etapa %zu recibe un contenedor disperso; descomprímalo con -d\n",
+                    ejecucion->indice + 1);
+            return -1;
+        default:
+            fprintf(stderr, "Error: La etapa %zu recibe una cabecera de contenedor desconocida\n",
+                    ejecucion->indice + 1);
+            return -1;
+    }
+}
+
+// Quita del principio del trozo los bytes de cabecera pendientes de saltar
+static void saltar_cabecera(EjecucionEtapa* ejecucion, Trozo* trozo) {
+    size_t saltados = ejecucion->saltar < trozo->tamano ? ejecucion->saltar : trozo->tamano;
+    memmove(trozo->datos, trozo->datos + saltados, trozo->tamano - saltados);
+    trozo->tamano -= saltados;
+    ejecucion->saltar -= saltados;
+}
+
+// Antepone al resultado la cabecera pendiente; libera el resultado si falla
+static Trozo* anteponer_cabecera(EjecucionEtapa* ejecucion, Trozo* resultado) {
+    Trozo* cabecera = crear_trozo(ejecucion->tamano_cabecera);
+    if (!cabecera) {
+        liberar_asignacion(resultado);
+        return NULL;
+    }
+    memcpy(cabecera->datos, ejecucion->cabecera, ejecucion->tamano_cabecera);
+    cabecera->tamano = ejecucion->tamano_cabecera;
+    ejecucion->tamano_cabecera = 0;
+    return unir_trozos(cabecera, resultado);
+}
+
+// Transforma un trozo; devuelve el trozo con el resultado (el mismo si es en el sitio)
+static Trozo* transformar_trozo(EjecucionEtapa* ejecucion, Trozo* trozo) {
+    const EtapaPipeline* etapa = ejecucion->etapa;
+    const DefinicionEtapa* definicion = etapa->definicion;
+    if (ejecucion->saltar > 0) {
+        saltar_cabecera(ejecucion, trozo);
+    }
+
+    Trozo* resultado = trozo;
+    if (!ejecucion->almacenar) {
+        double inicio = tiempo_actual();
+        LecturaContadoresHw contadores;
+        leer_contadores_hw(&contadores);
+        size_t tamano_entrada = trozo->tamano;
+        if (definicion->en_el_sitio) {
+            definicion->transformar(&ejecucion->estado, etapa->inversa, trozo->datos, trozo->tamano, trozo->datos);
+        } else {
+            resultado = crear_trozo(definicion->cota_salida(etapa->inversa, trozo->tamano));
+            if (resultado) {
+                resultado->tamano = definicion->transformar(&ejecucion->estado, etapa->inversa, trozo->datos,
+                                                            trozo->tamano, resultado->datos);
+            }
+            liberar_asignacion(trozo);
+        }
+        ejecucion->ocupado += tiempo_actual() - inicio;
+        registrar_medida(MEDIDA_TRANSFORMACION, inicio, tamano_entrada);
+        registrar_contadores_hw(definicion->operaciones[etapa->inversa ? 1 : 0], &contadores, tamano_entrada);
+    }
+
+    if (resultado && ejecucion->tamano_cabecera > 0) {
+        resultado = anteponer_cabecera(ejecucion, resultado);
+    }
+    if (!resultado) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para el pipeline\n");
+    }
+    return resultado;
+}
+
+/**
+ * Pasa un trozo por una etapa
+ *
+ * El trozo pasa a ser de la etapa. Mientras no se ha reunido la firma de
+ * formato la etapa retiene los datos y *resultado queda en NULL.
+ *
+ * @return 0 si es exitoso, -1 si hay error
+ */
+static int pasar_por_etapa(EjecucionEtapa* ejecucion, Trozo* trozo, Trozo** resultado) {
+    *resultado = NULL;
+    if (!ejecucion->decidido) {
+        trozo = unir_trozos(ejecucion->retenido, trozo);
+        ejecucion->retenido = NULL;
+        if (!trozo) {
+            fprintf(stderr, "Error: No se pudo asignar memoria para el pipeline\n");
+            return -1;
+        }
+        if (trozo->tamano < TAMANO_FIRMA_COMPRIMIDO) {
+            ejecucion->retenido = trozo;
+            return 0;
+        }
+        if (decidir_almacenar(ejecucion, trozo) != 0) {
+            liberar_asignacion(trozo);
+            return -1;
+        }
+    }
+
+    *resultado = transformar_trozo(ejecucion, trozo);
+    return *resultado ? 0 : -1;
+}
+
+/**
+ * Termina una etapa al acabarse su entrada: emite lo que retenía y lo que
+ * quedó pendiente en su estado
+ *
+ * @return 0 si es exitoso, -1 si hay error
+ */
+static int terminar_etapa(EjecucionEtapa* ejecucion, Trozo** resultado) {
+    const EtapaPipeline* etapa = ejecucion->etapa;
+    Trozo* final = NULL;
+    *resultado = NULL;
+
+    // Entrada más corta que la firma: se decide con lo que haya
+    if (ejecucion->retenido) {
+        Trozo* retenido = ejecucion->retenido;
+        ejecucion->retenido = NULL;
+        if (decidir_almacenar(ejecucion, retenido) != 0) {
+            liberar_asignacion(retenido);
+            return -1;
+        }
+        final = transformar_trozo(ejecucion, retenido);
+        if (!final) {
+            return -1;
+        }
+    }
+
+    if (!ejecucion->almacenar) {
+        Trozo* pendiente = crear_trozo(etapa->definicion->cota_salida(etapa->inversa, 0));
+        if (pendiente) {
+            pendiente->tamano = etapa->definicion->finalizar(&ejecucion->estado, etapa->inversa, pendiente->datos);
+            final = unir_trozos(final, pendiente);
+        }
+        if (!pendiente || !final) {
+            fprintf(stderr, "Error: No se pudo asignar memoria para el pipeline\n");
+            liberar_asignacion(pendiente ? NULL : final);
+            return -1;
+        }
+    }
+
+    *resultado = final;
+    return 0;
+}
+
+/**
+ * Estado compartido por los hilos de una ejecución del pipeline
+ */
+typedef struct {
+    const EspecificacionPipeline* especificacion;
+    const char* ruta_entrada;
+    int fd_entrada;
+    size_t tamano_trozo;
+    EjecucionEtapa etapas[MAX_ETAPAS_PIPELINE];
+    ColaAcotada* colas[MAX_ETAPAS_PIPELINE + 1]; // colas[i] alimenta la etapa i; la última, al escritor
+    pthread_mutex_t mutex;                       // Protege los campos siguientes
+    int error;
+    size_t trozos_leidos;
+} EjecucionPipeline;
+
+/**
+ * Datos del hilo de una etapa
+ */
+typedef struct {
+    EjecucionPipeline* ejecucion;
+    size_t indice;
+} HiloEtapa;
+
+// Lee el siguiente trozo de la entrada; *trozo queda en NULL al final del archivo
+static int leer_trozo_entrada(EjecucionPipeline* ejecucion, off_t posicion, Trozo** trozo) {
+    *trozo = crear_trozo(ejecucion->tamano_trozo);
+    if (!*trozo) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para el pipeline\n");
+        return -1;
+    }
+
+    double inicio = iniciar_medida();
+    ssize_t leidos;
+    do {
+        leidos = pread(ejecucion->fd_entrada, (*trozo)->datos, ejecucion->tamano_trozo, posicion);
+    } while (leidos == -1 && errno == EINTR);
+    if (leidos <= 0) {
+        liberar_asignacion(*trozo);
+        *trozo = NULL;
+        if (leidos == -1) {
+            fprintf(stderr, "Error: No se pudo leer el archivo '%s': %s\n",
+                    ejecucion->ruta_entrada, strerror(errno));
+            return -1;
+        }
+        return 0;
+    }
+
+    registrar_medida(MEDIDA_LECTURA, inicio, (size_t)leidos);
+    (*trozo)->tamano = (size_t)leidos;
+    ejecucion->trozos_leidos++; // Solo lo modifica quien lee la entrada
+    return 0;
+}
+
+// Marca el error y cancela todas las colas para que ningún hilo quede esperando
+static void abortar_pipeline(EjecucionPipeline* ejecucion) {
+    pthread_mutex_lock(&ejecucion->mutex);
+    ejecucion->error = 1;
+    pthread_mutex_unlock(&ejecucion->mutex);
+    for (size_t i = 0; i <= ejecucion->especificacion->num_etapas; i++) {
+        cancelar_cola_acotada(ejecucion->colas[i]);
+    }
+}
+
+static int hay_error(EjecucionPipeline* ejecucion) {
+    pthread_mutex_lock(&ejecucion->mutex);
+    int error = ejecucion->error;
+    pthread_mutex_unlock(&ejecucion->mutex);
+    return error;
+}
+
+// Pasa un resultado a la siguiente cola; devuelve -1 si el pipeline se detuvo
+static int emitir_trozo(ColaAcotada* salida, Trozo* resultado) {
+    if (!resultado) {
+        return 0;
+    }
+    if (resultado->tamano == 0) {
+        liberar_asignacion(resultado);
+        return 0;
+    }
+    if (encolar_acotada(salida, resultado) != 0) {
+        liberar_asignacion(resultado);
+        return -1;
+    }
+    return 0;
+}
+
+// Hilo lector: divide la entrada en trozos y alimenta la primera etapa
+static void* hilo_lector(void* arg) {
+    EjecucionPipeline* ejecucion = arg;
+    off_t posicion = 0;
+    etiquetar_traza(ejecucion->ruta_entrada);
+
+    for (;;) {
+        Trozo* trozo;
+        if (leer_trozo_entrada(ejecucion, posicion, &trozo) != 0) {
+            abortar_pipeline(ejecucion);
+            return NULL;
+        }
+        if (!trozo) {
+            break;
+        }
+        posicion += (off_t)trozo->tamano;
+        if (emitir_trozo(ejecucion->colas[0], trozo) != 0) {
+            return NULL;
+        }
+    }
+
+    cerrar_cola_acotada(ejecucion->colas[0]);
+    return NULL;
+}
+
+// Hilo de una etapa: transforma los trozos de su cola y los pasa a la siguiente
+static void* hilo_etapa(void* arg) {
+    HiloEtapa* hilo = arg;
+    EjecucionPipeline* ejecucion = hilo->ejecucion;
+    EjecucionEtapa* etapa = &ejecucion->etapas[hilo->indice];
+    ColaAcotada* entrada = ejecucion->colas[hilo->indice];
+    ColaAcotada* salida = ejecucion->colas[hilo->indice + 1];
+    Trozo* resultado;
+    void* elemento;
+    etiquetar_traza(ejecucion->ruta_entrada);
+
+    while (desencolar_acotada(entrada, &elemento) == 0) {
+        if (pasar_por_etapa(etapa, elemento, &resultado) != 0) {
+            abortar_pipeline(ejecucion);
+            return NULL;
+        }
+        if (emitir_trozo(salida, resultado) != 0) {
+            return NULL;
+        }
+    }
+    if (hay_error(ejecucion)) {
+        return NULL;
+    }
+
+    if (terminar_etapa(etapa, &resultado) != 0) {
+        abortar_pipeline(ejecucion);
+        return NULL;
+    }
+    if (emitir_trozo(salida, resultado) == 0) {
+        cerrar_cola_acotada(salida);
+    }
+    return NULL;
+}
+
+// Escribe un trozo de salida y lo libera
+static int escribir_trozo(int fd_salida, const char* ruta_salida, Trozo* trozo, off_t* escritos) {
+    if (!trozo) {
+        return 0;
+    }
+    double inicio = iniciar_medida();
+    int resultado = escribir_rango_archivo(fd_salida, trozo->datos, trozo->tamano, *escritos);
+    if (resultado != 0) {
+        fprintf(stderr, "Error: No se pudo escribir al archivo '%s': %s\n", ruta_salida, strerror(errno));
+    } else {
+        registrar_medida(MEDIDA_ESCRITURA, inicio, trozo->tamano);
+        *escritos += (off_t)trozo->tamano;
+    }
+    liberar_asignacion(trozo);
+    return resultado;
+}
+
+// Ejecuta el pipeline con un hilo lector y uno por etapa; el hilo llamador escribe
+static int ejecutar_con_hilos(EjecucionPipeline* ejecucion, int fd_salida, const char* ruta_salida,
+                              off_t* escritos) {
+    size_t num_etapas = ejecucion->especificacion->num_etapas;
+    size_t num_colas = num_etapas + 1;
+    for (size_t i = 0; i < num_colas; i++) {
+        ejecucion->colas[i] = crear_cola_acotada(CAPACIDAD_COLA_PIPELINE);
+        if (!ejecucion->colas[i]) {
+            fprintf(stderr, "Error: No se pudo crear la cola de la etapa %zu\n", i + 1);
+            for (size_t j = 0; j < i; j++) {
+                destruir_cola_acotada(ejecucion->colas[j], NULL);
+            }
+            return -1;
+        }
+    }
+    pthread_mutex_init(&ejecucion->mutex, NULL);
+
+    pthread_t lector;
+    pthread_t hilos[MAX_ETAPAS_PIPELINE];
+    HiloEtapa datos_hilos[MAX_ETAPAS_PIPELINE];
+    size_t hilos_creados = 0;
+    int lector_creado = pthread_create(&lector, NULL, hilo_lector, ejecucion) == 0;
+    if (lector_creado) {
+        sumar_memoria(MEMORIA_PILAS, tamano_pila_hilos());
+    } else {
+        fprintf(stderr, "Error: No se pudo crear el hilo lector del pipeline\n");
+        abortar_pipeline(ejecucion);
+    }
+    for (size_t i = 0; lector_creado && i < num_etapas; i++) {
+        datos_hilos[i].ejecucion = ejecucion;
+        datos_hilos[i].indice = i;
+        if (pthread_create(&hilos[i], NULL, hilo_etapa, &datos_hilos[i]) != 0) {
+            fprintf(stderr, "Error: No se pudo crear el hilo de la etapa %zu\n", i + 1);
+            abortar_pipeline(ejecucion);
+            break;
+        }
+        hilos_creados++;
+        sumar_memoria(MEMORIA_PILAS, tamano_pila_hilos());
+    }
+
+    void* elemento;
+    while (desencolar_acotada(ejecucion->colas[num_etapas], &elemento) == 0) {
+        if (escribir_trozo(fd_salida, ruta_salida, elemento, escritos) != 0) {
+            abortar_pipeline(ejecucion);
+            break;
+        }
+    }
+
+    if (lector_creado) {
+        pthread_join(lector, NULL);
+        restar_memoria(MEMORIA_PILAS, tamano_pila_hilos());
+    }
+    for (size_t i = 0; i < hilos_creados; i++) {
+        pthread_join(hilos[i], NULL);
+        restar_memoria(MEMORIA_PILAS, tamano_pila_hilos());
+    }
+
+    for (size_t i = 0; i < num_colas; i++) {
+        destruir_cola_acotada(ejecucion->colas[i], liberar_trozo);
+    }
+    pthread_mutex_destroy(&ejecucion->mutex);
+    return ejecucion->error ? -1 : 0;
+}
+
+// Ejecuta el pipeline en el hilo llamador, pasando cada trozo por todas las etapas
+static int ejecutar_en_linea(EjecucionPipeline* ejecucion, int fd_salida, const char* ruta_salida,
+                             off_t* escritos) {
+    size_t num_etapas = ejecucion->especificacion->num_etapas;
+    off_t posicion = 0;
+
+    for (;;) {
+        Trozo* trozo;
+        if (leer_trozo_entrada(ejecucion, posicion, &trozo) != 0) {
+            return -1;
+        }
+        if (!trozo) {
+            break;
+        }
+        posicion += (off_t)trozo->tamano;
+        for (size_t i = 0; trozo && i < num_etapas; i++) {
+            if (pasar_por_etapa(&ejecucion->etapas[i], trozo, &trozo) != 0) {
+                return -1;
+            }
+        }
+        if (escribir_trozo(fd_salida, ruta_salida, trozo, escritos) != 0) {
+            return -1;
+        }
+    }
+
+    // Cada etapa termina en orden y lo que emite atraviesa las siguientes
+    for (size_t i = 0; i < num_etapas; i++) {
+        Trozo* trozo;
+        if (terminar_etapa(&ejecucion->etapas[i], &trozo) != 0) {
+            return -1;
+        }
+        for (size_t j = i + 1; trozo && j < num_etapas; j++) {
+            if (pasar_por_etapa(&ejecucion->etapas[j], trozo, &trozo) != 0) {
+                return -1;
+            }
+        }
+        if (escribir_trozo(fd_salida, ruta_salida, trozo, escritos) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int procesar_archivo_pipeline(const char* ruta_entrada, const char* ruta_salida,
+                              const EspecificacionPipeline* especificacion,
+                              const char* clave, size_t tamano_trozo, int con_hilos) {
+    if (!ruta_entrada || !ruta_salida || !especificacion || especificacion->num_etapas == 0 ||
+        tamano_trozo == 0) {
+        fprintf(stderr, "Error: Parámetros inválidos para procesar_archivo_pipeline\n");
+        return -1;
+    }
+    if (pipeline_requiere_clave(especificacion) && !validar_clave(clave)) {
+        fprintf(stderr, "Error: El pipeline necesita una clave válida (-k)\n");
+        return -1;
+    }
+
+    EjecucionPipeline ejecucion;
+    memset(&ejecucion, 0, sizeof(ejecucion));
+    ejecucion.especificacion = especificacion;
+    ejecucion.ruta_entrada = ruta_entrada;
+    ejecucion.tamano_trozo = tamano_trozo;
+    for (size_t i = 0; i < especificacion->num_etapas; i++) {
+        iniciar_ejecucion_etapa(&ejecucion.etapas[i], &especificacion->etapas[i], i, clave);
+    }
+
+    ejecucion.fd_entrada = open(ruta_entrada, O_RDONLY);
+    if (ejecucion.fd_entrada == -1) {
+        fprintf(stderr, "Error: No se pudo abrir el archivo '%s': %s\n", ruta_entrada, strerror(errno));
+        return -1;
+    }
+    int fd_salida = open(ruta_salida, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_salida == -1) {
+        fprintf(stderr, "Error: No se pudo crear/abrir el archivo '%s': %s\n", ruta_salida, strerror(errno));
+        close(ejecucion.fd_entrada);
+        return -1;
+    }
+
+    double inicio = tiempo_actual();
+    off_t escritos = 0;
+    int resultado = con_hilos ? ejecutar_con_hilos(&ejecucion, fd_salida, ruta_salida, &escritos)
+                              : ejecutar_en_linea(&ejecucion, fd_salida, ruta_salida, &escritos);
+    double tiempo_total = tiempo_actual() - inicio;
+
+    if (resultado == 0 && sincronizar_archivo(fd_salida, (size_t)escritos) == -1) {
+        fprintf(stderr, "Advertencia: No se pudo sincronizar el archivo con el disco: %s\n", strerror(errno));
+    }
+    close(fd_salida);
+    close(ejecucion.fd_entrada);
+    for (size_t i = 0; i < especificacion->num_etapas; i++) {
+        liberar_asignacion(ejecucion.etapas[i].retenido);
+    }
+
+    if (resultado != 0) {
+        unlink(ruta_salida);
+        return -1;
+    }
+
+    char descripcion[256];
+    describir_pipeline(especificacion, descripcion, sizeof(descripcion));
+    LOG_INFO("Procesado en pipeline: %s [%s] (%lld bytes de salida, %zu trozos de %zu bytes, %.3f s)",
+             ruta_entrada, descripcion, (long long)escritos, ejecucion.trozos_leidos, tamano_trozo, tiempo_total);
+    if (con_hilos) {
+        for (size_t i = 0; i < especificacion->num_etapas; i++) {
+            LOG_INFO("- Etapa %zu (%s%s): %.3f s ocupada", i + 1, especificacion->etapas[i].inversa ? "-" : "",
+                     especificacion->etapas[i].definicion->nombre, ejecucion.etapas[i].ocupado);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,162 @@
+#define _GNU_SOURCE // clock_gettime() y pthread_cond_timedwait()
+#include "../include/progress.h"
+#include "../include/memory_accounting.h"
+#include <stdio.h>
+#include <pthread.h>
+#include <time.h>
+
+// Los contadores se actualizan con operaciones atómicas relajadas: los
+// trabajadores no toman ningún cerrojo y el informe tolera leerlos desfasados
+struct Progreso {
+    size_t archivos_total;
+    size_t bytes_total;
+    size_t archivos_hechos;
+    size_t bytes_hechos;
+    long directorios_pendientes;
+
+    FormatoProgreso formato;
+    int intervalo_ms;
+    double inicio;
+    pthread_t hilo;
+    pthread_mutex_t mutex;      // Protege terminando
+    pthread_cond_t aviso;       // Despierta al hilo para el último informe
+    int terminando;
+};
+
+static double segundos_monotonicos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Formatea una duración como hh:mm:ss
+static void formatear_duracion(double segundos, char* destino, size_t capacidad) {
+    if (segundos < 0.0) {
+        snprintf(destino, capacidad, "--:--:--");
+        return;
+    }
+    unsigned long total = (unsigned long)(segundos + 0.5);
+    snprintf(destino, capacidad, "%02lu:%02lu:%02lu", total / 3600, total / 60 % 60, total % 60);
+}
+
+// Escribe un informe con los contadores actuales
+static void informar(Progreso* progreso, int final) {
+    size_t archivos_total = __atomic_load_n(&progreso->archivos_total, __ATOMIC_RELAXED);
+    size_t bytes_total = __atomic_load_n(&progreso->bytes_total, __ATOMIC_RELAXED);
+    size_t archivos_hechos = __atomic_load_n(&progreso->archivos_hechos, __ATOMIC_RELAXED);
+    size_t bytes_hechos = __atomic_load_n(&progreso->bytes_hechos, __ATOMIC_RELAXED);
+    int explorando = __atomic_load_n(&progreso->directorios_pendientes, __ATOMIC_RELAXED) > 0;
+
+    // El ritmo medio desde el inicio es estable aunque los archivos terminen a saltos
+    const double mb = 1024.0 * 1024.0;
+    double transcurrido = segundos_monotonicos() - progreso->inicio;
+    double bytes_por_segundo = transcurrido > 0.0 ? (double)bytes_hechos / transcurrido : 0.0;
+    double restante = -1.0;
+    if (bytes_hechos >= bytes_total && !explorando) {
+        restante = 0.0;
+    } else if (bytes_por_segundo > 0.0) {
+        restante = (double)(bytes_total - (bytes_hechos < bytes_total ? bytes_hechos : bytes_total)) /
+                   bytes_por_segundo;
+    }
+
+    if (progreso->formato == PROGRESO_LINEAS) {
+        fprintf(stderr, "progreso archivos=%zu total_archivos=%zu bytes=%zu total_bytes=%zu "
+                "mb_s=%.2f eta_s=%.0f explorando=%d transcurrido_s=%.1f\n",
+                archivos_hechos, archivos_total, bytes_hechos, bytes_total,
+                bytes_por_segundo / mb, restante, explorando, transcurrido);
+    } else {
+        char eta[32];
+        formatear_duracion(restante, eta, sizeof(eta));
+        fprintf(stderr, "\r%zu/%zu%s archivos | %.1f/%.1f%s MiB | %.2f MB/s | ETA %s\033[K%s",
+                archivos_hechos, archivos_total, explorando ? "+" : "",
+                (double)bytes_hechos / mb, (double)bytes_total / mb, explorando ? "+" : "",
+                bytes_por_segundo / mb, eta, final ? "\n" : "");
+    }
+    fflush(stderr);
+}
+
+// Hilo informador: un informe por intervalo y uno último al terminar
+static void* hilo_progreso(void* arg) {
+    Progreso* progreso = arg;
+    pthread_mutex_lock(&progreso->mutex);
+    while (!progreso->terminando) {
+        struct timespec limite;
+        clock_gettime(CLOCK_REALTIME, &limite);
+        limite.tv_sec += progreso->intervalo_ms / 1000;
+        limite.tv_nsec += (long)(progreso->intervalo_ms % 1000) * 1000000L;
+        if (limite.tv_nsec >= 1000000000L) {
+            limite.tv_sec++;
+            limite.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&progreso->aviso, &progreso->mutex, &limite);
+        if (!progreso->terminando) {
+            informar(progreso, 0);
+        }
+    }
+    pthread_mutex_unlock(&progreso->mutex);
+    informar(progreso, 1);
+    return NULL;
+}
+
+Progreso* iniciar_progreso(FormatoProgreso formato) {
+    if (formato == PROGRESO_DESACTIVADO) {
+        return NULL;
+    }
+    Progreso* progreso = asignar_memoria_ceros(MEMORIA_DIRECTORIOS, 1, sizeof(Progreso));
+    if (!progreso) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para el progreso\n");
+        return NULL;
+    }
+    progreso->formato = formato;
+    progreso->intervalo_ms = formato == PROGRESO_LINEAS ? INTERVALO_PROGRESO_LINEAS_MS
+                                                        : INTERVALO_PROGRESO_TERMINAL_MS;
+    progreso->inicio = segundos_monotonicos();
+    pthread_mutex_init(&progreso->mutex, NULL);
+    pthread_cond_init(&progreso->aviso, NULL);
+
+    if (pthread_create(&progreso->hilo, NULL, hilo_progreso, progreso) != 0) {
+        fprintf(stderr, "Error: No se pudo crear el hilo de progreso\n");
+        pthread_cond_destroy(&progreso->aviso);
+        pthread_mutex_destroy(&progreso->mutex);
+        liberar_asignacion(progreso);
+        return NULL;
+    }
+    sumar_memoria(MEMORIA_PILAS, tamano_pila_hilos());
+    return progreso;
+}
+
+void anotar_directorio_progreso(Progreso* progreso, int delta) {
+    if (progreso) {
+        __atomic_add_fetch(&progreso->directorios_pendientes, (long)delta, __ATOMIC_RELAXED);
+    }
+}
+
+void anotar_archivo_progreso(Progreso* progreso, size_t bytes) {
+    if (progreso) {
+        __atomic_add_fetch(&progreso->archivos_total, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&progreso->bytes_total, bytes, __ATOMIC_RELAXED);
+    }
+}
+
+void avanzar_progreso(Progreso* progreso, size_t bytes) {
+    if (progreso) {
+        __atomic_add_fetch(&progreso->archivos_hechos, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&progreso->bytes_hechos, bytes, __ATOMIC_RELAXED);
+    }
+}
+
+void terminar_progreso(Progreso* progreso) {
+    if (!progreso) {
+        return;
+    }
+    pthread_mutex_lock(&progreso->mutex);
+    progreso->terminando = 1;
+    pthread_cond_signal(&progreso->aviso);
+    pthread_mutex_unlock(&progreso->mutex);
+
+    pthread_join(progreso->hilo, NULL);
+    restar_memoria(MEMORIA_PILAS, tamano_pila_hilos());
+    pthread_cond_destroy(&progreso->aviso);
+    pthread_mutex_destroy(&progreso->mutex);
+    liberar_asignacion(progreso);
+}
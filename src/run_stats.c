@@ -0,0 +1,279 @@
+#define _GNU_SOURCE // clock_gettime()
+#include "../include/run_stats.h"
+#include "../include/memory_accounting.h"
+#include "../include/trace.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+// Histograma de duraciones en nanosegundos con cubetas log-lineales
+typedef struct {
+    uint64_t cuentas[NUM_CUBETAS];
+    uint64_t operaciones;
+    uint64_t suma_ns;
+    uint64_t maximo_ns;
+    uint64_t bytes;
+} Histograma;
+
+// Histogramas de un hilo: solo los escribe su hilo
+typedef struct ColectorHilo {
+    Histograma medidas[NUM_MEDIDAS];
+    struct ColectorHilo* siguiente;
+} ColectorHilo;
+
+static const char* const NOMBRES_MEDIDAS[NUM_MEDIDAS] = {
+    "lectura", "transformacion", "escritura", "sincronizacion", "archivo"
+};
+
+static pthread_mutex_t mutex_colectores = PTHREAD_MUTEX_INITIALIZER; // Protege la lista
+static pthread_key_t clave_colector;
+static ColectorHilo* colectores = NULL;
+static int activas = 0;
+static double inicio_ejecucion = 0.0;
+static LimitesEjecucion limites_ejecucion; // Se fijan antes de arrancar los hilos
+
+static double segundos_monotonicos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Cubeta de una duración: exacta por debajo de SUBCUBETAS y con SUBCUBETAS
+// divisiones por cada potencia de 2 a partir de ahí
+static size_t cubeta_de(uint64_t ns) {
+    if (ns < SUBCUBETAS) {
+        return (size_t)ns;
+    }
+    int exponente = 63;
+    while (!(ns >> exponente)) {
+        exponente--;
+    }
+    uint64_t subcubeta = (ns >> (exponente - BITS_SUBCUBETA)) & (SUBCUBETAS - 1);
+    return (size_t)(exponente - BITS_SUBCUBETA + 1) * SUBCUBETAS + (size_t)subcubeta;
+}
+
+// Valor central de una cubeta, en nanosegundos
+static double valor_de_cubeta(size_t cubeta) {
+    if (cubeta < SUBCUBETAS) {
+        return (double)cubeta;
+    }
+    int exponente = (int)(cubeta / SUBCUBETAS) + BITS_SUBCUBETA - 1;
+    double ancho = (double)((uint64_t)1 << (exponente - BITS_SUBCUBETA));
+    double inferior = (double)(SUBCUBETAS + cubeta % SUBCUBETAS) * ancho;
+    return inferior + ancho / 2.0;
+}
+
+// Colector del hilo llamador, creado y registrado en su primera medida
+static ColectorHilo* colector_del_hilo(void) {
+    ColectorHilo* colector = pthread_getspecific(clave_colector);
+    if (colector) {
+        return colector;
+    }
+
+    colector = calloc(1, sizeof(ColectorHilo));
+    if (!colector) {
+        return NULL;
+    }
+    if (pthread_setspecific(clave_colector, colector) != 0) {
+        free(colector);
+        return NULL;
+    }
+    pthread_mutex_lock(&mutex_colectores);
+    colector->siguiente = colectores;
+    colectores = colector;
+    pthread_mutex_unlock(&mutex_colectores);
+    return colector;
+}
+
+void iniciar_estadisticas(void) {
+    if (activas) {
+        return;
+    }
+    // Los colectores sobreviven a sus hilos: se combinan al final
+    if (pthread_key_create(&clave_colector, NULL) != 0) {
+        fprintf(stderr, "Advertencia: No se pudieron activar las estadísticas\n");
+        return;
+    }
+    iniciar_contabilidad_memoria();
+    inicio_ejecucion = segundos_monotonicos();
+    activas = 1;
+}
+
+int estadisticas_activas(void) {
+    return activas;
+}
+
+double iniciar_medida(void) {
+    return activas || traza_activa() ? segundos_monotonicos() : 0.0;
+}
+
+void registrar_medida(TipoMedida tipo, double inicio, size_t bytes) {
+    if ((!activas && !traza_activa()) || tipo >= NUM_MEDIDAS) {
+        return;
+    }
+    double fin = segundos_monotonicos();
+    anotar_evento_traza(NOMBRES_MEDIDAS[tipo], inicio, fin, bytes, tipo == MEDIDA_ARCHIVO);
+
+    ColectorHilo* colector = activas ? colector_del_hilo() : NULL;
+    if (!colector) {
+        return;
+    }
+
+    double segundos = fin - inicio;
+    uint64_t ns = segundos > 0.0 ? (uint64_t)(segundos * 1e9) : 0;
+    Histograma* histograma = &colector->medidas[tipo];
+    histograma->cuentas[cubeta_de(ns)]++;
+    histograma->operaciones++;
+    histograma->suma_ns += ns;
+    histograma->bytes += bytes;
+    if (ns > histograma->maximo_ns) {
+        histograma->maximo_ns = ns;
+    }
+}
+
+// Percentil (0-100) de un histograma, en milisegundos
+static double percentil_ms(const Histograma* histograma, double percentil) {
+    if (histograma->operaciones == 0) {
+        return 0.0;
+    }
+    uint64_t objetivo = (uint64_t)((double)histograma->operaciones * percentil / 100.0 + 0.5);
+    if (objetivo == 0) {
+        objetivo = 1;
+    }
+    uint64_t acumuladas = 0;
+    for (size_t i = 0; i < NUM_CUBETAS; i++) {
+        acumuladas += histograma->cuentas[i];
+        if (acumuladas >= objetivo) {
+            // El valor central nunca supera al máximo observado
+            double ns = valor_de_cubeta(i);
+            return (ns < (double)histograma->maximo_ns ? ns : (double)histograma->maximo_ns) / 1e6;
+        }
+    }
+    return (double)histograma->maximo_ns / 1e6;
+}
+
+// Escribe una cadena JSON escapando comillas, barras y caracteres de control
+static void escribir_cadena_json(FILE* destino, const char* texto) {
+    fputc('"', destino);
+    for (const unsigned char* p = (const unsigned char*)(texto ? texto : ""); *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fprintf(destino, "\\%c", *p);
+        } else if (*p < 0x20) {
+            fprintf(destino, "\\u%04x", *p);
+        } else {
+            fputc(*p, destino);
+        }
+    }
+    fputc('"', destino);
+}
+
+// Escribe la sección "memoria": proceso, total contabilizado y cada subsistema
+void registrar_limites_ejecucion(const LimitesEjecucion* limites) {
+    if (limites) {
+        limites_ejecucion = *limites;
+    }
+}
+
+static void escribir_limites_json(FILE* destino) {
+    const LimitesEjecucion* l = &limites_ejecucion;
+    fprintf(destino, "  \"limites\": {\n");
+    fprintf(destino, "    \"cgroup_version\": %d,\n", l->version_cgroup);
+    fprintf(destino, "    \"cgroup_cpus\": %.3f,\n", l->cpus_cgroup);
+    fprintf(destino, "    \"cgroup_memoria_bytes\": %zu,\n", l->memoria_cgroup);
+    fprintf(destino, "    \"hilos\": %d,\n", l->hilos);
+    fprintf(destino, "    \"limite_memoria_bytes\": %zu,\n", l->limite_memoria);
+    fprintf(destino, "    \"limite_por_defecto\": %s,\n", l->limite_por_defecto ? "true" : "false");
+    fprintf(destino, "    \"memoria_arenas_bytes\": %zu\n", l->memoria_arenas);
+    fprintf(destino, "  },\n");
+}
+
+static void escribir_memoria_json(FILE* destino) {
+    EstadisticasMemoria memoria;
+    obtener_estadisticas_memoria(&memoria);
+
+    fprintf(destino, "  \"memoria\": {\n");
+    fprintf(destino, "    \"rss_bytes\": %zu,\n", memoria.rss);
+    fprintf(destino, "    \"pico_rss_bytes\": %zu,\n", memoria.pico_rss);
+    fprintf(destino, "    \"en_uso_bytes\": %zu,\n", memoria.actual);
+    fprintf(destino, "    \"pico_bytes\": %zu,\n", memoria.pico);
+    fprintf(destino, "    \"subsistemas\": {\n");
+    for (int s = 0; s < NUM_SUBSISTEMAS_MEMORIA; s++) {
+        const ContadorMemoria* c = &memoria.subsistemas[s];
+        fprintf(destino, "      \"%s\": {\"en_uso_bytes\": %zu, \"pico_bytes\": %zu, \"total_bytes\": %zu, "
+                "\"asignaciones\": %zu, \"liberaciones\": %zu}%s\n",
+                nombre_subsistema_memoria((SubsistemaMemoria)s), c->actual, c->pico, c->total,
+                c->asignaciones, c->liberaciones, s + 1 < NUM_SUBSISTEMAS_MEMORIA ? "," : "");
+    }
+    fprintf(destino, "    }\n  }\n");
+}
+
+int escribir_estadisticas_json(FILE* destino, const char* operacion, const char* entrada, int resultado) {
+    if (!destino || !activas) {
+        return -1;
+    }
+    double tiempo_total = segundos_monotonicos() - inicio_ejecucion;
+
+    // Los hilos ya terminaron: sus histogramas se pueden leer sin cerrojos
+    Histograma* total = calloc(NUM_MEDIDAS, sizeof(Histograma));
+    if (!total) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para las estadísticas\n");
+        return -1;
+    }
+    size_t hilos = 0;
+    pthread_mutex_lock(&mutex_colectores);
+    for (ColectorHilo* colector = colectores; colector; colector = colector->siguiente) {
+        for (int m = 0; m < NUM_MEDIDAS; m++) {
+            const Histograma* origen = &colector->medidas[m];
+            for (size_t i = 0; i < NUM_CUBETAS; i++) {
+                total[m].cuentas[i] += origen->cuentas[i];
+            }
+            total[m].operaciones += origen->operaciones;
+            total[m].suma_ns += origen->suma_ns;
+            total[m].bytes += origen->bytes;
+            if (origen->maximo_ns > total[m].maximo_ns) {
+                total[m].maximo_ns = origen->maximo_ns;
+            }
+        }
+        hilos++;
+    }
+    pthread_mutex_unlock(&mutex_colectores);
+
+    const double mb = 1024.0 * 1024.0;
+    uint64_t bytes_entrada = total[MEDIDA_LECTURA].bytes;
+    uint64_t bytes_salida = total[MEDIDA_ESCRITURA].bytes;
+
+    fprintf(destino, "{\n  \"operacion\": ");
+    escribir_cadena_json(destino, operacion);
+    fprintf(destino, ",\n  \"entrada\": ");
+    escribir_cadena_json(destino, entrada);
+    fprintf(destino, ",\n  \"resultado\": %d,\n", resultado);
+    fprintf(destino, "  \"tiempo_total_s\": %.6f,\n", tiempo_total);
+    fprintf(destino, "  \"hilos_medidos\": %zu,\n", hilos);
+    fprintf(destino, "  \"bytes_entrada\": %llu,\n", (unsigned long long)bytes_entrada);
+    fprintf(destino, "  \"bytes_salida\": %llu,\n", (unsigned long long)bytes_salida);
+    fprintf(destino, "  \"mb_por_segundo\": %.3f,\n",
+            tiempo_total > 0.0 ? (double)bytes_entrada / mb / tiempo_total : 0.0);
+    fprintf(destino, "  \"medidas\": {\n");
+    for (int m = 0; m < NUM_MEDIDAS; m++) {
+        const Histograma* h = &total[m];
+        double ocupado = (double)h->suma_ns / 1e9;
+        fprintf(destino, "    \"%s\": {\"operaciones\": %llu, \"bytes\": %llu, \"tiempo_ocupado_s\": %.6f, "
+                "\"mb_por_segundo\": %.3f, \"media_ms\": %.3f, \"p50_ms\": %.3f, \"p99_ms\": %.3f, "
+                "\"max_ms\": %.3f}%s\n",
+                NOMBRES_MEDIDAS[m], (unsigned long long)h->operaciones, (unsigned long long)h->bytes,
+                ocupado, ocupado > 0.0 ? (double)h->bytes / mb / ocupado : 0.0,
+                h->operaciones ? (double)h->suma_ns / 1e6 / (double)h->operaciones : 0.0,
+                percentil_ms(h, 50.0), percentil_ms(h, 99.0), (double)h->maximo_ns / 1e6,
+                m + 1 < NUM_MEDIDAS ? "," : "");
+    }
+    fprintf(destino, "  },\n");
+    escribir_limites_json(destino);
+    escribir_memoria_json(destino);
+    fprintf(destino, "}\n");
+    fflush(destino);
+
+    free(total);
+    return ferror(destino) ? -1 : 0;
+}
@@ -0,0 +1,519 @@
+#define _GNU_SOURCE // sched_getaffinity() y CPU_COUNT
+#include "../include/scheduler.h"
+#include "../include/cgroup.h"
+#include "../include/numa_topology.h"
+#include "../include/memory_accounting.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+// Tarea encolada en un trabajador
+typedef struct {
+    FuncionTarea funcion;
+    void* datos;
+    size_t costo;
+    int prioritaria;         // Se ejecuta antes que las no prioritarias en cualquier orden
+    unsigned long secuencia; // Orden de llegada, para desempatar y para ORDEN_FIFO
+} Tarea;
+
+// Cola de prioridad (montículo) propia de cada trabajador
+typedef struct {
+    pthread_mutex_t mutex;
+    Tarea* tareas;
+    size_t num_tareas;
+    size_t capacidad;
+    size_t costo_pendiente;   // Suma de costos encolados
+    size_t costo_en_curso;    // Costo de la tarea que se está ejecutando
+
+    // Estadísticas (solo las modifica el propio trabajador)
+    size_t ejecutadas;
+    size_t robadas;
+    double tiempo_ocupado;
+    size_t bytes;             // Bytes que las tareas registraron como procesados
+    int nodo;                 // Nodo NUMA al que está fijado (-1 = sin fijar)
+
+    pthread_t hilo;
+    int id;
+    struct Planificador* planificador;
+} ColaTrabajador;
+
+struct Planificador {
+    ColaTrabajador* colas;
+    int num_trabajadores;
+    int hilos_creados;
+    OrdenTareas orden;
+
+    pthread_mutex_t mutex;          // Protege los campos siguientes
+    pthread_cond_t hay_tareas;      // Señala tareas disponibles o terminación
+    pthread_cond_t sin_pendientes;  // Señala que no quedan tareas sin terminar
+    size_t disponibles;             // Tareas encoladas aún no reservadas por un trabajador
+    size_t sin_terminar;            // Tareas enviadas que no han terminado
+    unsigned long secuencia;
+    int terminar;
+
+    double inicio;
+    double fin;
+};
+
+// Devuelve el instante actual en segundos (reloj monótono)
+static double tiempo_actual(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Indica si la tarea 'a' debe ejecutarse antes que la tarea 'b'
+static int va_antes(OrdenTareas orden, const Tarea* a, const Tarea* b) {
+    if (a->prioritaria != b->prioritaria) {
+        return a->prioritaria;
+    }
+    if (orden == ORDEN_LPT && a->costo != b->costo) {
+        return a->costo > b->costo;
+    }
+    return a->secuencia < b->secuencia;
+}
+
+// Inserta una tarea en el montículo de una cola (con su mutex tomado)
+static int insertar_tarea(ColaTrabajador* cola, OrdenTareas orden, const Tarea* tarea) {
+    if (cola->num_tareas == cola->capacidad) {
+        size_t nueva = cola->capacidad ? cola->capacidad * 2 : 64;
+        Tarea* tmp = reasignar_memoria(MEMORIA_PLANIFICADOR, cola->tareas, nueva * sizeof(Tarea));
+        if (!tmp) {
+            return -1;
+        }
+        cola->tareas = tmp;
+        cola->capacidad = nueva;
+    }
+
+    // Subir la tarea hasta su posición
+    size_t i = cola->num_tareas++;
+    while (i > 0) {
+        size_t padre = (i - 1) / 2;
+        if (!va_antes(orden, tarea, &cola->tareas[padre])) {
+            break;
+        }
+        cola->tareas[i] = cola->tareas[padre];
+        i = padre;
+    }
+    cola->tareas[i] = *tarea;
+    cola->costo_pendiente += tarea->costo;
+    return 0;
+}
+
+// Extrae la tarea prioritaria del montículo de una cola (con su mutex tomado)
+static int extraer_tarea(ColaTrabajador* cola, OrdenTareas orden, Tarea* tarea) {
+    if (cola->num_tareas == 0) {
+        return 0;
+    }
+
+    *tarea = cola->tareas[0];
+    cola->costo_pendiente -= tarea->costo;
+
+    // Bajar la última tarea desde la raíz hasta su posición
+    Tarea ultima = cola->tareas[--cola->num_tareas];
+    size_t i = 0;
+    for (;;) {
+        size_t hijo = 2 * i + 1;
+        if (hijo >= cola->num_tareas) {
+            break;
+        }
+        if (hijo + 1 < cola->num_tareas && va_antes(orden, &cola->tareas[hijo + 1], &cola->tareas[hijo])) {
+            hijo++;
+        }
+        if (!va_antes(orden, &cola->tareas[hijo], &ultima)) {
+            break;
+        }
+        cola->tareas[i] = cola->tareas[hijo];
+        i = hijo;
+    }
+    if (cola->num_tareas > 0) {
+        cola->tareas[i] = ultima;
+    }
+    return 1;
+}
+
+// Obtiene una tarea de la cola propia o, si está vacía, la roba de la cola más cargada
+static int obtener_tarea(Planificador* pl, ColaTrabajador* propia, Tarea* tarea, int* robada) {
+    pthread_mutex_lock(&propia->mutex);
+    int encontrada = extraer_tarea(propia, pl->orden, tarea);
+    if (encontrada) {
+        propia->costo_en_curso = tarea->costo;
+    }
+    pthread_mutex_unlock(&propia->mutex);
+    if (encontrada) {
+        *robada = 0;
+        return 1;
+    }
+
+    // Elegir como víctima la cola con más costo pendiente y robar su tarea prioritaria
+    ColaTrabajador* victima = NULL;
+    size_t mayor_costo = 0;
+    size_t mayor_num = 0;
+    for (int i = 0; i < pl->num_trabajadores; i++) {
+        ColaTrabajador* cola = &pl->colas[i];
+        if (cola == propia) continue;
+        pthread_mutex_lock(&cola->mutex);
+        if (cola->num_tareas > 0 &&
+            (!victima || cola->costo_pendiente > mayor_costo ||
+             (cola->costo_pendiente == mayor_costo && cola->num_tareas > mayor_num))) {
+            victima = cola;
+            mayor_costo = cola->costo_pendiente;
+            mayor_num = cola->num_tareas;
+        }
+        pthread_mutex_unlock(&cola->mutex);
+    }
+
+    if (!victima) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&victima->mutex);
+    encontrada = extraer_tarea(victima, pl->orden, tarea);
+    pthread_mutex_unlock(&victima->mutex);
+
+    if (encontrada) {
+        pthread_mutex_lock(&propia->mutex);
+        propia->costo_en_curso = tarea->costo;
+        pthread_mutex_unlock(&propia->mutex);
+        *robada = 1;
+    }
+    return encontrada;
+}
+
+// Función que ejecuta cada hilo trabajador
+static void* bucle_trabajador(void* arg) {
+    ColaTrabajador* propia = (ColaTrabajador*)arg;
+    Planificador* pl = propia->planificador;
+
+    for (;;) {
+        // Reservar una tarea: garantiza que hay al menos una en alguna cola
+        pthread_mutex_lock(&pl->mutex);
+        while (pl->disponibles == 0 && !pl->terminar) {
+            pthread_cond_wait(&pl->hay_tareas, &pl->mutex);
+        }
+        if (pl->disponibles == 0) {
+            pthread_mutex_unlock(&pl->mutex);
+            break;
+        }
+        pl->disponibles--;
+        pthread_mutex_unlock(&pl->mutex);
+
+        // La reserva asegura que la búsqueda termina encontrando una tarea
+        Tarea tarea;
+        int robada = 0;
+        while (!obtener_tarea(pl, propia, &tarea, &robada)) {
+            sched_yield();
+        }
+
+        double inicio = tiempo_actual();
+        tarea.funcion(tarea.datos, propia->id);
+        propia->tiempo_ocupado += tiempo_actual() - inicio;
+        propia->ejecutadas++;
+        propia->robadas += (size_t)robada;
+
+        pthread_mutex_lock(&propia->mutex);
+        propia->costo_en_curso = 0;
+        pthread_mutex_unlock(&propia->mutex);
+
+        pthread_mutex_lock(&pl->mutex);
+        pl->sin_terminar--;
+        if (pl->sin_terminar == 0) {
+            pthread_cond_broadcast(&pl->sin_pendientes);
+        }
+        pthread_mutex_unlock(&pl->mutex);
+    }
+
+    return NULL;
+}
+
+/**
+ * Obtiene el número de núcleos disponibles para el proceso
+ *
+ * Respeta la máscara de afinidad (taskset, cpusets) antes que el total del
+ * sistema, y la cuota de CPU del cgroup: con más hilos que la cuota el
+ * kernel los congela al agotarla en cada periodo.
+ */
+int obtener_num_nucleos(void) {
+    int nucleos = 0;
+    cpu_set_t conjunto;
+    if (sched_getaffinity(0, sizeof(conjunto), &conjunto) == 0) {
+        nucleos = CPU_COUNT(&conjunto);
+    }
+    if (nucleos <= 0) {
+        long en_linea = sysconf(_SC_NPROCESSORS_ONLN);
+        nucleos = en_linea > 0 ? (int)en_linea : 1;
+    }
+
+    // Una cuota fraccionaria se redondea hacia arriba
+    double cuota = obtener_limites_cgroup()->cpus;
+    if (cuota > 0.0 && cuota < (double)nucleos) {
+        int cpus_cuota = (int)cuota;
+        nucleos = cpus_cuota < cuota ? cpus_cuota + 1 : cpus_cuota;
+    }
+    return nucleos;
+}
+
+/**
+ * Crea un planificador y arranca sus hilos trabajadores
+ */
+Planificador* crear_planificador(int num_trabajadores, OrdenTareas orden) {
+    if (num_trabajadores <= 0) {
+        num_trabajadores = obtener_num_nucleos();
+    }
+
+    Planificador* pl = asignar_memoria_ceros(MEMORIA_PLANIFICADOR, 1, sizeof(Planificador));
+    if (!pl) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para el planificador\n");
+        return NULL;
+    }
+
+    pl->colas = asignar_memoria_ceros(MEMORIA_PLANIFICADOR, (size_t)num_trabajadores, sizeof(ColaTrabajador));
+    if (!pl->colas) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para las colas de trabajo\n");
+        liberar_asignacion(pl);
+        return NULL;
+    }
+
+    pl->num_trabajadores = num_trabajadores;
+    pl->orden = orden;
+    pl->inicio = tiempo_actual();
+    pthread_mutex_init(&pl->mutex, NULL);
+    pthread_cond_init(&pl->hay_tareas, NULL);
+    pthread_cond_init(&pl->sin_pendientes, NULL);
+
+    for (int i = 0; i < num_trabajadores; i++) {
+        pthread_mutex_init(&pl->colas[i].mutex, NULL);
+        pl->colas[i].id = i;
+        pl->colas[i].nodo = -1;
+        pl->colas[i].planificador = pl;
+    }
+
+    for (int i = 0; i < num_trabajadores; i++) {
+        if (pthread_create(&pl->colas[i].hilo, NULL, bucle_trabajador, &pl->colas[i]) != 0) {
+            fprintf(stderr, "Error: No se pudo crear el hilo trabajador %d\n", i);
+            break;
+        }
+        pl->hilos_creados++;
+        sumar_memoria(MEMORIA_PILAS, tamano_pila_hilos());
+    }
+
+    if (pl->hilos_creados == 0) {
+        destruir_planificador(pl);
+        return NULL;
+    }
+
+    return pl;
+}
+
+/**
+ * Fija los trabajadores a los nodos NUMA, repartiéndolos por turnos
+ */
+int fijar_trabajadores_por_nodo(Planificador* pl) {
+    if (!pl) return -1;
+
+    TopologiaNuma* topologia = asignar_memoria(MEMORIA_PLANIFICADOR, sizeof(TopologiaNuma));
+    if (!topologia || leer_topologia_numa(topologia) != 0) {
+        liberar_asignacion(topologia);
+        return -1;
+    }
+
+    int resultado = topologia->num_nodos;
+    for (int i = 0; i < pl->hilos_creados; i++) {
+        int indice = i % topologia->num_nodos;
+        if (fijar_hilo_en_nodo(topologia, indice, pl->colas[i].hilo) != 0) {
+            resultado = -1;
+            break;
+        }
+        pl->colas[i].nodo = topologia->ids[indice];
+    }
+
+    liberar_asignacion(topologia);
+    return resultado;
+}
+
+/**
+ * Suma bytes procesados al trabajador que ejecuta la tarea
+ */
+void sumar_bytes_trabajador(Planificador* pl, int id_trabajador, size_t bytes) {
+    if (pl && id_trabajador >= 0 && id_trabajador < pl->hilos_creados) {
+        pl->colas[id_trabajador].bytes += bytes;
+    }
+}
+
+// Encola una tarea en el trabajador de origen o en el menos cargado
+static int encolar_tarea(Planificador* pl, int id_origen, FuncionTarea funcion, void* datos,
+                         size_t costo, int prioritaria) {
+    if (!pl || !funcion) {
+        return -1;
+    }
+
+    Tarea tarea;
+    tarea.funcion = funcion;
+    tarea.datos = datos;
+    tarea.costo = costo;
+    tarea.prioritaria = prioritaria;
+
+    pthread_mutex_lock(&pl->mutex);
+    tarea.secuencia = pl->secuencia++;
+    pl->sin_terminar++;
+    pthread_mutex_unlock(&pl->mutex);
+
+    // Desde fuera del pool: asignar al trabajador con menos carga (pendiente + en curso)
+    ColaTrabajador* destino = NULL;
+    if (id_origen >= 0 && id_origen < pl->hilos_creados) {
+        destino = &pl->colas[id_origen];
+    } else {
+        size_t menor_carga = 0;
+        for (int i = 0; i < pl->hilos_creados; i++) {
+            ColaTrabajador* cola = &pl->colas[i];
+            pthread_mutex_lock(&cola->mutex);
+            size_t carga = cola->costo_pendiente + cola->costo_en_curso;
+            pthread_mutex_unlock(&cola->mutex);
+            if (!destino || carga < menor_carga) {
+                destino = cola;
+                menor_carga = carga;
+            }
+        }
+    }
+
+    pthread_mutex_lock(&destino->mutex);
+    int resultado = insertar_tarea(destino, pl->orden, &tarea);
+    pthread_mutex_unlock(&destino->mutex);
+
+    pthread_mutex_lock(&pl->mutex);
+    if (resultado == 0) {
+        pl->disponibles++;
+        pthread_cond_signal(&pl->hay_tareas);
+    } else {
+        fprintf(stderr, "Error: No se pudo asignar memoria para encolar la tarea\n");
+        pl->sin_terminar--;
+        if (pl->sin_terminar == 0) {
+            pthread_cond_broadcast(&pl->sin_pendientes);
+        }
+    }
+    pthread_mutex_unlock(&pl->mutex);
+
+    return resultado;
+}
+
+/**
+ * Envía una tarea al planificador
+ */
+int enviar_tarea(Planificador* pl, int id_origen, FuncionTarea funcion, void* datos, size_t costo) {
+    return encolar_tarea(pl, id_origen, funcion, datos, costo, 0);
+}
+
+/**
+ * Envía una tarea que se ejecuta antes que las ordinarias
+ */
+int enviar_tarea_prioritaria(Planificador* pl, int id_origen, FuncionTarea funcion,
+                             void* datos, size_t costo) {
+    return encolar_tarea(pl, id_origen, funcion, datos, costo, 1);
+}
+
+/**
+ * Espera a que terminen todas las tareas enviadas
+ */
+void esperar_planificador(Planificador* pl) {
+    if (!pl) return;
+
+    pthread_mutex_lock(&pl->mutex);
+    while (pl->sin_terminar > 0) {
+        pthread_cond_wait(&pl->sin_pendientes, &pl->mutex);
+    }
+    pthread_mutex_unlock(&pl->mutex);
+
+    pl->fin = tiempo_actual();
+}
+
+/**
+ * Obtiene el número de hilos trabajadores del planificador
+ */
+int obtener_num_trabajadores(const Planificador* pl) {
+    return pl ? pl->hilos_creados : 0;
+}
+
+/**
+ * Obtiene las estadísticas acumuladas del planificador
+ *
+ * Debe llamarse después de esperar_planificador(), cuando los trabajadores
+ * están ociosos.
+ */
+void obtener_estadisticas_planificador(Planificador* pl, EstadisticasPlanificador* est) {
+    memset(est, 0, sizeof(*est));
+    if (!pl || pl->hilos_creados == 0) return;
+
+    double suma_ocupado = 0.0;
+    for (int i = 0; i < pl->hilos_creados; i++) {
+        ColaTrabajador* cola = &pl->colas[i];
+        est->tareas_ejecutadas += cola->ejecutadas;
+        est->tareas_robadas += cola->robadas;
+        suma_ocupado += cola->tiempo_ocupado;
+        if (cola->tiempo_ocupado > est->tiempo_ocupado_max) {
+            est->tiempo_ocupado_max = cola->tiempo_ocupado;
+        }
+    }
+    est->tiempo_ocupado_medio = suma_ocupado / pl->hilos_creados;
+    est->tiempo_total = (pl->fin > pl->inicio ? pl->fin : tiempo_actual()) - pl->inicio;
+}
+
+/**
+ * Obtiene las estadísticas de cada nodo NUMA con trabajadores fijados
+ *
+ * Como obtener_estadisticas_planificador, debe llamarse después de
+ * esperar_planificador().
+ */
+int obtener_estadisticas_nodos(Planificador* pl, EstadisticasNodo* nodos, int max_nodos) {
+    int num_nodos = 0;
+    if (!pl) return 0;
+
+    for (int i = 0; i < pl->hilos_creados; i++) {
+        ColaTrabajador* cola = &pl->colas[i];
+        if (cola->nodo < 0) continue;
+
+        int j = 0;
+        while (j < num_nodos && nodos[j].nodo != cola->nodo) j++;
+        if (j == num_nodos) {
+            if (num_nodos == max_nodos) continue;
+            memset(&nodos[j], 0, sizeof(nodos[j]));
+            nodos[j].nodo = cola->nodo;
+            num_nodos++;
+        }
+        nodos[j].trabajadores++;
+        nodos[j].bytes += cola->bytes;
+        nodos[j].tiempo_ocupado += cola->tiempo_ocupado;
+    }
+    return num_nodos;
+}
+
+/**
+ * Detiene los hilos trabajadores y libera el planificador
+ */
+void destruir_planificador(Planificador* pl) {
+    if (!pl) return;
+
+    pthread_mutex_lock(&pl->mutex);
+    pl->terminar = 1;
+    pthread_cond_broadcast(&pl->hay_tareas);
+    pthread_mutex_unlock(&pl->mutex);
+
+    for (int i = 0; i < pl->hilos_creados; i++) {
+        pthread_join(pl->colas[i].hilo, NULL);
+        restar_memoria(MEMORIA_PILAS, tamano_pila_hilos());
+    }
+
+    for (int i = 0; i < pl->num_trabajadores; i++) {
+        pthread_mutex_destroy(&pl->colas[i].mutex);
+        liberar_asignacion(pl->colas[i].tareas);
+    }
+
+    pthread_mutex_destroy(&pl->mutex);
+    pthread_cond_destroy(&pl->hay_tareas);
+    pthread_cond_destroy(&pl->sin_pendientes);
+    liberar_asignacion(pl->colas);
+    liberar_asignacion(pl);
+}
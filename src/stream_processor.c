@@ -0,0 +1,299 @@
+#define _GNU_SOURCE // pread() y pwrite()
+#include "../include/stream_processor.h"
+#include "../include/file_manager.h"
+#include "../include/compression.h"
+#include "../include/encryption.h"
+#include "../include/log.h"
+#include "../include/run_stats.h"
+#include "../include/perf_counters.h"
+#include "../include/memory_accounting.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+size_t memoria_por_archivo(char operacion, size_t tamano) {
+    switch (operacion) {
+        case 'c':
+            return tamano + 1 + cota_compresion_rle(tamano);
+        case 'd':
+            return tamano + 1 + cota_descompresion_rle(tamano);
+        default:
+            return tamano + 1; // Vigenère transforma el buffer de lectura sin otra copia
+    }
+}
+
+size_t trozo_para_limite(char operacion, size_t limite) {
+    size_t trozo = TAMANO_TROZO_FLUJO;
+    if (limite > 0) {
+        // Entrada más salida en el peor caso; Vigenère transforma el trozo sin otra copia
+        switch (operacion) {
+            case 'c':
+                trozo = limite / 3;
+                break;
+            case 'd':
+                trozo = limite / 11 * 2;
+                break;
+            default:
+                trozo = limite;
+                break;
+        }
+    }
+    if (trozo > TAMANO_TROZO_FLUJO) {
+        trozo = TAMANO_TROZO_FLUJO;
+    }
+    if (trozo < TAMANO_TROZO_MINIMO) {
+        trozo = TAMANO_TROZO_MINIMO;
+    }
+    return trozo;
+}
+
+// Lee hasta tamano bytes desde una posición, reintentando si la llamada se interrumpe
+static ssize_t leer_trozo(int fd, char* destino, size_t tamano, off_t desplazamiento) {
+    size_t total = 0;
+    while (total < tamano) {
+        ssize_t n = pread(fd, destino + total, tamano - total, desplazamiento + (off_t)total);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        total += (size_t)n;
+    }
+    return (ssize_t)total;
+}
+
+// Comprueba si el archivo debe procesarse por el camino en memoria (formatos
+// ya comprimidos, contenedores almacenados o dispersos y cabeceras
+// desconocidas; el contenedor RLE se procesa por trozos). Con dos etapas, la cabecera se pasa
+// por la primera (Vigenère) antes de comprobar si la segunda (RLE) la
+// trataría de forma especial
+static int requiere_camino_en_memoria(int fd, off_t tamano, const char* etapas, const char* clave) {
+    char operacion = etapas[0];
+    if (tamano == 0) {
+        return 1;
+    }
+    if (operacion != 'd' && descriptor_tiene_huecos(fd, tamano)) {
+        return 1;
+    }
+
+    char cabecera[TAMANO_FIRMA_COMPRIMIDO];
+    ssize_t leidos = pread(fd, cabecera, sizeof(cabecera), 0);
+    if (leidos <= 0) {
+        return 1;
+    }
+    if (etapas[1] != '\0' && (operacion == 'e' || operacion == 'u')) {
+        FlujoVigenere flujo;
+        iniciar_flujo_vigenere(&flujo, clave, operacion == 'u');
+        aplicar_vigenere_flujo(&flujo, cabecera, cabecera, (size_t)leidos);
+        operacion = etapas[1];
+    }
+    if (operacion == 'c' && es_formato_comprimido(cabecera, (size_t)leidos)) {
+        return 1;
+    }
+    if (operacion != 'd') {
+        return 0;
+    }
+    TipoContenedor tipo = identificar_contenedor(cabecera, (size_t)leidos);
+    return tipo != CONTENEDOR_NINGUNO && tipo != CONTENEDOR_RLE;
+}
+
+// Aplica una etapa RLE a un trozo (o, con datos NULL, emite lo pendiente al final)
+static size_t aplicar_etapa_rle(FlujoRle* flujo, char operacion, const char* datos, size_t tamano, char* salida) {
+    if (!datos) {
+        return operacion == 'c' ? finalizar_compresion_rle_flujo(flujo, salida)
+                                : finalizar_descompresion_rle_flujo(flujo, salida);
+    }
+    return operacion == 'c' ? comprimir_rle_flujo(flujo, datos, tamano, salida)
+                            : descomprimir_rle_flujo(flujo, datos, tamano, salida);
+}
+
+/**
+ * Procesa un archivo por trozos pasando cada trozo por una o dos etapas
+ *
+ * Las etapas son operaciones ('c', 'd', 'e', 'u') con como mucho una de RLE.
+ * Vigenère transforma en el sitio el trozo que recibe, así que basta un
+ * buffer de entrada y, si hay etapa RLE, uno de salida.
+ */
+static int procesar_etapas_en_flujo(const char* ruta_entrada, const char* ruta_salida,
+                                    const char* etapas, const char* algoritmo_comp,
+                                    const char* algoritmo_enc, const char* clave,
+                                    size_t tamano_trozo) {
+    if (!ruta_entrada || !ruta_salida || tamano_trozo == 0) {
+        fprintf(stderr, "Error: Parámetros inválidos para procesar_archivo_en_flujo\n");
+        return -1;
+    }
+
+    // Los algoritmos o claves no válidos se informan en el camino habitual
+    char etapa_rle = '\0';
+    FlujoVigenere flujo_vigenere;
+    size_t num_etapas = strlen(etapas);
+    for (size_t i = 0; i < num_etapas; i++) {
+        char operacion = etapas[i];
+        int es_rle = (operacion == 'c' || operacion == 'd') && algoritmo_comp && strcmp(algoritmo_comp, "rle") == 0;
+        int es_vigenere = (operacion == 'e' || operacion == 'u') && algoritmo_enc &&
+                          strcmp(algoritmo_enc, "vigenere") == 0 && validar_clave(clave);
+        if ((!es_rle && !es_vigenere) || (es_rle && etapa_rle != '\0')) {
+            return 1;
+        }
+        if (es_rle) {
+            etapa_rle = operacion;
+        } else {
+            iniciar_flujo_vigenere(&flujo_vigenere, clave, operacion == 'u');
+        }
+    }
+    if (num_etapas == 0 || (num_etapas > 1 && etapa_rle == '\0')) {
+        return 1;
+    }
+    int vigenere_primero = (etapas[0] == 'e' || etapas[0] == 'u');
+    int vigenere_despues = num_etapas > 1 ? !vigenere_primero : (etapa_rle == '\0');
+
+    int fd_entrada = open(ruta_entrada, O_RDONLY);
+    if (fd_entrada == -1) {
+        fprintf(stderr, "Error: No se pudo abrir el archivo '%s': %s\n", ruta_entrada, strerror(errno));
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd_entrada, &st) == -1) {
+        fprintf(stderr, "Error: No se pudo obtener información del archivo '%s': %s\n", ruta_entrada, strerror(errno));
+        close(fd_entrada);
+        return -1;
+    }
+    if (requiere_camino_en_memoria(fd_entrada, st.st_size, etapas, clave)) {
+        close(fd_entrada);
+        return 1;
+    }
+
+    // Vigenère transforma el trozo sobre sí mismo; RLE necesita un buffer de salida
+    // (al comprimir, el primer trozo puede llevar delante la cabecera de contenedor)
+    size_t tamano_salida = etapa_rle == 'c' ? tamano_trozo * 2 + 2 + TAMANO_CABECERA_CONTENEDOR :
+                           etapa_rle == 'd' ? cota_descompresion_rle(tamano_trozo + 1) : 0;
+    char* entrada = asignar_memoria(MEMORIA_FLUJO, tamano_trozo);
+    char* salida = tamano_salida ? asignar_memoria(MEMORIA_FLUJO, tamano_salida) : entrada;
+    if (!entrada || !salida) {
+        fprintf(stderr, "Error: No se pudo asignar memoria para procesar '%s' en flujo\n", ruta_entrada);
+        if (salida != entrada) liberar_asignacion(salida);
+        liberar_asignacion(entrada);
+        close(fd_entrada);
+        return -1;
+    }
+
+    int fd_salida = open(ruta_salida, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_salida == -1) {
+        fprintf(stderr, "Error: No se pudo crear/abrir el archivo '%s': %s\n", ruta_salida, strerror(errno));
+        if (salida != entrada) liberar_asignacion(salida);
+        liberar_asignacion(entrada);
+        close(fd_entrada);
+        return -1;
+    }
+
+    FlujoRle flujo_rle;
+    iniciar_flujo_rle(&flujo_rle);
+
+    int resultado = 0;
+    size_t num_trozos = 0;
+    off_t pos_entrada = 0; // La detección de huecos mueve el offset del descriptor: se lee con pread
+    off_t pos_salida = 0;
+    for (;;) {
+        double inicio = iniciar_medida();
+        ssize_t leidos = leer_trozo(fd_entrada, entrada, tamano_trozo, pos_entrada);
+        if (leidos == -1) {
+            fprintf(stderr, "Error: No se pudo leer el archivo '%s': %s\n", ruta_entrada, strerror(errno));
+            resultado = -1;
+            break;
+        }
+        registrar_medida(MEDIDA_LECTURA, inicio, (size_t)leidos);
+
+        // Fin de la entrada: la etapa RLE emite lo que quedó pendiente del último trozo
+        size_t producidos = 0;
+        inicio = iniciar_medida();
+        LecturaContadoresHw contadores;
+        if (leidos > 0 && vigenere_primero && etapa_rle != '\0') {
+            leer_contadores_hw(&contadores);
+            aplicar_vigenere_flujo(&flujo_vigenere, entrada, entrada, (size_t)leidos);
+            registrar_contadores_hw(etapas[0], &contadores, (size_t)leidos);
+        }
+        if (etapa_rle != '\0') {
+            // El primer trozo lleva (o trae) la cabecera del contenedor RLE
+            size_t cabecera = 0;
+            size_t saltar = 0;
+            if (pos_entrada == 0 && leidos > 0) {
+                if (etapa_rle == 'c' && requiere_contenedor_rle(entrada, (size_t)leidos)) {
+                    escribir_cabecera_contenedor(CONTENEDOR_RLE, salida);
+                    cabecera = TAMANO_CABECERA_CONTENEDOR;
+                } else if (etapa_rle == 'd' &&
+                           identificar_contenedor(entrada, (size_t)leidos) == CONTENEDOR_RLE) {
+                    saltar = TAMANO_CABECERA_CONTENEDOR;
+                }
+            }
+            leer_contadores_hw(&contadores);
+            producidos = cabecera + aplicar_etapa_rle(&flujo_rle, etapa_rle, leidos > 0 ? entrada + saltar : NULL,
+                                                      (size_t)leidos - saltar, salida + cabecera);
+            registrar_contadores_hw(etapa_rle, &contadores, (size_t)leidos);
+        } else {
+            producidos = (size_t)leidos;
+        }
+        if (vigenere_despues) {
+            leer_contadores_hw(&contadores);
+            aplicar_vigenere_flujo(&flujo_vigenere, salida, salida, producidos);
+            registrar_contadores_hw(etapas[num_etapas - 1], &contadores, producidos);
+        }
+        registrar_medida(MEDIDA_TRANSFORMACION, inicio, (size_t)leidos);
+
+        inicio = iniciar_medida();
+        if (producidos > 0 && escribir_rango_archivo(fd_salida, salida, producidos, pos_salida) != 0) {
+            fprintf(stderr, "Error: No se pudo escribir al archivo '%s': %s\n", ruta_salida, strerror(errno));
+            resultado = -1;
+            break;
+        }
+        registrar_medida(MEDIDA_ESCRITURA, inicio, producidos);
+        pos_salida += (off_t)producidos;
+
+        if (leidos == 0) {
+            break;
+        }
+        pos_entrada += leidos;
+        num_trozos++;
+    }
+
+    if (resultado == 0 && sincronizar_archivo(fd_salida, (size_t)pos_salida) == -1) {
+        fprintf(stderr, "Advertencia: No se pudo sincronizar el archivo con el disco: %s\n", strerror(errno));
+    }
+    close(fd_salida);
+    close(fd_entrada);
+    if (salida != entrada) liberar_asignacion(salida);
+    liberar_asignacion(entrada);
+
+    if (resultado != 0) {
+        unlink(ruta_salida);
+        return -1;
+    }
+
+    LOG_INFO("Procesado en flujo: %s (%lld bytes -> %lld bytes, %zu trozos de %zu bytes)",
+             ruta_entrada, (long long)st.st_size, (long long)pos_salida, num_trozos, tamano_trozo);
+    return 0;
+}
+
+int procesar_archivo_en_flujo(const char* ruta_entrada, const char* ruta_salida,
+                              char operacion, const char* algoritmo_comp,
+                              const char* algoritmo_enc, const char* clave,
+                              size_t tamano_trozo) {
+    char etapas[2] = { operacion, '\0' };
+    return procesar_etapas_en_flujo(ruta_entrada, ruta_salida, etapas, algoritmo_comp,
+                                    algoritmo_enc, clave, tamano_trozo);
+}
+
+int procesar_combinada_en_flujo(const char* ruta_entrada, const char* ruta_salida,
+                                char primera, char segunda, const char* algoritmo_comp,
+                                const char* algoritmo_enc, const char* clave,
+                                size_t tamano_trozo) {
+    char etapas[3] = { primera, segunda, '\0' };
+    return procesar_etapas_en_flujo(ruta_entrada, ruta_salida, etapas, algoritmo_comp,
+                                    algoritmo_enc, clave, tamano_trozo);
+}
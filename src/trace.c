@@ -0,0 +1,232 @@
+#define _GNU_SOURCE // clock_gettime()
+#include "../include/trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+typedef struct {
+    const char* nombre;
+    double inicio;
+    double fin;
+    size_t bytes;
+    size_t etiqueta;    // Índice en las etiquetas del hilo
+    int asincrono;
+} EventoTraza;
+
+// Eventos y etiquetas de un hilo: solo los escribe su hilo
+typedef struct BufferTraza {
+    EventoTraza* eventos;
+    size_t num_eventos;
+    size_t capacidad_eventos;
+    size_t descartados;
+    char** etiquetas;
+    size_t num_etiquetas;
+    size_t capacidad_etiquetas;
+    size_t etiqueta_actual;     // num_etiquetas si el hilo no tiene etiqueta
+    int id;                     // Fila del hilo en el visor
+    struct BufferTraza* siguiente;
+} BufferTraza;
+
+static pthread_mutex_t mutex_traza = PTHREAD_MUTEX_INITIALIZER; // Protege la lista y el contador de ids
+static pthread_key_t clave_traza;
+static BufferTraza* buffers = NULL;
+static int siguiente_id = 0;
+static int activa = 0;
+static double inicio_traza = 0.0;
+
+static double segundos_monotonicos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Buffer del hilo llamador, creado y registrado en su primer uso
+static BufferTraza* buffer_del_hilo(void) {
+    BufferTraza* buffer = pthread_getspecific(clave_traza);
+    if (buffer) {
+        return buffer;
+    }
+
+    buffer = calloc(1, sizeof(BufferTraza));
+    if (!buffer) {
+        return NULL;
+    }
+    if (pthread_setspecific(clave_traza, buffer) != 0) {
+        free(buffer);
+        return NULL;
+    }
+    pthread_mutex_lock(&mutex_traza);
+    buffer->id = ++siguiente_id;
+    buffer->siguiente = buffers;
+    buffers = buffer;
+    pthread_mutex_unlock(&mutex_traza);
+    return buffer;
+}
+
+int iniciar_traza(void) {
+    if (activa) {
+        return 0;
+    }
+    // Los buffers sobreviven a sus hilos: se escriben al final
+    if (pthread_key_create(&clave_traza, NULL) != 0) {
+        fprintf(stderr, "Error: No se pudo activar la traza\n");
+        return -1;
+    }
+    inicio_traza = segundos_monotonicos();
+    activa = 1;
+    return 0;
+}
+
+int traza_activa(void) {
+    return activa;
+}
+
+void etiquetar_traza(const char* etiqueta) {
+    if (!activa || !etiqueta) {
+        return;
+    }
+    BufferTraza* buffer = buffer_del_hilo();
+    if (!buffer) {
+        return;
+    }
+    // Los bloques de un mismo archivo repiten la etiqueta
+    if (buffer->etiqueta_actual < buffer->num_etiquetas &&
+        strcmp(buffer->etiquetas[buffer->etiqueta_actual], etiqueta) == 0) {
+        return;
+    }
+
+    if (buffer->num_etiquetas == buffer->capacidad_etiquetas) {
+        size_t nueva = buffer->capacidad_etiquetas ? buffer->capacidad_etiquetas * 2 : 64;
+        char** etiquetas = realloc(buffer->etiquetas, nueva * sizeof(char*));
+        if (!etiquetas) {
+            buffer->etiqueta_actual = buffer->num_etiquetas;
+            return;
+        }
+        buffer->etiquetas = etiquetas;
+        buffer->capacidad_etiquetas = nueva;
+    }
+    size_t largo = strlen(etiqueta) + 1;
+    char* copia = malloc(largo);
+    if (!copia) {
+        buffer->etiqueta_actual = buffer->num_etiquetas;
+        return;
+    }
+    memcpy(copia, etiqueta, largo);
+    buffer->etiquetas[buffer->num_etiquetas] = copia;
+    buffer->etiqueta_actual = buffer->num_etiquetas++;
+}
+
+void anotar_evento_traza(const char* nombre, double inicio, double fin, size_t bytes, int asincrono) {
+    if (!activa) {
+        return;
+    }
+    BufferTraza* buffer = buffer_del_hilo();
+    if (!buffer) {
+        return;
+    }
+
+    if (buffer->num_eventos == buffer->capacidad_eventos) {
+        size_t nueva = buffer->capacidad_eventos ? buffer->capacidad_eventos * 2 : 1024;
+        EventoTraza* eventos = nueva <= MAX_EVENTOS_TRAZA_HILO ?
+                               realloc(buffer->eventos, nueva * sizeof(EventoTraza)) : NULL;
+        if (!eventos) {
+            buffer->descartados++;
+            return;
+        }
+        buffer->eventos = eventos;
+        buffer->capacidad_eventos = nueva;
+    }
+    EventoTraza* evento = &buffer->eventos[buffer->num_eventos++];
+    evento->nombre = nombre;
+    evento->inicio = inicio;
+    evento->fin = fin;
+    evento->bytes = bytes;
+    evento->etiqueta = buffer->etiqueta_actual;
+    evento->asincrono = asincrono;
+}
+
+// Escribe una cadena JSON escapando comillas, barras y caracteres de control
+static void escribir_cadena_json(FILE* destino, const char* texto) {
+    fputc('"', destino);
+    for (const unsigned char* p = (const unsigned char*)texto; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fprintf(destino, "\\%c", *p);
+        } else if (*p < 0x20) {
+            fprintf(destino, "\\u%04x", *p);
+        } else {
+            fputc(*p, destino);
+        }
+    }
+    fputc('"', destino);
+}
+
+// Microsegundos desde el inicio de la traza
+static double microsegundos(double instante) {
+    return (instante - inicio_traza) * 1e6;
+}
+
+// Escribe los argumentos comunes de un evento
+static void escribir_argumentos(FILE* destino, const BufferTraza* buffer, const EventoTraza* evento) {
+    fprintf(destino, ",\"args\":{\"bytes\":%zu", evento->bytes);
+    if (evento->etiqueta < buffer->num_etiquetas) {
+        fprintf(destino, ",\"archivo\":");
+        escribir_cadena_json(destino, buffer->etiquetas[evento->etiqueta]);
+    }
+    fprintf(destino, "}}");
+}
+
+int escribir_traza(const char* ruta) {
+    if (!activa || !ruta) {
+        return -1;
+    }
+    FILE* destino = fopen(ruta, "w");
+    if (!destino) {
+        fprintf(stderr, "Error: No se pudo crear el archivo de traza '%s'\n", ruta);
+        return -1;
+    }
+
+    // Los hilos ya terminaron: sus buffers se pueden leer sin cerrojos
+    pthread_mutex_lock(&mutex_traza);
+    fprintf(destino, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(destino, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"gsea\"}}");
+    size_t id_asincrono = 0;
+    size_t descartados = 0;
+    for (const BufferTraza* buffer = buffers; buffer; buffer = buffer->siguiente) {
+        fprintf(destino, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                "\"args\":{\"name\":\"hilo %d\"}}", buffer->id, buffer->id);
+        for (size_t i = 0; i < buffer->num_eventos; i++) {
+            const EventoTraza* evento = &buffer->eventos[i];
+            if (evento->asincrono) {
+                id_asincrono++;
+                fprintf(destino, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"b\",\"id\":%zu,\"pid\":1,"
+                        "\"tid\":%d,\"ts\":%.3f", evento->nombre, evento->nombre, id_asincrono,
+                        buffer->id, microsegundos(evento->inicio));
+                escribir_argumentos(destino, buffer, evento);
+                fprintf(destino, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"e\",\"id\":%zu,\"pid\":1,"
+                        "\"tid\":%d,\"ts\":%.3f}", evento->nombre, evento->nombre, id_asincrono,
+                        buffer->id, microsegundos(evento->fin));
+            } else {
+                fprintf(destino, ",\n{\"name\":\"%s\",\"cat\":\"fase\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                        "\"ts\":%.3f,\"dur\":%.3f", evento->nombre, buffer->id,
+                        microsegundos(evento->inicio), (evento->fin - evento->inicio) * 1e6);
+                escribir_argumentos(destino, buffer, evento);
+            }
+        }
+        descartados += buffer->descartados;
+    }
+    pthread_mutex_unlock(&mutex_traza);
+    fprintf(destino, "\n],\"otherData\":{\"eventos_descartados\":%zu}}\n", descartados);
+
+    int error = ferror(destino);
+    if (fclose(destino) != 0 || error) {
+        fprintf(stderr, "Error: No se pudo escribir el archivo de traza '%s'\n", ruta);
+        return -1;
+    }
+    if (descartados > 0) {
+        fprintf(stderr, "Advertencia: Se descartaron %zu eventos de la traza (máximo %zu por hilo)\n",
+                descartados, MAX_EVENTOS_TRAZA_HILO);
+    }
+    return 0;
+}
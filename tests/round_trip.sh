@@ -0,0 +1,128 @@
+#!/usr/bin/env bash
+# Pruebas de ida y vuelta de GSEA (make test)
+#
+# Comprime y descomprime con cmp cada caso que ha roto el formato alguna vez:
+# dígitos en la entrada, archivos dispersos, entradas ya comprimidas que se
+# almacenan sin transformar, salidas de RLE que empiezan como la firma de xz
+# y archivos planos que empiezan como una cabecera de contenedor. Los archivos
+# grandes se comparan además entre el procesamiento en memoria, por bloques
+# (con y sin --limite-memoria) y en flujo con --limite-memoria, que deben dar
+# la misma salida byte a byte.
+
+set -u
+
+GSEA=${1:-./gsea}
+DIRECTORIO=test_dir_ida_vuelta
+
+if [ ! -x "$GSEA" ]; then
+    echo "Error: No se encuentra el ejecutable '$GSEA'" >&2
+    exit 2
+fi
+
+rm -rf "$DIRECTORIO"
+mkdir -p "$DIRECTORIO" || exit 2
+trap 'rm -rf "$DIRECTORIO"' EXIT
+
+FALLOS=0
+
+fallo() {
+    echo "FALLO: $1" >&2
+    FALLOS=$((FALLOS + 1))
+}
+
+# gsea sin mensajes; los errores siguen en stderr
+gsea() {
+    "$GSEA" -q "$@" > /dev/null
+}
+
+# Comprime y descomprime un archivo con las mismas opciones y compara con el original
+ida_vuelta() {
+    local nombre=$1 original=$2
+    shift 2
+    if ! gsea -c --comp-alg rle -i "$original" -o "$original.rle" "$@"; then
+        fallo "$nombre: -c"
+        return 1
+    fi
+    if ! gsea -d --comp-alg rle -i "$original.rle" -o "$original.restaurado" "$@"; then
+        fallo "$nombre: -d"
+        return 1
+    fi
+    cmp -s "$original" "$original.restaurado" || { fallo "$nombre: la salida de -d no es el original"; return 1; }
+}
+
+# Primeros bytes de un archivo comparados con una cabecera escrita con printf
+empieza_con() {
+    cmp -s -n "$(printf "$2" | wc -c)" "$1" <(printf "$2")
+}
+
+# Dígitos sueltos y en rachas: el contador es un solo dígito tras el carácter
+{
+    printf '5%.0s' $(seq 1 30)
+    printf '1234567890112233'
+    printf 'A%.0s' $(seq 1 25)
+    printf '9\n'
+} > "$DIRECTORIO/digitos.txt"
+ida_vuelta "dígitos" "$DIRECTORIO/digitos.txt"
+
+# Archivo disperso: los huecos se conservan en el contenedor
+truncate -s 8M "$DIRECTORIO/disperso.bin"
+printf 'hola' | dd of="$DIRECTORIO/disperso.bin" bs=1 seek=4194304 conv=notrunc status=none
+if ida_vuelta "disperso" "$DIRECTORIO/disperso.bin"; then
+    [ "$(stat -c %s "$DIRECTORIO/disperso.bin.restaurado")" = 8388608 ] || fallo "disperso: tamaño restaurado"
+fi
+
+# Entrada ya comprimida: se almacena con la etiqueta ALM y -d la extrae tal cual
+seq 1 2000 | gzip -c > "$DIRECTORIO/datos.gz"
+if ida_vuelta "almacenado" "$DIRECTORIO/datos.gz"; then
+    empieza_con "$DIRECTORIO/datos.gz.rle" '\0GSEAALM' || fallo "almacenado: falta la cabecera ALM"
+fi
+
+# RLE de siete 0xFD seguido de "zXZ\0" empieza como la firma de xz: -d no debe almacenarlo
+printf '\375\375\375\375\375\375\375zXZ\0hello' > "$DIRECTORIO/colision_xz.bin"
+ida_vuelta "colisión con xz" "$DIRECTORIO/colision_xz.bin"
+
+# Archivo plano que empieza como un contenedor disperso: se comprime con la etiqueta RLE
+printf '\0GSEAHUE datos planos que no son un mapa de huecos' > "$DIRECTORIO/colision_contenedor.bin"
+if ida_vuelta "colisión con contenedor" "$DIRECTORIO/colision_contenedor.bin"; then
+    empieza_con "$DIRECTORIO/colision_contenedor.bin.rle" '\0GSEARLE' || fallo "colisión con contenedor: falta la cabecera RLE"
+fi
+
+# Archivos grandes con rachas, uno de ellos empezando por NUL
+awk 'BEGIN {
+    srand(1)
+    for (i = 0; i < 40000; i++) {
+        c = substr("ACGTN0123456789", int(rand() * 15) + 1, 1)
+        n = int(rand() * 12) + 1
+        for (j = 0; j < n; j++) printf "%s", c
+        if (i % 64 == 63) printf "\n"
+    }
+}' > "$DIRECTORIO/grande.txt"
+{ printf '\0\0\0'; cat "$DIRECTORIO/grande.txt"; } > "$DIRECTORIO/grande_nul.bin"
+
+for grande in grande.txt grande_nul.bin; do
+    original="$DIRECTORIO/$grande"
+    ida_vuelta "$grande en memoria" "$original" || continue
+    cp "$original.rle" "$original.memoria"
+
+    # Por bloques: misma salida que en memoria
+    if ida_vuelta "$grande por bloques" "$original" -t 3 --umbral-bloques 1K --tamano-bloque 4K; then
+        cmp -s "$original.memoria" "$original.rle" || fallo "$grande: la salida por bloques difiere de la de memoria"
+    fi
+
+    # Por bloques dentro de --limite-memoria: los bloques esperan sitio en el presupuesto
+    if ida_vuelta "$grande por bloques con límite" "$original" -t 3 --umbral-bloques 1K --tamano-bloque 4K \
+                  --limite-memoria 32K; then
+        cmp -s "$original.memoria" "$original.rle" || fallo "$grande: la salida por bloques con límite difiere de la de memoria"
+    fi
+
+    # En flujo con --limite-memoria: misma salida que en memoria
+    if ida_vuelta "$grande en flujo" "$original" --limite-memoria 64K; then
+        cmp -s "$original.memoria" "$original.rle" || fallo "$grande: la salida en flujo difiere de la de memoria"
+    fi
+done
+
+if [ $FALLOS -gt 0 ]; then
+    echo "Error: $FALLOS pruebas de ida y vuelta fallaron" >&2
+    exit 1
+fi
+echo "Pruebas de ida y vuelta completadas"